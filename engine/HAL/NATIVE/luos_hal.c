@@ -12,16 +12,31 @@
 #include <stdbool.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
 
 pthread_mutex_t mutex_msg_alloc = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t mutex_luos      = PTHREAD_MUTEX_INITIALIZER;
 
+#ifdef WITH_THREADED_RUNTIME
+typedef struct
+{
+    LUOS_TASK task;
+    void *arg;
+} hal_task_t;
+
+static pthread_mutex_t mutex_task = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_task   = PTHREAD_COND_INITIALIZER;
+#endif
+
 /*******************************************************************************
  * Function
  ******************************************************************************/
 static void LuosHAL_SystickInit(void);
 static void LuosHAL_FlashInit(void);
 static void LuosHAL_FlashEraseLuosMemoryInfo(void);
+#ifdef WITH_THREADED_RUNTIME
+static void *LuosHAL_TaskThread(void *arg);
+#endif
 
 /////////////////////////Luos Library Needed function///////////////////////////
 
@@ -41,6 +56,15 @@ void LuosHAL_Init(void)
 
         // start timestamp
         LuosHAL_StartTimestamp();
+
+#ifdef WITH_THREADED_RUNTIME
+        // Tasks lock Luos again when they send messages, the Luos mutex have to be recursive.
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&mutex_luos, &attr);
+        pthread_mutexattr_destroy(&attr);
+#endif
     }
 }
 
@@ -53,6 +77,66 @@ void LuosHAL_SetIrqState(bool Enable)
 {
 }
 
+#ifdef WITH_THREADED_RUNTIME
+/******************************************************************************
+ * @brief Run a task in its own thread
+ * @param task : Function to execute, it return false when it have nothing to do
+ * @param arg : Argument given to the task
+ * @return None
+ ******************************************************************************/
+void LuosHAL_CreateTask(LUOS_TASK task, void *arg)
+{
+    pthread_t thread_id;
+    hal_task_t *hal_task = malloc(sizeof(hal_task_t));
+    hal_task->task       = task;
+    hal_task->arg        = arg;
+    pthread_create(&thread_id, NULL, LuosHAL_TaskThread, hal_task);
+    pthread_detach(thread_id);
+}
+
+/******************************************************************************
+ * @brief Wake up all the tasks waiting for something to do
+ * @param None
+ * @return None
+ ******************************************************************************/
+void LuosHAL_NotifyTasks(void)
+{
+    pthread_mutex_lock(&mutex_task);
+    pthread_cond_broadcast(&cond_task);
+    pthread_mutex_unlock(&mutex_task);
+}
+
+/******************************************************************************
+ * @brief Thread executing a task
+ * @param arg : Pointer to the task to execute
+ * @return None
+ ******************************************************************************/
+static void *LuosHAL_TaskThread(void *arg)
+{
+    hal_task_t *hal_task = (hal_task_t *)arg;
+    struct timespec deadline;
+    while (1)
+    {
+        if (hal_task->task(hal_task->arg) == false)
+        {
+            // Nothing to do, wait for a notification.
+            // Tasks also have timeouts to manage, so never sleep more than 1ms.
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 1000000;
+            if (deadline.tv_nsec >= 1000000000)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+            pthread_mutex_lock(&mutex_task);
+            pthread_cond_timedwait(&cond_task, &mutex_task, &deadline);
+            pthread_mutex_unlock(&mutex_task);
+        }
+    }
+    return NULL;
+}
+#endif
+
 /******************************************************************************
  * @brief Luos HAL general systick tick at 1ms initialize
  * @param None
@@ -56,4 +56,11 @@ uint64_t LuosHAL_GetTimestamp(void);
 void LuosHAL_StartTimestamp(void);
 void LuosHAL_StopTimestamp(void);
 
+#ifdef WITH_THREADED_RUNTIME
+// threaded runtime functions
+typedef bool (*LUOS_TASK)(void *arg);
+void LuosHAL_CreateTask(LUOS_TASK task, void *arg);
+void LuosHAL_NotifyTasks(void);
+#endif
+
 #endif /* _LUOSHAL_H_ */
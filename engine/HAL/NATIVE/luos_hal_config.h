@@ -28,6 +28,8 @@ static uint32_t *last_page_stub_flash_x86 = &stub_flash_x86[FLASH_PAGE_NUMBER -
 
 /*******************************************************************************
  * DEFINE THREAD MUTEX LOCKING AND UNLOCKING FUNCTIONS
+ * Define WITH_THREADED_RUNTIME to run the messages dispatching and each service
+ * callback on dedicated threads instead of Luos_Loop.
  ******************************************************************************/
 #include <pthread.h>
 extern pthread_mutex_t mutex_msg_alloc;
@@ -12,6 +12,14 @@
 #include <stdbool.h>
 #include <string.h>
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+// Topology cache flash region, it survives LuosHAL_Init like a flash and is erased on the first access.
+static uint8_t stub_memory_info[TOPOLOGY_CACHE_SIZE];
+static bool stub_memory_info_erased = false;
+void (*stub_irq_handler)(void)      = NULL;
+
 /*******************************************************************************
  * Function
  ******************************************************************************/
@@ -47,6 +55,10 @@ void LuosHAL_Init(void)
  ******************************************************************************/
 void LuosHAL_SetIrqState(bool Enable)
 {
+    if ((Enable == true) && (stub_irq_handler != NULL))
+    {
+        stub_irq_handler();
+    }
 }
 
 /******************************************************************************
@@ -120,6 +132,8 @@ static void LuosHAL_FlashInit(void)
  ******************************************************************************/
 static void LuosHAL_FlashEraseLuosMemoryInfo(void)
 {
+    memset(stub_memory_info, 0xFF, sizeof(stub_memory_info));
+    stub_memory_info_erased = true;
 }
 
 /******************************************************************************
@@ -129,6 +143,14 @@ static void LuosHAL_FlashEraseLuosMemoryInfo(void)
  ******************************************************************************/
 void LuosHAL_FlashWriteLuosMemoryInfo(uint32_t addr, uint16_t size, uint8_t *data)
 {
+    if (stub_memory_info_erased == false)
+    {
+        LuosHAL_FlashEraseLuosMemoryInfo();
+    }
+    if ((addr - TOPOLOGY_CACHE_ADDRESS + size) <= sizeof(stub_memory_info))
+    {
+        memcpy(&stub_memory_info[addr - TOPOLOGY_CACHE_ADDRESS], data, size);
+    }
 }
 
 /******************************************************************************
@@ -138,7 +160,15 @@ void LuosHAL_FlashWriteLuosMemoryInfo(uint32_t addr, uint16_t size, uint8_t *dat
  ******************************************************************************/
 void LuosHAL_FlashReadLuosMemoryInfo(uint32_t addr, uint16_t size, uint8_t *data)
 {
+    if (stub_memory_info_erased == false)
+    {
+        LuosHAL_FlashEraseLuosMemoryInfo();
+    }
     memset(data, 0xFF, size);
+    if ((addr - TOPOLOGY_CACHE_ADDRESS + size) <= sizeof(stub_memory_info))
+    {
+        memcpy(data, &stub_memory_info[addr - TOPOLOGY_CACHE_ADDRESS], size);
+    }
 }
 
 /******************************************************************************
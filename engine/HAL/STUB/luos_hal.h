@@ -23,6 +23,8 @@
 /*******************************************************************************
  * Variables
  ******************************************************************************/
+// Called each time the IRQs are enabled again, the tests can run the work of an IRQ with it
+extern void (*stub_irq_handler)(void);
 
 /*******************************************************************************
  * Function
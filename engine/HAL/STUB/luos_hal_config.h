@@ -53,6 +53,16 @@ static uint32_t *last_page_stub_flash_x86 = &stub_flash_x86[FLASH_PAGE_NUMBER -
     #define ADDRESS_LAST_PAGE_FLASH (uint32_t) last_page_stub_flash_x86
 #endif
 
+/*******************************************************************************
+ * TOPOLOGY CACHE CONFIG
+ ******************************************************************************/
+#ifndef TOPOLOGY_CACHE_ADDRESS
+    #define TOPOLOGY_CACHE_ADDRESS 0 // The topology cache is kept in RAM, its address is an offset in it
+#endif
+#ifndef TOPOLOGY_CACHE_SIZE
+    #define TOPOLOGY_CACHE_SIZE (15 * PAGE_SIZE) // Size of the topology cache flash region
+#endif
+
 /*******************************************************************************
  * BOOTLOADER CONFIG
  ******************************************************************************/
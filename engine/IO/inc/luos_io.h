@@ -26,7 +26,11 @@
 void LuosIO_Init(void);
 void LuosIO_Loop(void);
 int LuosIO_TopologyDetection(service_t *service, connection_t *connection_table);
+int LuosIO_BranchDetection(service_t *service, uint16_t node_id, uint16_t nb_node, connection_t *connection_table);
+error_return_t LuosIO_GetNodeServiceNb(uint16_t node_id, uint16_t *service_nb);
+error_return_t LuosIO_GetNodeSignature(uint16_t node_id, uint32_t *signature);
 error_return_t LuosIO_Send(service_t *service, msg_t *msg);
+error_return_t LuosIO_SendSegments(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb);
 
 // Job management
 error_return_t LuosIO_GetNextJob(phy_job_t **job);
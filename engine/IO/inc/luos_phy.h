@@ -33,6 +33,7 @@ extern "C"
     // Phy creation
     luos_phy_t *Phy_Create(JOB_CB job_cb, RUN_TOPO run_topo, RESET_PHY reset_phy); // Use it to reference your phy to Luos.
     void Phy_DisableSynchro(luos_phy_t *phy_ptr);                                  // Use it to disable the luos synchronisation mechanism with this phy.
+    void Phy_SetMtu(luos_phy_t *phy_ptr, uint16_t mtu);                            // Use it to limit the data size of the messages on this phy. (By default MAX_DATA_MSG_SIZE)
 
     // Topology management
     void Phy_TopologyNext(void);                                   // Use it to find the next node that need to be detected accross phys.
@@ -41,19 +42,23 @@ extern "C"
 
     // Rx management
     void Phy_ComputeHeader(luos_phy_t *phy_ptr); // After receiving the first 7 bytes (the header) call this function to compute how you should manage the incoming message.
+    void Phy_alloc(luos_phy_t *phy_ptr);         // After Phy_ComputeHeader, call this function to allocate the message and receive the next bytes directly in phy_ptr.rx_data.
     void Phy_ValidMsg(luos_phy_t *phy_ptr);      // After receiving as much valid bytes as phy_ptr.rx_size, call this function to validate the message.
     void Phy_ResetMsg(luos_phy_t *phy_ptr);      // Call this function to reset the rx process.
 
     // Tx management
-    time_luos_t Phy_ComputeMsgTimestamp(luos_phy_t *phy_ptr, phy_job_t *job); // Use it to compute the timestamp of the message to send.
+    time_luos_wire_t Phy_ComputeMsgTimestamp(luos_phy_t *phy_ptr, phy_job_t *job); // Use it to compute the timestamp of the message to send.
     uint64_t Phy_GetTimestamp(void);                                          // Use it to get the current timestamp in ns.
     uint16_t Phy_GetNodeId(void);                                             // Use it to get your current node id. (This can be used to compute priority or controled latency avoiding infinite collision condition)
+    uint8_t Phy_GetProtocolRevision(void);                                    // Use it to get the protocol revision shared by all the nodes of the network. (This can be used to enable protocol extensions)
 
     // Job management
-    void Phy_FailedJob(luos_phy_t *phy_ptr, phy_job_t *job); // If some messages failed to be sent, call this function to consider the target as dead
-    phy_job_t *Phy_GetJob(luos_phy_t *phy_ptr);              // Use it to get the first job to send.
-    void Phy_RmJob(luos_phy_t *phy_ptr, phy_job_t *job);     // Use it to remove a job from your phy job list when it's done.
-    uint16_t Phy_GetJobNumber(luos_phy_t *phy_ptr);          // Use it to get the number of job to send.
+    void Phy_FailedJob(luos_phy_t *phy_ptr, phy_job_t *job);        // If some messages failed to be sent, call this function to consider the target as dead
+    phy_job_t *Phy_GetJob(luos_phy_t *phy_ptr);                     // Use it to get the first job to send.
+    phy_job_t *Phy_GetNextJob(luos_phy_t *phy_ptr, phy_job_t *job); // Use it to get the job following this one.
+    void Phy_RmJob(luos_phy_t *phy_ptr, phy_job_t *job);            // Use it to remove a job from your phy job list when it's done.
+    uint16_t Phy_GetJobNumber(luos_phy_t *phy_ptr);                 // Use it to get the number of job to send.
+    void Phy_CountRetry(luos_phy_t *phy_ptr, bool collision);       // Use it to count a transmission retry in the statistics.
 
 #ifdef __cplusplus
 }
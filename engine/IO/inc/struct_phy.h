@@ -77,6 +77,7 @@ typedef struct luos_phy_t
     volatile uint8_t job_nb;      // Number of jobs to send.
     uint16_t oldest_job_index;    // Index of the oldest job.
     uint16_t available_job_index; // Index of the next available job.
+    uint16_t mtu;                 // Maximum data size of a message this phy can transmit.
 
     // *************** Phy filters ***************
 
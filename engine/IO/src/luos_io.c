@@ -12,18 +12,25 @@
 #include "filter.h"
 #include "luos_utils.h"
 #include "luos_hal.h"
-#include "luos_engine.h"
+#include "_luos_engine.h"
 #include "_routing_table.h"
+#include "_clock_sync.h"
+#include "_topology_cache.h"
 #include "_luos_phy.h"
 #include "stats.h"
 
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#define BRANCH_DETECTION_TIMEOUT_MS (2 * DETECTION_TIMEOUT_MS) // The node detecting a branch have its own timeout, give it time to notify us
+
 static int LuosIO_StartTopologyDetection(service_t *service);
 static int LuosIO_DetectNextNodes(service_t *service);
 static error_return_t LuosIO_ConsumeMsg(const msg_t *input);
 static void LuosIO_TransmitLocalRoutingTable(service_t *service, msg_t *routeTB_msg);
+static void LuosIO_TransmitLocalRoutingTableEntries(service_t *service, msg_t *routeTB_msg, uint16_t entry);
+static uint16_t LuosIO_GetLocalRoutingTable(routing_table_t *local_routing_table);
+static uint32_t LuosIO_GetLocalSignature(void);
 
 // Phy_callbacks
 static void LuosIO_MsgHandler(luos_phy_t *phy_ptr, phy_job_t *job);
@@ -34,11 +41,17 @@ error_return_t LuosIO_RunTopo(luos_phy_t *phy_ptr, uint8_t *portId);
  ******************************************************************************/
 volatile uint16_t last_node        = 0;
 connection_t *connection_table_ptr = NULL;
+uint16_t node_service_nb[MAX_NODE_NUMBER]; // Number of services of each node given during the topology detection, 0xFFFF if unknown.
+uint32_t node_signature[MAX_NODE_NUMBER];  // Signature of the local routing table of each node given during the topology detection, 0 if unknown.
+uint8_t detection_revision = 0;            // Protocol revision of the detecting node.
 luos_phy_t *luos_phy;
 service_filter_t service_filter[MAX_MSG_NB]; // Service filter table. Each of these filter will be linked with jobs.
 uint8_t service_filter_index = 0;            // Index of the next service filter to use.
 service_t *detection_service = NULL;
 bool Flag_DetectServices     = false;
+uint16_t branch_node         = 0;     // Node looking for new nodes on its ports, 0 if there is no branch detection.
+bool branch_scan             = false; // This node is looking for new nodes on its ports.
+bool branch_done             = false; // The node looking for new nodes on its ports finished.
 
 /*******************************************************************************
  * Functions
@@ -59,6 +72,10 @@ void LuosIO_Reset(luos_phy_t *phy_ptr)
     Service_ClearId();
     // Reset the data reception context
     Luos_ReceiveData(NULL, NULL, NULL);
+    // Jobs are cleared, forget all the borrowed messages
+    Luos_ReleaseMsg(NULL, NULL);
+    // A branch detection is stopped by a complete one
+    branch_scan = false;
 }
 
 /******************************************************************************
@@ -86,6 +103,8 @@ void LuosIO_Init(void)
 
     // Detection init
     Flag_DetectServices = false;
+    branch_node         = 0;
+    branch_scan         = false;
 }
 
 /******************************************************************************
@@ -120,6 +139,31 @@ void LuosIO_Loop(void)
             detection_service   = NULL;
         }
     }
+    if (branch_scan == true)
+    {
+        // Look for new nodes on our ports
+        if (LuosIO_DetectNextNodes(NULL) != 0)
+        {
+            // Notify the detecting node that we are done
+            msg_t msg;
+            branch_scan            = false;
+            msg.header.target_mode = NODEIDACK;
+            msg.header.target      = 1;
+            msg.header.cmd         = BRANCH_DETECTION;
+            msg.header.size        = 0;
+            Luos_SendMsg(0, &msg);
+        }
+    }
+    if (branch_node != 0)
+    {
+        LUOS_ASSERT(detection_service != NULL);
+        // Check if the branch detection is finished
+        if (RoutingTB_DetectBranch(detection_service, branch_node))
+        {
+            branch_node       = 0;
+            detection_service = NULL;
+        }
+    }
 }
 
 /******************************************************************************
@@ -197,6 +241,65 @@ error_return_t LuosIO_Send(service_t *service, msg_t *msg)
     return error;
 }
 
+/******************************************************************************
+ * @brief Send a message header with a payload gathered from multiple segments
+ * @param service pointer to the service sending the message
+ * @param msg pointer to the message, only the header is used
+ * @param segments table of payload segments to copy after the header
+ * @param segment_nb number of segments in the table
+ * @return error_return_t SUCCEED if the message is sent, FAILED if there is no more space, PROHIBITED if the network is down
+ ******************************************************************************/
+error_return_t LuosIO_SendSegments(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb)
+{
+    LUOS_ASSERT((segments != NULL) || (segment_nb == 0));
+    // ***************************************************
+    // Don't send luos messages if the network is down
+    // ***************************************************
+    if ((msg->header.cmd >= LUOS_LAST_RESERVED_CMD) && (Node_GetState() != DETECTION_OK))
+    {
+        return PROHIBITED;
+    }
+
+    // Save the header information in the Luosphy struct
+    luos_phy->rx_buffer_base = (uint8_t *)msg;
+    luos_phy->rx_data        = luos_phy->rx_buffer_base;
+    // Only the header is available, the payload will be gathered directly into the allocated space.
+    luos_phy->received_data = sizeof(header_t);
+    luos_phy->rx_keep       = true; // Tell phy that we want to keep this message
+    Phy_ComputeHeader(luos_phy);
+    LUOS_ASSERT(luos_phy->rx_keep == true);
+    // Allocate the complete message, this only copy the header.
+    Phy_alloc(luos_phy);
+    if (luos_phy->rx_data == NULL)
+    {
+        // There is no more space on the buffer.
+        // Return a failure to notify user.
+        return FAILED;
+    }
+    if (luos_phy->rx_keep == false)
+    {
+        // Nobody is concerned by this message, there is nothing to gather.
+        return SUCCEED;
+    }
+    // Copy the payload segments right after the header
+    uint8_t *payload_pt = (uint8_t *)luos_phy->rx_data + sizeof(header_t);
+    uint16_t payload    = 0;
+    for (uint8_t i = 0; i < segment_nb; i++)
+    {
+        LUOS_ASSERT((payload + segments[i].size) <= (luos_phy->rx_size - sizeof(header_t)));
+        memcpy(&payload_pt[payload], segments[i].data, segments[i].size);
+        payload += segments[i].size;
+    }
+    // The segments have to fill the complete message
+    LUOS_ASSERT(payload == (luos_phy->rx_size - sizeof(header_t)));
+    luos_phy->received_data = luos_phy->rx_size;
+    // Validate the message to generate tasks.
+    Phy_ValidMsg(luos_phy);
+    // Execute phy loop to dispatch the allocated message.
+    Phy_Loop();
+    return SUCCEED;
+}
+
 /******************************************************************************
  * @brief Run a topology detection procedure as a master node.
  * @param service pointer to the detecting service
@@ -236,6 +339,11 @@ int LuosIO_TopologyDetection(service_t *service, connection_t *connection_table)
             }
             // Setup local node
             Node_Get()->node_id = 1;
+            // Nodes will give their number of services during the topology detection
+            memset(node_service_nb, 0xFF, sizeof(node_service_nb));
+            node_service_nb[0] = Service_GetNumber();
+            memset(node_signature, 0, sizeof(node_signature));
+            node_signature[0] = LuosIO_GetLocalSignature();
             // Add this node id in the Luos phy filter allowing us to receive node messages
             memset(luos_phy->nodes, 0, sizeof(luos_phy->nodes));
             Phy_IndexSet(luos_phy->nodes, 1);
@@ -279,6 +387,60 @@ int LuosIO_TopologyDetection(service_t *service, connection_t *connection_table)
     return last_node;
 }
 
+/******************************************************************************
+ * @brief Run a topology detection of the new nodes connected to a node without network reset.
+ * @param service pointer to the detecting service
+ * @param node_id node looking for new nodes on its ports
+ * @param nb_node number of nodes already on the network
+ * @param connection_table connections of the nodes, the new ones are added after the others
+ * @return 0 during the detection, -1 if it have been interrupted, then the number of nodes on the network
+ ******************************************************************************/
+int LuosIO_BranchDetection(service_t *service, uint16_t node_id, uint16_t nb_node, connection_t *connection_table)
+{
+    static uint8_t detect_state_machine = 0;
+    static uint32_t start_tick;
+    msg_t msg;
+
+    // Make sure that the detection is not interrupted
+    if (Node_GetState() == EXTERNAL_DETECTION)
+    {
+        detect_state_machine = 0;
+        connection_table_ptr = NULL;
+        return -1;
+    }
+    switch (detect_state_machine)
+    {
+        case 0:
+            // The new nodes get the ids following the ones of the network
+            connection_table_ptr = connection_table;
+            last_node            = nb_node;
+            branch_done          = false;
+            // Ask the node to look for new nodes, the other nodes forward the messages of the new ones
+            msg.header.target      = BROADCAST_VAL;
+            msg.header.target_mode = BROADCAST;
+            msg.header.cmd         = BRANCH_DETECTION;
+            msg.header.size        = sizeof(uint16_t);
+            memcpy(msg.data, &node_id, sizeof(uint16_t));
+            while (Luos_SendMsg(service, &msg) != SUCCEED)
+                ;
+            start_tick = LuosHAL_GetSystick();
+            detect_state_machine++;
+        case 1:
+            // The node looking for new nodes notify us when it is done
+            if ((branch_done == false) && (LuosHAL_GetSystick() - start_tick < BRANCH_DETECTION_TIMEOUT_MS))
+            {
+                return 0;
+            }
+            detect_state_machine = 0;
+            break;
+        default:
+            LUOS_ASSERT(0);
+            break;
+    }
+    connection_table_ptr = NULL;
+    return last_node;
+}
+
 /******************************************************************************
  * @brief Initiate a topology detection by reseting all service port states as a master node.
  * @param service pointer to the detecting service
@@ -302,7 +464,8 @@ static int LuosIO_StartTopologyDetection(service_t *service)
             msg.header.target      = BROADCAST_VAL;
             msg.header.target_mode = BROADCAST;
             msg.header.cmd         = START_DETECTION;
-            msg.header.size        = 0;
+            msg.header.size        = sizeof(uint8_t);
+            msg.data[0]            = PROTOCOL_REVISION;
             Luos_SendMsg(service, &msg);
             detect_state_machine++;
         case 1:
@@ -330,7 +493,8 @@ static int LuosIO_StartTopologyDetection(service_t *service)
             msg.header.target      = BROADCAST_VAL;
             msg.header.target_mode = BROADCAST;
             msg.header.cmd         = START_DETECTION;
-            msg.header.size        = 0;
+            msg.header.size        = sizeof(uint8_t);
+            msg.data[0]            = PROTOCOL_REVISION;
             Luos_SendMsg(service, &msg);
             detect_state_machine++;
         case 5:
@@ -341,6 +505,8 @@ static int LuosIO_StartTopologyDetection(service_t *service)
             }
             start_tick = LuosHAL_GetSystick();
             detect_state_machine++;
+            // Let the phy loop reset the phys with this message before waiting
+            return 0;
         case 6:
             // Wait 10ms to be sure all previous messages are received and treated by all the nodes
             if (LuosHAL_GetSystick() - start_tick < 10)
@@ -414,10 +580,19 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
         case PORT_DATA:
             LUOS_ASSERT(connection_table_ptr != NULL);
             // This is the last part (input port) of a connection_ data
-            // Check that we receive a full port information
-            LUOS_ASSERT(input->header.size == sizeof(port_t)
+            // Check that we receive a full port information, recent nodes add their number of services and their signature
+            LUOS_ASSERT(((input->header.size == sizeof(port_t)) || (input->header.size == sizeof(port_t) + sizeof(uint16_t))
+                         || (input->header.size == sizeof(port_t) + sizeof(uint16_t) + sizeof(uint32_t)))
                         && (connection_table_ptr[last_node - 1].parent.node_id != 0xFFFF));
             memcpy(&connection_table_ptr[last_node - 1].child, input->data, sizeof(port_t));
+            if (input->header.size > sizeof(port_t))
+            {
+                memcpy(&node_service_nb[last_node - 1], &input->data[sizeof(port_t)], sizeof(uint16_t));
+            }
+            if (input->header.size > sizeof(port_t) + sizeof(uint16_t))
+            {
+                memcpy(&node_signature[last_node - 1], &input->data[sizeof(port_t) + sizeof(uint16_t)], sizeof(uint32_t));
+            }
             // This message have been consumed
             return SUCCEED;
             break;
@@ -461,6 +636,20 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
             output_msg.header.cmd         = PORT_DATA;
             output_msg.header.size        = sizeof(port_t);
             memcpy(output_msg.data, input_port, sizeof(port_t));
+            if (detection_revision >= 4)
+            {
+                // The detecting node can ask all the local routing tables at once if it knows our number of services
+                uint16_t service_nb = Service_GetNumber();
+                memcpy(&output_msg.data[sizeof(port_t)], &service_nb, sizeof(uint16_t));
+                output_msg.header.size += sizeof(uint16_t);
+            }
+            if (detection_revision >= 5)
+            {
+                // The detecting node can reuse its saved routing table if our local routing table didn't change
+                uint32_t signature = LuosIO_GetLocalSignature();
+                memcpy(&output_msg.data[output_msg.header.size], &signature, sizeof(uint32_t));
+                output_msg.header.size += sizeof(uint32_t);
+            }
             Luos_SendMsg(service, &output_msg);
             // This message can't be send directly to avoid dispatch re-entrance issue.
             // To be able to send this message then run the detection of the other nodes we need to make it later on the LuosIO_Loop, so we put a flag for it.
@@ -487,6 +676,24 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
                     output_msg.header.target      = input->header.source;
                     LuosIO_TransmitLocalRoutingTable(0, &output_msg);
                     break;
+                case 4:
+                {
+                    // Generate local ID then send back the local route table entries at the given routing table entry
+                    // The detecting node already cleaned its routing table and may be filling it.
+                    uint16_t entry;
+                    if (Node_Get()->node_id != 1)
+                    {
+                        RoutingTB_Erase();
+                    }
+                    memcpy(&base_id, &input->data[0], sizeof(uint16_t));
+                    memcpy(&entry, &input->data[2], sizeof(uint16_t));
+                    Service_GenerateId(base_id);
+                    output_msg.header.cmd         = RTB_ENTRIES;
+                    output_msg.header.target_mode = NODEIDACK;
+                    output_msg.header.target      = input->header.source;
+                    LuosIO_TransmitLocalRoutingTableEntries(0, &output_msg, entry);
+                }
+                break;
                 default:
                     LUOS_ASSERT(0);
                     break;
@@ -494,6 +701,19 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
             return SUCCEED;
             break;
 
+        case SERVICE_BASE_ID:
+            // The detecting node already knows our local routing table, just generate our local IDs
+            // The detecting node keeps the routing table it loaded.
+            LUOS_ASSERT(input->header.size == sizeof(uint16_t));
+            if (Node_Get()->node_id != 1)
+            {
+                RoutingTB_Erase();
+            }
+            memcpy(&base_id, input->data, sizeof(uint16_t));
+            Service_GenerateId(base_id);
+            return SUCCEED;
+            break;
+
         case RTB:
             // We are receiving a routing table
             // Check routing table overflow
@@ -507,6 +727,36 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
             return SUCCEED;
             break;
 
+        case RTB_ENTRIES:
+            // We are receiving a part of a local routing table at a given entry
+            RoutingTB_ReceiveEntries(input);
+            return SUCCEED;
+            break;
+
+        case RTB_DELTA:
+            // We are receiving the routing table entries of new nodes
+            RoutingTB_ReceiveDelta(input);
+            return SUCCEED;
+            break;
+
+        case RTB_CHUNK:
+            // We are receiving a part of a broadcasted routing table
+            RoutingTB_ReceiveChunk(input);
+            return SUCCEED;
+            break;
+
+        case RTB_REPAIR:
+            // Tell the detecting node which parts of the routing table we missed
+            RoutingTB_ReceiveRepair(service, input);
+            return SUCCEED;
+            break;
+
+        case RTB_NACK:
+            // Only the detecting node should receive this message
+            RoutingTB_ReceiveNack(input);
+            return SUCCEED;
+            break;
+
         case PHY_ID:
 
             // We receive a phy id. We have to save it, because we will need it to save the indexes in the good phy.
@@ -550,8 +800,12 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
             break;
 
         case START_DETECTION:
+            // Save the protocol revision of the detecting node, older ones don't send it
+            detection_revision = (input->header.size >= sizeof(uint8_t)) ? input->data[0] : 0;
             // Reset All phy
             Phy_ResetAllNeeded();
+            // The reference clock may change, forget the previous one
+            ClockSync_Reset();
             // This message have been consumed
             return SUCCEED;
             break;
@@ -559,18 +813,69 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
         case END_DETECTION:
             // Detect end of detection
             Node_SetState(DETECTION_OK);
+            Phy_SetBranchDetection(false);
+            // Get the protocol revision and the message size of the network. Older masters don't send them and use the base values.
+            Node_SetProtocolRevision((input->header.size >= sizeof(uint8_t)) ? input->data[0] : 0);
+            if (input->header.size >= sizeof(uint8_t) + sizeof(uint16_t))
+            {
+                uint16_t mtu;
+                memcpy(&mtu, &input->data[1], sizeof(uint16_t));
+                Node_SetMtu(mtu);
+            }
             return FAILED;
             break;
 
         case ASK_DETECTION:
-            if (Node_GetState() < LOCAL_DETECTION)
+            if ((input->header.size == sizeof(uint16_t)) && (Node_Get()->node_id == 1) && (Node_GetState() == DETECTION_OK)
+                && (Node_GetProtocolRevision() >= 6))
             {
+                // Detect the new nodes connected to the given node, the network keeps running
+                if (branch_node == 0)
+                {
+                    memcpy(&branch_node, input->data, sizeof(uint16_t));
+                    detection_service = service;
+                }
+            }
+            else if ((Node_GetState() < LOCAL_DETECTION) && (branch_node == 0))
+            {
+                // Older nodes can't detect a branch, detect everything
                 detection_service   = service;
                 Flag_DetectServices = true;
             }
             return SUCCEED;
             break;
 
+        case BRANCH_DETECTION:
+            if (input->header.size == 0)
+            {
+                // Only the detecting node should receive this message, the node looking for new nodes is done
+                branch_done = true;
+                return SUCCEED;
+            }
+            // New nodes are connected to a node, they will get their ids without network reset
+            LUOS_ASSERT(input->header.size == sizeof(uint16_t));
+            Phy_SetBranchDetection(true);
+            memcpy(&base_id, input->data, sizeof(uint16_t));
+            if ((base_id != 0) && (base_id == Node_Get()->node_id))
+            {
+                // We have to look for the new nodes on our ports
+                branch_scan = true;
+            }
+            return SUCCEED;
+            break;
+
+        //**************************************** data transfer section ************************************
+        case DATA_CREDIT:
+            Luos_ReceiveDataCredit(input);
+            return SUCCEED;
+            break;
+
+        //**************************************** time section *********************************************
+        case CLOCK_SYNC:
+            ClockSync_Update(input);
+            return SUCCEED;
+            break;
+
         //**************************************** failure section ****************************************
         case ASSERT:
             // A service assert remove all services of the asserted node in routing table
@@ -647,6 +952,16 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
                 Luos_SendMsg(service, &output_msg);
                 return SUCCEED;
             }
+            if ((input->header.size == 1) && (input->data[0] == IO_STATS))
+            {
+                output_msg.header.cmd         = LUOS_STATISTICS;
+                output_msg.header.target_mode = SERVICEID;
+                output_msg.header.size        = sizeof(io_stats_t);
+                output_msg.header.target      = input->header.source;
+                memcpy(output_msg.data, Stats_GetIO()->unmap, sizeof(io_stats_t));
+                Luos_SendMsg(service, &output_msg);
+                return SUCCEED;
+            }
             break;
             //**************************************** service section ****************************************
 
@@ -697,10 +1012,52 @@ error_return_t LuosIO_ConsumeMsg(const msg_t *input)
 static inline void LuosIO_TransmitLocalRoutingTable(service_t *service, msg_t *routeTB_msg)
 {
     LUOS_ASSERT(routeTB_msg != NULL);
-    uint16_t entry_nb = 0;
     routing_table_t local_routing_table[Service_GetNumber() + 1];
+    uint16_t entry_nb = LuosIO_GetLocalRoutingTable(local_routing_table);
+    Luos_SendData(service, routeTB_msg, (void *)local_routing_table, (entry_nb * sizeof(routing_table_t)));
+}
 
-    // start by saving node entry
+/******************************************************************************
+ * @brief Transmit local RTB to network in self-contained messages
+ * @param service : Service who send
+ * @param routeTB_msg : Local RTB message to transmit
+ * @param entry : Routing table entry of our node in the detecting node routing table
+ * @return None
+ * @note Each message starts with the routing table entry of its first element, allowing the
+ *       detecting node to receive several local routing tables at the same time.
+ ******************************************************************************/
+static void LuosIO_TransmitLocalRoutingTableEntries(service_t *service, msg_t *routeTB_msg, uint16_t entry)
+{
+    LUOS_ASSERT(routeTB_msg != NULL);
+    routing_table_t local_routing_table[Service_GetNumber() + 1];
+    uint16_t entry_nb     = LuosIO_GetLocalRoutingTable(local_routing_table);
+    uint16_t msg_entry_nb = (BASE_DATA_MSG_SIZE - sizeof(uint16_t)) / sizeof(routing_table_t);
+    for (uint16_t i = 0; i < entry_nb; i += msg_entry_nb)
+    {
+        uint16_t nb    = ((entry_nb - i) > msg_entry_nb) ? msg_entry_nb : (entry_nb - i);
+        uint16_t index = entry + i;
+        memcpy(routeTB_msg->data, &index, sizeof(uint16_t));
+        memcpy(&routeTB_msg->data[sizeof(uint16_t)], &local_routing_table[i], nb * sizeof(routing_table_t));
+        routeTB_msg->header.size = sizeof(uint16_t) + nb * sizeof(routing_table_t);
+        // No more memory space available, wait for the previous messages to be sent.
+        uint32_t tickstart = LuosHAL_GetSystick();
+        while (Luos_SendMsg(service, routeTB_msg) == FAILED)
+        {
+            LUOS_ASSERT((LuosHAL_GetSystick() - tickstart) < 500);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Create the local RTB of this node
+ * @param local_routing_table : Table receiving the node and services entries
+ * @return Number of entries
+ ******************************************************************************/
+static uint16_t LuosIO_GetLocalRoutingTable(routing_table_t *local_routing_table)
+{
+    uint16_t entry_nb = 0;
+    // start by saving node entry with the biggest message size we can handle
+    Node_Get()->mtu = Phy_GetMtu();
     RoutingTB_ConvertNodeToRoutingTable(&local_routing_table[entry_nb], Node_Get());
     entry_nb++;
     // save services entry
@@ -708,7 +1065,53 @@ static inline void LuosIO_TransmitLocalRoutingTable(service_t *service, msg_t *r
     {
         RoutingTB_ConvertServiceToRoutingTable((routing_table_t *)&local_routing_table[entry_nb++], &Service_GetTable()[i]);
     }
-    Luos_SendData(service, routeTB_msg, (void *)local_routing_table, (entry_nb * sizeof(routing_table_t)));
+    return entry_nb;
+}
+
+/******************************************************************************
+ * @brief Compute the signature of the local RTB of this node
+ * @param None
+ * @return Signature of the local routing table
+ ******************************************************************************/
+static uint32_t LuosIO_GetLocalSignature(void)
+{
+    routing_table_t local_routing_table[Service_GetNumber() + 1];
+    uint16_t entry_nb = LuosIO_GetLocalRoutingTable(local_routing_table);
+    return TopologyCache_LocalSignature(local_routing_table, entry_nb);
+}
+
+/******************************************************************************
+ * @brief Get the number of services a node gave during the topology detection
+ * @param node_id : Id of the node
+ * @param service_nb : Number of services of this node
+ * @return SUCCEED if the node gave it, FAILED if it is unknown
+ ******************************************************************************/
+error_return_t LuosIO_GetNodeServiceNb(uint16_t node_id, uint16_t *service_nb)
+{
+    LUOS_ASSERT((service_nb != NULL) && (node_id > 0) && (node_id <= MAX_NODE_NUMBER));
+    if (node_service_nb[node_id - 1] == 0xFFFF)
+    {
+        return FAILED;
+    }
+    *service_nb = node_service_nb[node_id - 1];
+    return SUCCEED;
+}
+
+/******************************************************************************
+ * @brief Get the signature of the local routing table a node gave during the topology detection
+ * @param node_id : Id of the node
+ * @param signature : Signature of the local routing table of this node
+ * @return SUCCEED if the node gave it, FAILED if it is unknown
+ ******************************************************************************/
+error_return_t LuosIO_GetNodeSignature(uint16_t node_id, uint32_t *signature)
+{
+    LUOS_ASSERT((signature != NULL) && (node_id > 0) && (node_id <= MAX_NODE_NUMBER));
+    if (node_signature[node_id - 1] == 0)
+    {
+        return FAILED;
+    }
+    *signature = node_signature[node_id - 1];
+    return SUCCEED;
 }
 
 /******************************************************************************
@@ -748,6 +1151,7 @@ static int LuosIO_DetectNextNodes(service_t *service)
                 if (LuosHAL_GetSystick() - start_tick > DETECTION_TIMEOUT_MS)
                 {
                     // Topology detection is too long, we should abort it and restart
+                    detect_state_machine = 0;
                     return -1;
                 }
                 return 0;
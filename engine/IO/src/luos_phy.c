@@ -53,10 +53,17 @@
 #include "luos_io.h"
 #include "service.h"
 #include "filter.h"
+#include "stats.h"
 
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#define IO_JOB_RING_SIZE                (MAX_MSG_NB + 1)           // One slot always stay free to differentiate a full ring from an empty one.
+#define BRANCH_DETECTION_END_TIMEOUT_MS (4 * DETECTION_TIMEOUT_MS) // Without END_DETECTION the branch detection is considered as lost.
+
+// io_job ring indexes are shared between the reception (IRQ or thread) and the dispatch (loop) without any lock.
+#define IO_JOB_INDEX_LOAD(index)         __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define IO_JOB_INDEX_STORE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
 
 typedef struct __attribute__((__packed__))
 {
@@ -66,6 +73,14 @@ typedef struct __attribute__((__packed__))
     uint16_t size;
 } IO_job_t;
 
+// Single producer (the receiving phy) single consumer (Phy_Dispatch) ring of io_jobs.
+typedef struct
+{
+    IO_job_t job[IO_JOB_RING_SIZE];
+    uint16_t head; // Next slot to write, only modified by the receiving phy.
+    uint16_t tail; // Oldest slot to dispatch, only modified by Phy_Dispatch.
+} io_job_ring_t;
+
 typedef struct
 {
     // ******************** Phy management ********************
@@ -80,22 +95,24 @@ typedef struct
     bool find_next_node_job; // We put this bits to 1 to indicate that we will need to find another node.
     bool resetAllNeed;       // We put this bits to 1 to indicate that we will need to reset all the nodes. We need it to avoid to reset all phy at reset message reception, allowing the phy's to send their reset message.
     bool PhyExeptSourceDone; // We put this bit to 1 when all the phys except the source one are done with their detection.
+    bool branch_detection;   // We put this bit to 1 when new nodes are detected without network reset.
+    uint32_t branch_date;    // Systick of the branch detection start, used to stop it if the detecting node never ends it.
 
     // ******************** Job management ********************
-    // io_jobs are stores from the newest to the oldest.
-    // This will add time in IRQ when we will pull a job but allow to keep pointers constant.
-    IO_job_t io_job[MAX_MSG_NB]; // Table of all the io_jobs to dispatch.
-    volatile uint16_t io_job_nb; // Number of io_jobs in the io_job table.
-    phy_job_t failed_job[4];     // Table of all the failed jobs we have to deal with.
-    uint8_t failed_job_nb;       // Number of failed jobs in the failed_job table.
+    // Each phy have its own io_job ring, allowing reception and dispatch to run concurrently without disabling IRQ.
+    io_job_ring_t io_job[LOCAL_PHY_NB + 1]; // Rings of all the io_jobs to dispatch, indexed by receiving phy.
+    phy_job_t failed_job[4];                // Table of all the failed jobs we have to deal with.
+    uint8_t failed_job_nb;                  // Number of failed jobs in the failed_job table.
 } luos_phy_ctx_t;
 
-static void Phy_alloc(luos_phy_t *phy);
 static void Phy_Dispatch(void);
+static void Phy_DispatchJob(IO_job_t *job, int phy_id);
 static void Phy_ManageFailedJob(void);
 static phy_job_t *Phy_AddJob(luos_phy_t *phy_ptr, phy_job_t *phy_job);
 static int Phy_GetJobId(luos_phy_t *phy_ptr, phy_job_t *job);
 static int Phy_GetPhyId(luos_phy_t *phy_ptr);
+// Statistics functions
+static void Phy_CountDrop(luos_phy_t *phy_ptr);
 // Filtering functions
 static bool Phy_IndexFilter(uint8_t *index, uint16_t id);
 static bool Phy_Need(luos_phy_t *phy_ptr, header_t *header);
@@ -133,7 +150,6 @@ void Phy_Reset(void)
 {
     // Put everything to 0
     memset((void *)phy_ctx.io_job, 0, sizeof(phy_ctx.io_job));
-    phy_ctx.io_job_nb = 0;
     memset((void *)phy_ctx.failed_job, 0, sizeof(phy_ctx.failed_job));
     phy_ctx.failed_job_nb = 0;
     phy_ctx.resetAllNeed  = false;
@@ -153,6 +169,7 @@ void Phy_Reset(void)
     phy_ctx.topology_running   = false;
     phy_ctx.find_next_node_job = false;
     phy_ctx.PhyExeptSourceDone = true;
+    phy_ctx.branch_detection   = false;
 }
 
 void Phy_ResetAllNeeded(void)
@@ -175,6 +192,24 @@ void Phy_ResetAll(void)
     }
 }
 
+/******************************************************************************
+ * @brief Start or stop a branch detection, new nodes are detected without network reset
+ * @param state true during the branch detection
+ * @return None
+ * @note During a branch detection the messages of the new nodes are forwarded even if their services are unknown.
+ *       Without END_DETECTION the branch detection stop by itself after BRANCH_DETECTION_END_TIMEOUT_MS.
+ ******************************************************************************/
+void Phy_SetBranchDetection(bool state)
+{
+    if (state == true)
+    {
+        // Our ports have been detected by the last detection, check them again
+        phy_ctx.topology_done = 0;
+        phy_ctx.branch_date   = LuosHAL_GetSystick();
+    }
+    phy_ctx.branch_detection = state;
+}
+
 /******************************************************************************
  * @brief Check if a phy is actually detecting nodes on one of its port
  * @param None
@@ -223,13 +258,27 @@ void Phy_Loop(void)
             ;
         Phy_FindNextNode();
     }
+    // Stop a branch detection lost by the detecting node
+    if ((phy_ctx.branch_detection == true) && ((LuosHAL_GetSystick() - phy_ctx.branch_date) > BRANCH_DETECTION_END_TIMEOUT_MS))
+    {
+        phy_ctx.branch_detection = false;
+    }
     // Compute phy job statistics
-    /*
-    uint8_t stat = (uint8_t)((job nbr * 100) / (MAX_MSG_NB));
-    if (stat > mem_stat->rx_msg_stack_ratio)
+    memory_stats_t *memory_stats = Stats_GetMemory();
+    for (int phy_id = 0; phy_id < phy_ctx.phy_nb; phy_id++)
     {
-        memory_stats_t mem_stat->rx_msg_stack_ratio = stat;
-    }*/
+        io_job_ring_t *ring = &phy_ctx.io_job[phy_id];
+        uint8_t stat        = (uint8_t)((((IO_JOB_INDEX_LOAD(ring->head) + IO_JOB_RING_SIZE - IO_JOB_INDEX_LOAD(ring->tail)) % IO_JOB_RING_SIZE) * 100) / (MAX_MSG_NB));
+        if (stat > memory_stats->rx_msg_stack_ratio)
+        {
+            memory_stats->rx_msg_stack_ratio = stat;
+        }
+        stat = (uint8_t)((phy_ctx.phy[phy_id].job_nb * 100) / (MAX_MSG_NB));
+        if (stat > memory_stats->tx_msg_stack_ratio)
+        {
+            memory_stats->tx_msg_stack_ratio = stat;
+        }
+    }
 }
 
 /******************************************************************************
@@ -450,6 +499,8 @@ luos_phy_t *Phy_Get(uint8_t id, JOB_CB job_cb, RUN_TOPO run_topo, RESET_PHY rese
     phy_ctx.phy[id].job_nb    = 0;
     // By default enable synchronisation for all phys
     phy_ctx.phy[id].enable_synchro = true;
+    // By default phys can transmit the biggest messages of this node
+    phy_ctx.phy[id].mtu = MAX_DATA_MSG_SIZE;
     // Return the phy pointer
     return &phy_ctx.phy[id];
 }
@@ -464,6 +515,37 @@ void Phy_DisableSynchro(luos_phy_t *phy_ptr)
     phy_ptr->enable_synchro = false;
 }
 
+/******************************************************************************
+ * @brief Limit the data size of the messages on a specific phy.
+ * @param phy_ptr pointer on the phy we want to limit
+ * @param mtu maximum data size of a message on this phy
+ * @return None
+ ******************************************************************************/
+void Phy_SetMtu(luos_phy_t *phy_ptr, uint16_t mtu)
+{
+    // Every phy have to be able to transmit base messages
+    LUOS_ASSERT((phy_ptr != NULL) && (mtu >= BASE_DATA_MSG_SIZE));
+    phy_ptr->mtu = (mtu > MAX_DATA_MSG_SIZE) ? MAX_DATA_MSG_SIZE : mtu;
+}
+
+/******************************************************************************
+ * @brief Get the maximum data size of a message all the phys of this node can transmit
+ * @param None
+ * @return Maximum data size
+ ******************************************************************************/
+uint16_t Phy_GetMtu(void)
+{
+    uint16_t mtu = MAX_DATA_MSG_SIZE;
+    for (uint8_t i = 0; i < phy_ctx.phy_nb; i++)
+    {
+        if (phy_ctx.phy[i].mtu < mtu)
+        {
+            mtu = phy_ctx.phy[i].mtu;
+        }
+    }
+    return mtu;
+}
+
 /******************************************************************************
  * @brief return a local physical layer pointer (only used by LuosIO, this function is private)
  * @param id of the phy we want
@@ -484,10 +566,10 @@ _CRITICAL void Phy_ComputeHeader(luos_phy_t *phy_ptr)
 {
     LUOS_ASSERT(phy_ptr != NULL);
     // Compute the size of the data to allocate
-    if (((header_t *)phy_ptr->rx_buffer_base)->size > MAX_DATA_MSG_SIZE)
+    if (((header_t *)phy_ptr->rx_buffer_base)->size > Luos_GetMtu())
     {
-        // Cap the size to the maximum size of a message
-        phy_ptr->rx_size = MAX_DATA_MSG_SIZE + sizeof(header_t);
+        // Cap the size to the maximum size of a message on the network
+        phy_ptr->rx_size = Luos_GetMtu() + sizeof(header_t);
     }
     else
     {
@@ -551,14 +633,16 @@ bool Phy_Need(luos_phy_t *phy_ptr, header_t *header)
         case NODEID:
             if (header->target == 0)
             {
-                return Node_DoWeWaitId() || (phy_ctx.PhyExeptSourceDone == false);
+                return Node_DoWeWaitId() || (phy_ctx.PhyExeptSourceDone == false) || (phy_ctx.branch_detection == true);
             }
             else
             {
                 if (Luos_IsDetected())
                 {
                     // If the target is not for the receiving phy, and the source service is known, we need to keep this message
-                    return (!Phy_IndexFilter(phy_ptr->nodes, header->target) && (Node_Get()->node_id != 0) && (Phy_IndexFilter(phy_ptr->services, header->source)));
+                    // During a branch detection the services of the new nodes are not indexed yet
+                    return (!Phy_IndexFilter(phy_ptr->nodes, header->target) && (Node_Get()->node_id != 0)
+                            && (Phy_IndexFilter(phy_ptr->services, header->source) || (phy_ctx.branch_detection == true)));
                 }
                 else
                 {
@@ -702,17 +786,29 @@ _CRITICAL void Phy_ValidMsg(luos_phy_t *phy_ptr)
         // This message is ok we can reference it in the allocator
         MsgAlloc_Reference((uint8_t *)phy_ptr->rx_data, (uint8_t)phy_ptr->rx_phy_filter);
 
-        // Now we can create a phy_job to dispatch the tx_job later
-        LUOS_ASSERT(phy_ctx.io_job_nb < MAX_MSG_NB);
-        Phy_SetIrqState(false);
-        uint16_t my_job                  = phy_ctx.io_job_nb++;
-        phy_ctx.io_job[my_job].alloc_msg = (msg_t *)phy_ptr->rx_data;
-        Phy_SetIrqState(true);
-        // Now copy the data in the job
-        phy_ctx.io_job[my_job].timestamp  = phy_ptr->rx_timestamp;
-        phy_ctx.io_job[my_job].phy_filter = phy_ptr->rx_phy_filter;
-        phy_ptr->rx_phy_filter            = 0;
-        phy_ctx.io_job[my_job].size       = phy_ptr->rx_size;
+        // Now we can create an io_job to dispatch the tx_job later
+        // This phy is the only one writing in its ring, we just have to publish the job once it is complete.
+        io_job_ring_t *ring = &phy_ctx.io_job[Phy_GetPhyId(phy_ptr)];
+        uint16_t head       = ring->head;
+        uint16_t next_head  = (head + 1) % IO_JOB_RING_SIZE;
+        LUOS_ASSERT(next_head != IO_JOB_INDEX_LOAD(ring->tail));
+        ring->job[head].alloc_msg  = (msg_t *)phy_ptr->rx_data;
+        ring->job[head].timestamp  = phy_ptr->rx_timestamp;
+        ring->job[head].phy_filter = phy_ptr->rx_phy_filter;
+        ring->job[head].size       = phy_ptr->rx_size;
+        phy_ptr->rx_phy_filter     = 0;
+        IO_JOB_INDEX_STORE(ring->head, next_head);
+        if (Phy_GetPhyId(phy_ptr) < STATS_PHY_NB)
+        {
+            // Count the number of messages waiting to be dispatched on this phy
+            phy_stats_t *phy_stats            = &Stats_GetIO()->phy[Phy_GetPhyId(phy_ptr)];
+            uint8_t bucket                    = Stats_GetHistogramBucket((next_head + IO_JOB_RING_SIZE - IO_JOB_INDEX_LOAD(ring->tail)) % IO_JOB_RING_SIZE);
+            phy_stats->rx_queue_depth[bucket] = Stats_Increment(phy_stats->rx_queue_depth[bucket]);
+        }
+#ifdef WITH_THREADED_RUNTIME
+        // Wake up the IO task to dispatch this job.
+        LuosHAL_NotifyTasks();
+#endif
 
         // Then reset the phy to receive the next message
         phy_ptr->rx_data       = phy_ptr->rx_buffer_base;
@@ -727,6 +823,12 @@ _CRITICAL void Phy_ValidMsg(luos_phy_t *phy_ptr)
  ******************************************************************************/
 _CRITICAL void Phy_ResetMsg(luos_phy_t *phy_ptr)
 {
+    if (phy_ptr->rx_data != phy_ptr->rx_buffer_base)
+    {
+        // This message have been allocated but never validated, give back its space.
+        Phy_CountDrop(phy_ptr);
+        MsgAlloc_Drop((uint8_t *)phy_ptr->rx_data);
+    }
     phy_ptr->received_data = 0;
     phy_ptr->rx_size       = 0;
     phy_ptr->rx_keep       = true;
@@ -737,9 +839,9 @@ _CRITICAL void Phy_ResetMsg(luos_phy_t *phy_ptr)
 /******************************************************************************
  * @brief Compute the timestamp to send with the message
  * @param job Pointer to the job concerned by this message
- * @return None
+ * @return Timestamp in its network representation
  ******************************************************************************/
-time_luos_t Phy_ComputeMsgTimestamp(luos_phy_t *phy_ptr, phy_job_t *job)
+time_luos_wire_t Phy_ComputeMsgTimestamp(luos_phy_t *phy_ptr, phy_job_t *job)
 {
     LUOS_ASSERT((job != NULL) && (job->msg_pt != NULL) && (job->timestamp == true) && (phy_ptr != NULL));
     if (phy_ptr->enable_synchro == false)
@@ -747,9 +849,9 @@ time_luos_t Phy_ComputeMsgTimestamp(luos_phy_t *phy_ptr, phy_job_t *job)
         // We don't want to synchronize this phy, just return the timestamp
         time_luos_t timestamp_date;
         memcpy(&timestamp_date, &job->msg_pt->data[job->msg_pt->header.size], sizeof(time_luos_t));
-        return timestamp_date;
+        return TimeOD_TimeToWire(timestamp_date);
     }
-    return Timestamp_ConvertToLatency(job->msg_pt);
+    return TimeOD_TimeToWire(Timestamp_ConvertToLatency(job->msg_pt));
 }
 
 /******************************************************************************
@@ -771,12 +873,21 @@ uint16_t Phy_GetNodeId(void)
     return Node_Get()->node_id;
 }
 
+/******************************************************************************
+ * @brief return the protocol revision shared by all the nodes of the network
+ * @return Protocol revision, 0 until the end of the detection
+ ******************************************************************************/
+uint8_t Phy_GetProtocolRevision(void)
+{
+    return Node_GetProtocolRevision();
+}
+
 /******************************************************************************
  * @brief Allocate the received data if needed
  * @param phy_ptr Pointer to the phy concerned by this message
  * @return None
  ******************************************************************************/
-_CRITICAL static void Phy_alloc(luos_phy_t *phy_ptr)
+_CRITICAL void Phy_alloc(luos_phy_t *phy_ptr)
 {
     LUOS_ASSERT(phy_ptr != NULL);
     void *rx_data;
@@ -814,6 +925,7 @@ _CRITICAL static void Phy_alloc(luos_phy_t *phy_ptr)
                 // We probably have been reseted in the meantime, or the message is corrupted. Just drop it.
                 phy_ptr->rx_alloc_job = false;
                 phy_ptr->rx_keep      = false;
+                Phy_CountDrop(phy_ptr);
                 Phy_SetIrqState(true);
                 return;
             }
@@ -828,15 +940,34 @@ _CRITICAL static void Phy_alloc(luos_phy_t *phy_ptr)
             uint16_t phy_stored_data_size = phy_ptr->received_data;
             phy_ptr->rx_alloc_job         = false;
             // Now allocate it
-            rx_data          = MsgAlloc_Alloc(phy_ptr->rx_size, (uint8_t)phy_ptr->rx_phy_filter);
-            phy_ptr->rx_data = rx_data;
+            io_stats_t *io_stats = Stats_GetIO();
+            uint64_t alloc_date  = Phy_GetTimestamp();
+            rx_data              = MsgAlloc_Alloc(phy_ptr->rx_size, (uint8_t)phy_ptr->rx_phy_filter);
+            alloc_date           = Phy_GetTimestamp() - alloc_date;
+            phy_ptr->rx_data     = rx_data;
             Phy_SetIrqState(true);
+            // Compute allocation statistics
+            if (alloc_date > io_stats->max_alloc_latency_ns)
+            {
+                io_stats->max_alloc_latency_ns = (alloc_date > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)alloc_date;
+            }
+            if (rx_data == NULL)
+            {
+                io_stats->alloc_failure_number = Stats_Increment(io_stats->alloc_failure_number);
+            }
+            else
+            {
+                uint8_t bucket             = Stats_GetHistogramBucket(phy_ptr->rx_size >> 3);
+                io_stats->msg_size[bucket] = Stats_Increment(io_stats->msg_size[bucket]);
+            }
             // Check if this message is a luos transmission and if allocation succeed
             if ((phy_ptr == &phy_ctx.phy[0]) && (rx_data == NULL))
             {
                 // We don't successfully allocated the message we are trying to send.
                 // return and the transmitter will be able to wait to get more space...
-                phy_ptr->rx_keep = false;
+                // The next message sent can have other targets, compute them again.
+                phy_ptr->rx_keep       = false;
+                phy_ptr->rx_phy_filter = 0;
                 return;
             }
             LUOS_ASSERT(rx_data != NULL); // Assert if the allocation failed. We don't allow to loose a message comming from outside.
@@ -864,54 +995,83 @@ _CRITICAL static void Phy_alloc(luos_phy_t *phy_ptr)
 static void Phy_Dispatch(void)
 {
     static bool running = false;
-    int i               = 0;
-    if ((running) || (phy_ctx.io_job_nb == 0))
+    if (running)
     {
         return;
     }
     // Interpreat received messages and create tasks for it.
-    Phy_SetIrqState(false);
-    while (i < phy_ctx.io_job_nb)
+    for (int phy_id = 0; phy_id < phy_ctx.phy_nb; phy_id++)
     {
-        Phy_SetIrqState(true);
-        // Get the oldest job
-        IO_job_t *job = &phy_ctx.io_job[i];
-        i++;
-        running = false;
-        LUOS_ASSERT((job->alloc_msg != NULL)
-                    && (job->size >= sizeof(header_t)));
-        running = true;
-        // If message is timestamped, convert the latency to date
-        if (Luos_IsMsgTimstamped(job->alloc_msg))
+        io_job_ring_t *ring = &phy_ctx.io_job[phy_id];
+        uint16_t tail       = ring->tail;
+        // Get the oldest job until we reach the last one published by the receiving phy.
+        while (tail != IO_JOB_INDEX_LOAD(ring->head))
         {
-            Timestamp_ConvertToDate(job->alloc_msg, job->timestamp);
+            IO_job_t *job = &ring->job[tail];
+            LUOS_ASSERT((job->alloc_msg != NULL)
+                        && (job->size >= sizeof(header_t)));
+            running = true;
+            Phy_DispatchJob(job, phy_id);
+            running = false;
+            // Give back the slot to the receiving phy.
+            tail = (tail + 1) % IO_JOB_RING_SIZE;
+            IO_JOB_INDEX_STORE(ring->tail, tail);
         }
-        // Network phy first then Luos in the end
-        for (int y = phy_ctx.phy_nb - 1; y >= 0; y--)
+    }
+}
+
+/******************************************************************************
+ * @brief Create and notify the phy jobs of a received message
+ * @param job Pointer to the io_job to dispatch
+ * @param phy_id Id of the phy which received the message
+ * @return None
+ ******************************************************************************/
+static void Phy_DispatchJob(IO_job_t *job, int phy_id)
+{
+    // If message is timestamped and comes from the network, convert the latency to date
+    // Messages coming from Luos (phy 0) already contain a local date.
+    if ((phy_id != 0) && Luos_IsMsgTimstamped(job->alloc_msg))
+    {
+        Timestamp_ConvertToDate(job->alloc_msg, job->timestamp);
+    }
+    // Network phy first then Luos in the end
+    for (int y = phy_ctx.phy_nb - 1; y >= 0; y--)
+    {
+        // Loop in all phys
+        if ((job->phy_filter >> y) & 0x01)
         {
-            // Loop in all phys
-            if ((job->phy_filter >> y) & 0x01)
-            {
-                // Phy[y] is concerned by this message.
-                // Generate the job and put it in the phy queue
-                phy_job_t phy_job;
-                phy_job.msg_pt    = job->alloc_msg;
-                phy_job.size      = job->size;
-                phy_job.ack       = ((job->alloc_msg->header.target_mode == NODEIDACK) || (job->alloc_msg->header.target_mode == SERVICEIDACK));
-                phy_job.timestamp = Luos_IsMsgTimstamped(job->alloc_msg);
-                phy_job.phy_data  = NULL;
-
-                // Write the job in the phy queue and get back the pointer to it
-                phy_job_t *job_ptr = Phy_AddJob(&phy_ctx.phy[y], &phy_job);
-                // Notify this phy that a job is available and give it the concerned job on his queue
-                phy_ctx.phy[y].job_cb(&phy_ctx.phy[y], job_ptr);
-            }
+            // Phy[y] is concerned by this message.
+            // The network message size is the lowest one of all the phys, so phy[y] can transmit it as it is.
+            // Generate the job and put it in the phy queue
+            phy_job_t phy_job;
+            phy_job.msg_pt    = job->alloc_msg;
+            phy_job.size      = job->size;
+            phy_job.ack       = ((job->alloc_msg->header.target_mode == NODEIDACK) || (job->alloc_msg->header.target_mode == SERVICEIDACK));
+            phy_job.timestamp = Luos_IsMsgTimstamped(job->alloc_msg);
+            phy_job.phy_data  = NULL;
+
+            // Write the job in the phy queue and get back the pointer to it
+            phy_job_t *job_ptr = Phy_AddJob(&phy_ctx.phy[y], &phy_job);
+            // Notify this phy that a job is available and give it the concerned job on his queue
+            phy_ctx.phy[y].job_cb(&phy_ctx.phy[y], job_ptr);
         }
-        Phy_SetIrqState(false);
     }
-    phy_ctx.io_job_nb = 0;
-    Phy_SetIrqState(true);
-    running = false;
+}
+
+/******************************************************************************
+ * @brief Get the number of io_jobs waiting to be dispatched
+ * @param None
+ * @return Number of io_jobs of all the phys
+ ******************************************************************************/
+uint16_t Phy_GetIoJobNumber(void)
+{
+    uint16_t job_nb = 0;
+    for (int phy_id = 0; phy_id < phy_ctx.phy_nb; phy_id++)
+    {
+        io_job_ring_t *ring = &phy_ctx.io_job[phy_id];
+        job_nb += (IO_JOB_INDEX_LOAD(ring->head) + IO_JOB_RING_SIZE - IO_JOB_INDEX_LOAD(ring->tail)) % IO_JOB_RING_SIZE;
+    }
+    return job_nb;
 }
 
 /******************************************************************************
@@ -946,6 +1106,7 @@ _CRITICAL void Phy_FailedJob(luos_phy_t *phy_ptr, phy_job_t *job)
             if ((phy_ptr->job[i].msg_pt->header.target == target) && (phy_ptr->job[i].msg_pt->header.target_mode == target_mode))
             {
                 // This job is targeting the dead target, remove it from the queue
+                Phy_CountDrop(phy_ptr);
                 Phy_RmJob(phy_ptr, &phy_ptr->job[i]);
             }
         }
@@ -1021,6 +1182,13 @@ static phy_job_t *Phy_AddJob(luos_phy_t *phy_ptr, phy_job_t *phy_job)
     // Copy the actual job data to the allocated job
     *returned_job = *phy_job;
     Phy_SetIrqState(true);
+    if (Phy_GetPhyId(phy_ptr) < STATS_PHY_NB)
+    {
+        // Count the number of jobs waiting to be sent on this phy
+        phy_stats_t *phy_stats            = &Stats_GetIO()->phy[Phy_GetPhyId(phy_ptr)];
+        uint8_t bucket                    = Stats_GetHistogramBucket(phy_ptr->job_nb);
+        phy_stats->tx_queue_depth[bucket] = Stats_Increment(phy_stats->tx_queue_depth[bucket]);
+    }
     return returned_job;
 }
 
@@ -1097,6 +1265,47 @@ inline int Phy_GetPhyId(luos_phy_t *phy_ptr)
     return ((uintptr_t)phy_ptr - (uintptr_t)phy_ctx.phy) / sizeof(luos_phy_t);
 }
 
+/******************************************************************************
+ * @brief Count a message dropped by a phy
+ * @param phy_ptr Phy dropping the message
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static void Phy_CountDrop(luos_phy_t *phy_ptr)
+{
+    memory_stats_t *memory_stats = Stats_GetMemory();
+    if (memory_stats->msg_drop_number < 0xFF)
+    {
+        memory_stats->msg_drop_number++;
+    }
+    if (Phy_GetPhyId(phy_ptr) < STATS_PHY_NB)
+    {
+        phy_stats_t *phy_stats = &Stats_GetIO()->phy[Phy_GetPhyId(phy_ptr)];
+        phy_stats->drop_number = Stats_Increment(phy_stats->drop_number);
+    }
+}
+
+/******************************************************************************
+ * @brief Count a transmission retried by a phy
+ * @param phy_ptr Phy retrying the transmission
+ * @param collision true if the transmission have been interrupted by a collision
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL void Phy_CountRetry(luos_phy_t *phy_ptr, bool collision)
+{
+    LUOS_ASSERT(phy_ptr != NULL);
+    if (Phy_GetPhyId(phy_ptr) < STATS_PHY_NB)
+    {
+        phy_stats_t *phy_stats  = &Stats_GetIO()->phy[Phy_GetPhyId(phy_ptr)];
+        phy_stats->retry_number = Stats_Increment(phy_stats->retry_number);
+        if (collision == true)
+        {
+            phy_stats->collision_number = Stats_Increment(phy_stats->collision_number);
+        }
+    }
+}
+
 /******************************************************************************
  * @brief Remove the oldest job from the phy queue
  * @param phy_ptr Phy to remove the job from
@@ -1284,13 +1493,6 @@ inline void Phy_NodeIndexRm(uint16_t id)
 inline bool Phy_FilterType(uint16_t type_id)
 {
     LUOS_ASSERT(type_id <= 4096);
-    // Check all service type
-    for (int i = 0; i < Service_GetNumber(); i++)
-    {
-        if (type_id == Service_GetTable()[i].type)
-        {
-            return true;
-        }
-    }
-    return false;
+    // Check if any service have this type
+    return (Service_GetTypeFilter(type_id) != 0);
 }
@@ -40,6 +40,18 @@
  *  - Task E  : Msg_buffer can also save some TX tasks and list them into tx_task tasks
  *
  * After all of it Luos_tasks are ready to be managed by luos_loop execution.
+ *
+ * When WITH_MSGALLOC_POOLS is defined, msg_buffer is not used as a ring anymore
+ * but is split into 3 pools of fixed size blocks (small, medium and large).
+ * A message takes the first free block of the smallest pool able to store it,
+ * and spill over the bigger pools if its own one is full. Each block is freed
+ * independently so a message slow to be consumed doesn't prevent the others to
+ * be reused, and the block index is directly computed from the message address.
+ *
+ *         msg_buffer
+ *        +-------------------------------------------------------------+
+ *        | large | large |  medium  |  medium  |sm|sm|sm|sm|sm|sm|sm|sm|
+ *        +-------------------------------------------------------------+
  ******************************************************************************/
 
 #include <string.h>
@@ -51,11 +63,58 @@
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#ifdef WITH_MSGALLOC_POOLS
+    // Block sizes are kept even to preserve the 2 bytes alignment of the messages.
+    #define POOL_SMALL_BLOCK_SIZE  32                                                 // Header + 25 bytes of data, enough for most of the commands.
+    #define POOL_MEDIUM_BLOCK_SIZE 64                                                 // Header + 57 bytes of data.
+    #define POOL_LARGE_BLOCK_SIZE  ((sizeof(msg_t) + sizeof(time_luos_t) + 1) & ~1UL) // A complete timestamped message.
+
+    // Half of the buffer goes to large blocks (at least one), the rest is shared between medium and small blocks.
+    #define POOL_LARGE_BLOCK_NB  (((MSG_BUFFER_SIZE) / (2 * POOL_LARGE_BLOCK_SIZE)) ? ((MSG_BUFFER_SIZE) / (2 * POOL_LARGE_BLOCK_SIZE)) : 1)
+    #define POOL_REMAINING_SIZE  ((MSG_BUFFER_SIZE) - (POOL_LARGE_BLOCK_NB * POOL_LARGE_BLOCK_SIZE))
+    #define POOL_MEDIUM_BLOCK_NB (POOL_REMAINING_SIZE / (2 * POOL_MEDIUM_BLOCK_SIZE))
+    #define POOL_SMALL_BLOCK_NB  ((POOL_REMAINING_SIZE - (POOL_MEDIUM_BLOCK_NB * POOL_MEDIUM_BLOCK_SIZE)) / POOL_SMALL_BLOCK_SIZE)
+    #define POOL_BLOCK_NB        (POOL_SMALL_BLOCK_NB + POOL_MEDIUM_BLOCK_NB + POOL_LARGE_BLOCK_NB)
+
+    #define POOL_NO_BLOCK 0xFFFF
+
+typedef enum
+{
+    POOL_SMALL,
+    POOL_MEDIUM,
+    POOL_LARGE,
+    POOL_NB
+} alloc_pool_id_t;
+
+typedef enum
+{
+    BLOCK_FREE,     // The block is available.
+    BLOCK_RESERVED, // The block is allocated but the message is not referenced yet.
+    BLOCK_USED      // The block contain a referenced message.
+} alloc_block_state_t;
+
+typedef struct
+{
+    uint16_t block_size; // Size of the blocks of this pool.
+    uint16_t block_nb;   // Number of blocks of this pool.
+    uint16_t offset;     // Position of the first block of this pool into msg_buffer.
+    uint16_t first;      // Index of the first block of this pool into alloc_blocks.
+    uint16_t free_block; // Index of the first free block of this pool, POOL_NO_BLOCK if the pool is full.
+} alloc_pool_t;
+
+typedef struct
+{
+    uint16_t next;      // Index of the next free block of the same pool.
+    uint8_t state;      // alloc_block_state_t of the block.
+    uint8_t phy_filter; // Physical filter of the message.
+} alloc_block_t;
+#else
 typedef struct
 {
     uint8_t *data;      // Pointer to the first byte of the message.
     uint8_t phy_filter; // Physical filter of the message.
 } alloc_slot_t;
+#endif
 
 /*******************************************************************************
  * Variables
@@ -64,16 +123,31 @@ memory_stats_t *mem_stat = NULL;
 
 // msg buffering
 volatile uint8_t msg_buffer[MSG_BUFFER_SIZE]; /*!< Memory space used to save and alloc messages. */
-volatile uint8_t *data_ptr;                   /*!< Pointer to the next data able to be written into msgbuffer. */
+#ifdef WITH_MSGALLOC_POOLS
+alloc_pool_t pools[POOL_NB];                /*!< Pools description, sorted from the smallest blocks to the biggest. */
+alloc_block_t alloc_blocks[POOL_BLOCK_NB];  /*!< State of each block of each pool. */
+volatile uint16_t used_block_nb;            // Number of blocks containing a referenced message.
+volatile uint32_t used_size;                // Number of bytes taken by allocated blocks.
+volatile uint32_t max_used_size;            // Peak of used_size since the last MsgAlloc_Loop.
+#else
+volatile uint8_t *data_ptr; /*!< Pointer to the next data able to be written into msgbuffer. */
 
 alloc_slot_t alloc_slots[MAX_MSG_NB];   /*!< Slots used to save the index of the first byte of a message. */
 volatile uint16_t oldest_alloc_slot;    // Index of the oldest allocation.
 volatile uint16_t available_alloc_slot; // Index of the next available allocation slot.
+#endif
 
 /*******************************************************************************
  * Functions
  ******************************************************************************/
 
+#ifdef WITH_MSGALLOC_POOLS
+// Find the block containing a message
+_CRITICAL static inline uint16_t MsgAlloc_GetBlock(const uint8_t *data);
+
+// Give a block back to its pool
+_CRITICAL static inline void MsgAlloc_ReleaseBlock(uint16_t block);
+#else
 // msg buffering
 _CRITICAL static inline error_return_t MsgAlloc_DoWeHaveSpaceUntilBufferEnd(const void *to);
 
@@ -82,7 +156,9 @@ static inline error_return_t MsgAlloc_CheckMsgSpace(const void *from, const void
 
 // Available buffer space evaluation
 static inline uint32_t MsgAlloc_BufferAvailableSpaceComputation(void);
+#endif
 
+#ifndef WITH_MSGALLOC_POOLS
 /*******************************************************************************
  * Functions --> generic
  ******************************************************************************/
@@ -408,3 +484,254 @@ static inline error_return_t MsgAlloc_CheckMsgSpace(const void *from, const void
     }
     return SUCCEED;
 }
+
+/******************************************************************************
+ * @brief Drop an allocation that will never be referenced
+ * @param uint8_t *data : pointer returned by MsgAlloc_Alloc
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL void MsgAlloc_Drop(const uint8_t *data)
+{
+    // Nothing to do, the ring will write over this space on the next allocations.
+}
+#else
+/*******************************************************************************
+ * Functions --> generic
+ ******************************************************************************/
+
+/******************************************************************************
+ * @brief Init the allocator.
+ * @param Pointer to Node statistics
+ * @return None
+ ******************************************************************************/
+void MsgAlloc_Init(memory_stats_t *memory_stats)
+{
+    const uint16_t block_size[POOL_NB] = {POOL_SMALL_BLOCK_SIZE, POOL_MEDIUM_BLOCK_SIZE, POOL_LARGE_BLOCK_SIZE};
+    const uint16_t block_nb[POOL_NB]   = {POOL_SMALL_BLOCK_NB, POOL_MEDIUM_BLOCK_NB, POOL_LARGE_BLOCK_NB};
+    // Large blocks are put at the begining of the buffer, small ones at the end.
+    uint16_t offset = POOL_LARGE_BLOCK_NB * POOL_LARGE_BLOCK_SIZE + POOL_MEDIUM_BLOCK_NB * POOL_MEDIUM_BLOCK_SIZE + POOL_SMALL_BLOCK_NB * POOL_SMALL_BLOCK_SIZE;
+    uint16_t first  = 0;
+
+    LUOS_ASSERT((MSG_BUFFER_SIZE) >= POOL_LARGE_BLOCK_SIZE);
+    //******** Init pools **********
+    Phy_SetIrqState(false);
+    for (uint16_t pool = 0; pool < POOL_NB; pool++)
+    {
+        offset -= block_nb[pool] * block_size[pool];
+        pools[pool].block_size = block_size[pool];
+        pools[pool].block_nb   = block_nb[pool];
+        pools[pool].offset     = offset;
+        pools[pool].first      = first;
+        pools[pool].free_block = (block_nb[pool] > 0) ? first : POOL_NO_BLOCK;
+        // Chain all the blocks of this pool
+        for (uint16_t i = 0; i < block_nb[pool]; i++)
+        {
+            alloc_blocks[first + i].next       = (i + 1 < block_nb[pool]) ? first + i + 1 : POOL_NO_BLOCK;
+            alloc_blocks[first + i].state      = BLOCK_FREE;
+            alloc_blocks[first + i].phy_filter = 0;
+        }
+        first += block_nb[pool];
+    }
+    used_block_nb = 0;
+    used_size     = 0;
+    max_used_size = 0;
+    Phy_SetIrqState(true);
+    if (memory_stats != NULL)
+    {
+        mem_stat = memory_stats;
+    }
+}
+
+/******************************************************************************
+ * @brief execute some things out of IRQ
+ * @param None
+ * @return None
+ ******************************************************************************/
+void MsgAlloc_Loop(void)
+{
+    // Compute buffer occupation rate
+    Phy_SetIrqState(false);
+    uint32_t peak = max_used_size;
+    max_used_size = used_size;
+    Phy_SetIrqState(true);
+    uint8_t stat = (uint8_t)((peak * 100) / (MSG_BUFFER_SIZE));
+    if (stat > mem_stat->buffer_occupation_ratio)
+    {
+        mem_stat->buffer_occupation_ratio = stat;
+    }
+}
+
+/*******************************************************************************
+ * Functions --> msg buffering
+ ******************************************************************************/
+
+/******************************************************************************
+ * @brief Find the block containing a message
+ * @param data : pointer to the first byte of the message
+ * @return Index of the block in alloc_blocks
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static inline uint16_t MsgAlloc_GetBlock(const uint8_t *data)
+{
+    LUOS_ASSERT(((uintptr_t)data >= (uintptr_t)&msg_buffer[0]) && ((uintptr_t)data < (uintptr_t)&msg_buffer[MSG_BUFFER_SIZE]));
+    uint16_t offset = (uint16_t)((uintptr_t)data - (uintptr_t)&msg_buffer[0]);
+    for (uint16_t pool = 0; pool < POOL_NB; pool++)
+    {
+        if ((offset >= pools[pool].offset) && (offset < pools[pool].offset + pools[pool].block_nb * pools[pool].block_size))
+        {
+            offset -= pools[pool].offset;
+            // A message always start at the begining of a block
+            LUOS_ASSERT((offset % pools[pool].block_size) == 0);
+            return pools[pool].first + (offset / pools[pool].block_size);
+        }
+    }
+    // This space is not part of any block
+    LUOS_ASSERT(0);
+    return POOL_NO_BLOCK;
+}
+
+/******************************************************************************
+ * @brief Give a block back to its pool
+ * @param block : index of the block in alloc_blocks
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static inline void MsgAlloc_ReleaseBlock(uint16_t block)
+{
+    // This function is always called with IRQ disabled.
+    for (uint16_t pool = 0; pool < POOL_NB; pool++)
+    {
+        if (block < pools[pool].first + pools[pool].block_nb)
+        {
+            alloc_blocks[block].state      = BLOCK_FREE;
+            alloc_blocks[block].phy_filter = 0;
+            alloc_blocks[block].next       = pools[pool].free_block;
+            pools[pool].free_block         = block;
+            used_size -= pools[pool].block_size;
+            return;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Allocate a new message
+ * @param uint16_t data_size
+ * @param phy_target_t phy_filter
+ * @return uint8_t * : pointer to the allocated message
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL uint8_t *MsgAlloc_Alloc(uint16_t data_size, uint8_t phy_filter)
+{
+    // This function is always called with IRQ disabled.
+    LUOS_ASSERT((data_size > 0)
+                && (phy_filter != 0)
+                && (data_size <= MSG_BUFFER_SIZE));
+    // Take the first free block of the smallest pool able to store this message
+    for (uint16_t pool = 0; pool < POOL_NB; pool++)
+    {
+        if ((pools[pool].block_size >= data_size) && (pools[pool].free_block != POOL_NO_BLOCK))
+        {
+            uint16_t block            = pools[pool].free_block;
+            pools[pool].free_block    = alloc_blocks[block].next;
+            alloc_blocks[block].state = BLOCK_RESERVED;
+            used_size += pools[pool].block_size;
+            if (used_size > max_used_size)
+            {
+                max_used_size = used_size;
+            }
+            return (uint8_t *)&msg_buffer[pools[pool].offset + (block - pools[pool].first) * pools[pool].block_size];
+        }
+    }
+    // We don't have the space to store the message, return NULL to indicate that there is no more space
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief Reference a message
+ * @param uint8_t *rx_data
+ * @param phy_target_t phy_filter
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL void MsgAlloc_Reference(uint8_t *rx_data, uint8_t phy_filter)
+{
+    LUOS_ASSERT((rx_data < &msg_buffer[MSG_BUFFER_SIZE]) && (rx_data >= &msg_buffer[0]) && (phy_filter != 0));
+    uint16_t block = MsgAlloc_GetBlock(rx_data);
+    Phy_SetIrqState(false);
+    LUOS_ASSERT(alloc_blocks[block].state == BLOCK_RESERVED);
+    alloc_blocks[block].state      = BLOCK_USED;
+    alloc_blocks[block].phy_filter = phy_filter;
+    used_block_nb++;
+    Phy_SetIrqState(true);
+}
+
+/******************************************************************************
+ * @brief Free a message
+ * @param uint8_t phy_id : id of the phy that free the message
+ * @param uint8_t *data : pointer to the message to free
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL void MsgAlloc_Free(uint8_t phy_id, const uint8_t *data)
+{
+    LUOS_ASSERT(data != NULL);
+    uint16_t block = MsgAlloc_GetBlock(data);
+    if (alloc_blocks[block].state != BLOCK_USED)
+    {
+        // The message have been freed already.
+        // You probably are in detection and the reset detection reseted the allocator before this free.
+        return;
+    }
+    // Assert if this phy have already been freed
+    LUOS_ASSERT(alloc_blocks[block].phy_filter & (0x01 << phy_id));
+    Phy_SetIrqState(false);
+    alloc_blocks[block].phy_filter &= ~(0x01 << phy_id);
+    // Check if the phy_filter is empty
+    if (alloc_blocks[block].phy_filter == 0)
+    {
+        // This message is not used anymore, free it
+        MsgAlloc_ReleaseBlock(block);
+        used_block_nb--;
+    }
+    Phy_SetIrqState(true);
+}
+
+/******************************************************************************
+ * @brief Drop an allocation that will never be referenced
+ * @param uint8_t *data : pointer returned by MsgAlloc_Alloc
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL void MsgAlloc_Drop(const uint8_t *data)
+{
+    if (((uintptr_t)data < (uintptr_t)&msg_buffer[0]) || ((uintptr_t)data >= (uintptr_t)&msg_buffer[MSG_BUFFER_SIZE]))
+    {
+        // This is not an allocated message
+        return;
+    }
+    uint16_t block = MsgAlloc_GetBlock(data);
+    Phy_SetIrqState(false);
+    if (alloc_blocks[block].state == BLOCK_RESERVED)
+    {
+        MsgAlloc_ReleaseBlock(block);
+    }
+    Phy_SetIrqState(true);
+}
+
+/******************************************************************************
+ * @brief No message in buffer receive since initialization
+ * @param None
+ * @return msg_t* sucess or fail if good init
+ ******************************************************************************/
+error_return_t MsgAlloc_IsEmpty(void)
+{
+    if (used_block_nb == 0)
+    {
+        return SUCCEED;
+    }
+    else
+    {
+        return FAILED;
+    }
+}
+#endif
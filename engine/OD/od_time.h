@@ -18,16 +18,19 @@ static inline void TimeOD_TimeToMsg(const time_luos_t *const self, msg_t *const
 {
     LUOS_ASSERT(self);
     LUOS_ASSERT(msg);
-    msg->header.cmd = TIME;
-    memcpy(msg->data, self, sizeof(time_luos_t));
-    msg->header.size = sizeof(time_luos_t);
+    msg->header.cmd        = TIME;
+    time_luos_wire_t value = TimeOD_TimeToWire(*self);
+    memcpy(msg->data, &value, sizeof(time_luos_wire_t));
+    msg->header.size = sizeof(time_luos_wire_t);
 }
 
 static inline void TimeOD_TimeFromMsg(time_luos_t *const self, const msg_t *const msg)
 {
     LUOS_ASSERT(self);
     LUOS_ASSERT(msg);
-    memcpy(self, msg->data, msg->header.size);
+    time_luos_wire_t value = TimeOD_TimeToWire(*self);
+    memcpy(&value, msg->data, msg->header.size);
+    *self = TimeOD_TimeFromWire(value);
 }
 
 #endif /* OD_OD_TIME_H_ */
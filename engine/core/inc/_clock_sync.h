@@ -0,0 +1,20 @@
+/******************************************************************************
+ * @file clock synchronization feature
+ * @brief network time management
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#ifndef __CLOCK_SYNC_H_
+#define __CLOCK_SYNC_H_
+
+#include "luos_engine.h"
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+
+void ClockSync_Reset(void);
+void ClockSync_Loop(void);
+void ClockSync_Update(const msg_t *msg);
+
+#endif /* __CLOCK_SYNC_H_ */
@@ -0,0 +1,17 @@
+/******************************************************************************
+ * @file luos_engine
+ * @brief Private functionalities of the Luos engine library
+ * @author Luos
+ ******************************************************************************/
+#ifndef _PRIVATE_LUOS_ENGINE_H_
+#define _PRIVATE_LUOS_ENGINE_H_
+
+#include "luos_engine.h"
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+
+void Luos_ReceiveDataCredit(const msg_t *msg);
+
+#endif /* _PRIVATE_LUOS_ENGINE_H_ */
@@ -21,13 +21,23 @@ uint16_t RoutingTB_NodeIDFromID(uint16_t id);
 // ********************* routing_table management tools ************************
 void RoutingTB_ComputeRoutingTableEntryNB(void);
 bool RoutingTB_DetectServices(service_t *service);
+bool RoutingTB_DetectBranch(service_t *service, uint16_t node_id);
 void RoutingTB_ConvertNodeToRoutingTable(routing_table_t *entry, node_t *node);
 void RoutingTB_ConvertServiceToRoutingTable(routing_table_t *entry, service_t *service);
 void RoutingTB_RemoveNode(uint16_t nodeid);
 void RoutingTB_RemoveService(uint16_t id);
+void RoutingTB_AddNode(const routing_table_t *entry);
+void RoutingTB_AddService(uint16_t nodeid, const routing_table_t *entry);
 void RoutingTB_Erase(void);
 routing_table_t *RoutingTB_Get(void);
 uint16_t *RoutingTB_GetLastNode(void);
 uint16_t RoutingTB_GetLastEntry(void);
 
+// ********************* routing_table distribution tools ************************
+void RoutingTB_ReceiveChunk(const msg_t *msg);
+void RoutingTB_ReceiveRepair(service_t *service, const msg_t *msg);
+void RoutingTB_ReceiveNack(const msg_t *msg);
+void RoutingTB_ReceiveEntries(const msg_t *msg);
+void RoutingTB_ReceiveDelta(const msg_t *msg);
+
 #endif /* ROUTING_TABLE */
@@ -0,0 +1,35 @@
+/******************************************************************************
+ * @file topology cache
+ * @brief save the routing table of a known network to skip its generation
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#ifndef __TOPOLOGY_CACHE_H_
+#define __TOPOLOGY_CACHE_H_
+
+#include "luos_engine.h"
+#include "routing_table.h"
+#include "luos_hal.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#ifdef WITH_TOPOLOGY_CACHE
+    #if !defined(TOPOLOGY_CACHE_ADDRESS) || !defined(TOPOLOGY_CACHE_SIZE)
+        #warning This HAL does not give a flash region to the topology cache, WITH_TOPOLOGY_CACHE is ignored.
+        #undef WITH_TOPOLOGY_CACHE
+    #endif
+#endif
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+
+uint32_t TopologyCache_LocalSignature(const routing_table_t *entries, uint16_t entry_nb);
+#ifdef WITH_TOPOLOGY_CACHE
+uint32_t TopologyCache_NetworkHash(uint16_t nb_node, const connection_t *connection_table);
+#endif
+error_return_t TopologyCache_Load(uint16_t nb_node, const connection_t *connection_table);
+void TopologyCache_Save(uint16_t nb_node, const connection_t *connection_table);
+
+#endif /* __TOPOLOGY_CACHE_H_ */
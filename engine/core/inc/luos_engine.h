@@ -38,6 +38,7 @@ extern "C"
     // ***************** Node management *****************
     uint32_t Luos_GetSystick(void);
     bool Luos_IsDetected(void);
+    uint16_t Luos_GetMtu(void);
 
     // ***************** Package management *****************
     void Luos_AddPackage(void (*Init)(void), void (*Loop)(void));
@@ -47,6 +48,7 @@ extern "C"
     service_t *Luos_CreateService(SERVICE_CB service_cb, uint8_t type, const char *alias, revision_t revision);
     error_return_t Luos_UpdateAlias(service_t *service, const char *alias, uint16_t size);
     void Luos_Detect(service_t *service);
+    void Luos_DetectBranch(service_t *service);
     void Luos_ServicesClear(void);
 
     // ***************** Messaging management *****************
@@ -65,6 +67,11 @@ extern "C"
     time_luos_t Luos_GetMsgTimestamp(const msg_t *msg);
     error_return_t Luos_SendTimestampMsg(service_t *service, msg_t *msg, time_luos_t timestamp);
 
+    // *** Network time management (in file `clock_sync.c`)***
+    bool Luos_IsNetworkTimeSynced(void);
+    time_luos_t Luos_GetNetworkTime(void);
+    time_luos_t Luos_ConvertToNetworkTime(time_luos_t local_date);
+
     // *** Pub/Sub management (in file `pub_sub.c`)***
     error_return_t Luos_Subscribe(service_t *service, uint16_t topic);
     error_return_t Luos_Unsubscribe(service_t *service, uint16_t topic);
@@ -72,14 +79,21 @@ extern "C"
     // *** Big data management ***
     void Luos_SendData(service_t *service, msg_t *msg, void *bin_data, uint16_t size);
     int Luos_ReceiveData(service_t *service, const msg_t *msg, void *bin_data);
+    error_return_t Luos_SendDataAsync(service_t *service, const msg_t *msg, data_transfer_t *transfer, const void *bin_data, uint16_t size, TRANSFER_CB end_cb);
+    void Luos_CancelDataAsync(data_transfer_t *transfer);
+    void Luos_GiveDataCredit(service_t *service, const msg_t *msg);
 
     // *** Basic transmission management ***
     error_return_t Luos_SendMsg(service_t *service, msg_t *msg);
+    error_return_t Luos_SendMsgSegments(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb);
     error_return_t Luos_TxComplete(void);
 
     // *** Polling reception management ***
     error_return_t Luos_ReadMsg(service_t *service, msg_t *msg_to_write);
     error_return_t Luos_ReadFromService(service_t *service, uint16_t id, msg_t *msg_to_write);
+    error_return_t Luos_BorrowMsg(service_t *service, const msg_t **msg);
+    error_return_t Luos_BorrowFromService(service_t *service, uint16_t id, const msg_t **msg);
+    void Luos_ReleaseMsg(service_t *service, const msg_t *msg);
     uint16_t Luos_NbrAvailableMsg(void);
 
 #ifdef __cplusplus
@@ -37,6 +37,12 @@ typedef struct __attribute__((__packed__))
     };
 } luos_assert_t;
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+extern const uint16_t luos_crc_table[256];
+
 /*******************************************************************************
  * Function
  ******************************************************************************/
@@ -44,5 +50,6 @@ typedef struct __attribute__((__packed__))
 void Luos_assert(char *file, uint32_t line);
 void node_assert(char *file, uint32_t line);
 void Luos_JumpToBootloader(void);
+uint16_t Luos_ComputeCRC(const uint8_t *data, uint16_t size, uint16_t crc);
 
 #endif /* LUOS_UTILS_H */
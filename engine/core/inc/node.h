@@ -39,8 +39,9 @@ typedef struct __attribute__((__packed__))
             };
             uint8_t node_info;
             connection_t connection;
+            uint16_t mtu; /*!< Maximum data size of a message this node can handle */
         };
-        uint8_t unmap[sizeof(connection_t) + 3]; /*!< Uncmaped form. */
+        uint8_t unmap[sizeof(connection_t) + 5]; /*!< Uncmaped form. */
     };
 } node_t;
 
@@ -55,5 +56,8 @@ bool Node_WaitId(void);
 bool Node_DoWeWaitId(void);
 node_state_t Node_GetState(void);
 void Node_SetState(node_state_t);
+void Node_SetProtocolRevision(uint8_t revision);
+uint8_t Node_GetProtocolRevision(void);
+void Node_SetMtu(uint16_t mtu);
 
 #endif /* __NODE_H_ */
@@ -50,6 +50,7 @@ typedef struct __attribute__((__packed__))
                 uint8_t node_info;      // node info can contain info such as the saving of routing table
             };
             connection_t connection; // Node connection source
+            uint16_t mtu;            // Maximum data size of a message this node can handle, 0 for old nodes
         };
         uint8_t unmap_data[MAX_ALIAS_SIZE + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint8_t)];
     };
@@ -42,5 +42,8 @@ error_return_t Service_Deliver(phy_job_t *job);
 // IO related functions
 service_t *Service_GetConcerned(const header_t *header);
 service_filter_t Service_GetFilter(const msg_t *msg);
+void Service_UpdateLookup(void);
+service_filter_t Service_GetTypeFilter(uint16_t type);
+service_filter_t Service_UpdateTopicLookup(uint16_t topic);
 
 #endif /* _SERVICE_H_ */
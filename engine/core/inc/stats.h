@@ -17,5 +17,9 @@ void Stats_Init(void);
 general_stats_t *Stats_Get(void);
 memory_stats_t *Stats_GetMemory(void);
 luos_stats_t *Stats_GetLuos(void);
+io_stats_t *Stats_GetIO(void);
+
+uint8_t Stats_GetHistogramBucket(uint16_t value);
+uint16_t Stats_Increment(uint16_t counter);
 
 #endif /* _PUB_SUB_H_ */
@@ -7,6 +7,7 @@
 #ifndef __LUOS_STRUCT_H
 #define __LUOS_STRUCT_H
 
+#include <stdbool.h>
 #include "engine_config.h"
 #include "struct_stat.h"
 #include "struct_utils.h"
@@ -18,8 +19,9 @@
 typedef enum
 {
     // Protocol version
-    BASE_PROTOCOL = PROTOCOL_REVISION,
+    BASE_PROTOCOL = 0,
     TIMESTAMP_PROTOCOL,
+    CREDIT_PROTOCOL, // Chunk of a data transfer, the receiver have to give credits back to the sender
 } protocol_t;
 
 /******************************************************************************
@@ -34,7 +36,7 @@ typedef enum
     PORT_DATA,       // Message containing port_t information. This is used to complete the input part of a partial CONNECTION_DATA.
     START_DETECTION, // Start a detection
     END_DETECTION,   // Detect the end of a detection
-    LOCAL_RTB,       // Ask(size == 0), generate(size == 2) a local routing_table.
+    LOCAL_RTB,       // Ask(size == 0), generate(size == 2) a local routing_table, generate and send it at an entry(size == 4).
     RTB,             // Receive a routing_table.
     PHY_ID,          // indicate a phy id. This is used to indicate for witch phy the indexes are.
     NODE_INDEXES,    // Send the node indexes of a specific phy allowing us to compute the message switching (the route of the messages).
@@ -62,6 +64,23 @@ typedef enum
     BOOTLOADER_APP_SAVED,
     BOOTLOADER_ERROR_SIZE,
 
+    // Time management
+    CLOCK_SYNC, // Timestamped reference date of the detection master, used to synchronize the clocks of the network
+
+    // Data transfer management
+    DATA_CREDIT, // Number of chunks (data[1]) a receiver accept for the data transfer using the command data[0]
+
+    // Routing table distribution
+    RTB_CHUNK,  // Broadcasted part of the routing table (sequence number, routing table size, data)
+    RTB_REPAIR, // Ask the nodes for the routing table chunks they missed (routing table size, repair pass)
+    RTB_NACK,   // Routing table chunks a node missed (repair pass, node id, bitfield), without bitfield the node have the complete routing table
+
+    // Detection management
+    RTB_ENTRIES,      // Part of a local routing table (routing table entry of the first element, elements)
+    SERVICE_BASE_ID,  // First service id of a node, sent instead of LOCAL_RTB when the detecting node already knows its local routing table
+    BRANCH_DETECTION, // Detect the new nodes of a node ports without network reset (node id), or notify the end of this branch detection (size == 0)
+    RTB_DELTA,        // Routing table entries of the new nodes found by a branch detection
+
     // compatibility area
     // LUOS_LAST_RESERVED_CMD = 42
 } reserved_luos_cmd_t;
@@ -133,6 +152,16 @@ typedef struct __attribute__((__packed__))
     };
 } msg_t;
 
+/******************************************************************************
+ * @struct msg_segment_t
+ * @brief Piece of payload used to build a message from scattered data
+ ******************************************************************************/
+typedef struct
+{
+    const void *data; /*!< Start of the data to send. */
+    uint16_t size;    /*!< Size of the data to send. */
+} msg_segment_t;
+
 /******************************************************************************
  * This structure is used to manage services timed auto update
  * please refer to the documentation
@@ -224,4 +253,25 @@ typedef struct service_t
 
 typedef void (*SERVICE_CB)(service_t *service, const msg_t *msg);
 
+/******************************************************************************
+ * This structure is used to manage non blocking data transfers
+ * please refer to the documentation
+ ******************************************************************************/
+typedef struct data_transfer_t
+{
+    service_t *service;   /*!< Service sending the data. */
+    header_t header;      /*!< Header of the transfer, size is the remaining size for each chunk. */
+    const uint8_t *data;  /*!< Data to send, it have to stay available until the end of the transfer. */
+    uint16_t size;        /*!< Total size of the data. */
+    uint16_t sent_size;   /*!< Size of the data already given to Luos. */
+    uint32_t last_date;   /*!< Date of the last progress of the transfer, used for timeout. */
+    uint8_t credit;       /*!< Number of chunks the receiver accept. */
+    bool flow_control;    /*!< True if the receiver give credits. */
+    volatile bool active; /*!< True until the end of the transfer. */
+    void (*end_cb)(struct data_transfer_t *transfer, error_return_t status);
+    struct data_transfer_t *next; /*!< Next transfer in progress. */
+} data_transfer_t;
+
+typedef void (*TRANSFER_CB)(data_transfer_t *transfer, error_return_t status);
+
 #endif /*__LUOS_STRUCT_H */
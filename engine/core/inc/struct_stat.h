@@ -12,6 +12,18 @@
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#define STATS_HISTOGRAM_SIZE 5 // Number of power of 2 buckets of the histograms.
+#define STATS_PHY_NB         4 // Number of phy reported by the IO statistics. This is fixed to keep the same format on every node.
+
+/******************************************************************************
+ * @enum stats_request_t
+ * @brief data of a LUOS_STATISTICS request, a request without data ask for GENERAL_STATS
+ ******************************************************************************/
+typedef enum
+{
+    GENERAL_STATS, // general_stats_t
+    IO_STATS,      // io_stats_t
+} stats_request_t;
 
 /******************************************************************************
  * @struct memory_stats_t
@@ -75,4 +87,36 @@ typedef struct __attribute__((__packed__))
     };
 } general_stats_t;
 
+/******************************************************************************
+ * @struct phy_stats_t
+ * @brief store informations about a phy queues
+ ******************************************************************************/
+typedef struct __attribute__((__packed__))
+{
+    uint16_t rx_queue_depth[STATS_HISTOGRAM_SIZE]; // Number of received messages waiting to be dispatched : 1, 2-3, 4-7, 8-15, 16+
+    uint16_t tx_queue_depth[STATS_HISTOGRAM_SIZE]; // Number of jobs waiting to be sent : 1, 2-3, 4-7, 8-15, 16+
+    uint16_t drop_number;                          // Number of messages dropped by this phy.
+    uint16_t retry_number;                         // Number of transmissions retried by this phy.
+    uint16_t collision_number;                     // Number of transmissions interrupted by a collision.
+} phy_stats_t;
+
+/******************************************************************************
+ * @struct io_stats_t
+ * @brief format IO layer statistics to be sent trough msg
+ ******************************************************************************/
+typedef struct __attribute__((__packed__))
+{
+    union
+    {
+        struct __attribute__((__packed__))
+        {
+            uint32_t max_alloc_latency_ns;           // Longest time spent into the message allocator.
+            uint16_t alloc_failure_number;           // Number of allocations that failed because of a full msg_buffer.
+            uint16_t msg_size[STATS_HISTOGRAM_SIZE]; // Size of the allocated messages : <16, 16-31, 32-63, 64-127, 128+ bytes
+            phy_stats_t phy[STATS_PHY_NB];
+        };
+        uint8_t unmap[sizeof(uint32_t) + sizeof(uint16_t) + (sizeof(uint16_t) * STATS_HISTOGRAM_SIZE) + (sizeof(phy_stats_t) * STATS_PHY_NB)]; /*!< streamable form. */
+    };
+} io_stats_t;
+
 #endif /*__STAT_STRUCT_H */
@@ -7,14 +7,26 @@
 #ifndef TIME_LUOS_H_
 #define TIME_LUOS_H_
 
+#include <stdint.h>
 #include <string.h>
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#ifdef WITH_INTEGER_TIME
+// Time is stored as an integer number of nanoseconds, timestamping only use integer operations.
+typedef struct
+{
+    int64_t raw;
+} time_luos_t;
+#else
 typedef struct
 {
     double raw;
 } time_luos_t;
+#endif
+
+// Time values always travel on the network as a double number of seconds, whatever the local representation is.
+typedef double time_luos_wire_t;
 
 /*******************************************************************************
  * Variables
@@ -23,6 +35,114 @@ typedef struct
 /*******************************************************************************
  * Function
  ******************************************************************************/
+#ifdef WITH_INTEGER_TIME
+// time values are stored in nanoseconds (ns)
+//******** Conversions ***********
+
+// sec
+static inline double TimeOD_TimeTo_s(time_luos_t self)
+{
+    return (double)self.raw / 1000000000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_s(double sec)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(sec * 1000000000.0);
+    return self;
+}
+
+// ms
+static inline double TimeOD_TimeTo_ms(time_luos_t self)
+{
+    return (double)self.raw / 1000000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_ms(double ms)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(ms * 1000000.0);
+    return self;
+}
+
+// µs
+static inline double TimeOD_TimeTo_us(time_luos_t self)
+{
+    return (double)self.raw / 1000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_us(double us)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(us * 1000.0);
+    return self;
+}
+
+// ns
+static inline double TimeOD_TimeTo_ns(time_luos_t self)
+{
+    return (double)self.raw;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_ns(double ns)
+{
+    time_luos_t self;
+    self.raw = (int64_t)ns;
+    return self;
+}
+
+// min
+static inline double TimeOD_TimeTo_min(time_luos_t self)
+{
+    return (double)self.raw / 60000000000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_min(double min)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(min * 60000000000.0);
+    return self;
+}
+
+// hour
+static inline double TimeOD_TimeTo_h(time_luos_t self)
+{
+    return (double)self.raw / 3600000000000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_h(double hour)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(hour * 3600000000000.0);
+    return self;
+}
+
+// day
+static inline double TimeOD_TimeTo_day(time_luos_t self)
+{
+    return (double)self.raw / 86400000000000.0;
+}
+
+static inline time_luos_t TimeOD_TimeFrom_day(double day)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(day * 86400000000000.0);
+    return self;
+}
+
+//******** Network representation ***********
+static inline time_luos_wire_t TimeOD_TimeToWire(time_luos_t self)
+{
+    return (double)self.raw * 0.000000001;
+}
+
+static inline time_luos_t TimeOD_TimeFromWire(time_luos_wire_t sec)
+{
+    time_luos_t self;
+    self.raw = (int64_t)(sec * 1000000000.0);
+    return self;
+}
+#else
 // time values are stored in seconds (s)
 //******** Conversions ***********
 
@@ -117,4 +237,18 @@ static inline time_luos_t TimeOD_TimeFrom_day(double day)
     return self;
 }
 
+//******** Network representation ***********
+static inline time_luos_wire_t TimeOD_TimeToWire(time_luos_t self)
+{
+    return self.raw;
+}
+
+static inline time_luos_t TimeOD_TimeFromWire(time_luos_wire_t sec)
+{
+    time_luos_t self;
+    self.raw = sec;
+    return self;
+}
+#endif
+
 #endif /* TIME_LUOS_H_ */
@@ -0,0 +1,267 @@
+/******************************************************************************
+ * @file clock synchronization feature
+ * @brief network time management
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#include <string.h>
+#include "_clock_sync.h"
+#include "luos_hal.h"
+#include "node.h"
+#include "service.h"
+/******************************* Description of Clock synchronization process ************************************
+ *
+ * Each node have its own free running clock (LuosHAL_GetTimestamp). The node 1 (the detection master) is used as the reference
+ * clock of the network, its dates are the network time.
+ *
+ * Every CLOCK_SYNC_PERIOD_MS the master broadcasts a timestamped CLOCK_SYNC message, if all the nodes know this command (protocol
+ * revision 7). The data of this message is the master date (int64 in ns) and the timestamp of this message is the same date.
+ * The timestamp mechanism already compensates the transmission time of the message on each phy (the date is converted to a
+ * latency at the last moment before sending and back to a date at the reception of the first byte), so on reception
+ * Luos_GetMsgTimestamp gives the local date of the instant sampled by the master.
+ *
+ *      master date ──────────────┐                     ┌──────── local date of the same instant
+ *                                ▼                     ▼
+ *                  ┌─────────┬──────────────────┬─────────────┐
+ *                  │  Header │ master date (ns) │  Timestamp  │   offset = master date - local date
+ *                  └─────────┴──────────────────┴─────────────┘
+ *
+ * The difference between these two dates is the offset between the clocks. Successive offsets give the drift of the
+ * local clock compared to the master one. Both are filtered to remove the reception jitter:
+ *  - The error between the measured offset and the one predicted by the previous estimation corrects the offset (proportional part)
+ *    and the drift (integral part).
+ *  - If the error is bigger than CLOCK_SYNC_STEP_NS (new master, clock jump, ...) the estimation restarts from the new sample.
+ *
+ * The network time of a local date is then : local date + offset + drift * (local date - date of the last sample).
+ * All the computation is done with integer operations in ns.
+ *
+ * The precision depends on the resolution of LuosHAL_GetTimestamp and on the reception date precision of the phys.
+ *
+ ***************************************************************************************************/
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define CLOCK_SYNC_MASTER_ID    1        // Node id of the reference clock
+#define CLOCK_SYNC_STEP_NS      1000000  // Offset error above which the estimation restarts instead of being filtered
+#define CLOCK_SYNC_MAX_DRIFT    1000000  // Maximum drift between two clocks in ns per second (ppb)
+#define CLOCK_SYNC_FILTER_RATIO 4        // Only 1/CLOCK_SYNC_FILTER_RATIO of the measured error is applied
+#define CLOCK_SYNC_REVISION     7        // First protocol revision knowing the CLOCK_SYNC command
+
+typedef struct
+{
+    int64_t ref_date;  // Local date of the last sample in ns
+    int64_t offset;    // Network time minus local time at ref_date in ns
+    int64_t drift;     // Drift of the network clock compared to the local one in ppb
+    uint8_t sample_nb; // Number of samples used since the last reset
+} clock_sync_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static clock_sync_t clock_sync;
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+static int64_t ClockSync_ToNs(time_luos_t time);
+static time_luos_t ClockSync_FromNs(int64_t ns);
+static bool ClockSync_IsMaster(void);
+static int64_t ClockSync_Drift(int64_t elapsed);
+
+/******************************************************************************
+ * @brief Check if the network time is available on this node
+ * @param None
+ * @return true if the node is the reference clock or if the offset and drift are estimated
+ ******************************************************************************/
+bool Luos_IsNetworkTimeSynced(void)
+{
+    return ClockSync_IsMaster() || (clock_sync.sample_nb > 1);
+}
+
+/******************************************************************************
+ * @brief Convert a local date into the network time
+ * @param local_date : Date given by Luos_Timestamp or Luos_GetMsgTimestamp
+ * @return Network date, the local date if the network time is not available
+ ******************************************************************************/
+time_luos_t Luos_ConvertToNetworkTime(time_luos_t local_date)
+{
+    if (ClockSync_IsMaster() || (clock_sync.sample_nb == 0))
+    {
+        return local_date;
+    }
+    int64_t local_ns = ClockSync_ToNs(local_date);
+    int64_t elapsed  = local_ns - clock_sync.ref_date;
+    return ClockSync_FromNs(local_ns + clock_sync.offset + ClockSync_Drift(elapsed));
+}
+
+/******************************************************************************
+ * @brief Get the present network time
+ * @param None
+ * @return Network date
+ ******************************************************************************/
+time_luos_t Luos_GetNetworkTime(void)
+{
+    return Luos_ConvertToNetworkTime(Luos_Timestamp());
+}
+
+//************************* Private functions *********************************/
+
+/******************************************************************************
+ * @brief Forget the previous estimation, used when the network change
+ * @param None
+ * @return None
+ ******************************************************************************/
+void ClockSync_Reset(void)
+{
+    memset(&clock_sync, 0, sizeof(clock_sync_t));
+}
+
+/******************************************************************************
+ * @brief Periodically send the reference date if this node is the master
+ * @param None
+ * @return None
+ ******************************************************************************/
+void ClockSync_Loop(void)
+{
+#if (CLOCK_SYNC_PERIOD_MS > 0)
+    static uint32_t last_sync_date = 0;
+    if ((ClockSync_IsMaster() == false) || (Service_GetNumber() == 0) || (Node_GetProtocolRevision() < CLOCK_SYNC_REVISION))
+    {
+        // Older nodes don't know the CLOCK_SYNC command, don't flood them with it
+        return;
+    }
+    if ((Luos_GetSystick() - last_sync_date) < CLOCK_SYNC_PERIOD_MS)
+    {
+        return;
+    }
+    last_sync_date = Luos_GetSystick();
+
+    msg_t msg;
+    msg.header.target_mode = BROADCAST;
+    msg.header.target      = BROADCAST_VAL;
+    msg.header.cmd         = CLOCK_SYNC;
+    msg.header.size        = sizeof(int64_t);
+    // The master date is the network time, send it in the data and as the timestamp of the message
+    time_luos_t now = Luos_Timestamp();
+    int64_t date    = ClockSync_ToNs(now);
+    memcpy(msg.data, &date, sizeof(int64_t));
+    Luos_SendTimestampMsg(Service_GetTable(), &msg, now);
+#endif
+}
+
+/******************************************************************************
+ * @brief Update the offset and drift estimation with a received CLOCK_SYNC message
+ * @param msg : Timestamped CLOCK_SYNC message
+ * @return None
+ ******************************************************************************/
+void ClockSync_Update(const msg_t *msg)
+{
+    LUOS_ASSERT(msg != NULL);
+    if ((ClockSync_IsMaster() == true) || (Luos_IsMsgTimstamped(msg) == false) || (msg->header.size != sizeof(int64_t)))
+    {
+        return;
+    }
+    int64_t master_date;
+    memcpy(&master_date, msg->data, sizeof(int64_t));
+    int64_t local_date = ClockSync_ToNs(Luos_GetMsgTimestamp(msg));
+    int64_t offset     = master_date - local_date;
+
+    if (clock_sync.sample_nb > 0)
+    {
+        int64_t elapsed = local_date - clock_sync.ref_date;
+        if (elapsed <= 0)
+        {
+            // Out of order sample, we can't use it
+            return;
+        }
+        int64_t predicted = clock_sync.offset + ClockSync_Drift(elapsed);
+        int64_t error     = offset - predicted;
+        if ((error < CLOCK_SYNC_STEP_NS) && (error > -CLOCK_SYNC_STEP_NS))
+        {
+            // Drift error during the elapsed time
+            int64_t drift_error = (error * 1000000000) / elapsed;
+            if (clock_sync.sample_nb == 1)
+            {
+                // First drift estimation, take it as is
+                clock_sync.drift  = drift_error;
+                clock_sync.offset = offset;
+            }
+            else
+            {
+                clock_sync.drift += drift_error / CLOCK_SYNC_FILTER_RATIO;
+                clock_sync.offset = predicted + error / CLOCK_SYNC_FILTER_RATIO;
+            }
+            if (clock_sync.drift > CLOCK_SYNC_MAX_DRIFT)
+            {
+                clock_sync.drift = CLOCK_SYNC_MAX_DRIFT;
+            }
+            else if (clock_sync.drift < -CLOCK_SYNC_MAX_DRIFT)
+            {
+                clock_sync.drift = -CLOCK_SYNC_MAX_DRIFT;
+            }
+            clock_sync.ref_date = local_date;
+            if (clock_sync.sample_nb < 2)
+            {
+                clock_sync.sample_nb++;
+            }
+            return;
+        }
+    }
+    // First sample or clock jump, restart the estimation from this sample
+    clock_sync.ref_date  = local_date;
+    clock_sync.offset    = offset;
+    clock_sync.drift     = 0;
+    clock_sync.sample_nb = 1;
+}
+
+/******************************************************************************
+ * @brief Check if this node is the reference clock of the network
+ * @param None
+ * @return true if this node is the detection master
+ ******************************************************************************/
+static bool ClockSync_IsMaster(void)
+{
+    return (Node_GetState() == DETECTION_OK) && (Node_Get()->node_id == CLOCK_SYNC_MASTER_ID);
+}
+
+/******************************************************************************
+ * @brief Compute the drift of the network clock during a local duration
+ * @param elapsed : Local duration in ns
+ * @return Drift in ns
+ ******************************************************************************/
+static int64_t ClockSync_Drift(int64_t elapsed)
+{
+    // drift * elapsed overflows after a few hours, compute the whole seconds and the remaining ns separately
+    return clock_sync.drift * (elapsed / 1000000000) + (clock_sync.drift * (elapsed % 1000000000)) / 1000000000;
+}
+
+/******************************************************************************
+ * @brief Convert a time into an integer number of ns
+ * @param time : Time to convert
+ * @return Time in ns
+ ******************************************************************************/
+static int64_t ClockSync_ToNs(time_luos_t time)
+{
+#ifdef WITH_INTEGER_TIME
+    return time.raw;
+#else
+    return (int64_t)TimeOD_TimeTo_ns(time);
+#endif
+}
+
+/******************************************************************************
+ * @brief Convert an integer number of ns into a time
+ * @param ns : Time in ns
+ * @return Time
+ ******************************************************************************/
+static time_luos_t ClockSync_FromNs(int64_t ns)
+{
+#ifdef WITH_INTEGER_TIME
+    time_luos_t time;
+    time.raw = ns;
+    return time;
+#else
+    return TimeOD_TimeFrom_ns((double)ns);
+#endif
+}
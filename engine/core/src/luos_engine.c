@@ -5,9 +5,10 @@
  * @version 0.0.0
  ******************************************************************************/
 #include <stdio.h>
-#include "luos_engine.h"
+#include "_luos_engine.h"
 #include "luos_hal.h"
 #include "_timestamp.h"
+#include "_clock_sync.h"
 #include "filter.h"
 #include "service.h"
 #include "struct_engine.h"
@@ -21,13 +22,35 @@
 const revision_t luos_version = {.major = 3, .minor = 0, .build = 0};
 package_t package_table[MAX_LOCAL_SERVICE_NUMBER];
 uint16_t package_number = 0;
+// Job lent to each service by Luos_BorrowMsg/Luos_BorrowFromService (one per service)
+static phy_job_t *borrowed_job[MAX_LOCAL_SERVICE_NUMBER] = {0};
+// Non blocking data transfers in progress
+static data_transfer_t *transfer_list = NULL;
+// Credits given to the sender of the data transfer received by each service
+static struct
+{
+    uint16_t target;  // Service sending the data
+    uint8_t cmd;      // Command of the data transfer
+    uint8_t credit;   // Number of chunks the sender can still send
+    uint8_t pending;  // Number of chunks granted but not sent yet
+} data_credit[MAX_LOCAL_SERVICE_NUMBER] = {0};
 
 /*******************************************************************************
  * Function
  ******************************************************************************/
 static error_return_t Luos_Send(service_t *service, msg_t *msg);
+static error_return_t Luos_Transmit(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb);
 static inline void Luos_PackageInit(void);
 static inline void Luos_PackageLoop(void);
+static error_return_t Luos_Borrow(service_t *service, uint16_t id, const msg_t **msg);
+static void Luos_DataTransferLoop(void);
+static void Luos_DataTransferProcess(data_transfer_t *transfer);
+static void Luos_SendDataCredit(uint16_t service_index);
+#ifdef WITH_THREADED_RUNTIME
+static void Luos_StartTasks(void);
+static bool Luos_IOTask(void *arg);
+static bool Luos_ServiceTask(void *arg);
+#endif
 
 /******************************************************************************
  * @brief Luos init must be call in project init
@@ -59,7 +82,6 @@ void Luos_Init(void)
 void Luos_Loop(void)
 {
     static uint32_t last_loop_date;
-    phy_job_t *job = NULL;
 
 #ifdef WITH_BOOTLOADER
     // After 3 Luos_Loop, consider this application as safe and write a flag to let the booloader know it can jump to the application safely.
@@ -81,6 +103,14 @@ void Luos_Loop(void)
     {
         luos_stats->max_loop_time_ms = LuosHAL_GetSystick() - last_loop_date;
     }
+#ifdef WITH_THREADED_RUNTIME
+    // The IO and services tasks use the same states as the following managers, keep them out until the end of the loop.
+    LUOS_MUTEX_LOCK
+    Node_Loop();
+    // Messages dispatching and services callbacks are executed by dedicated tasks.
+    Luos_StartTasks();
+#else
+    phy_job_t *job = NULL;
     Node_Loop();
     LuosIO_Loop();
     // Look at all received jobs
@@ -96,12 +126,110 @@ void Luos_Loop(void)
         }
     }
     LUOS_MUTEX_UNLOCK
+#endif
     // manage timed auto update
     Service_AutoUpdateManager();
+    // continue the non blocking data transfers
+    Luos_DataTransferLoop();
+    // share the reference clock if we are the master
+    ClockSync_Loop();
+#ifdef WITH_THREADED_RUNTIME
+    LUOS_MUTEX_UNLOCK
+#endif
     // save loop date
     last_loop_date = LuosHAL_GetSystick();
 }
 
+#ifdef WITH_THREADED_RUNTIME
+/******************************************************************************
+ * @brief Start the IO task and a delivery task for each new service
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Luos_StartTasks(void)
+{
+    static bool io_task_started     = false;
+    static uint16_t service_task_nb = 0;
+    if (io_task_started == false)
+    {
+        LuosHAL_CreateTask(Luos_IOTask, NULL);
+        io_task_started = true;
+    }
+    // Services can be created at any time, each service slot get its own task the first time it is used.
+    while (service_task_nb < Service_GetNumber())
+    {
+        LuosHAL_CreateTask(Luos_ServiceTask, &Service_GetTable()[service_task_nb]);
+        service_task_nb++;
+    }
+}
+
+/******************************************************************************
+ * @brief IO task, allocate and dispatch the received messages
+ * @param arg : Not used
+ * @return true if new jobs have been given to the services
+ ******************************************************************************/
+static bool Luos_IOTask(void *arg)
+{
+    static uint16_t last_job_nb = 0;
+    LUOS_MUTEX_LOCK
+    LuosIO_Loop();
+    uint16_t job_nb = LuosIO_GetJobNb();
+    LUOS_MUTEX_UNLOCK
+    bool new_job = (job_nb > last_job_nb);
+    last_job_nb  = job_nb;
+    if (new_job)
+    {
+        // Wake up the services tasks
+        LuosHAL_NotifyTasks();
+    }
+    return new_job;
+}
+
+/******************************************************************************
+ * @brief Service task, deliver the oldest job of a service to its callback
+ * @param arg : Pointer to the service
+ * @return true if a job have been delivered
+ ******************************************************************************/
+static bool Luos_ServiceTask(void *arg)
+{
+    service_t *service    = (service_t *)arg;
+    uint8_t service_index = Service_GetIndex(service);
+    phy_job_t *job        = NULL;
+    const msg_t *msg      = NULL;
+    if ((service_index >= Service_GetNumber()) || (service->service_cb == NULL))
+    {
+        // This service doesn't exist anymore or use Luos_ReadMsg to get its messages.
+        return false;
+    }
+    // The jobs having this service in their filter are the delivery queue of this service.
+    LUOS_MUTEX_LOCK
+    while (LuosIO_GetNextJob(&job) != FAILED)
+    {
+        if ((*(service_filter_t *)job->phy_data >> service_index) & 0x01)
+        {
+            msg = job->msg_pt;
+            break;
+        }
+    }
+    LUOS_MUTEX_UNLOCK
+    if (msg == NULL)
+    {
+        return false;
+    }
+    // This job can't be removed while this service is in its filter, so the callback can run without lock.
+    service->service_cb(service, (msg_t *)msg);
+    LUOS_MUTEX_LOCK
+    // Jobs could have been reset during the callback (detection), check that this job is still ours.
+    if ((job->msg_pt == msg) && (job->phy_data != NULL))
+    {
+        *(service_filter_t *)job->phy_data &= ~((service_filter_t)1 << service_index);
+        LuosIO_RmJob(job);
+    }
+    LUOS_MUTEX_UNLOCK
+    return true;
+}
+#endif
+
 /******************************************************************************
  * @brief Luos clear statistic
  * @param None
@@ -162,6 +290,24 @@ error_return_t Luos_SendTimestampMsg(service_t *service, msg_t *msg, time_luos_t
     return Luos_Send(service, msg);
 }
 
+/******************************************************************************
+ * @brief Send msg through network with a payload gathered from multiple segments
+ * @param service : Who send
+ * @param msg : Message header to send, the data field is not used
+ * @param segments : Table of payload segments copied after the header
+ * @param segment_nb : Number of segments
+ * @return SUCCEED : If the message is sent, else FAILED or PROHIBITED
+ * @note Payload is copied only once, directly from segments to the message buffer.
+ *       The sum of the segments size have to match the message size.
+ ******************************************************************************/
+error_return_t Luos_SendMsgSegments(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb)
+{
+    LUOS_ASSERT((msg != 0) && (segments != 0));
+    // set protocol version
+    msg->header.config = BASE_PROTOCOL;
+    return Luos_Transmit(service, msg, segments, segment_nb);
+}
+
 /******************************************************************************
  * @brief Send msg through network
  * @param service : Who send
@@ -170,6 +316,19 @@ error_return_t Luos_SendTimestampMsg(service_t *service, msg_t *msg, time_luos_t
  * @return SUCCEED : If the message is sent, else FAILED or PROHIBITED
  ******************************************************************************/
 static error_return_t Luos_Send(service_t *service, msg_t *msg)
+{
+    return Luos_Transmit(service, msg, NULL, 0);
+}
+
+/******************************************************************************
+ * @brief Prepare a message and give it to LuosIO
+ * @param service : Who send
+ * @param msg : Message to send
+ * @param segments : Table of payload segments, NULL if the payload is in msg
+ * @param segment_nb : Number of segments
+ * @return SUCCEED : If the message is sent, else FAILED or PROHIBITED
+ ******************************************************************************/
+static error_return_t Luos_Transmit(service_t *service, msg_t *msg, const msg_segment_t *segments, uint8_t segment_nb)
 {
     LUOS_ASSERT(msg != 0);
     if (service == 0)
@@ -193,7 +352,25 @@ static error_return_t Luos_Send(service_t *service, msg_t *msg)
     {
         msg->header.source = Node_Get()->node_id;
     }
-    if (LuosIO_Send(service, msg) == FAILED)
+    error_return_t error;
+#ifdef WITH_THREADED_RUNTIME
+    // Any task can send, but only one of them can use the Luos phy at a time.
+    LUOS_MUTEX_LOCK
+#endif
+    if (segments != NULL)
+    {
+        error = LuosIO_SendSegments(service, msg, segments, segment_nb);
+    }
+    else
+    {
+        error = LuosIO_Send(service, msg);
+    }
+#ifdef WITH_THREADED_RUNTIME
+    LUOS_MUTEX_UNLOCK
+    // Local messages are dispatched during the send, wake up the services tasks.
+    LuosHAL_NotifyTasks();
+#endif
+    if (error == FAILED)
     {
         return FAILED;
     }
@@ -216,13 +393,13 @@ error_return_t Luos_ReadMsg(service_t *service, msg_t *msg_to_write)
     {
         // We got a job
         // Check if our service is concerned by this job
-        if (((*(uint8_t *)job->phy_data) >> service_index) & 0x01)
+        if ((((*(uint8_t *)job->phy_data) >> service_index) & 0x01) && (job != borrowed_job[service_index]))
         {
             uint16_t msg_size = job->msg_pt->header.size;
             // This job is for our service, copy the job message to the user message
-            if (msg_size > MAX_DATA_MSG_SIZE)
+            if (msg_size > Luos_GetMtu())
             {
-                msg_size = MAX_DATA_MSG_SIZE;
+                msg_size = Luos_GetMtu();
             }
             if (Luos_IsMsgTimstamped(job->msg_pt) == true)
             {
@@ -262,7 +439,7 @@ error_return_t Luos_ReadFromService(service_t *service, uint16_t id, msg_t *msg_
     {
         // We got a job
         // Check if our service is concerned by this job
-        if ((*(service_filter_t *)job->phy_data >> service_index & 0x01) && (job->msg_pt->header.source == id))
+        if ((*(service_filter_t *)job->phy_data >> service_index & 0x01) && (job->msg_pt->header.source == id) && (job != borrowed_job[service_index]))
         {
             // This job is for our service, copy the job message to the user message
             if (Luos_IsMsgTimstamped(job->msg_pt) == true)
@@ -285,6 +462,93 @@ error_return_t Luos_ReadFromService(service_t *service, uint16_t id, msg_t *msg_
     return FAILED;
 }
 
+/******************************************************************************
+ * @brief Find a message for a service and lend it without copying it
+ * @param service : The service asking for a message
+ * @param id : Who sent the message we are looking for (0 for any source)
+ * @param msg : Pointer set to the message stored in the message buffer
+ * @return SUCCEED : If a message is lent to the user, else FAILED
+ ******************************************************************************/
+static error_return_t Luos_Borrow(service_t *service, uint16_t id, const msg_t **msg)
+{
+    LUOS_ASSERT((msg != 0) && (service != 0));
+    phy_job_t *job        = NULL;
+    uint8_t service_index = Service_GetIndex(service);
+    // A service have to release its previous message before borrowing a new one
+    LUOS_ASSERT(borrowed_job[service_index] == NULL);
+    LUOS_MUTEX_LOCK
+    while (LuosIO_GetNextJob(&job) != FAILED)
+    {
+        // We got a job
+        // Check if our service is concerned by this job
+        if ((*(service_filter_t *)job->phy_data >> service_index & 0x01) && ((id == 0) || (job->msg_pt->header.source == id)))
+        {
+            // This job is for our service, keep it allocated until the service release it
+            borrowed_job[service_index] = job;
+            *msg                        = job->msg_pt;
+            LUOS_MUTEX_UNLOCK
+            return SUCCEED;
+        }
+    }
+    LUOS_MUTEX_UNLOCK
+    return FAILED;
+}
+
+/******************************************************************************
+ * @brief Borrow last message without copying it
+ * @param service : The service asking for a message
+ * @param msg : Pointer set to the message stored in the message buffer
+ * @return SUCCEED : If a message is lent to the user, else FAILED
+ * @note The message stay allocated until Luos_ReleaseMsg is called.
+ *       A service can only borrow one message at a time.
+ ******************************************************************************/
+error_return_t Luos_BorrowMsg(service_t *service, const msg_t **msg)
+{
+    return Luos_Borrow(service, 0, msg);
+}
+
+/******************************************************************************
+ * @brief Borrow last msg from a specific service id without copying it
+ * @param service : The service asking for a message
+ * @param id : Who sent the message we are looking for
+ * @param msg : Pointer set to the message stored in the message buffer
+ * @return SUCCEED : If a message is lent to the user, else FAILED
+ * @note The message stay allocated until Luos_ReleaseMsg is called.
+ *       A service can only borrow one message at a time.
+ ******************************************************************************/
+error_return_t Luos_BorrowFromService(service_t *service, uint16_t id, const msg_t **msg)
+{
+    LUOS_ASSERT(id != 0);
+    return Luos_Borrow(service, id, msg);
+}
+
+/******************************************************************************
+ * @brief Give back a message lent by Luos_BorrowMsg or Luos_BorrowFromService
+ * @param service : The service releasing the message
+ * @param msg : Message to release
+ * @return None
+ ******************************************************************************/
+void Luos_ReleaseMsg(service_t *service, const msg_t *msg)
+{
+    // When this function receive a NULL service the jobs have been reset and we should forget every borrowed message
+    if (service == NULL)
+    {
+        memset(borrowed_job, 0, sizeof(borrowed_job));
+        return;
+    }
+    LUOS_ASSERT(msg != 0);
+    uint8_t service_index = Service_GetIndex(service);
+    phy_job_t *job        = borrowed_job[service_index];
+    LUOS_ASSERT((job != NULL) && (job->msg_pt == msg));
+    LUOS_MUTEX_LOCK
+    borrowed_job[service_index] = NULL;
+    // Remove this service from the job filter
+    *(service_filter_t *)job->phy_data &= ~(1 << service_index);
+    // Services consume this job. try to remove it
+    LuosIO_RmJob(job);
+    LUOS_MUTEX_UNLOCK
+}
+
 /******************************************************************************
  * @brief Send large among of data and formating to send into multiple msg
  * @param service : Who send
@@ -297,12 +561,13 @@ void Luos_SendData(service_t *service, msg_t *msg, void *bin_data, uint16_t size
 {
     LUOS_ASSERT((msg != 0) && (bin_data != 0) && (size != 0));
     // Compute number of message needed to send this data
+    uint16_t mtu        = Luos_GetMtu();
     uint16_t msg_number = 1;
     uint16_t sent_size  = 0;
-    if (size > MAX_DATA_MSG_SIZE)
+    if (size > mtu)
     {
-        msg_number = (size / MAX_DATA_MSG_SIZE);
-        msg_number += (msg_number * MAX_DATA_MSG_SIZE < size);
+        msg_number = (size / mtu);
+        msg_number += (msg_number * mtu < size);
     }
 
     // Send messages one by one
@@ -310,23 +575,23 @@ void Luos_SendData(service_t *service, msg_t *msg, void *bin_data, uint16_t size
     {
         // Compute chunk size
         uint16_t chunk_size = 0;
-        if ((size - sent_size) > MAX_DATA_MSG_SIZE)
+        if ((size - sent_size) > mtu)
         {
-            chunk_size = MAX_DATA_MSG_SIZE;
+            chunk_size = mtu;
         }
         else
         {
             chunk_size = size - sent_size;
         }
 
-        // Copy data into message
-        memcpy(msg->data, (uint8_t *)bin_data + sent_size, chunk_size);
-        msg->header.size = size - sent_size;
+        // Reference data chunk, it will be copied directly into the message buffer
+        msg_segment_t segment = {.data = (uint8_t *)bin_data + sent_size, .size = chunk_size};
+        msg->header.size      = size - sent_size;
 
         // Send message
         uint32_t tickstart = Luos_GetSystick();
 
-        while (Luos_SendMsg(service, msg) == FAILED)
+        while (Luos_SendMsgSegments(service, msg, &segment, 1) == FAILED)
         {
             // No more memory space available
             // 500ms of timeout after start trying to load our data in memory. Perhaps the buffer is full of RX messages try to increase the buffer size.
@@ -357,12 +622,14 @@ int Luos_ReceiveData(service_t *service, const msg_t *msg, void *bin_data)
     {
         memset(data_size, 0, sizeof(data_size));
         memset(total_data_size, 0, sizeof(total_data_size));
+        memset(data_credit, 0, sizeof(data_credit));
         last_msg_size = 0;
         return -1;
     }
     LUOS_ASSERT((msg != 0) && (bin_data != 0));
 
-    uint16_t id = Service_GetIndex(service);
+    uint16_t id  = Service_GetIndex(service);
+    uint16_t mtu = Luos_GetMtu();
 
     // store total size of a msg
     if (total_data_size[id] == 0)
@@ -373,20 +640,22 @@ int Luos_ReceiveData(service_t *service, const msg_t *msg, void *bin_data)
     LUOS_ASSERT(msg->header.size <= total_data_size[id]);
 
     // check message integrity
-    if ((last_msg_size > 0) && (last_msg_size - MAX_DATA_MSG_SIZE > msg->header.size))
+    if ((last_msg_size > 0) && (last_msg_size - mtu > msg->header.size))
     {
         // we miss a message (a part of the data),
         // reset session and return an error.
-        data_size[id] = 0;
-        last_msg_size = 0;
+        data_size[id]           = 0;
+        last_msg_size           = 0;
+        data_credit[id].credit  = 0;
+        data_credit[id].pending = 0;
         return -1;
     }
 
     // Get chunk size
     uint16_t chunk_size = 0;
-    if (msg->header.size > MAX_DATA_MSG_SIZE)
+    if (msg->header.size > mtu)
     {
-        chunk_size = MAX_DATA_MSG_SIZE;
+        chunk_size = mtu;
     }
     else
     {
@@ -403,8 +672,11 @@ int Luos_ReceiveData(service_t *service, const msg_t *msg, void *bin_data)
     // check
     LUOS_ASSERT(data_size[id] <= total_data_size[id]);
 
+    // This chunk is consumed, let the sender continue
+    Luos_GiveDataCredit(service, msg);
+
     // Check end of data
-    if (msg->header.size <= MAX_DATA_MSG_SIZE)
+    if (msg->header.size <= mtu)
     {
         // Data collection finished, reset buffer session state
         data_size[id]       = 0;
@@ -416,6 +688,271 @@ int Luos_ReceiveData(service_t *service, const msg_t *msg, void *bin_data)
     return 0;
 }
 
+/******************************************************************************
+ * @brief Start a non blocking transfer of a large among of data
+ * @param service : Who send
+ * @param msg : Message header to use, the data field is not used
+ * @param transfer : Transfer context, it have to stay allocated until the end of the transfer
+ * @param bin_data : Pointer to the data table, it have to stay allocated until the end of the transfer
+ * @param size : Size of the data to transmit
+ * @param end_cb : Function called by Luos_Loop at the end of the transfer, can be NULL
+ * @return SUCCEED : If the transfer is started, else PROHIBITED
+ * @note Chunks are sent during Luos_Loop as soon as the Tx buffer and the receiver
+ *       allow it, the caller never wait for the transfer.
+ ******************************************************************************/
+error_return_t Luos_SendDataAsync(service_t *service, const msg_t *msg, data_transfer_t *transfer, const void *bin_data, uint16_t size, TRANSFER_CB end_cb)
+{
+    LUOS_ASSERT((service != 0) && (msg != 0) && (transfer != 0) && (bin_data != 0) && (size != 0));
+    LUOS_ASSERT(transfer->active == false);
+    if (service->id == 0)
+    {
+        // We are in detection mode, user data can't be sent
+        return PROHIBITED;
+    }
+    transfer->service   = service;
+    transfer->header    = msg->header;
+    transfer->data      = (const uint8_t *)bin_data;
+    transfer->size      = size;
+    transfer->sent_size = 0;
+    transfer->credit    = DATA_TRANSFER_WINDOW;
+    transfer->last_date = Luos_GetSystick();
+    transfer->end_cb    = end_cb;
+    transfer->next      = NULL;
+    // Credits are only given by nodes knowing them and only one receiver can give them
+    transfer->flow_control = (Phy_GetProtocolRevision() >= 2)
+                             && ((msg->header.target_mode == SERVICEID) || (msg->header.target_mode == SERVICEIDACK));
+    transfer->active = true;
+
+    // Add it at the end of the transfer list
+    LUOS_MUTEX_LOCK
+    data_transfer_t **last = &transfer_list;
+    while (*last != NULL)
+    {
+        last = &(*last)->next;
+    }
+    *last = transfer;
+    LUOS_MUTEX_UNLOCK
+
+    // Send the first chunks right now
+    Luos_DataTransferProcess(transfer);
+    return SUCCEED;
+}
+
+/******************************************************************************
+ * @brief Stop a non blocking data transfer without calling its end callback
+ * @param transfer : Transfer to stop
+ * @return None
+ ******************************************************************************/
+void Luos_CancelDataAsync(data_transfer_t *transfer)
+{
+    LUOS_ASSERT(transfer != 0);
+    LUOS_MUTEX_LOCK
+    for (data_transfer_t **item = &transfer_list; *item != NULL; item = &(*item)->next)
+    {
+        if (*item == transfer)
+        {
+            *item = transfer->next;
+            break;
+        }
+    }
+    transfer->next   = NULL;
+    transfer->active = false;
+    LUOS_MUTEX_UNLOCK
+}
+
+/******************************************************************************
+ * @brief Add the credits given by a receiver to the matching data transfer
+ * @param msg : DATA_CREDIT message
+ * @return None
+ ******************************************************************************/
+void Luos_ReceiveDataCredit(const msg_t *msg)
+{
+    LUOS_ASSERT(msg != 0);
+    if (msg->header.size < 2)
+    {
+        return;
+    }
+    LUOS_MUTEX_LOCK
+    for (data_transfer_t *transfer = transfer_list; transfer != NULL; transfer = transfer->next)
+    {
+        if ((transfer->service->id == msg->header.target)
+            && (transfer->header.target == msg->header.source)
+            && (transfer->header.cmd == msg->data[0]))
+        {
+            uint16_t credit     = transfer->credit + msg->data[1];
+            transfer->credit    = (credit > 0xFF) ? 0xFF : (uint8_t)credit;
+            transfer->last_date = Luos_GetSystick();
+            break;
+        }
+    }
+    LUOS_MUTEX_UNLOCK
+}
+
+/******************************************************************************
+ * @brief Manage the non blocking data transfers, called by Luos_Loop
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Luos_DataTransferLoop(void)
+{
+    // Retry the credits we didn't manage to send
+    for (uint16_t i = 0; i < MAX_LOCAL_SERVICE_NUMBER; i++)
+    {
+        if (data_credit[i].pending != 0)
+        {
+            Luos_SendDataCredit(i);
+        }
+    }
+    data_transfer_t **item = &transfer_list;
+    while (*item != NULL)
+    {
+        data_transfer_t *transfer = *item;
+        Luos_DataTransferProcess(transfer);
+        if (transfer->active == true)
+        {
+            item = &transfer->next;
+            continue;
+        }
+        // This transfer is finished, remove it from the list before calling the user
+        LUOS_MUTEX_LOCK
+        *item          = transfer->next;
+        transfer->next = NULL;
+        LUOS_MUTEX_UNLOCK
+        if (transfer->end_cb != NULL)
+        {
+            transfer->end_cb(transfer, (transfer->sent_size == transfer->size) ? SUCCEED : FAILED);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Send as many chunks of a transfer as the Tx buffer and the credits allow
+ * @param transfer : Transfer to continue
+ * @return None
+ ******************************************************************************/
+static void Luos_DataTransferProcess(data_transfer_t *transfer)
+{
+    uint16_t mtu = Luos_GetMtu();
+    while ((transfer->active == true) && (transfer->sent_size < transfer->size))
+    {
+        if ((transfer->flow_control == true) && (transfer->credit == 0))
+        {
+            // Wait for the receiver, it may have disappeared
+            if ((Luos_GetSystick() - transfer->last_date) > DATA_TRANSFER_TIMEOUT_MS)
+            {
+                transfer->active = false;
+            }
+            return;
+        }
+        // Compute chunk size
+        uint16_t chunk_size = transfer->size - transfer->sent_size;
+        if (chunk_size > mtu)
+        {
+            chunk_size = mtu;
+        }
+        msg_t msg;
+        msg.header            = transfer->header;
+        msg.header.size       = transfer->size - transfer->sent_size;
+        msg.header.config     = (transfer->flow_control == true) ? CREDIT_PROTOCOL : BASE_PROTOCOL;
+        msg_segment_t segment = {.data = transfer->data + transfer->sent_size, .size = chunk_size};
+        error_return_t error  = Luos_Transmit(transfer->service, &msg, &segment, 1);
+        if (error == FAILED)
+        {
+            // No more space in the Tx buffer, try again on the next loop
+            return;
+        }
+        if (error == PROHIBITED)
+        {
+            // The network is under detection, this transfer can't continue
+            transfer->active = false;
+            return;
+        }
+        transfer->sent_size += chunk_size;
+        transfer->last_date = Luos_GetSystick();
+        if (transfer->flow_control == true)
+        {
+            transfer->credit--;
+        }
+    }
+    transfer->active = false;
+}
+
+/******************************************************************************
+ * @brief Update the credits of the sender of a chunk received with flow control
+ * @param service : Service receiving the data
+ * @param msg : Chunk consumed by the service
+ * @return None
+ * @note Luos_ReceiveData already does it, services handling the chunks by
+ *       themselves have to call it for each chunk or the sender will stop.
+ ******************************************************************************/
+void Luos_GiveDataCredit(service_t *service, const msg_t *msg)
+{
+    LUOS_ASSERT((service != 0) && (msg != 0));
+    if (msg->header.config != CREDIT_PROTOCOL)
+    {
+        // The sender doesn't wait for credits
+        return;
+    }
+    uint16_t id             = Service_GetIndex(service);
+    uint16_t mtu            = Luos_GetMtu();
+    uint16_t remaining_size = (msg->header.size > mtu) ? msg->header.size - mtu : 0;
+    if ((data_credit[id].target != msg->header.source) || (data_credit[id].cmd != msg->header.cmd))
+    {
+        // New transfer, the sender start with a full window
+        data_credit[id].target  = msg->header.source;
+        data_credit[id].cmd     = msg->header.cmd;
+        data_credit[id].credit  = DATA_TRANSFER_WINDOW;
+        data_credit[id].pending = 0;
+    }
+    if (data_credit[id].credit > 0)
+    {
+        data_credit[id].credit--;
+    }
+    if (remaining_size == 0)
+    {
+        // End of the transfer, the next one will start with a full window
+        data_credit[id].target  = 0;
+        data_credit[id].credit  = 0;
+        data_credit[id].pending = 0;
+        return;
+    }
+    // Give new credits when half of the window is consumed, without giving more than the remaining chunks
+    uint16_t to_come = (remaining_size + mtu - 1) / mtu;
+    uint16_t granted = data_credit[id].credit + data_credit[id].pending;
+    if ((granted < to_come) && (granted <= DATA_TRANSFER_WINDOW / 2))
+    {
+        uint16_t credit = DATA_TRANSFER_WINDOW - granted;
+        if (credit > to_come - granted)
+        {
+            credit = to_come - granted;
+        }
+        data_credit[id].pending += credit;
+        Luos_SendDataCredit(id);
+    }
+}
+
+/******************************************************************************
+ * @brief Send the pending credits of a service to the sender of its data
+ * @param service_index : Index of the service receiving the data
+ * @return None
+ ******************************************************************************/
+static void Luos_SendDataCredit(uint16_t service_index)
+{
+    msg_t msg;
+    msg.header.config      = BASE_PROTOCOL;
+    msg.header.target_mode = SERVICEID;
+    msg.header.target      = data_credit[service_index].target;
+    msg.header.cmd         = DATA_CREDIT;
+    msg.header.size        = 2;
+    msg.data[0]            = data_credit[service_index].cmd;
+    msg.data[1]            = data_credit[service_index].pending;
+    if (Luos_Send(&Service_GetTable()[service_index], &msg) == SUCCEED)
+    {
+        data_credit[service_index].credit += data_credit[service_index].pending;
+        data_credit[service_index].pending = 0;
+    }
+}
+
 /******************************************************************************
  * @brief Return the number of messages available
  * @param None
@@ -539,3 +1076,29 @@ void Luos_Detect(service_t *service)
         Luos_SendMsg(service, &detect_msg);
     }
 }
+
+/******************************************************************************
+ * @brief Demand a detection of the new nodes connected to the ports of this node
+ * @param service : Service that launched the detection
+ * @return None
+ * @note The rest of the network is not reset. If the network is not detected yet a complete detection is done.
+ ******************************************************************************/
+void Luos_DetectBranch(service_t *service)
+{
+    msg_t detect_msg;
+    LUOS_ASSERT(service != NULL);
+
+    if (Luos_IsDetected() == false)
+    {
+        Luos_Detect(service);
+        return;
+    }
+    // Ask the detecting node to give ids to the nodes connected to our ports
+    uint16_t node_id              = Node_Get()->node_id;
+    detect_msg.header.target_mode = SERVICEIDACK;
+    detect_msg.header.cmd         = ASK_DETECTION;
+    detect_msg.header.size        = sizeof(uint16_t);
+    detect_msg.header.target      = 1;
+    memcpy(detect_msg.data, &node_id, sizeof(uint16_t));
+    Luos_SendMsg(service, &detect_msg);
+}
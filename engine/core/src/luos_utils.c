@@ -16,6 +16,45 @@
     #include <stdio.h>
 #endif
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+// CRC-16 (polynomial 0x0007, no reflection) of each byte value, used by the network layers.
+const uint16_t luos_crc_table[256] = {
+    0x0000, 0x0007, 0x000E, 0x0009, 0x001C, 0x001B, 0x0012, 0x0015,
+    0x0038, 0x003F, 0x0036, 0x0031, 0x0024, 0x0023, 0x002A, 0x002D,
+    0x0070, 0x0077, 0x007E, 0x0079, 0x006C, 0x006B, 0x0062, 0x0065,
+    0x0048, 0x004F, 0x0046, 0x0041, 0x0054, 0x0053, 0x005A, 0x005D,
+    0x00E0, 0x00E7, 0x00EE, 0x00E9, 0x00FC, 0x00FB, 0x00F2, 0x00F5,
+    0x00D8, 0x00DF, 0x00D6, 0x00D1, 0x00C4, 0x00C3, 0x00CA, 0x00CD,
+    0x0090, 0x0097, 0x009E, 0x0099, 0x008C, 0x008B, 0x0082, 0x0085,
+    0x00A8, 0x00AF, 0x00A6, 0x00A1, 0x00B4, 0x00B3, 0x00BA, 0x00BD,
+    0x01C0, 0x01C7, 0x01CE, 0x01C9, 0x01DC, 0x01DB, 0x01D2, 0x01D5,
+    0x01F8, 0x01FF, 0x01F6, 0x01F1, 0x01E4, 0x01E3, 0x01EA, 0x01ED,
+    0x01B0, 0x01B7, 0x01BE, 0x01B9, 0x01AC, 0x01AB, 0x01A2, 0x01A5,
+    0x0188, 0x018F, 0x0186, 0x0181, 0x0194, 0x0193, 0x019A, 0x019D,
+    0x0120, 0x0127, 0x012E, 0x0129, 0x013C, 0x013B, 0x0132, 0x0135,
+    0x0118, 0x011F, 0x0116, 0x0111, 0x0104, 0x0103, 0x010A, 0x010D,
+    0x0150, 0x0157, 0x015E, 0x0159, 0x014C, 0x014B, 0x0142, 0x0145,
+    0x0168, 0x016F, 0x0166, 0x0161, 0x0174, 0x0173, 0x017A, 0x017D,
+    0x0380, 0x0387, 0x038E, 0x0389, 0x039C, 0x039B, 0x0392, 0x0395,
+    0x03B8, 0x03BF, 0x03B6, 0x03B1, 0x03A4, 0x03A3, 0x03AA, 0x03AD,
+    0x03F0, 0x03F7, 0x03FE, 0x03F9, 0x03EC, 0x03EB, 0x03E2, 0x03E5,
+    0x03C8, 0x03CF, 0x03C6, 0x03C1, 0x03D4, 0x03D3, 0x03DA, 0x03DD,
+    0x0360, 0x0367, 0x036E, 0x0369, 0x037C, 0x037B, 0x0372, 0x0375,
+    0x0358, 0x035F, 0x0356, 0x0351, 0x0344, 0x0343, 0x034A, 0x034D,
+    0x0310, 0x0317, 0x031E, 0x0319, 0x030C, 0x030B, 0x0302, 0x0305,
+    0x0328, 0x032F, 0x0326, 0x0321, 0x0334, 0x0333, 0x033A, 0x033D,
+    0x0240, 0x0247, 0x024E, 0x0249, 0x025C, 0x025B, 0x0252, 0x0255,
+    0x0278, 0x027F, 0x0276, 0x0271, 0x0264, 0x0263, 0x026A, 0x026D,
+    0x0230, 0x0237, 0x023E, 0x0239, 0x022C, 0x022B, 0x0222, 0x0225,
+    0x0208, 0x020F, 0x0206, 0x0201, 0x0214, 0x0213, 0x021A, 0x021D,
+    0x02A0, 0x02A7, 0x02AE, 0x02A9, 0x02BC, 0x02BB, 0x02B2, 0x02B5,
+    0x0298, 0x029F, 0x0296, 0x0291, 0x0284, 0x0283, 0x028A, 0x028D,
+    0x02D0, 0x02D7, 0x02DE, 0x02D9, 0x02CC, 0x02CB, 0x02C2, 0x02C5,
+    0x02E8, 0x02EF, 0x02E6, 0x02E1, 0x02F4, 0x02F3, 0x02FA, 0x02FD,
+};
+
 /*******************************************************************************
  * Function
  ******************************************************************************/
@@ -31,6 +70,23 @@ __attribute__((weak)) void node_assert(char *file, uint32_t line)
     return;
 }
 
+/******************************************************************************
+ * @brief Compute the CRC-16 (polynomial 0x0007) of a buffer
+ * @param data : Data to compute
+ * @param size : Size of the data
+ * @param crc : CRC of the previous data or 0xFFFF to start
+ * @return CRC value
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL uint16_t Luos_ComputeCRC(const uint8_t *data, uint16_t size, uint16_t crc)
+{
+    for (uint16_t i = 0; i < size; i++)
+    {
+        crc = (crc << 8) ^ luos_crc_table[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
 /******************************************************************************
  * @brief Jump to bootloader by restarting the MCU
  * @param None
@@ -18,12 +18,14 @@ typedef struct
     bool timeout_run;
     bool wait_id; // A flag to indicate that wr are about to reeive a node_id
     uint32_t timeout;
+    uint8_t protocol_revision; // The protocol revision shared by all the nodes of the network
+    uint16_t mtu;              // The maximum data size of a message shared by all the nodes of the network
 } node_ctx_t;
 
 /*******************************************************************************
  * Variables
  ******************************************************************************/
-node_ctx_t node_ctx;
+node_ctx_t node_ctx = {.mtu = BASE_DATA_MSG_SIZE};
 
 /*******************************************************************************
  * Function
@@ -96,6 +98,10 @@ void Node_Init(void)
 #ifdef NO_RTB
     node_ctx.info.node_info |= 1 << 0;
 #endif
+    // Advertise our protocol revision on the 4 MSB of node_info
+    node_ctx.info.node_info |= (PROTOCOL_REVISION & 0x0F) << 4;
+    node_ctx.info.mtu = MAX_DATA_MSG_SIZE;
+    node_ctx.mtu      = BASE_DATA_MSG_SIZE;
     Node_SetState(NO_DETECTION);
     node_ctx.wait_id = false;
 }
@@ -127,14 +133,22 @@ void Node_SetState(node_state_t state)
 {
     switch (state)
     {
-        case NO_DETECTION:
         case DETECTION_OK:
             node_ctx.timeout_run = false;
             node_ctx.timeout     = 0;
             break;
+        case NO_DETECTION:
+            node_ctx.timeout_run = false;
+            node_ctx.timeout     = 0;
+            // Until the next detection we don't know the other nodes, use the base revision
+            node_ctx.protocol_revision = 0;
+            node_ctx.mtu               = BASE_DATA_MSG_SIZE;
+            break;
         case LOCAL_DETECTION:
         case EXTERNAL_DETECTION:
-            node_ctx.timeout_run = true;
+            node_ctx.protocol_revision = 0;
+            node_ctx.mtu               = BASE_DATA_MSG_SIZE;
+            node_ctx.timeout_run       = true;
             node_ctx.timeout     = Luos_GetSystick();
             break;
         default:
@@ -144,6 +158,53 @@ void Node_SetState(node_state_t state)
     node_ctx.state = state;
 }
 
+/******************************************************************************
+ * @brief set the protocol revision shared by all the nodes of the network
+ * @param revision : Lowest protocol revision of the network
+ * @return None
+ ******************************************************************************/
+void Node_SetProtocolRevision(uint8_t revision)
+{
+    // We can't use a revision we don't know
+    node_ctx.protocol_revision = (revision > PROTOCOL_REVISION) ? PROTOCOL_REVISION : revision;
+}
+
+/******************************************************************************
+ * @brief get the protocol revision shared by all the nodes of the network
+ * @param None
+ * @return revision
+ ******************************************************************************/
+uint8_t Node_GetProtocolRevision(void)
+{
+    return node_ctx.protocol_revision;
+}
+
+/******************************************************************************
+ * @brief set the maximum data size of a message shared by all the nodes of the network
+ * @param mtu : Lowest maximum data size of the network
+ * @return None
+ ******************************************************************************/
+void Node_SetMtu(uint16_t mtu)
+{
+    // We can't use a size we can't handle
+    if (mtu < BASE_DATA_MSG_SIZE)
+    {
+        mtu = BASE_DATA_MSG_SIZE;
+    }
+    node_ctx.mtu = (mtu > MAX_DATA_MSG_SIZE) ? MAX_DATA_MSG_SIZE : mtu;
+}
+
+/******************************************************************************
+ * @brief get the maximum data size of a message shared by all the nodes of the network
+ * @param None
+ * @return Maximum data size, BASE_DATA_MSG_SIZE until the end of the detection
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL uint16_t Luos_GetMtu(void)
+{
+    return node_ctx.mtu;
+}
+
 /******************************************************************************
  * @brief Get tick number
  * @param None
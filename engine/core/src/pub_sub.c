@@ -61,6 +61,7 @@ error_return_t Luos_Subscribe(service_t *service, uint16_t topic)
     {
         service->topic_list[service->last_topic_position] = topic;
         service->last_topic_position++;
+        Service_UpdateTopicLookup(topic);
         return SUCCEED;
     }
     return FAILED;
@@ -93,12 +94,10 @@ error_return_t Luos_Unsubscribe(service_t *service, uint16_t topic)
     // Recompute multicast mask if needed
     if (err == SUCCEED)
     {
-        for (uint16_t i = 0; i < Service_GetNumber(); i++)
+        if (Service_UpdateTopicLookup(topic) != 0)
         {
-            if (PubSub_IsTopicSubscribed(&Service_GetTable()[i], topic) == true)
-            {
-                return err;
-            }
+            // Other services still subscribe to this topic
+            return err;
         }
         // Remove topic from multicast mask
         Filter_RmTopic(topic);
@@ -15,6 +15,39 @@
 #include "struct_engine.h"
 #include "luos_io.h"
 #include "service.h"
+#include "_topology_cache.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define ALIAS_INDEX_SIZE (2 * MAX_SERVICE_NUMBER)
+#define NO_ENTRY         0 // The first entry of the routing table is always a node, it can't be a service entry.
+
+// Broadcast routing table distribution
+#define RTB_CHUNK_HEADER_SIZE (2 * sizeof(uint16_t))                                                            // Sequence number and routing table size
+#define RTB_CHUNK_SIZE        (BASE_DATA_MSG_SIZE - RTB_CHUNK_HEADER_SIZE)                                      // Routing table bytes in a chunk
+#define RTB_CHUNK_MAX_NB      ((sizeof(routing_table_t) * MAX_RTB_ENTRY + RTB_CHUNK_SIZE - 1) / RTB_CHUNK_SIZE) // Maximum number of chunks of a routing table
+#define RTB_CHUNK_MAP_SIZE    (RTB_CHUNK_MAX_NB / 8 + 1)                                                        // Size of a bitfield of chunks
+#define RTB_REPAIR_TIMEOUT_MS 10                                                                                // Time given to the nodes to report their missing chunks after the end of the transmission
+#define RTB_REPAIR_MAX_NB     3                                                                                 // Number of repair passes before sending the routing table to each node
+#define RTB_REPAIR_SIZE       (sizeof(uint16_t) + sizeof(uint8_t))                                              // Routing table size and repair pass of a RTB_REPAIR message
+#define RTB_NACK_HEADER_SIZE  (sizeof(uint8_t) + sizeof(uint16_t))                                              // Repair pass and node id of a RTB_NACK message
+
+typedef struct
+{
+    uint16_t entry_nb;                   // Value of last_routing_table_entry when the index have been computed.
+    uint16_t id[MAX_SERVICE_NUMBER + 1]; // Routing table entry of each service ID.
+    uint16_t alias[ALIAS_INDEX_SIZE];    // Open addressing table of routing table entries by alias hash.
+} rtb_index_t;
+
+typedef struct
+{
+    uint16_t node_id;  // Node asked for its local routing table, 0 if this request is free.
+    uint16_t entry;    // Routing table entry of this node.
+    uint16_t entry_nb; // Number of entries expected from this node.
+    uint16_t received; // Number of entries received from this node.
+    uint32_t date;     // Date of the request.
+} rtb_request_t;
 
 /*******************************************************************************
  * Variables
@@ -22,6 +55,30 @@
 routing_table_t routing_table[MAX_RTB_ENTRY];
 volatile uint16_t last_service             = 0;
 volatile uint16_t last_routing_table_entry = 0;
+rtb_index_t rtb_index;
+// Chunks received by this node during a broadcast routing table distribution
+static struct
+{
+    uint16_t size;                      // Size of the routing table being received, 0 if there is no reception in progress
+    bool complete;                      // True when all the chunks have been received
+    uint8_t chunks[RTB_CHUNK_MAP_SIZE]; // Bitfield of the received chunks
+} rtb_reception;
+// Reports of the nodes during a broadcast routing table distribution
+static struct
+{
+    uint8_t pass;                                     // Number of the current repair pass, the reports of the other passes are ignored
+    bool collecting;                                  // True when the detecting node wait for the reports of the nodes
+    uint8_t missing_chunks[RTB_CHUNK_MAP_SIZE];       // Bitfield of the chunks reported as missing during this pass
+    uint8_t confirmed_nodes[MAX_NODE_NUMBER / 8 + 1]; // Bitfield of the nodes which reported a complete routing table
+} rtb_repair;
+// Local routing tables asked at the same time during the detection
+static struct
+{
+    uint16_t node_id;                         // Next node to ask
+    uint16_t entry;                           // Routing table entry of the next node
+    uint16_t service_id;                      // First service id of the next node
+    rtb_request_t requests[LOCAL_RTB_WINDOW]; // Requests waiting for an answer
+} rtb_window;
 
 /*******************************************************************************
  * Function
@@ -31,14 +88,31 @@ uint16_t RoutingTB_IDFromAlias(char *alias);
 char *RoutingTB_AliasFromId(uint16_t id);
 static uint16_t RoutingTB_BigestNodeID(void);
 uint16_t RoutingTB_GetServiceIndex(uint16_t id);
+static void RoutingTB_UpdateIndex(void);
+static uint16_t RoutingTB_AliasHash(const char *alias);
+static void RoutingTB_IndexAlias(uint16_t entry);
+static uint16_t RoutingTB_EntryFromId(uint16_t id);
+static uint16_t RoutingTB_EntryFromAlias(const char *alias);
 
 static int RoutingTB_Generate(service_t *service, uint16_t nb_node, connection_t *connection_table);
+static bool RoutingTB_ServiceNbKnown(uint16_t nb_node);
+static int RoutingTB_GenerateWindow(service_t *service, uint16_t nb_node, connection_t *connection_table);
+static int RoutingTB_GenerateFromCache(service_t *service, uint16_t nb_node, connection_t *connection_table);
 static bool RoutingTB_Share(service_t *service, uint16_t nb_node);
 static void RoutingTB_SendEndDetection(service_t *service);
 static void RoutingTB_ComputeNodeIndexes(service_t *service, uint16_t node_index, uint16_t nb_node, connection_t *connection_table);
 static void RoutingTB_SendNodeIndexes(service_t *service, uint16_t node_id, uint8_t phy_index, uint8_t *node_indexes);
 static void RoutingTB_ComputeServiceIndexes(service_t *service, uint16_t rtb_index);
 static void RoutingTB_SendServiceIndexes(service_t *service, uint16_t node_id, uint8_t phy_index, uint8_t *service_indexes);
+static uint8_t RoutingTB_GetNetworkRevision(void);
+static bool RoutingTB_NeedUnicastShare(void);
+static bool RoutingTB_ShareConfirmed(uint16_t nb_node);
+static void RoutingTB_UnicastShare(service_t *service, uint16_t nb_node);
+static void RoutingTB_BroadcastChunks(service_t *service, const uint8_t *chunks);
+static void RoutingTB_CheckAliases(void);
+static uint8_t RoutingTB_PhyToward(uint16_t node_id, uint16_t target_id, connection_t *connection_table);
+static void RoutingTB_ComputeTreeIndexes(service_t *service, uint16_t node_id, uint16_t nb_node, connection_t *connection_table, bool services);
+static void RoutingTB_ShareDelta(service_t *service, uint16_t nb_node, uint16_t first_entry);
 
 // ************************ routing_table search tools ***************************
 
@@ -50,17 +124,12 @@ static void RoutingTB_SendServiceIndexes(service_t *service, uint16_t node_id, u
 uint16_t RoutingTB_IDFromAlias(char *alias)
 {
     LUOS_ASSERT(alias);
-    for (int i = 0; i <= last_routing_table_entry; i++)
+    uint16_t entry = RoutingTB_EntryFromAlias(alias);
+    if (entry == NO_ENTRY)
     {
-        if (routing_table[i].mode == SERVICE)
-        {
-            if (strcmp(routing_table[i].alias, alias) == 0)
-            {
-                return routing_table[i].id;
-            }
-        }
+        return 0;
     }
-    return 0;
+    return routing_table[entry].id;
 }
 
 /******************************************************************************
@@ -90,17 +159,12 @@ uint16_t RoutingTB_NodeIDFromID(uint16_t id)
 char *RoutingTB_AliasFromId(uint16_t id)
 {
     LUOS_ASSERT(id != 0); // Services can't have id 0.
-    for (int i = 0; i <= last_routing_table_entry; i++)
+    uint16_t entry = RoutingTB_EntryFromId(id);
+    if (entry == NO_ENTRY)
     {
-        if (routing_table[i].mode == SERVICE)
-        {
-            if (id == routing_table[i].id)
-            {
-                return routing_table[i].alias;
-            }
-        }
+        return (char *)0;
     }
-    return (char *)0;
+    return routing_table[entry].alias;
 }
 
 /******************************************************************************
@@ -138,14 +202,127 @@ static uint16_t RoutingTB_BigestNodeID(void)
 uint16_t RoutingTB_GetServiceIndex(uint16_t id)
 {
     LUOS_ASSERT(id != 0); // Services can't have id 0.
-    for (uint8_t i = 0; i < last_routing_table_entry; i++)
+    return RoutingTB_EntryFromId(id);
+}
+
+// ********************* routing_table index ************************
+
+/******************************************************************************
+ * @brief Compute the ID and alias indexes from the routing table
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void RoutingTB_UpdateIndex(void)
+{
+    memset(&rtb_index, 0, sizeof(rtb_index));
+    rtb_index.entry_nb = last_routing_table_entry;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
     {
-        if (routing_table[i].mode == SERVICE && routing_table[i].id == id)
+        if (routing_table[i].mode != SERVICE)
+        {
+            continue;
+        }
+        // Keep the first entry of an ID, this is the one a linear search would find.
+        if ((routing_table[i].id <= MAX_SERVICE_NUMBER) && (rtb_index.id[routing_table[i].id] == NO_ENTRY))
         {
-            return i;
+            rtb_index.id[routing_table[i].id] = i;
         }
+        RoutingTB_IndexAlias(i);
     }
-    return 0;
+}
+
+/******************************************************************************
+ * @brief Add a routing table entry to the alias index
+ * @param entry : Service entry to add
+ * @return None
+ ******************************************************************************/
+static void RoutingTB_IndexAlias(uint16_t entry)
+{
+    // Entries with the same alias are stored in the same probe sequence in the routing table order.
+    uint16_t slot = RoutingTB_AliasHash(routing_table[entry].alias);
+    for (uint16_t probe = 0; probe < ALIAS_INDEX_SIZE; probe++)
+    {
+        if (rtb_index.alias[slot] == NO_ENTRY)
+        {
+            rtb_index.alias[slot] = entry;
+            return;
+        }
+        slot = (slot + 1) % ALIAS_INDEX_SIZE;
+    }
+}
+
+/******************************************************************************
+ * @brief Compute the alias index slot of an alias (FNV-1a)
+ * @param alias : Alias to hash
+ * @return First slot to look at in the alias index
+ ******************************************************************************/
+static uint16_t RoutingTB_AliasHash(const char *alias)
+{
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; (i < MAX_ALIAS_SIZE) && (alias[i] != '\0'); i++)
+    {
+        hash ^= (uint8_t)alias[i];
+        hash *= 16777619u;
+    }
+    return (uint16_t)(hash % ALIAS_INDEX_SIZE);
+}
+
+/******************************************************************************
+ * @brief Find the routing table entry of a service ID
+ * @param id : Id of the service
+ * @return Routing table entry, or NO_ENTRY if this ID is not in the routing table
+ ******************************************************************************/
+static uint16_t RoutingTB_EntryFromId(uint16_t id)
+{
+    // The routing table could have been filled without any index update (RTB reception for example).
+    if (rtb_index.entry_nb != last_routing_table_entry)
+    {
+        RoutingTB_UpdateIndex();
+    }
+    if (id > MAX_SERVICE_NUMBER)
+    {
+        // This ID can't be indexed, look for it in the routing table.
+        for (uint16_t i = 0; i < last_routing_table_entry; i++)
+        {
+            if ((routing_table[i].mode == SERVICE) && (routing_table[i].id == id))
+            {
+                return i;
+            }
+        }
+        return NO_ENTRY;
+    }
+    uint16_t entry = rtb_index.id[id];
+    if ((entry != NO_ENTRY) && ((routing_table[entry].mode != SERVICE) || (routing_table[entry].id != id)))
+    {
+        // The routing table have been modified without any index update, compute it again.
+        RoutingTB_UpdateIndex();
+        entry = rtb_index.id[id];
+    }
+    return entry;
+}
+
+/******************************************************************************
+ * @brief Find the first routing table entry having an alias
+ * @param alias : Alias of the service
+ * @return Routing table entry, or NO_ENTRY if this alias is not in the routing table
+ ******************************************************************************/
+static uint16_t RoutingTB_EntryFromAlias(const char *alias)
+{
+    if (rtb_index.entry_nb != last_routing_table_entry)
+    {
+        RoutingTB_UpdateIndex();
+    }
+    uint16_t slot = RoutingTB_AliasHash(alias);
+    for (uint16_t probe = 0; (probe < ALIAS_INDEX_SIZE) && (rtb_index.alias[slot] != NO_ENTRY); probe++)
+    {
+        uint16_t entry = rtb_index.alias[slot];
+        if ((routing_table[entry].mode == SERVICE) && (strncmp(routing_table[entry].alias, alias, MAX_ALIAS_SIZE) == 0))
+        {
+            return entry;
+        }
+        slot = (slot + 1) % ALIAS_INDEX_SIZE;
+    }
+    return NO_ENTRY;
 }
 
 // ********************* routing_table management tools ************************
@@ -166,11 +343,13 @@ void RoutingTB_ComputeRoutingTableEntryNB(void)
         if (routing_table[i].mode == CLEAR)
         {
             last_routing_table_entry = i;
+            RoutingTB_UpdateIndex();
             return;
         }
     }
     // Routing table space is full.
     last_routing_table_entry = MAX_RTB_ENTRY - 1;
+    RoutingTB_UpdateIndex();
 }
 
 /******************************************************************************
@@ -223,7 +402,6 @@ static int RoutingTB_Generate(service_t *service, uint16_t nb_node, connection_t
     static uint16_t last_node_id = 0;
     uint16_t last_service_id     = 0;
     msg_t intro_msg;
-    uint16_t nb_service;
     static uint16_t rtb_next_node_index;
     static uint8_t detect_state_machine = 0;
     static uint16_t entry_bkp;
@@ -232,6 +410,24 @@ static int RoutingTB_Generate(service_t *service, uint16_t nb_node, connection_t
     switch (detect_state_machine)
     {
         case 0:
+            if ((last_node_id == 0) && (TopologyCache_Load(nb_node, connection_table) == SUCCEED))
+            {
+                // The network didn't change since the routing table have been saved, just give their ids to the nodes
+                memset(&rtb_window, 0, sizeof(rtb_window));
+                rtb_window.node_id    = 1;
+                rtb_window.service_id = 1;
+                detect_state_machine  = 4;
+                return 0;
+            }
+            if ((last_node_id == 0) && (RoutingTB_ServiceNbKnown(nb_node) == true))
+            {
+                // Every node gave its number of services, we can ask several local routing tables at the same time
+                memset(&rtb_window, 0, sizeof(rtb_window));
+                rtb_window.node_id    = 1;
+                rtb_window.service_id = 1;
+                detect_state_machine  = 3;
+                return 0;
+            }
             if ((last_node_id >= nb_node) || (try_nb >= nb_node))
             {
                 // Go to check alias duplication step
@@ -283,89 +479,697 @@ static int RoutingTB_Generate(service_t *service, uint16_t nb_node, connection_t
             break;
         case 2:
             // Check Alias duplication.
-            nb_service = RoutingTB_BigestID();
-            for (uint16_t id = 1; id <= nb_service; id++)
+            RoutingTB_CheckAliases();
+            detect_state_machine = 0;
+            last_node_id         = 0;
+            return 1;
+            break;
+        case 3:
+            if (RoutingTB_GenerateWindow(service, nb_node, connection_table) == 0)
+            {
+                // We don't get all the answers yet
+                return 0;
+            }
+            // Go to Alias duplication check
+            detect_state_machine = 2;
+            return 0;
+            break;
+        case 4:
+            if (RoutingTB_GenerateFromCache(service, nb_node, connection_table) == 0)
+            {
+                // Some nodes don't have their ids yet
+                return 0;
+            }
+            // Aliases of the saved routing table are already unique
+            detect_state_machine = 0;
+            return 1;
+            break;
+        default:
+            LUOS_ASSERT(0);
+            break;
+    }
+    LUOS_ASSERT(0);
+    return -1;
+}
+
+/******************************************************************************
+ * @brief Rename the services having an alias already used by a previous service
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void RoutingTB_CheckAliases(void)
+{
+    uint16_t annotation[MAX_RTB_ENTRY] = {0}; // Last number added to the alias of each entry
+    // Index the services one by one, the alias of a service is only compared to the aliases of the previous ones.
+    memset(rtb_index.alias, 0, sizeof(rtb_index.alias));
+    rtb_index.entry_nb = last_routing_table_entry;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        if (routing_table[i].mode != SERVICE)
+        {
+            continue;
+        }
+        uint16_t owner = RoutingTB_EntryFromAlias(routing_table[i].alias);
+        while (owner != NO_ENTRY)
+        {
+            // This alias is already used by a previous service, add the next free number of this alias.
+            // Numbers are never tried twice for the same alias, the ones already tried are used by previous services.
+            bool error_alias = (strcmp(routing_table[owner].alias, "error") == 0);
+            uint16_t used;
+            do
             {
-                int32_t found_id = RoutingTB_IDFromAlias(RoutingTB_AliasFromId(id));
-                if ((found_id != id) & (found_id != -1))
+                annotation[owner]++;
+                if (error_alias)
+                {
+                    // "error" is short enough to take any number, every service gets its own alias
+                    memset(routing_table[i].alias, 0, MAX_ALIAS_SIZE);
+                    sprintf(routing_table[i].alias, "error%d", annotation[owner]);
+                }
+                else
                 {
-                    // The found_id don't match with the actual ID of the service because the alias already exist
-                    // Find the new alias to give him
-                    uint8_t annotation              = 1;
-                    char base_alias[MAX_ALIAS_SIZE] = {0};
-                    memcpy(base_alias, RoutingTB_AliasFromId(id), MAX_ALIAS_SIZE);
-                    // Add a number after alias in routing table
-                    RoutingTB_AddNumToAlias(RoutingTB_AliasFromId(id), annotation++);
-                    // check another time if this alias is already used
-                    while (RoutingTB_IDFromAlias(RoutingTB_AliasFromId(id)) != id)
+                    // Above 99, RoutingTB_AddNumToAlias gives an "error" alias
+                    memcpy(routing_table[i].alias, routing_table[owner].alias, MAX_ALIAS_SIZE);
+                    RoutingTB_AddNumToAlias(routing_table[i].alias, (annotation[owner] > 100) ? 100 : annotation[owner]);
+                }
+                used = RoutingTB_EntryFromAlias(routing_table[i].alias);
+            } while ((used != NO_ENTRY) && (error_alias || (annotation[owner] <= 99)));
+            // No number left for this alias and the "error" alias is used too, number it.
+            owner = used;
+        }
+        RoutingTB_IndexAlias(i);
+    }
+    // The ID index could be outdated.
+    RoutingTB_UpdateIndex();
+}
+
+/******************************************************************************
+ * @brief Check if all the nodes gave their number of services during the topology detection
+ * @param nb_node : number of nodes on network
+ * @return true if the number of services of every node is known
+ ******************************************************************************/
+static bool RoutingTB_ServiceNbKnown(uint16_t nb_node)
+{
+    uint16_t service_nb;
+    for (uint16_t node_id = 1; node_id <= nb_node; node_id++)
+    {
+        if (LuosIO_GetNodeServiceNb(node_id, &service_nb) == FAILED)
+        {
+            // This node is too old or have a static connection
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+ * @brief Ask the local routing table of LOCAL_RTB_WINDOW nodes at the same time
+ * @param service : Service who send
+ * @param nb_node : number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @return 0 if some nodes still have to answer, 1 if the routing table is complete
+ * @note Because the number of services of each node is known, the service ids and the
+ *       routing table entry of each node are computed before asking it.
+ ******************************************************************************/
+static int RoutingTB_GenerateWindow(service_t *service, uint16_t nb_node, connection_t *connection_table)
+{
+    bool pending       = false;
+    uint16_t end_entry = MAX_RTB_ENTRY;
+    for (uint16_t i = 0; i < LOCAL_RTB_WINDOW; i++)
+    {
+        rtb_request_t *request = &rtb_window.requests[i];
+        if (request->node_id == 0)
+        {
+            continue;
+        }
+        if (request->received >= request->entry_nb)
+        {
+            // We get the answer
+            // The node answer don't include connection because the node don't know it yet
+            // Add this information to the routing table
+            LUOS_ASSERT(routing_table[request->entry].mode == NODE);
+            routing_table[request->entry].connection = connection_table[request->node_id - 1];
+            request->node_id                         = 0;
+            continue;
+        }
+        pending = true;
+        if ((LuosHAL_GetSystick() - request->date) >= 2000)
+        {
+            // Time out is reached, we will keep the nodes before this one
+            end_entry = (request->entry < end_entry) ? request->entry : end_entry;
+        }
+    }
+    if (end_entry != MAX_RTB_ENTRY)
+    {
+        // Some nodes didn't answer, remove them and the ones after them
+        for (uint16_t i = 0; i < LOCAL_RTB_WINDOW; i++)
+        {
+            if (rtb_window.requests[i].entry >= end_entry)
+            {
+                rtb_window.requests[i].node_id = 0;
+            }
+        }
+        memset(&routing_table[end_entry], 0, (MAX_RTB_ENTRY - end_entry) * sizeof(routing_table_t));
+        pending = false;
+        for (uint16_t i = 0; i < LOCAL_RTB_WINDOW; i++)
+        {
+            pending |= (rtb_window.requests[i].node_id != 0);
+        }
+        rtb_window.node_id = nb_node + 1;
+    }
+
+    // Ask the next nodes
+    for (uint16_t i = 0; (i < LOCAL_RTB_WINDOW) && (rtb_window.node_id <= nb_node); i++)
+    {
+        rtb_request_t *request = &rtb_window.requests[i];
+        if (request->node_id != 0)
+        {
+            continue;
+        }
+        uint16_t service_nb;
+        LuosIO_GetNodeServiceNb(rtb_window.node_id, &service_nb);
+        LUOS_ASSERT(rtb_window.entry + service_nb + 1 <= MAX_RTB_ENTRY);
+        // First compute the node indexes for this node and send it to it.
+        RoutingTB_ComputeNodeIndexes(service, rtb_window.node_id - 1, nb_node, connection_table);
+        // Save the request before sending it because our own node answer right away
+        request->node_id  = rtb_window.node_id;
+        request->entry    = rtb_window.entry;
+        request->entry_nb = service_nb + 1;
+        request->received = 0;
+        request->date     = LuosHAL_GetSystick();
+        // Set the first service id it can use and the place of its entries
+        msg_t intro_msg;
+        intro_msg.header.cmd         = LOCAL_RTB;
+        intro_msg.header.target_mode = NODEIDACK;
+        intro_msg.header.target      = rtb_window.node_id;
+        intro_msg.header.size        = 2 * sizeof(uint16_t);
+        memcpy(&intro_msg.data[0], &rtb_window.service_id, sizeof(uint16_t));
+        memcpy(&intro_msg.data[sizeof(uint16_t)], &rtb_window.entry, sizeof(uint16_t));
+        // The node can't answer a request lost in a full Tx buffer, wait for some space
+        while (Luos_SendMsg(service, &intro_msg) != SUCCEED)
+            ;
+        rtb_window.node_id++;
+        rtb_window.entry += service_nb + 1;
+        rtb_window.service_id += service_nb;
+        pending = true;
+    }
+    if ((pending == true) || (rtb_window.node_id <= nb_node))
+    {
+        return 0;
+    }
+    // All the nodes answered
+    RoutingTB_ComputeRoutingTableEntryNB();
+    return 1;
+}
+
+/******************************************************************************
+ * @brief Give their ids to the nodes of a network matching the saved routing table
+ * @param service : Service who send
+ * @param nb_node : number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @return 0 if some nodes still have to get their ids, 1 if all the nodes have them
+ * @note The saved routing table have been generated with a window, the services ids
+ *       of a node follow the ones of the previous node.
+ ******************************************************************************/
+static int RoutingTB_GenerateFromCache(service_t *service, uint16_t nb_node, connection_t *connection_table)
+{
+    if (rtb_window.node_id > nb_node)
+    {
+        return 1;
+    }
+    uint16_t service_nb;
+    LuosIO_GetNodeServiceNb(rtb_window.node_id, &service_nb);
+    // First compute the node indexes for this node and send it to it.
+    RoutingTB_ComputeNodeIndexes(service, rtb_window.node_id - 1, nb_node, connection_table);
+    // Then set the first service id it can use
+    msg_t id_msg;
+    id_msg.header.cmd         = SERVICE_BASE_ID;
+    id_msg.header.target_mode = NODEIDACK;
+    id_msg.header.target      = rtb_window.node_id;
+    id_msg.header.size        = sizeof(uint16_t);
+    memcpy(id_msg.data, &rtb_window.service_id, sizeof(uint16_t));
+    while (Luos_SendMsg(service, &id_msg) != SUCCEED)
+        ;
+    rtb_window.node_id++;
+    rtb_window.service_id += service_nb;
+    return 0;
+}
+
+/******************************************************************************
+ * @brief Save the entries of a local routing table asked with a window
+ * @param msg : RTB_ENTRIES message
+ * @return None
+ ******************************************************************************/
+void RoutingTB_ReceiveEntries(const msg_t *msg)
+{
+    LUOS_ASSERT(msg != NULL);
+    if (msg->header.size < sizeof(uint16_t) + sizeof(routing_table_t))
+    {
+        return;
+    }
+    uint16_t entry;
+    uint16_t entry_nb = (msg->header.size - sizeof(uint16_t)) / sizeof(routing_table_t);
+    memcpy(&entry, msg->data, sizeof(uint16_t));
+    for (uint16_t i = 0; i < LOCAL_RTB_WINDOW; i++)
+    {
+        rtb_request_t *request = &rtb_window.requests[i];
+        // A node send its entries in order, ignore the repeated or unexpected ones
+        if ((request->node_id != 0) && (entry == request->entry + request->received)
+            && (request->received + entry_nb <= request->entry_nb))
+        {
+            memcpy(&routing_table[entry], &msg->data[sizeof(uint16_t)], entry_nb * sizeof(routing_table_t));
+            request->received += entry_nb;
+            return;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Send the complete route table and all indexes to each node on the network
+ * @param service : Service who send
+ * @param nb_node : number of nodes on network
+ * @return None
+ * @note On networks supporting it the routing table is broadcasted once in numbered
+ *       chunks, then nodes report the chunks they missed and only those are broadcasted again.
+ *       Each node have to confirm the reception, the nodes still not confirming after the last
+ *       repair pass receive the complete routing table directly.
+ ******************************************************************************/
+static bool RoutingTB_Share(service_t *service, uint16_t nb_node)
+{
+    static uint8_t detect_state_machine = 0;
+    static uint8_t repair_nb            = 0;
+    static uint32_t start_tick          = 0;
+    LUOS_ASSERT(service);
+    // Make sure that the detection is not interrupted
+    if (Node_GetState() == EXTERNAL_DETECTION)
+    {
+        detect_state_machine  = 0;
+        rtb_repair.collecting = false;
+        return true;
+    }
+
+    switch (detect_state_machine)
+    {
+        case 0:
+            // Compute local indexes
+            RoutingTB_ComputeServiceIndexes(service, 0);
+            detect_state_machine++;
+            return false;
+            break;
+        case 1:
+            // Send the indexes of each nodes. Routing tables are commonly usable for each services of a node.
+            for (uint16_t i = 2; i <= nb_node; i++) // don't send to ourself
+            {
+                uint16_t node_idx;
+                for (node_idx = i; node_idx < last_routing_table_entry; node_idx++)
+                {
+                    if ((routing_table[node_idx].mode == NODE) && (routing_table[node_idx].node_id == i))
                     {
-                        // This alias is already used.
-                        // Remove the number previously setuped by overwriting it with the base_alias
-                        memcpy(RoutingTB_AliasFromId(id), base_alias, MAX_ALIAS_SIZE);
-                        RoutingTB_AddNumToAlias(RoutingTB_AliasFromId(id), annotation++);
+                        break;
                     }
                 }
+                RoutingTB_ComputeServiceIndexes(service, node_idx);
             }
-            detect_state_machine = 0;
-            last_node_id         = 0;
-            return 1;
+            memset(rtb_repair.confirmed_nodes, 0, sizeof(rtb_repair.confirmed_nodes));
+            if (RoutingTB_NeedUnicastShare())
+            {
+                // Some nodes don't know the broadcast distribution or nobody need the routing table
+                RoutingTB_UnicastShare(service, nb_node);
+                detect_state_machine = 0;
+                return true;
+            }
+            // Send all the chunks
+            memset(rtb_repair.missing_chunks, 0xFF, sizeof(rtb_repair.missing_chunks));
+            repair_nb = 0;
+            detect_state_machine++;
+            // fallthrough
+        case 2:
+        {
+            // Broadcast the missing chunks and ask the nodes for the ones they still miss
+            uint8_t chunks[RTB_CHUNK_MAP_SIZE];
+            memcpy(chunks, rtb_repair.missing_chunks, sizeof(chunks));
+            memset(rtb_repair.missing_chunks, 0, sizeof(rtb_repair.missing_chunks));
+            RoutingTB_BroadcastChunks(service, chunks);
+            // Only the reports of this pass are taken into account from now
+            rtb_repair.pass++;
+            rtb_repair.collecting = true;
+            msg_t msg;
+            uint16_t size          = last_routing_table_entry * sizeof(routing_table_t);
+            msg.header.target      = BROADCAST_VAL;
+            msg.header.target_mode = BROADCAST;
+            msg.header.cmd         = RTB_REPAIR;
+            msg.header.size        = RTB_REPAIR_SIZE;
+            memcpy(msg.data, &size, sizeof(uint16_t));
+            msg.data[sizeof(uint16_t)] = rtb_repair.pass;
+            while (Luos_SendMsg(service, &msg) != SUCCEED)
+                ;
+            detect_state_machine++;
+            return false;
+        }
+        break;
+        case 3:
+            // The nodes can't answer before the end of the transmission, start the timeout only then
+            if (LuosIO_TxAllComplete() != SUCCEED)
+            {
+                return false;
+            }
+            start_tick = LuosHAL_GetSystick();
+            detect_state_machine++;
+            return false;
+            break;
+        case 4:
+            // Let the nodes report their missing chunks
+            if (RoutingTB_ShareConfirmed(nb_node) == false)
+            {
+                if ((LuosHAL_GetSystick() - start_tick) < RTB_REPAIR_TIMEOUT_MS)
+                {
+                    return false;
+                }
+                if (++repair_nb < RTB_REPAIR_MAX_NB)
+                {
+                    // Broadcast the missing chunks again and ask the silent nodes again
+                    rtb_repair.collecting = false;
+                    detect_state_machine  = 2;
+                    return false;
+                }
+                // Some nodes can't get the broadcasted chunks, send them the complete routing table
+                RoutingTB_UnicastShare(service, nb_node);
+            }
+            rtb_repair.collecting = false;
+            detect_state_machine  = 0;
+            return true;
             break;
         default:
             LUOS_ASSERT(0);
             break;
     }
-    LUOS_ASSERT(0);
-    return -1;
+    LUOS_ASSERT(0);
+    return true;
+}
+
+/******************************************************************************
+ * @brief Check if the routing table have to be sent to each node separately
+ * @param None
+ * @return true if a node can't receive a broadcasted routing table or if no node need it
+ ******************************************************************************/
+static bool RoutingTB_NeedUnicastShare(void)
+{
+    if (RoutingTB_GetNetworkRevision() < 3)
+    {
+        // Older nodes don't know the broadcasted routing table
+        return true;
+    }
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        if ((routing_table[i].mode == NODE) && (routing_table[i].node_id != 1) && ((routing_table[i].node_info & (1 << 0)) == 0))
+        {
+            // At least one node need the routing table
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+ * @brief Check if all the nodes needing the routing table confirmed its reception
+ * @param nb_node : number of nodes on network
+ * @return true if all the nodes confirmed the reception
+ ******************************************************************************/
+static bool RoutingTB_ShareConfirmed(uint16_t nb_node)
+{
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        uint16_t node_id = routing_table[i].node_id;
+        if ((routing_table[i].mode == NODE) && (node_id != 1) && (node_id <= nb_node) && ((routing_table[i].node_info & (1 << 0)) == 0)
+            && ((rtb_repair.confirmed_nodes[node_id / 8] & (1 << (node_id % 8))) == 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+ * @brief Send the complete route table to each node needing it
+ * @param service : Service who send
+ * @param nb_node : number of nodes on network
+ * @return None
+ * @note Nodes which already confirmed the reception of the broadcasted routing table are skipped.
+ ******************************************************************************/
+static void RoutingTB_UnicastShare(service_t *service, uint16_t nb_node)
+{
+    msg_t intro_msg;
+    intro_msg.header.cmd         = RTB;
+    intro_msg.header.target_mode = NODEIDACK;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        // Check if this node need to get the routing table, don't send it to ourself.
+        uint16_t node_id = routing_table[i].node_id;
+        if ((routing_table[i].mode == NODE) && (node_id != 1) && (node_id <= nb_node) && ((routing_table[i].node_info & (1 << 0)) == 0)
+            && ((rtb_repair.confirmed_nodes[node_id / 8] & (1 << (node_id % 8))) == 0))
+        {
+            intro_msg.header.target = node_id;
+            Luos_SendData(service, &intro_msg, routing_table, (last_routing_table_entry * sizeof(routing_table_t)));
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Broadcast some chunks of the routing table
+ * @param service : Service who send
+ * @param chunks : Bitfield of the chunks to send
+ * @return None
+ ******************************************************************************/
+static void RoutingTB_BroadcastChunks(service_t *service, const uint8_t *chunks)
+{
+    msg_t msg;
+    uint16_t size          = last_routing_table_entry * sizeof(routing_table_t);
+    uint16_t chunk_nb      = (size + RTB_CHUNK_SIZE - 1) / RTB_CHUNK_SIZE;
+    msg.header.target      = BROADCAST_VAL;
+    msg.header.target_mode = BROADCAST;
+    msg.header.cmd         = RTB_CHUNK;
+    memcpy(&msg.data[sizeof(uint16_t)], &size, sizeof(uint16_t));
+    for (uint16_t seq = 0; seq < chunk_nb; seq++)
+    {
+        if ((chunks[seq / 8] & (1 << (seq % 8))) == 0)
+        {
+            continue;
+        }
+        uint16_t offset = seq * RTB_CHUNK_SIZE;
+        uint16_t length = size - offset;
+        if (length > RTB_CHUNK_SIZE)
+        {
+            length = RTB_CHUNK_SIZE;
+        }
+        memcpy(msg.data, &seq, sizeof(uint16_t));
+        memcpy(&msg.data[RTB_CHUNK_HEADER_SIZE], (uint8_t *)routing_table + offset, length);
+        msg.header.size = RTB_CHUNK_HEADER_SIZE + length;
+        // No more memory space available, wait for the previous chunks to be sent.
+        uint32_t tickstart = LuosHAL_GetSystick();
+        while (Luos_SendMsg(service, &msg) == FAILED)
+        {
+            LUOS_ASSERT((LuosHAL_GetSystick() - tickstart) < 500);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Save a chunk of a broadcasted routing table
+ * @param msg : RTB_CHUNK message
+ * @return None
+ ******************************************************************************/
+void RoutingTB_ReceiveChunk(const msg_t *msg)
+{
+    LUOS_ASSERT(msg != NULL);
+    if ((Node_Get()->node_id == 1) || (Node_Get()->node_info & (1 << 0)) || (msg->header.size <= RTB_CHUNK_HEADER_SIZE))
+    {
+        // The detecting node already have the routing table, and some nodes don't need it
+        return;
+    }
+    uint16_t seq;
+    uint16_t size;
+    memcpy(&seq, msg->data, sizeof(uint16_t));
+    memcpy(&size, &msg->data[sizeof(uint16_t)], sizeof(uint16_t));
+    uint16_t offset = seq * RTB_CHUNK_SIZE;
+    uint16_t length = msg->header.size - RTB_CHUNK_HEADER_SIZE;
+    LUOS_ASSERT((size <= sizeof(routing_table)) && (offset + length <= size));
+    if (size != rtb_reception.size)
+    {
+        // This is a new routing table
+        memset(&rtb_reception, 0, sizeof(rtb_reception));
+        rtb_reception.size = size;
+    }
+    memcpy((uint8_t *)routing_table + offset, &msg->data[RTB_CHUNK_HEADER_SIZE], length);
+    rtb_reception.chunks[seq / 8] |= 1 << (seq % 8);
+    if (rtb_reception.complete == true)
+    {
+        return;
+    }
+    uint16_t chunk_nb = (size + RTB_CHUNK_SIZE - 1) / RTB_CHUNK_SIZE;
+    for (uint16_t i = 0; i < chunk_nb; i++)
+    {
+        if ((rtb_reception.chunks[i / 8] & (1 << (i % 8))) == 0)
+        {
+            // Some chunks are still missing
+            return;
+        }
+    }
+    // route table reception complete
+    rtb_reception.complete = true;
+    RoutingTB_ComputeRoutingTableEntryNB();
+    Luos_ResetStatistic();
+}
+
+/******************************************************************************
+ * @brief Report the chunks of the broadcasted routing table this node missed
+ * @param service : Service who send
+ * @param msg : RTB_REPAIR message
+ * @return None
+ * @note A report without any chunk confirm the reception of the complete routing table.
+ ******************************************************************************/
+void RoutingTB_ReceiveRepair(service_t *service, const msg_t *msg)
+{
+    LUOS_ASSERT(msg != NULL);
+    if ((Node_Get()->node_id == 1) || (Node_Get()->node_info & (1 << 0)) || (msg->header.size != RTB_REPAIR_SIZE))
+    {
+        return;
+    }
+    uint16_t size;
+    memcpy(&size, msg->data, sizeof(uint16_t));
+    LUOS_ASSERT(size <= sizeof(routing_table));
+    if (size != rtb_reception.size)
+    {
+        // We didn't receive any chunk of this routing table
+        memset(&rtb_reception, 0, sizeof(rtb_reception));
+        rtb_reception.size = size;
+    }
+    msg_t nack_msg;
+    uint16_t node_id            = Node_Get()->node_id;
+    uint16_t chunk_nb           = (size + RTB_CHUNK_SIZE - 1) / RTB_CHUNK_SIZE;
+    nack_msg.header.target      = 1;
+    nack_msg.header.target_mode = NODEIDACK;
+    nack_msg.header.cmd         = RTB_NACK;
+    nack_msg.header.size        = RTB_NACK_HEADER_SIZE;
+    nack_msg.data[0]            = msg->data[sizeof(uint16_t)];
+    memcpy(&nack_msg.data[sizeof(uint8_t)], &node_id, sizeof(uint16_t));
+    if (rtb_reception.complete == false)
+    {
+        // Report the missing chunks
+        uint8_t *chunks = &nack_msg.data[RTB_NACK_HEADER_SIZE];
+        memset(chunks, 0, chunk_nb / 8 + 1);
+        for (uint16_t i = 0; i < chunk_nb; i++)
+        {
+            if ((rtb_reception.chunks[i / 8] & (1 << (i % 8))) == 0)
+            {
+                chunks[i / 8] |= 1 << (i % 8);
+            }
+        }
+        nack_msg.header.size += chunk_nb / 8 + 1;
+    }
+    Luos_SendMsg(service, &nack_msg);
 }
 
 /******************************************************************************
- * @brief Send the complete route table and all indexes to each node on the network
- * @param service : Service who send
- * @param nb_node : number of nodes on network
+ * @brief Save the chunks missed by a node, they will be broadcasted again
+ * @param msg : RTB_NACK message
  * @return None
+ * @note Reports of a previous pass or coming after the end of the pass are ignored.
  ******************************************************************************/
-static bool RoutingTB_Share(service_t *service, uint16_t nb_node)
+void RoutingTB_ReceiveNack(const msg_t *msg)
 {
-    static uint8_t detect_state_machine = 0;
-    LUOS_ASSERT(service);
-    // Make sure that the detection is not interrupted
-    if (Node_GetState() == EXTERNAL_DETECTION)
+    LUOS_ASSERT(msg != NULL);
+    if ((rtb_repair.collecting == false) || (msg->header.size < RTB_NACK_HEADER_SIZE) || (msg->data[0] != rtb_repair.pass))
     {
-        return true;
+        return;
+    }
+    uint16_t node_id;
+    memcpy(&node_id, &msg->data[sizeof(uint8_t)], sizeof(uint16_t));
+    if ((node_id == 0) || (node_id > MAX_NODE_NUMBER))
+    {
+        return;
+    }
+    if (msg->header.size == RTB_NACK_HEADER_SIZE)
+    {
+        // This node have the complete routing table
+        rtb_repair.confirmed_nodes[node_id / 8] |= 1 << (node_id % 8);
+        return;
+    }
+    uint16_t size = msg->header.size - RTB_NACK_HEADER_SIZE;
+    if (size > sizeof(rtb_repair.missing_chunks))
+    {
+        size = sizeof(rtb_repair.missing_chunks);
+    }
+    for (uint16_t i = 0; i < size; i++)
+    {
+        rtb_repair.missing_chunks[i] |= msg->data[RTB_NACK_HEADER_SIZE + i];
     }
+}
 
-    if (detect_state_machine == 0)
+/******************************************************************************
+ * @brief Add the routing table entries of new nodes to the routing table
+ * @param msg : RTB_DELTA message
+ * @return None
+ * @note The entries of a node are sent in order, the services belong to the last added node.
+ ******************************************************************************/
+void RoutingTB_ReceiveDelta(const msg_t *msg)
+{
+    LUOS_ASSERT(msg != NULL);
+    routing_table_t entry;
+    for (uint16_t i = 0; i + sizeof(routing_table_t) <= msg->header.size; i += sizeof(routing_table_t))
     {
-        // Compute local indexes
-        RoutingTB_ComputeServiceIndexes(service, 0);
-        detect_state_machine++;
-        return false;
+        memcpy(&entry, &msg->data[i], sizeof(routing_table_t));
+        if (entry.mode == NODE)
+        {
+            RoutingTB_AddNode(&entry);
+        }
+        else if (entry.mode == SERVICE)
+        {
+            RoutingTB_AddService(RoutingTB_BigestNodeID(), &entry);
+        }
     }
+}
 
-    // send route table to each nodes. Routing tables are commonly usable for each services of a node.
-    msg_t intro_msg;
-    intro_msg.header.cmd         = RTB;
-    intro_msg.header.target_mode = NODEIDACK;
-    for (uint16_t i = 2; i <= nb_node; i++) // don't send to ourself
+/******************************************************************************
+ * @brief Send the routing table entries of the new nodes to the nodes needing it
+ * @param service : Service who send
+ * @param nb_node : number of nodes on network before the branch detection
+ * @param first_entry : routing table entry of the first new node
+ * @return None
+ * @note The new nodes receive the complete routing table.
+ ******************************************************************************/
+static void RoutingTB_ShareDelta(service_t *service, uint16_t nb_node, uint16_t first_entry)
+{
+    msg_t msg;
+    uint16_t msg_entry_nb  = BASE_DATA_MSG_SIZE / sizeof(routing_table_t);
+    msg.header.target_mode = NODEIDACK;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
     {
-        intro_msg.header.target = i;
-        uint16_t node_idx;
-        for (node_idx = i; node_idx < last_routing_table_entry; node_idx++)
+        // Check if this node need to get the routing table, don't send it to ourself.
+        if ((routing_table[i].mode != NODE) || (routing_table[i].node_id == 1) || (routing_table[i].node_info & (1 << 0)))
         {
-            if ((routing_table[node_idx].mode == NODE) && (routing_table[node_idx].node_id == i))
-            {
-                break;
-            }
+            continue;
         }
-        RoutingTB_ComputeServiceIndexes(service, node_idx);
-        // Check if this node need to get the routing table.
-        if ((routing_table[node_idx].node_info & (1 << 0)) == 0)
+        msg.header.target = routing_table[i].node_id;
+        if (routing_table[i].node_id > nb_node)
         {
-            Luos_SendData(service, &intro_msg, routing_table, (last_routing_table_entry * sizeof(routing_table_t)));
+            // This is a new node, it doesn't have any routing table
+            msg.header.cmd = RTB;
+            Luos_SendData(service, &msg, routing_table, (last_routing_table_entry * sizeof(routing_table_t)));
+            continue;
+        }
+        msg.header.cmd = RTB_DELTA;
+        for (uint16_t entry = first_entry; entry < last_routing_table_entry; entry += msg_entry_nb)
+        {
+            uint16_t nb     = ((last_routing_table_entry - entry) > msg_entry_nb) ? msg_entry_nb : (last_routing_table_entry - entry);
+            msg.header.size = nb * sizeof(routing_table_t);
+            memcpy(msg.data, &routing_table[entry], msg.header.size);
+            // No more memory space available, wait for the previous messages to be sent.
+            uint32_t tickstart = LuosHAL_GetSystick();
+            while (Luos_SendMsg(service, &msg) == FAILED)
+            {
+                LUOS_ASSERT((LuosHAL_GetSystick() - tickstart) < 500);
+            }
         }
     }
-    detect_state_machine = 0;
-    return true;
 }
 
 /******************************************************************************
@@ -675,6 +1479,95 @@ void RoutingTB_ComputeServiceIndexes(service_t *service, uint16_t rtb_index)
     }
 }
 
+/******************************************************************************
+ * @brief Find the phy of a node leading to another node
+ * @param node_id : node looking for the phy
+ * @param target_id : node to reach
+ * @param connection_table : Connections of the nodes
+ * @return Phy id leading to the target node, 0xFF if it is unknown
+ ******************************************************************************/
+static uint8_t RoutingTB_PhyToward(uint16_t node_id, uint16_t target_id, connection_t *connection_table)
+{
+    // Climb the parents of the target, if we find our node the target is behind one of our childs
+    uint16_t child_id = target_id;
+    for (uint16_t depth = 0; depth < MAX_NODE_NUMBER; depth++)
+    {
+        uint16_t parent_id = connection_table[child_id - 1].parent.node_id;
+        if (parent_id == node_id)
+        {
+            return connection_table[child_id - 1].parent.phy_id;
+        }
+        if ((parent_id == 0) || (parent_id > MAX_NODE_NUMBER))
+        {
+            // We reached the detecting node
+            break;
+        }
+        child_id = parent_id;
+    }
+    // The target is accessible trough the phy of our parent
+    return connection_table[node_id - 1].child.phy_id;
+}
+
+/******************************************************************************
+ * @brief Compute indexes of nodes or services on the network and send it to a node
+ * @param service : Service who send
+ * @param node_id : node to send indexes
+ * @param nb_node : number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @param services : true to send the services indexes, false to send the nodes indexes
+ * @return None
+ * @note Unlike RoutingTB_ComputeNodeIndexes the node ids don't have to follow the topology,
+ *       this allows to add a branch to a network without changing the ids of the other nodes.
+ ******************************************************************************/
+static void RoutingTB_ComputeTreeIndexes(service_t *service, uint16_t node_id, uint16_t nb_node, connection_t *connection_table, bool services)
+{
+    uint32_t sent_phys = 0;
+    for (uint16_t target_id = 1; target_id <= nb_node; target_id++)
+    {
+        uint8_t phy = RoutingTB_PhyToward(node_id, target_id, connection_table);
+        if ((target_id == node_id) || (phy >= 32) || (sent_phys & ((uint32_t)1 << phy)))
+        {
+            // This is our node, or this phy is unknown or already sent
+            continue;
+        }
+        sent_phys |= (uint32_t)1 << phy;
+        if (services == false)
+        {
+            // Previous nodes are accessible trough other phys
+            uint8_t nodes_indexes[MAX_NODE_NUMBER / 8 + 1] = {0};
+            for (uint16_t id = target_id; id <= nb_node; id++)
+            {
+                if ((id != node_id) && (RoutingTB_PhyToward(node_id, id, connection_table) == phy))
+                {
+                    uint16_t bit_index = id - 1; // Because 1 represent bit index 0.
+                    nodes_indexes[bit_index / 8] |= 1 << (bit_index % 8);
+                }
+            }
+            RoutingTB_SendNodeIndexes(service, node_id, phy, nodes_indexes);
+        }
+        else
+        {
+            uint8_t services_indexes[MAX_SERVICE_NUMBER / 8 + 1] = {0};
+            bool through_phy                                     = false;
+            for (uint16_t i = 0; i < last_routing_table_entry; i++)
+            {
+                if (routing_table[i].mode == NODE)
+                {
+                    // The following services belong to this node
+                    through_phy = (routing_table[i].node_id != node_id) && (routing_table[i].node_id != 0) && (routing_table[i].node_id <= nb_node)
+                                  && (RoutingTB_PhyToward(node_id, routing_table[i].node_id, connection_table) == phy);
+                }
+                else if ((routing_table[i].mode == SERVICE) && (through_phy == true) && (routing_table[i].id != 0) && (routing_table[i].id <= MAX_SERVICE_NUMBER))
+                {
+                    uint16_t bit_index = routing_table[i].id - 1; // Because 1 represent bit index 0.
+                    services_indexes[bit_index / 8] |= 1 << (bit_index % 8);
+                }
+            }
+            RoutingTB_SendServiceIndexes(service, node_id, phy, services_indexes);
+        }
+    }
+}
+
 /******************************************************************************
  * @brief Send a message to indicate the end of the detection
  * @param service : Service who send
@@ -688,16 +1581,50 @@ void RoutingTB_SendEndDetection(service_t *service)
     {
         return;
     }
+    // Find the lowest message size of the network, every node will use it with the protocol revision.
+    uint8_t revision = RoutingTB_GetNetworkRevision();
+    uint16_t mtu     = MAX_DATA_MSG_SIZE;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        if (routing_table[i].mode == NODE)
+        {
+            // Old nodes don't give their message size and can only handle the base one
+            if (routing_table[i].mtu < mtu)
+            {
+                mtu = (routing_table[i].mtu < BASE_DATA_MSG_SIZE) ? BASE_DATA_MSG_SIZE : routing_table[i].mtu;
+            }
+        }
+    }
     // send end detection message to each nodes
     msg_t msg;
     msg.header.target      = BROADCAST_VAL;
     msg.header.target_mode = BROADCAST;
     msg.header.cmd         = END_DETECTION;
-    msg.header.size        = 0;
+    msg.header.size        = sizeof(uint8_t) + sizeof(uint16_t);
+    msg.data[0]            = revision;
+    memcpy(&msg.data[1], &mtu, sizeof(uint16_t));
     while (Luos_SendMsg(service, &msg) != SUCCEED)
         ;
 }
 
+/******************************************************************************
+ * @brief Find the lowest protocol revision of the network
+ * @param None
+ * @return Protocol revision every node can use
+ ******************************************************************************/
+static uint8_t RoutingTB_GetNetworkRevision(void)
+{
+    uint8_t revision = PROTOCOL_REVISION;
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        if ((routing_table[i].mode == NODE) && ((routing_table[i].node_info >> 4) < revision))
+        {
+            revision = routing_table[i].node_info >> 4;
+        }
+    }
+    return revision;
+}
+
 /******************************************************************************
  * @brief Detect all services and create a route table with it.
  * If multiple services have the same name it will be changed with a number in it
@@ -763,6 +1690,10 @@ bool RoutingTB_DetectServices(service_t *service)
         case 4:
             // Send a message to indicate the end of the detection
             RoutingTB_SendEndDetection(service);
+#ifdef WITH_TOPOLOGY_CACHE
+            // Keep this routing table for the next detections
+            TopologyCache_Save(nb_node, connection_table);
+#endif
             // Clear statistic of node who start the detction
             Luos_ResetStatistic();
             detect_state_machine = 0;
@@ -776,6 +1707,142 @@ bool RoutingTB_DetectServices(service_t *service)
     return false;
 }
 
+/******************************************************************************
+ * @brief Detect the new nodes connected to a node and add them to the routing table.
+ * The other nodes keep their ids and their services keep running.
+ * @param service : Service who send
+ * @param node_id : node looking for new nodes on its ports
+ * @return return true if the detection is complete
+ ******************************************************************************/
+bool RoutingTB_DetectBranch(service_t *service, uint16_t node_id)
+{
+    LUOS_ASSERT(service);
+    static uint8_t detect_state_machine = 0;
+    static uint16_t nb_node             = 0;
+    static uint16_t new_nb_node         = 0;
+    static uint16_t next_node_id        = 0;
+    static uint16_t first_entry         = 0;
+    static uint16_t entry_bkp;
+    static uint32_t timestamp;
+    static connection_t connection_table[MAX_NODE_NUMBER];
+    uint16_t last_service_id;
+    msg_t intro_msg;
+    int result;
+
+    // Make sure that the detection is not interrupted
+    if ((Node_GetState() == EXTERNAL_DETECTION) && (detect_state_machine > 1))
+    {
+        detect_state_machine = 0;
+        return true;
+    }
+    switch (detect_state_machine)
+    {
+        case 0:
+            // Get back the connections of the nodes from the routing table
+            memset(connection_table, 0xFF, sizeof(connection_table));
+            for (uint16_t i = 0; i < last_routing_table_entry; i++)
+            {
+                if ((routing_table[i].mode == NODE) && (routing_table[i].node_id != 0) && (routing_table[i].node_id <= MAX_NODE_NUMBER))
+                {
+                    connection_table[routing_table[i].node_id - 1] = routing_table[i].connection;
+                }
+            }
+            nb_node = RoutingTB_BigestNodeID();
+            detect_state_machine++;
+            // fallthrough
+        case 1:
+            result = LuosIO_BranchDetection(service, node_id, nb_node, connection_table);
+            if (result == 0)
+            {
+                // Topology detection not finished
+                return false;
+            }
+            if (result < 0)
+            {
+                // another detection is in progress, stop this one
+                detect_state_machine = 0;
+                return true;
+            }
+            new_nb_node = (uint16_t)result;
+            if (new_nb_node == nb_node)
+            {
+                // There is no new node
+                detect_state_machine = 5;
+                return false;
+            }
+            // Every node have to know how to reach the new ones, parents have smaller ids and are updated first
+            for (uint16_t id = 1; id <= new_nb_node; id++)
+            {
+                RoutingTB_ComputeTreeIndexes(service, id, new_nb_node, connection_table, false);
+            }
+            first_entry  = last_routing_table_entry;
+            next_node_id = nb_node + 1;
+            detect_state_machine++;
+            // fallthrough
+        case 2:
+            if (next_node_id > new_nb_node)
+            {
+                // We asked all the new nodes
+                detect_state_machine = 4;
+                return false;
+            }
+            // Ask the local routing table of the next new node, its services use the ids following the network ones
+            intro_msg.header.cmd         = LOCAL_RTB;
+            intro_msg.header.target_mode = NODEIDACK;
+            intro_msg.header.target      = next_node_id;
+            intro_msg.header.size        = sizeof(uint16_t);
+            last_service_id              = RoutingTB_BigestID() + 1;
+            memcpy(intro_msg.data, &last_service_id, sizeof(uint16_t));
+            entry_bkp = last_routing_table_entry;
+            Luos_SendMsg(service, &intro_msg);
+            timestamp = LuosHAL_GetSystick();
+            detect_state_machine++;
+            // fallthrough
+        case 3:
+            if (entry_bkp == last_routing_table_entry)
+            {
+                if ((LuosHAL_GetSystick() - timestamp) < 2000)
+                {
+                    // We don't get the answer yet
+                    return false;
+                }
+                // This node doesn't answer, it will not be in the routing table
+            }
+            else
+            {
+                // The node answer don't include connection because the node don't know it
+                LUOS_ASSERT(routing_table[entry_bkp].mode == NODE);
+                routing_table[entry_bkp].connection = connection_table[next_node_id - 1];
+            }
+            next_node_id++;
+            detect_state_machine = 2;
+            return false;
+            break;
+        case 4:
+            // The new services can't use the aliases of the network
+            RoutingTB_CheckAliases();
+            // Every node have to know how to reach the new services
+            for (uint16_t id = 1; id <= new_nb_node; id++)
+            {
+                RoutingTB_ComputeTreeIndexes(service, id, new_nb_node, connection_table, true);
+            }
+            RoutingTB_ShareDelta(service, nb_node, first_entry);
+            detect_state_machine++;
+            // fallthrough
+        case 5:
+            // The end of the detection also ends the branch detection of every node
+            RoutingTB_SendEndDetection(service);
+            detect_state_machine = 0;
+            return true;
+            break;
+        default:
+            LUOS_ASSERT(0);
+            break;
+    }
+    LUOS_ASSERT(0);
+    return false;
+}
+
 /******************************************************************************
  * @brief Entry in routable node with associate service
  * @param entry : Route table
@@ -853,29 +1920,95 @@ void RoutingTB_RemoveService(uint16_t serviceid)
     LUOS_ASSERT(serviceid != 0);
     Service_RmAutoUpdateTarget(serviceid);
     // Find the service
-    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    uint16_t i = RoutingTB_EntryFromId(serviceid);
+    if (i == NO_ENTRY)
+    {
+        return;
+    }
+    LUOS_ASSERT(i < last_routing_table_entry);
+    memcpy(&routing_table[i], &routing_table[i + 1], sizeof(routing_table_t) * (last_routing_table_entry - (i + 1)));
+    last_routing_table_entry--;
+    memset(&routing_table[last_routing_table_entry], 0, sizeof(routing_table_t));
+    if (serviceid == last_service)
     {
-        if ((routing_table[i].mode == SERVICE) && (routing_table[i].id == serviceid))
+        last_service = 0;
+        for (uint16_t i = last_routing_table_entry; i > 0; i--)
         {
-            LUOS_ASSERT(i < last_routing_table_entry);
-            memcpy(&routing_table[i], &routing_table[i + 1], sizeof(routing_table_t) * (last_routing_table_entry - (i + 1)));
-            last_routing_table_entry--;
-            memset(&routing_table[last_routing_table_entry], 0, sizeof(routing_table_t));
-            if (serviceid == last_service)
+            if (routing_table[i].mode == SERVICE)
             {
-                last_service = 0;
-                for (uint16_t i = last_routing_table_entry; i > 0; i--)
-                {
-                    if (routing_table[i].mode == SERVICE)
-                    {
-                        last_service = routing_table[i].id;
-                        break;
-                    }
-                }
+                last_service = routing_table[i].id;
+                break;
             }
+        }
+    }
+    // All the following entries moved, compute the index again.
+    RoutingTB_UpdateIndex();
+}
+
+/******************************************************************************
+ * @brief Add a node at the end of the routing_table
+ * @param entry : Node entry to add
+ * @return None
+ ******************************************************************************/
+void RoutingTB_AddNode(const routing_table_t *entry)
+{
+    LUOS_ASSERT((entry != NULL) && (entry->mode == NODE) && (entry->node_id != 0));
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
+    {
+        if ((routing_table[i].mode == NODE) && (routing_table[i].node_id == entry->node_id))
+        {
+            // This node is already in the routing table
             return;
         }
     }
+    // Keep the last entry clear
+    LUOS_ASSERT(last_routing_table_entry < MAX_RTB_ENTRY - 1);
+    memcpy(&routing_table[last_routing_table_entry], entry, sizeof(routing_table_t));
+    last_routing_table_entry++;
+}
+
+/******************************************************************************
+ * @brief Add a service entry after the other services of its node
+ * @param nodeid : Node id of the service
+ * @param entry : Service entry to add
+ * @return None
+ ******************************************************************************/
+void RoutingTB_AddService(uint16_t nodeid, const routing_table_t *entry)
+{
+    LUOS_ASSERT((entry != NULL) && (entry->mode == SERVICE) && (entry->id != 0));
+    if (RoutingTB_EntryFromId(entry->id) != NO_ENTRY)
+    {
+        // This service is already in the routing table
+        return;
+    }
+    // Find the node
+    uint16_t i;
+    for (i = 0; i < last_routing_table_entry; i++)
+    {
+        if ((routing_table[i].mode == NODE) && (routing_table[i].node_id == nodeid))
+        {
+            break;
+        }
+    }
+    if (i == last_routing_table_entry)
+    {
+        // This node is not in the routing table
+        return;
+    }
+    // Go after its services
+    for (i++; (i < last_routing_table_entry) && (routing_table[i].mode == SERVICE); i++)
+        ;
+    // Keep the last entry clear
+    LUOS_ASSERT(last_routing_table_entry < MAX_RTB_ENTRY - 1);
+    memmove(&routing_table[i + 1], &routing_table[i], sizeof(routing_table_t) * (last_routing_table_entry - i));
+    memcpy(&routing_table[i], entry, sizeof(routing_table_t));
+    last_routing_table_entry++;
+    if (entry->id > last_service)
+    {
+        last_service = entry->id;
+    }
+    // All the following entries moved, compute the index again.
+    RoutingTB_UpdateIndex();
 }
 
 /******************************************************************************
@@ -886,6 +2019,8 @@ void RoutingTB_RemoveService(uint16_t serviceid)
 void RoutingTB_Erase(void)
 {
     memset(routing_table, 0, sizeof(routing_table));
+    memset(&rtb_index, 0, sizeof(rtb_index));
+    memset(&rtb_reception, 0, sizeof(rtb_reception));
     last_service             = 0;
     last_routing_table_entry = 0;
 }
@@ -937,7 +2072,7 @@ search_result_t *RTFilter_Reset(search_result_t *result)
     LUOS_ASSERT(result != NULL);
     // the initialization is to keep a pointer to all the  servicesentries of the routing table
     result->result_nbr = 0;
-    for (uint8_t i = 0; i < last_routing_table_entry; i++)
+    for (uint16_t i = 0; i < last_routing_table_entry; i++)
     {
         if (routing_table[i].mode == SERVICE)
         {
@@ -957,7 +2092,7 @@ search_result_t *RTFilter_Reset(search_result_t *result)
 search_result_t *RTFilter_ID(search_result_t *result, uint16_t id)
 {
     LUOS_ASSERT((result != NULL) && (id != 0));
-    uint8_t entry_nbr = 0;
+    uint16_t entry_nbr = 0;
     // Check result pointer
     LUOS_ASSERT(result != 0);
     // if we the result is not initialized return 0
@@ -965,20 +2100,19 @@ search_result_t *RTFilter_ID(search_result_t *result, uint16_t id)
     {
         result->result_nbr = 0;
     }
+    // Get the only entry having this id and check if it is part of the previous result
+    uint16_t entry = RoutingTB_EntryFromId(id);
     while (entry_nbr < result->result_nbr)
     {
-        // find a service with the wanted type
-        if (result->result_table[entry_nbr]->id != id)
-        {
-            // if we find an other id, erase it from the research table
-            memcpy(&result->result_table[entry_nbr], &result->result_table[entry_nbr + 1], sizeof(routing_table_t *) * (result->result_nbr - entry_nbr));
-            result->result_nbr--;
-        }
-        else
+        if ((entry != NO_ENTRY) && (result->result_table[entry_nbr] == &routing_table[entry]))
         {
-            entry_nbr++;
+            result->result_table[0] = &routing_table[entry];
+            result->result_nbr      = 1;
+            return (result);
         }
+        entry_nbr++;
     }
+    result->result_nbr = 0;
     // return a pointer to the search structure
     return (result);
 }
@@ -1063,7 +2197,7 @@ search_result_t *RTFilter_Node(search_result_t *result, uint16_t node_id)
 search_result_t *RTFilter_Alias(search_result_t *result, char *alias)
 {
     LUOS_ASSERT((result != NULL) && (alias != 0));
-    uint8_t entry_nbr = 0;
+    uint16_t entry_nbr = 0;
     // Check result pointer
     LUOS_ASSERT(result != 0);
     // if we the result is not initialized return 0
@@ -1071,21 +2205,16 @@ search_result_t *RTFilter_Alias(search_result_t *result, char *alias)
     {
         result->result_nbr = 0;
     }
-    // search all the entries of the research table
-    while (entry_nbr < result->result_nbr)
+    // Alias filtering match any alias containing the given string so we can't use the alias index here.
+    // Search all the entries of the research table and keep the matching ones in place.
+    for (uint16_t i = 0; i < result->result_nbr; i++)
     {
-        // find a service with the wanted node_id
-        if (strstr(result->result_table[entry_nbr]->alias, alias) == 0)
-        {
-            // if we find an other node_id, erase it from the research table
-            memcpy(&result->result_table[entry_nbr], &result->result_table[entry_nbr + 1], sizeof(routing_table_t *) * (result->result_nbr - entry_nbr));
-            result->result_nbr--;
-        }
-        else
+        if (strstr(result->result_table[i]->alias, alias) != 0)
         {
-            entry_nbr++;
+            result->result_table[entry_nbr++] = result->result_table[i];
         }
     }
+    result->result_nbr = entry_nbr;
     // return a pointer to the search structure
     return (result);
 }
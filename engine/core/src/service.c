@@ -16,10 +16,27 @@
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
+#define TYPE_LOOKUP_SIZE (2 * MAX_LOCAL_SERVICE_NUMBER)
+#define NO_SERVICE_INDEX 0xFF
+
+typedef struct
+{
+    uint16_t type;             // Service type of this entry.
+    uint8_t first;             // Index of the first service having this type.
+    service_filter_t services; // Services having this type, 0 if this entry is free.
+} type_lookup_t;
+
 typedef struct
 {
     service_t list[MAX_LOCAL_SERVICE_NUMBER];
     uint16_t number;
+
+    // ******************** Lookup tables ********************
+    // Those tables allow to find the services concerned by a message without looping in the service list.
+    uint16_t first_id;                                    // Smallest service ID referenced in id_lookup.
+    uint8_t id_lookup[MAX_LOCAL_SERVICE_NUMBER];          // Service index of each ID starting from first_id.
+    type_lookup_t type_lookup[TYPE_LOOKUP_SIZE];          // Open addressing table of services by type.
+    service_filter_t topic_lookup[MAX_LOCAL_TOPIC_NUMBER]; // Services subscribed to each topic.
 } service_ctx_t;
 
 /*******************************************************************************
@@ -30,6 +47,9 @@ service_ctx_t service_ctx;
 /*******************************************************************************
  * Function
  ******************************************************************************/
+static int Service_IndexFromId(uint16_t id);
+static type_lookup_t *Service_TypeLookup(uint16_t type);
+static inline service_filter_t Service_AllFilter(void);
 
 /******************************************************************************
  * @brief API to Init the service table
@@ -39,6 +59,7 @@ service_ctx_t service_ctx;
 void Service_Init(void)
 {
     service_ctx.number = 0;
+    Service_UpdateLookup();
 }
 
 /******************************************************************************
@@ -97,6 +118,7 @@ void Service_GenerateId(uint16_t base_id)
             service_ctx.list[i].id = base_id++;
         }
     }
+    Service_UpdateLookup();
 }
 
 /******************************************************************************
@@ -112,6 +134,144 @@ void Service_ClearId(void)
         service_ctx.list[i].auto_refresh.time_ms     = 0;
         service_ctx.list[i].auto_refresh.last_update = 0;
     }
+    Service_UpdateLookup();
+}
+
+/******************************************************************************
+ * @brief Compute all the lookup tables from the service list
+ * @return None
+ ******************************************************************************/
+void Service_UpdateLookup(void)
+{
+    // IDs generated by Service_GenerateId are consecutive, find the first one.
+    service_ctx.first_id = DEFAULTID;
+    for (uint16_t i = 0; i < service_ctx.number; i++)
+    {
+        if ((service_ctx.list[i].id != DEFAULTID) && ((service_ctx.first_id == DEFAULTID) || (service_ctx.list[i].id < service_ctx.first_id)))
+        {
+            service_ctx.first_id = service_ctx.list[i].id;
+        }
+    }
+    memset(service_ctx.id_lookup, NO_SERVICE_INDEX, sizeof(service_ctx.id_lookup));
+    for (uint16_t i = 0; i < service_ctx.number; i++)
+    {
+        uint16_t offset = service_ctx.list[i].id - service_ctx.first_id;
+        if ((service_ctx.list[i].id != DEFAULTID) && (offset < MAX_LOCAL_SERVICE_NUMBER))
+        {
+            service_ctx.id_lookup[offset] = i;
+        }
+    }
+    // Reference services by type and by topic
+    memset(service_ctx.type_lookup, 0, sizeof(service_ctx.type_lookup));
+    memset(service_ctx.topic_lookup, 0, sizeof(service_ctx.topic_lookup));
+    for (uint16_t i = 0; i < service_ctx.number; i++)
+    {
+        type_lookup_t *type_entry = Service_TypeLookup(service_ctx.list[i].type);
+        if (type_entry->services == 0)
+        {
+            type_entry->type  = service_ctx.list[i].type;
+            type_entry->first = i;
+        }
+        type_entry->services |= ((service_filter_t)1 << i);
+        for (uint16_t j = 0; j < service_ctx.list[i].last_topic_position; j++)
+        {
+            service_ctx.topic_lookup[service_ctx.list[i].topic_list[j]] |= ((service_filter_t)1 << i);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief Find the index of the service having a specific ID
+ * @param id ID of the service
+ * @return Index of the service in the service table, -1 if there is no service with this ID
+ ******************************************************************************/
+static int Service_IndexFromId(uint16_t id)
+{
+    if (id == DEFAULTID)
+    {
+        return -1;
+    }
+    uint16_t offset = id - service_ctx.first_id;
+    if (offset < MAX_LOCAL_SERVICE_NUMBER)
+    {
+        uint8_t index = service_ctx.id_lookup[offset];
+        if ((index < service_ctx.number) && (service_ctx.list[index].id == id))
+        {
+            return index;
+        }
+    }
+    // This ID is not in the lookup table, it may have been set outside of Service_GenerateId (detector ID for example).
+    // The Luos phy only give us messages targeting our own services so this should be rare.
+    for (uint16_t i = 0; i < service_ctx.number; i++)
+    {
+        if (service_ctx.list[i].id == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/******************************************************************************
+ * @brief Find the type lookup entry of a service type
+ * @param type Type of the service
+ * @return Entry of this type, or the free entry where this type should be stored
+ ******************************************************************************/
+static type_lookup_t *Service_TypeLookup(uint16_t type)
+{
+    uint16_t slot = type % TYPE_LOOKUP_SIZE;
+    // There is at least MAX_LOCAL_SERVICE_NUMBER free entries, so we always find the type or a free entry.
+    while ((service_ctx.type_lookup[slot].services != 0) && (service_ctx.type_lookup[slot].type != type))
+    {
+        slot++;
+        if (slot >= TYPE_LOOKUP_SIZE)
+        {
+            slot = 0;
+        }
+    }
+    return &service_ctx.type_lookup[slot];
+}
+
+/******************************************************************************
+ * @brief Get the filter of all the services having a specific type
+ * @param type Type of the services
+ * @return Filter of the services having this type
+ ******************************************************************************/
+service_filter_t Service_GetTypeFilter(uint16_t type)
+{
+    return Service_TypeLookup(type)->services;
+}
+
+/******************************************************************************
+ * @brief Compute the lookup table entry of a topic from the services subscriptions
+ * @param topic Topic to update
+ * @return Filter of the services subscribed to this topic
+ ******************************************************************************/
+service_filter_t Service_UpdateTopicLookup(uint16_t topic)
+{
+    LUOS_ASSERT(topic < MAX_LOCAL_TOPIC_NUMBER);
+    service_ctx.topic_lookup[topic] = 0;
+    for (uint16_t i = 0; i < service_ctx.number; i++)
+    {
+        if (PubSub_IsTopicSubscribed(&service_ctx.list[i], topic))
+        {
+            service_ctx.topic_lookup[topic] |= ((service_filter_t)1 << i);
+        }
+    }
+    return service_ctx.topic_lookup[topic];
+}
+
+/******************************************************************************
+ * @brief Get the filter of all the services
+ * @return Filter with a bit set for each service
+ ******************************************************************************/
+static inline service_filter_t Service_AllFilter(void)
+{
+    if (service_ctx.number == 0)
+    {
+        return 0;
+    }
+    return ((service_filter_t)~0) >> ((sizeof(service_filter_t) * 8) - service_ctx.number);
 }
 
 /******************************************************************************
@@ -202,30 +362,27 @@ void Service_AutoUpdateManager(void)
  ******************************************************************************/
 service_t *Service_GetConcerned(const header_t *header)
 {
-    uint16_t i = 0;
+    int index                 = 0;
+    type_lookup_t *type_entry = NULL;
     LUOS_ASSERT(header);
     // Find if we are concerned by this message.
     switch (header->target_mode)
     {
         case SERVICEIDACK:
         case SERVICEID:
-            // Check all service id
-            for (i = 0; i < service_ctx.number; i++)
+            // Find the service having this id
+            index = Service_IndexFromId(header->target);
+            if (index >= 0)
             {
-                if (header->target == service_ctx.list[i].id)
-                {
-                    return &service_ctx.list[i];
-                }
+                return &service_ctx.list[index];
             }
             break;
         case TYPE:
-            // Check all service type
-            for (i = 0; i < service_ctx.number; i++)
+            // Find the first service having this type
+            type_entry = Service_TypeLookup(header->target);
+            if (type_entry->services != 0)
             {
-                if (header->target == service_ctx.list[i].type)
-                {
-                    return &service_ctx.list[i];
-                }
+                return &service_ctx.list[type_entry->first];
             }
             break;
         case BROADCAST:
@@ -286,7 +443,7 @@ error_return_t Service_Deliver(phy_job_t *job)
 service_filter_t Service_GetFilter(const msg_t *msg)
 {
     LUOS_ASSERT(msg);
-    uint16_t i              = 0;
+    int index               = 0;
     service_filter_t filter = 0;
 
     // Find if we are concerned by this message.
@@ -294,39 +451,25 @@ service_filter_t Service_GetFilter(const msg_t *msg)
     {
         case SERVICEIDACK:
         case SERVICEID:
-            // Check all service id
-            for (i = 0; i < service_ctx.number; i++)
+            // Find the service having this id
+            index = Service_IndexFromId(msg->header.target);
+            if (index >= 0)
             {
-                if (msg->header.target == service_ctx.list[i].id)
-                {
-                    filter |= (1 << i);
-                    break;
-                }
+                filter = ((service_filter_t)1 << index);
             }
             break;
         case TYPE:
-            // Check all service type
-            for (i = 0; i < service_ctx.number; i++)
-            {
-                if (msg->header.target == service_ctx.list[i].type)
-                {
-                    filter |= (1 << i);
-                }
-            }
+            // Get all the services having this type
+            filter = Service_GetTypeFilter(msg->header.target);
             break;
         case BROADCAST:
-            for (i = 0; i < service_ctx.number; i++)
-            {
-                filter |= (1 << i);
-            }
+            filter = Service_AllFilter();
             break;
         case TOPIC:
-            for (i = 0; i < service_ctx.number; i++)
+            // Get all the services subscribed to this topic
+            if (msg->header.target < MAX_LOCAL_TOPIC_NUMBER)
             {
-                if (PubSub_IsTopicSubscribed(&service_ctx.list[i], msg->header.target))
-                {
-                    filter |= (1 << i);
-                }
+                filter = service_ctx.topic_lookup[msg->header.target];
             }
             break;
         case NODEIDACK:
@@ -336,10 +479,7 @@ service_filter_t Service_GetFilter(const msg_t *msg)
             if (msg->header.target == Node_Get()->node_id)
             {
                 // Give it to all services
-                for (i = 0; i < service_ctx.number; i++)
-                {
-                    filter |= (1 << i);
-                }
+                filter = Service_AllFilter();
             }
             break;
         default:
@@ -401,6 +541,8 @@ service_t *Luos_CreateService(SERVICE_CB service_cb, uint8_t type, const char *a
 
     service_ctx.number++;
     LUOS_ASSERT(service_ctx.number <= MAX_LOCAL_SERVICE_NUMBER);
+    // Reference this new service in the lookup tables
+    Service_UpdateLookup();
     return service;
 }
 
@@ -471,4 +613,5 @@ void Luos_ServicesClear(void)
 
     // Clear service table
     memset((void *)service_ctx.list, 0, sizeof(service_t) * MAX_LOCAL_SERVICE_NUMBER);
+    Service_UpdateLookup();
 }
@@ -6,6 +6,7 @@
  ******************************************************************************/
 #include <string.h>
 #include "stats.h"
+#include "luos_hal.h"
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
@@ -14,6 +15,7 @@
  * Variables
  ******************************************************************************/
 general_stats_t general_stats;
+io_stats_t io_stats;
 
 /*******************************************************************************
  * Function
@@ -22,6 +24,7 @@ general_stats_t general_stats;
 void Stats_Init(void)
 {
     memset(&general_stats, 0, sizeof(general_stats_t));
+    memset(&io_stats, 0, sizeof(io_stats_t));
 }
 
 general_stats_t *Stats_Get(void)
@@ -38,3 +41,40 @@ luos_stats_t *Stats_GetLuos(void)
 {
     return &general_stats.node_stat;
 }
+
+io_stats_t *Stats_GetIO(void)
+{
+    return &io_stats;
+}
+
+/******************************************************************************
+ * @brief Find the power of 2 bucket of a value in a histogram
+ * @param value value to count, 0 and 1 are counted in the first bucket
+ * @return Index of the bucket in a table of STATS_HISTOGRAM_SIZE counters
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL uint8_t Stats_GetHistogramBucket(uint16_t value)
+{
+    uint8_t bucket = 0;
+    while ((value > 1) && (bucket < STATS_HISTOGRAM_SIZE - 1))
+    {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/******************************************************************************
+ * @brief Increment a counter without overflowing it
+ * @param counter value of the counter
+ * @return Incremented value of the counter
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL uint16_t Stats_Increment(uint16_t counter)
+{
+    if (counter < 0xFFFF)
+    {
+        counter++;
+    }
+    return counter;
+}
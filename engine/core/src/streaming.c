@@ -12,6 +12,7 @@
 /*******************************************************************************
  * Function
  ******************************************************************************/
+static uint8_t Streaming_GetSampleSegments(streaming_channel_t *stream, msg_segment_t *segments, uint32_t size);
 
 /******************************************************************************
  * @brief Initialisation of a streaming channel.
@@ -242,7 +243,7 @@ void Luos_SendStreamingSize(service_t *service, msg_t *msg, streaming_channel_t
     {
         data_size = max_size;
     }
-    const int max_data_msg_size = (MAX_DATA_MSG_SIZE / stream->data_size);
+    const int max_data_msg_size = (Luos_GetMtu() / stream->data_size);
     if (data_size > max_data_msg_size)
     {
         msg_number = (data_size / max_data_msg_size);
@@ -263,18 +264,22 @@ void Luos_SendStreamingSize(service_t *service, msg_t *msg, streaming_channel_t
             chunk_size = data_size;
         }
 
-        // Copy data into message
-        Streaming_GetSample(stream, msg->data, chunk_size);
-        msg->header.size = data_size;
+        // Reference samples directly from the ring buffer, they will be copied only once into the message buffer
+        msg_segment_t segments[2];
+        uint8_t segment_nb = Streaming_GetSampleSegments(stream, segments, chunk_size);
+        // The message size is the remaining size in bytes, not in samples
+        msg->header.size = data_size * stream->data_size;
 
         // Send message
         uint32_t tickstart = Luos_GetSystick();
-        while (Luos_SendMsg(service, msg) == FAILED)
+        while (Luos_SendMsgSegments(service, msg, segments, segment_nb) == FAILED)
         {
             // No more memory space available
             // 500ms of timeout after start trying to load our data in memory. Perhaps the buffer is full of RX messages try to increate the buffer size.
             LUOS_ASSERT(((volatile uint32_t)Luos_GetSystick() - tickstart) < 500);
         }
+        // Samples are sent, remove them from the ring buffer
+        Streaming_RmvAvailableSampleNB(stream, chunk_size);
 
         // check end of data
         if (data_size > max_data_msg_size)
@@ -300,8 +305,8 @@ error_return_t Luos_ReceiveStreaming(service_t *service, const msg_t *msg, strea
     LUOS_ASSERT((service != NULL) && (msg != NULL) && (stream != NULL));
     // Get chunk size
     unsigned short chunk_size = 0;
-    if (msg->header.size > MAX_DATA_MSG_SIZE)
-        chunk_size = MAX_DATA_MSG_SIZE;
+    if (msg->header.size > Luos_GetMtu())
+        chunk_size = Luos_GetMtu();
     else
         chunk_size = msg->header.size;
 
@@ -309,10 +314,37 @@ error_return_t Luos_ReceiveStreaming(service_t *service, const msg_t *msg, strea
     Streaming_PutSample(stream, msg->data, (chunk_size / stream->data_size));
 
     // Check end of data
-    if ((msg->header.size <= MAX_DATA_MSG_SIZE))
+    if ((msg->header.size <= Luos_GetMtu()))
     {
         // Chunk collection finished
         return SUCCEED;
     }
     return FAILED;
 }
+
+/******************************************************************************
+ * @brief Reference samples of the ring buffer without copying them
+ * @param stream : Streaming channel pointer
+ * @param segments : Table of 2 segments to fill
+ * @param size : Number of samples to reference
+ * @return Number of segments used
+ ******************************************************************************/
+static uint8_t Streaming_GetSampleSegments(streaming_channel_t *stream, msg_segment_t *segments, uint32_t size)
+{
+    LUOS_ASSERT(Streaming_GetAvailableSampleNB(stream) >= size);
+    uint32_t byte_size = size * stream->data_size;
+    // check if we need to loop in ring buffer
+    if (((uintptr_t)stream->sample_ptr + byte_size) > (uintptr_t)stream->end_ring_buffer)
+    {
+        // requested data exceeds ring buffer end, cut it in 2 segments.
+        uint32_t chunk1  = (uintptr_t)stream->end_ring_buffer - (uintptr_t)stream->sample_ptr;
+        segments[0].data = stream->sample_ptr;
+        segments[0].size = chunk1;
+        segments[1].data = stream->ring_buffer;
+        segments[1].size = byte_size - chunk1;
+        return 2;
+    }
+    segments[0].data = stream->sample_ptr;
+    segments[0].size = byte_size;
+    return 1;
+}
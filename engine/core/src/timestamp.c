@@ -46,6 +46,11 @@
 *
 * Timestamp values are transformed from date to latency at message send and from latency to date at message reception.
 * This allow to track events in the system and put them at a representative date for the node using it.
+*
+* Locally, time_luos_t is a double number of seconds or, if WITH_INTEGER_TIME is defined, an int64 number of nanoseconds.
+* The integer representation keeps the date/latency conversions on integer operations, which matters on targets without FPU.
+* On the network the latency is always a double number of seconds (time_luos_wire_t), so both representations can
+* coexist on the same network. The only floating point operation left is the conversion to/from this wire format.
 *
  ***************************************************************************************************/
 
@@ -60,7 +65,13 @@
  ******************************************************************************/
 time_luos_t Luos_Timestamp(void)
 {
+#ifdef WITH_INTEGER_TIME
+    time_luos_t timestamp;
+    timestamp.raw = (int64_t)LuosHAL_GetTimestamp();
+    return timestamp;
+#else
     return TimeOD_TimeFrom_ns((double)LuosHAL_GetTimestamp());
+#endif
 }
 
 /******************************************************************************
@@ -82,7 +93,7 @@ _CRITICAL inline bool Luos_IsMsgTimstamped(const msg_t *msg)
 time_luos_t Luos_GetMsgTimestamp(const msg_t *msg)
 {
     LUOS_ASSERT(msg != NULL);
-    time_luos_t timestamp = {0.0f};
+    time_luos_t timestamp = {0};
     if (Luos_IsMsgTimstamped(msg))
     {
         // Timestamp is at the end of the message
@@ -118,24 +129,35 @@ _CRITICAL time_luos_t Timestamp_ConvertToLatency(const msg_t *msg)
     time_luos_t timestamp_date;
     memcpy(&timestamp_date, &msg->data[msg->header.size], sizeof(time_luos_t));
     // Compute the latency from date
+#ifdef WITH_INTEGER_TIME
+    time_luos_t latency;
+    latency.raw = timestamp_date.raw - (int64_t)LuosHAL_GetTimestamp();
+#else
     time_luos_t latency = TimeOD_TimeFrom_s(TimeOD_TimeTo_s(timestamp_date) - TimeOD_TimeTo_s(Luos_Timestamp()));
+#endif
     return latency;
 }
 
 /******************************************************************************
  * @brief Compute and write the date in the message
- * @param msg : Received message
+ * @param msg : Received message, the latency is in its network representation
  * @param reception_date : Date of reception in ns
  * @return None
  ******************************************************************************/
 _CRITICAL inline void Timestamp_ConvertToDate(msg_t *msg, uint64_t reception_date)
 {
     LUOS_ASSERT(msg != NULL);
-    time_luos_t timestamp_latency = {0.0f};
+    time_luos_wire_t wire_latency = 0.0;
     // Get latency
-    memcpy(&timestamp_latency, &msg->data[msg->header.size], sizeof(time_luos_t));
+    memcpy(&wire_latency, &msg->data[msg->header.size], sizeof(time_luos_wire_t));
+    time_luos_t timestamp_latency = TimeOD_TimeFromWire(wire_latency);
     // Compute the date from latency
+#ifdef WITH_INTEGER_TIME
+    time_luos_t timestamp_date;
+    timestamp_date.raw = timestamp_latency.raw + (int64_t)reception_date;
+#else
     time_luos_t timestamp_date = TimeOD_TimeFrom_ns(TimeOD_TimeTo_ns(timestamp_latency) + reception_date);
+#endif
     // Write the date on the message
     memcpy(&msg->data[msg->header.size], &timestamp_date, sizeof(time_luos_t));
 }
@@ -0,0 +1,237 @@
+/******************************************************************************
+ * @file topology cache
+ * @brief save the routing table of a known network to skip its generation
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#include <string.h>
+#include "_topology_cache.h"
+#include "_routing_table.h"
+#include "luos_hal.h"
+#include "luos_io.h"
+/******************************* Description of the topology cache ************************************
+ *
+ * During the topology detection each node gives its number of services and a signature of its local routing table
+ * (everything but the ids: node information, message size, types, access and aliases of its services).
+ * The detecting node hashes these signatures with the connection table, this hash changes if a node is added, removed,
+ * moved to another port or if one of its services changes.
+ *
+ * After a complete detection the detecting node saves the hash and the routing table in the flash region given by the HAL:
+ *
+ *                  ┌────────────────┬─────────────────┬─────────────────────────────┐
+ *                  │  hash (32 bit) │ entries (16 bit)│ routing table entries...    │
+ *                  └────────────────┴─────────────────┴─────────────────────────────┘
+ *
+ * On the next detection, if the topology detection gives the same hash, the saved routing table is reused. The nodes
+ * don't have to send their local routing table anymore, they only receive their first service id.
+ * The node ids are still given by the topology detection because only the detecting node keeps the cache.
+ * A routing table bigger than the flash region is not saved.
+ *
+ ***************************************************************************************************/
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+#ifdef WITH_TOPOLOGY_CACHE
+    #define TOPOLOGY_CACHE_MAX_ENTRY ((TOPOLOGY_CACHE_SIZE - sizeof(topology_cache_t)) / sizeof(routing_table_t)) // Number of routing table entries fitting in the flash region
+
+typedef struct __attribute__((__packed__))
+{
+    uint32_t hash;     // Hash of the saved network, 0xFFFFFFFF when nothing is saved
+    uint16_t entry_nb; // Number of saved routing table entries
+} topology_cache_t;
+#endif
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+static uint32_t TopologyCache_Hash(uint32_t hash, const void *data, uint16_t size);
+#ifdef WITH_TOPOLOGY_CACHE
+static bool TopologyCache_CheckRoutingTable(uint16_t nb_node);
+#endif
+
+/******************************************************************************
+ * @brief Compute the signature of a local routing table
+ * @param entries : Local routing table, the node entry first
+ * @param entry_nb : Number of entries
+ * @return Signature of the node, never 0
+ * @note Ids and connections are not used because they are given by the detection.
+ ******************************************************************************/
+uint32_t TopologyCache_LocalSignature(const routing_table_t *entries, uint16_t entry_nb)
+{
+    LUOS_ASSERT(entries != NULL);
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint16_t i = 0; i < entry_nb; i++)
+    {
+        hash = TopologyCache_Hash(hash, &entries[i].mode, sizeof(uint8_t));
+        if (entries[i].mode == NODE)
+        {
+            uint8_t certified = entries[i].certified;
+            hash              = TopologyCache_Hash(hash, &certified, sizeof(uint8_t));
+            hash              = TopologyCache_Hash(hash, &entries[i].node_info, sizeof(uint8_t));
+            hash              = TopologyCache_Hash(hash, &entries[i].mtu, sizeof(uint16_t));
+        }
+        else if (entries[i].mode == SERVICE)
+        {
+            hash = TopologyCache_Hash(hash, &entries[i].type, sizeof(uint16_t));
+            hash = TopologyCache_Hash(hash, &entries[i].access, sizeof(uint8_t));
+            for (uint16_t j = 0; (j < MAX_ALIAS_SIZE) && (entries[i].alias[j] != '\0'); j++)
+            {
+                hash = TopologyCache_Hash(hash, &entries[i].alias[j], sizeof(char));
+            }
+        }
+    }
+    // 0 means that a node didn't give its signature
+    return (hash == 0) ? 1 : hash;
+}
+
+#ifdef WITH_TOPOLOGY_CACHE
+/******************************************************************************
+ * @brief Compute the hash of the network found by the topology detection
+ * @param nb_node : Number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @return Hash of the network, 0 if a node didn't give its signature
+ ******************************************************************************/
+uint32_t TopologyCache_NetworkHash(uint16_t nb_node, const connection_t *connection_table)
+{
+    LUOS_ASSERT(connection_table != NULL);
+    uint32_t hash = TopologyCache_Hash(FNV_OFFSET_BASIS, &nb_node, sizeof(uint16_t));
+    for (uint16_t node_id = 1; node_id <= nb_node; node_id++)
+    {
+        uint16_t service_nb;
+        uint32_t signature;
+        if ((LuosIO_GetNodeServiceNb(node_id, &service_nb) == FAILED) || (LuosIO_GetNodeSignature(node_id, &signature) == FAILED))
+        {
+            // This node is too old or have a static connection, we can't know if it changed
+            return 0;
+        }
+        hash = TopologyCache_Hash(hash, &connection_table[node_id - 1], sizeof(connection_t));
+        hash = TopologyCache_Hash(hash, &service_nb, sizeof(uint16_t));
+        hash = TopologyCache_Hash(hash, &signature, sizeof(uint32_t));
+    }
+    return (hash == 0) ? 1 : hash;
+}
+#endif
+
+/******************************************************************************
+ * @brief Load the saved routing table if the network didn't change
+ * @param nb_node : Number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @return SUCCEED if the routing table have been loaded, FAILED if it have to be generated
+ ******************************************************************************/
+error_return_t TopologyCache_Load(uint16_t nb_node, const connection_t *connection_table)
+{
+#ifdef WITH_TOPOLOGY_CACHE
+    topology_cache_t cache;
+    uint32_t hash = TopologyCache_NetworkHash(nb_node, connection_table);
+    if (hash == 0)
+    {
+        return FAILED;
+    }
+    LuosHAL_FlashReadLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+    if ((cache.hash != hash) || (cache.entry_nb == 0) || (cache.entry_nb >= MAX_RTB_ENTRY) || (cache.entry_nb > TOPOLOGY_CACHE_MAX_ENTRY))
+    {
+        return FAILED;
+    }
+    LuosHAL_FlashReadLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS + sizeof(topology_cache_t), cache.entry_nb * sizeof(routing_table_t), (uint8_t *)RoutingTB_Get());
+    RoutingTB_ComputeRoutingTableEntryNB();
+    if ((RoutingTB_GetLastEntry() != cache.entry_nb) || (TopologyCache_CheckRoutingTable(nb_node) == false))
+    {
+        // The saved routing table is corrupted
+        RoutingTB_Erase();
+        return FAILED;
+    }
+    return SUCCEED;
+#else
+    return FAILED;
+#endif
+}
+
+/******************************************************************************
+ * @brief Save the routing table of the network
+ * @param nb_node : Number of nodes on network
+ * @param connection_table : Connections of the nodes
+ * @return None
+ * @note Nothing is written if the same network is already saved or if the routing table doesn't fit in the flash region.
+ ******************************************************************************/
+void TopologyCache_Save(uint16_t nb_node, const connection_t *connection_table)
+{
+#ifdef WITH_TOPOLOGY_CACHE
+    topology_cache_t cache;
+    uint32_t hash     = TopologyCache_NetworkHash(nb_node, connection_table);
+    uint16_t entry_nb = RoutingTB_GetLastEntry();
+    if ((hash == 0) || (TopologyCache_CheckRoutingTable(nb_node) == false))
+    {
+        // The network can't be identified or some nodes didn't answer
+        return;
+    }
+    if (entry_nb > TOPOLOGY_CACHE_MAX_ENTRY)
+    {
+        // The routing table doesn't fit in the flash region given by the HAL
+        return;
+    }
+    LuosHAL_FlashReadLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+    if ((cache.hash == hash) && (cache.entry_nb == entry_nb))
+    {
+        return;
+    }
+    // Invalidate the previous save first and write the header last, an interrupted save is never loaded
+    memset(&cache, 0xFF, sizeof(topology_cache_t));
+    LuosHAL_FlashWriteLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+    LuosHAL_FlashWriteLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS + sizeof(topology_cache_t), entry_nb * sizeof(routing_table_t), (uint8_t *)RoutingTB_Get());
+    cache.hash     = hash;
+    cache.entry_nb = entry_nb;
+    LuosHAL_FlashWriteLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+#endif
+}
+
+/******************************************************************************
+ * @brief Hash data with FNV-1a
+ * @param hash : Hash of the previous data
+ * @param data : Data to add
+ * @param size : Size of the data
+ * @return Hash including the data
+ ******************************************************************************/
+static uint32_t TopologyCache_Hash(uint32_t hash, const void *data, uint16_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+#ifdef WITH_TOPOLOGY_CACHE
+/******************************************************************************
+ * @brief Check that the routing table contains every node with all their services
+ * @param nb_node : Number of nodes on network
+ * @return true if the routing table is complete
+ ******************************************************************************/
+static bool TopologyCache_CheckRoutingTable(uint16_t nb_node)
+{
+    routing_table_t *rtb = RoutingTB_Get();
+    uint16_t entry       = 0;
+    for (uint16_t node_id = 1; node_id <= nb_node; node_id++)
+    {
+        uint16_t service_nb;
+        if ((entry >= MAX_RTB_ENTRY) || (LuosIO_GetNodeServiceNb(node_id, &service_nb) == FAILED) || (rtb[entry].mode != NODE) || (rtb[entry].node_id != node_id))
+        {
+            return false;
+        }
+        entry++;
+        for (uint16_t i = 0; i < service_nb; i++)
+        {
+            if ((entry >= MAX_RTB_ENTRY) || (rtb[entry++].mode != SERVICE))
+            {
+                return false;
+            }
+        }
+    }
+    return (entry == RoutingTB_GetLastEntry());
+}
+#endif
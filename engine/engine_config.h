@@ -14,9 +14,19 @@
 #define MAX_ALIAS_SIZE         16     // Number of max char for service alias
 #define DETECTION_TIMEOUT_MS   10000  // Timeout used to detect a failed detection
 #define DEFAULTID              0x00   // The default ID of a Luos service
-#define PROTOCOL_REVISION      0      // The Luos protocol revision
+#define PROTOCOL_REVISION      7      // The Luos protocol revision (1 : windowed acknowledgements, 2 : credit based data transfers, 3 : broadcasted routing table, 4 : pipelined services detection, 5 : cached topology, 6 : branch detection, 7 : clock synchronization)
 #define BROADCAST_VAL          0x0FFF // The broadcast target value
-#define MAX_DATA_MSG_SIZE      128    // The maximum size of a data message
+#define BASE_DATA_MSG_SIZE     128    // The maximum data size of a message every node can handle
+
+// The network use the lowest message size of all its nodes and phys (see Phy_SetMtu), negotiated during the detection.
+// There is no per phy message size: messages are never fragmented again when forwarded to another phy,
+// so a network containing a Robus phy keeps BASE_DATA_MSG_SIZE messages everywhere.
+#ifndef MAX_DATA_MSG_SIZE
+    #define MAX_DATA_MSG_SIZE BASE_DATA_MSG_SIZE // The maximum data size of a message this node can handle
+#endif
+#if (MAX_DATA_MSG_SIZE < BASE_DATA_MSG_SIZE)
+    #error 'MAX_DATA_MSG_SIZE' have to be at least BASE_DATA_MSG_SIZE.
+#endif
 
 #ifndef MAX_LOCAL_SERVICE_NUMBER
     #define MAX_LOCAL_SERVICE_NUMBER 5 // The maximum number of local services
@@ -50,11 +60,35 @@
 #ifndef MSG_BUFFER_SIZE
     #define MSG_BUFFER_SIZE 3 * sizeof(msg_t) // The size of the message buffer
 #endif
+// Define WITH_MSGALLOC_POOLS to split the message buffer into size-class pools instead of using it as a ring.
 
 #ifndef MAX_MSG_NB
     #define MAX_MSG_NB 2 * MAX_LOCAL_SERVICE_NUMBER // The maximum number of message referenced by Luos
 #endif
 
+#ifndef DATA_TRANSFER_WINDOW
+    #define DATA_TRANSFER_WINDOW 4 // Number of chunks a receiver accept in advance during a non blocking data transfer
+#endif
+#if (DATA_TRANSFER_WINDOW < 2) || (DATA_TRANSFER_WINDOW > 255)
+    #error 'DATA_TRANSFER_WINDOW' have to be between 2 and 255.
+#endif
+
+#ifndef DATA_TRANSFER_TIMEOUT_MS
+    #define DATA_TRANSFER_TIMEOUT_MS 1000 // Time without credit after which a non blocking data transfer fails
+#endif
+
+#ifndef LOCAL_RTB_WINDOW
+    #define LOCAL_RTB_WINDOW 4 // Number of nodes the detecting node ask for their local routing table at the same time
+#endif
+// Define WITH_TOPOLOGY_CACHE on the detecting node to save the routing table in flash and reuse it while the network doesn't change.
+// The HAL have to give a flash region with TOPOLOGY_CACHE_ADDRESS and TOPOLOGY_CACHE_SIZE, and LuosHAL_FlashWriteLuosMemoryInfo
+// have to be able to write all of it. Only the STUB HAL gives it for now, on the other HALs this define is ignored with a warning.
+
+#ifndef CLOCK_SYNC_PERIOD_MS
+    #define CLOCK_SYNC_PERIOD_MS 1000 // Period of the clock synchronization messages sent by the detection master, 0 disables it
+#endif
+// Define WITH_INTEGER_TIME to store time_luos_t as an int64 number of nanoseconds instead of a double number of seconds.
+
 #ifndef MAX_LOCAL_TOPIC_NUMBER
     #define MAX_LOCAL_TOPIC_NUMBER 20 // The maximum number of topic in the node
 #endif
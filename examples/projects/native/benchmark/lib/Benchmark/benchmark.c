@@ -0,0 +1,364 @@
+/******************************************************************************
+ * @file benchmark
+ * @brief Benchmark of the engine hot paths
+ *
+ *   This benchmark drive the LuosIO_Send -> Phy_Dispatch -> Service_Deliver
+ *   path of a single node with synthetic traffic mixes. For each of them it
+ *   report :
+ *      - the number of messages delivered per second
+ *      - the p50 and p99 latency between the send and the reception of a transfer
+ *      - the number of bytes copied by memcpy per message delivered
+ *
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "luos_engine.h"
+#include "benchmark.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define BENCHMARK_TOPIC        5
+#define BENCHMARK_SHORT_SIZE   8
+#define BENCHMARK_DATA_SIZE    1024
+#define BENCHMARK_SAMPLE_NB    200
+#define BENCHMARK_TIMEOUT_NS   1000000000ULL
+#define BENCHMARK_DETECTION_MS 1000
+
+typedef enum
+{
+    BENCHMARK_SHORT = LUOS_LAST_STD_CMD,
+    BENCHMARK_DATA,
+    BENCHMARK_STREAM
+} benchmark_cmd_t;
+
+typedef struct
+{
+    const char *name;
+    void (*Send)(void);
+    uint16_t completion_nb; // Number of transfer completion expected for each iteration
+} benchmark_scenario_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static service_t *sender;
+static service_t *receiver[2];
+
+static volatile uint32_t delivered_msg_nb = 0;
+static volatile uint32_t completion_nb    = 0;
+
+static bool copy_counting    = false;
+static uint64_t copied_bytes = 0;
+
+static uint8_t tx_data[BENCHMARK_DATA_SIZE];
+static uint8_t rx_data[BENCHMARK_DATA_SIZE];
+static int16_t tx_samples[BENCHMARK_SAMPLE_NB];
+static int16_t tx_ring_buffer[2 * BENCHMARK_SAMPLE_NB];
+static int16_t rx_ring_buffer[2 * BENCHMARK_SAMPLE_NB];
+static streaming_channel_t tx_stream;
+static streaming_channel_t rx_stream;
+
+static uint64_t latency_ns[BENCHMARK_MAX_ITERATION_NB];
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+static void Benchmark_MsgHandler(service_t *service, const msg_t *msg);
+static void Benchmark_SenderHandler(service_t *service, const msg_t *msg);
+static uint64_t Benchmark_GetTime(void);
+static int Benchmark_CompareLatency(const void *a, const void *b);
+static int Benchmark_RunScenario(const benchmark_scenario_t *scenario, uint32_t iteration_nb);
+static void Benchmark_SendServiceId(void);
+static void Benchmark_SendTopic(void);
+static void Benchmark_SendBroadcast(void);
+static void Benchmark_SendData(void);
+static void Benchmark_SendStreaming(void);
+
+static const benchmark_scenario_t scenarios[] = {
+    {"SERVICEID", Benchmark_SendServiceId, 1},
+    {"TOPIC", Benchmark_SendTopic, 1},
+    {"BROADCAST", Benchmark_SendBroadcast, 2},
+    {"SendData 1KB", Benchmark_SendData, 1},
+    {"Streaming", Benchmark_SendStreaming, 1},
+};
+
+/******************************************************************************
+ * @brief init must be call in project init
+ * @param None
+ * @return None
+ ******************************************************************************/
+void Benchmark_Init(void)
+{
+    revision_t revision = {.major = 1, .minor = 0, .build = 0};
+    sender              = Luos_CreateService(Benchmark_SenderHandler, VOID_TYPE, "bench_tx", revision);
+    receiver[0]         = Luos_CreateService(Benchmark_MsgHandler, VOID_TYPE, "bench_rx_a", revision);
+    receiver[1]         = Luos_CreateService(Benchmark_MsgHandler, VOID_TYPE, "bench_rx_b", revision);
+
+    tx_stream = Streaming_CreateChannel(tx_ring_buffer, 2 * BENCHMARK_SAMPLE_NB, sizeof(int16_t));
+    rx_stream = Streaming_CreateChannel(rx_ring_buffer, 2 * BENCHMARK_SAMPLE_NB, sizeof(int16_t));
+    for (uint16_t i = 0; i < BENCHMARK_DATA_SIZE; i++)
+    {
+        tx_data[i] = (uint8_t)i;
+    }
+    for (uint16_t i = 0; i < BENCHMARK_SAMPLE_NB; i++)
+    {
+        tx_samples[i] = (int16_t)i;
+    }
+}
+
+/******************************************************************************
+ * @brief Detect the node then run all the scenarios
+ * @param iteration_nb : Number of transfer of each scenario (0 for default)
+ * @return 0 if all the scenarios succeed
+ ******************************************************************************/
+int Benchmark_Run(uint32_t iteration_nb)
+{
+    if (iteration_nb == 0)
+    {
+        iteration_nb = BENCHMARK_DEFAULT_ITERATION_NB;
+    }
+    if (iteration_nb > BENCHMARK_MAX_ITERATION_NB)
+    {
+        iteration_nb = BENCHMARK_MAX_ITERATION_NB;
+    }
+
+    // Detect our node to get services IDs
+    Luos_Detect(sender);
+    uint32_t tickstart = Luos_GetSystick();
+    while (!Luos_IsDetected())
+    {
+        Luos_Loop();
+        if ((Luos_GetSystick() - tickstart) > BENCHMARK_DETECTION_MS)
+        {
+            printf("Detection failed\n");
+            return 1;
+        }
+    }
+    Luos_Subscribe(receiver[0], BENCHMARK_TOPIC);
+
+    printf("%-14s %12s %12s %12s %14s\n", "scenario", "msg/s", "p50 (ns)", "p99 (ns)", "copied B/msg");
+    int result = 0;
+    for (uint16_t i = 0; i < sizeof(scenarios) / sizeof(benchmark_scenario_t); i++)
+    {
+        result |= Benchmark_RunScenario(&scenarios[i], iteration_nb);
+    }
+    return result;
+}
+
+/******************************************************************************
+ * @brief Send transfers of a scenario one by one and measure them
+ * @param scenario : Scenario to run
+ * @param iteration_nb : Number of transfer to measure
+ * @return 0 if all the transfer have been received
+ ******************************************************************************/
+static int Benchmark_RunScenario(const benchmark_scenario_t *scenario, uint32_t iteration_nb)
+{
+    uint64_t total_ns = 0;
+    delivered_msg_nb  = 0;
+    copied_bytes      = 0;
+
+    for (uint32_t i = 0; i < iteration_nb; i++)
+    {
+        completion_nb  = 0;
+        copy_counting  = true;
+        uint64_t start = Benchmark_GetTime();
+        scenario->Send();
+        // Loop until all the receivers got the complete transfer
+        while (completion_nb < scenario->completion_nb)
+        {
+            Luos_Loop();
+            if ((Benchmark_GetTime() - start) > BENCHMARK_TIMEOUT_NS)
+            {
+                copy_counting = false;
+                printf("%-14s transfer %u timeout\n", scenario->name, (unsigned int)i);
+                return 1;
+            }
+        }
+        latency_ns[i] = Benchmark_GetTime() - start;
+        copy_counting = false;
+        total_ns += latency_ns[i];
+        // Consume what remains (the sender also receive its broadcasts)
+        while (Luos_NbrAvailableMsg())
+        {
+            Luos_Loop();
+        }
+    }
+
+    qsort(latency_ns, iteration_nb, sizeof(uint64_t), Benchmark_CompareLatency);
+    uint64_t p50 = latency_ns[(iteration_nb * 50) / 100];
+    uint64_t p99 = latency_ns[(iteration_nb * 99) / 100];
+    printf("%-14s %12.0f %12llu %12llu %14.1f\n",
+           scenario->name,
+           (double)delivered_msg_nb * 1000000000.0 / (double)total_ns,
+           (unsigned long long)p50,
+           (unsigned long long)p99,
+           (double)copied_bytes / (double)delivered_msg_nb);
+    return 0;
+}
+
+/******************************************************************************
+ * @brief Short message sent to a service ID
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SendServiceId(void)
+{
+    msg_t msg;
+    msg.header.target_mode = SERVICEID;
+    msg.header.target      = receiver[0]->id;
+    msg.header.cmd         = BENCHMARK_SHORT;
+    msg.header.size        = BENCHMARK_SHORT_SIZE;
+    Luos_SendMsg(sender, &msg);
+}
+
+/******************************************************************************
+ * @brief Short message published on a topic
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SendTopic(void)
+{
+    msg_t msg;
+    msg.header.target_mode = TOPIC;
+    msg.header.target      = BENCHMARK_TOPIC;
+    msg.header.cmd         = BENCHMARK_SHORT;
+    msg.header.size        = BENCHMARK_SHORT_SIZE;
+    Luos_SendMsg(sender, &msg);
+}
+
+/******************************************************************************
+ * @brief Short message broadcasted to all the services
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SendBroadcast(void)
+{
+    msg_t msg;
+    msg.header.target_mode = BROADCAST;
+    msg.header.target      = BROADCAST_VAL;
+    msg.header.cmd         = BENCHMARK_SHORT;
+    msg.header.size        = BENCHMARK_SHORT_SIZE;
+    Luos_SendMsg(sender, &msg);
+}
+
+/******************************************************************************
+ * @brief Large data split in multiple messages
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SendData(void)
+{
+    msg_t msg;
+    msg.header.target_mode = SERVICEID;
+    msg.header.target      = receiver[0]->id;
+    msg.header.cmd         = BENCHMARK_DATA;
+    Luos_SendData(sender, &msg, tx_data, BENCHMARK_DATA_SIZE);
+}
+
+/******************************************************************************
+ * @brief Samples sent from a streaming channel
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SendStreaming(void)
+{
+    msg_t msg;
+    msg.header.target_mode = SERVICEID;
+    msg.header.target      = receiver[0]->id;
+    msg.header.cmd         = BENCHMARK_STREAM;
+    // Samples production is not a part of the transfer
+    copy_counting = false;
+    Streaming_PutSample(&tx_stream, tx_samples, BENCHMARK_SAMPLE_NB);
+    copy_counting = true;
+    Luos_SendStreaming(sender, &msg, &tx_stream);
+}
+
+/******************************************************************************
+ * @brief Receivers message handler
+ * @param service : Service receiving the message
+ * @param msg : Received message
+ * @return None
+ ******************************************************************************/
+static void Benchmark_MsgHandler(service_t *service, const msg_t *msg)
+{
+    delivered_msg_nb++;
+    switch (msg->header.cmd)
+    {
+        case BENCHMARK_SHORT:
+            completion_nb++;
+            break;
+        case BENCHMARK_DATA:
+            if (Luos_ReceiveData(service, msg, rx_data) > 0)
+            {
+                completion_nb++;
+            }
+            break;
+        case BENCHMARK_STREAM:
+            if (Luos_ReceiveStreaming(service, msg, &rx_stream) == SUCCEED)
+            {
+                Streaming_ResetChannel(&rx_stream);
+                completion_nb++;
+            }
+            break;
+        default:
+            delivered_msg_nb--;
+            break;
+    }
+}
+
+/******************************************************************************
+ * @brief Sender message handler, messages received by the sender are not measured
+ * @param service : Service receiving the message
+ * @param msg : Received message
+ * @return None
+ ******************************************************************************/
+static void Benchmark_SenderHandler(service_t *service, const msg_t *msg)
+{
+}
+
+/******************************************************************************
+ * @brief Get a monotonic time
+ * @param None
+ * @return Time in ns
+ ******************************************************************************/
+static uint64_t Benchmark_GetTime(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ULL + (uint64_t)time.tv_nsec;
+}
+
+/******************************************************************************
+ * @brief qsort comparison of 2 latencies
+ * @param a : First latency
+ * @param b : Second latency
+ * @return Comparison result
+ ******************************************************************************/
+static int Benchmark_CompareLatency(const void *a, const void *b)
+{
+    uint64_t latency_a = *(const uint64_t *)a;
+    uint64_t latency_b = *(const uint64_t *)b;
+    return (latency_a > latency_b) - (latency_a < latency_b);
+}
+
+/******************************************************************************
+ * @brief memcpy counting the bytes copied during the measures
+ * @param dst : Destination
+ * @param src : Source
+ * @param size : Number of bytes to copy
+ * @return Destination
+ ******************************************************************************/
+#undef memcpy
+void *Benchmark_Memcpy(void *dst, const void *src, size_t size)
+{
+    if (copy_counting)
+    {
+        copied_bytes += size;
+    }
+    return memcpy(dst, src, size);
+}
@@ -0,0 +1,28 @@
+/******************************************************************************
+ * @file benchmark
+ * @brief Benchmark of the engine hot paths
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define BENCHMARK_DEFAULT_ITERATION_NB 10000
+#define BENCHMARK_MAX_ITERATION_NB     100000
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+void Benchmark_Init(void);
+int Benchmark_Run(uint32_t iteration_nb);
+
+#endif /* BENCHMARK_H */
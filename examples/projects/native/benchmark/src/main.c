@@ -0,0 +1,15 @@
+#include "luos_engine.h"
+#include "benchmark.h"
+#include <stdlib.h>
+
+int main(int argc, char *argv[])
+{
+    uint32_t iteration_nb = 0;
+    if (argc > 1)
+    {
+        iteration_nb = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    Luos_Init();
+    Benchmark_Init();
+    return Benchmark_Run(iteration_nb);
+}
@@ -486,17 +486,5 @@ static void RobusHAL_CRCInit(void)
  ******************************************************************************/
 void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc)
 {
-    for (uint8_t i = 0; i < 1; ++i)
-    {
-        uint16_t dbyte = data[i];
-        *(uint16_t *)crc ^= dbyte << 8;
-        for (uint8_t j = 0; j < 8; ++j)
-        {
-            uint16_t mix = *(uint16_t *)crc & 0x8000;
-
-            *(uint16_t *)crc = (*(uint16_t *)crc << 1);
-            if (mix)
-                *(uint16_t *)crc = *(uint16_t *)crc ^ 0x0007;
-        }
-    }
+    *(uint16_t *)crc = ll_crc_compute(data, 1, *(uint16_t *)crc);
 }
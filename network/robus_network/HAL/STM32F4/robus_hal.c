@@ -645,15 +645,21 @@ _CRITICAL void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc)
     __HAL_CRC_DR_RESET(&hcrc);
     *(uint16_t *)crc = (uint16_t)HAL_CRC_Accumulate(&hcrc, (uint32_t *)data, 1);
 #else
-    uint16_t dbyte = *data;
-    *(uint16_t *)crc ^= dbyte << 8;
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-        uint16_t mix = *(uint16_t *)crc & 0x8000;
-
-        *(uint16_t *)crc = (*(uint16_t *)crc << 1);
-        if (mix)
-            *(uint16_t *)crc = *(uint16_t *)crc ^ 0x0007;
-    }
+    *(uint16_t *)crc = ll_crc_compute(data, 1, *(uint16_t *)crc);
 #endif
 }
+#if (USE_CRC_HW == 1)
+/******************************************************************************
+ * @brief Compute the CRC of a complete buffer
+ * @param data Pointer to the data
+ * @param size Size of the data
+ * @param crc_seed CRC initialization value
+ * @return CRC value
+ ******************************************************************************/
+_CRITICAL uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+{
+    hcrc.Instance->INIT = crc_seed;
+    __HAL_CRC_DR_RESET(&hcrc);
+    return (uint16_t)HAL_CRC_Accumulate(&hcrc, (uint32_t *)data, size);
+}
+#endif
@@ -28,4 +28,5 @@ void RobusHAL_SetPTPReverseState(uint8_t PTPNbr);
 void RobusHAL_PushPTP(uint8_t PTPNbr);
 uint8_t RobusHAL_GetPTPState(uint8_t PTPNbr);
 void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc);
+uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed);
 #endif /* _RobusHAL_H_ */
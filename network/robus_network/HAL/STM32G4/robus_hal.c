@@ -48,6 +48,8 @@ Port_t PTP[NBR_PORT];
 
 volatile uint16_t data_size_to_transmit = 0;
 volatile uint8_t *tx_data               = 0;
+volatile uint16_t tx_trailer_size       = 0;
+volatile uint8_t *tx_trailer            = 0;
 
 /*******************************************************************************
  * Function
@@ -156,6 +158,8 @@ _CRITICAL void RobusHAL_SetTxState(uint8_t Enable)
         {
             LL_GPIO_ResetOutputPin(TX_EN_PORT, TX_EN_PIN);
         }
+        // Drop the trailer of the current transmit operation
+        tx_trailer_size = 0;
 #ifdef USE_TX_IT
         // Stop current transmit operation
         data_size_to_transmit = 0;
@@ -216,6 +220,19 @@ _CRITICAL void ROBUS_COM_IRQHANDLER()
     }
 
     // Transmission management
+#ifndef USE_TX_IT
+    if ((LL_USART_IsActiveFlag_TC(ROBUS_COM) != RESET) && (LL_USART_IsEnabledIT_TC(ROBUS_COM) != RESET) && (tx_trailer_size != 0))
+    {
+        // The data have been sent, continue with the trailer
+        LL_USART_ClearFlag_TC(ROBUS_COM);
+        LL_DMA_DisableChannel(ROBUS_DMA, ROBUS_DMA_CHANNEL);
+        LL_DMA_SetMemoryAddress(ROBUS_DMA, ROBUS_DMA_CHANNEL, (uint32_t)tx_trailer);
+        LL_DMA_SetDataLength(ROBUS_DMA, ROBUS_DMA_CHANNEL, tx_trailer_size);
+        tx_trailer_size = 0;
+        LL_DMA_EnableChannel(ROBUS_DMA, ROBUS_DMA_CHANNEL);
+    }
+    else
+#endif
     if ((LL_USART_IsActiveFlag_TC(ROBUS_COM) != RESET) && (LL_USART_IsEnabledIT_TC(ROBUS_COM) != RESET))
     {
         // Transmission complete
@@ -233,7 +250,14 @@ _CRITICAL void ROBUS_COM_IRQHANDLER()
         // Transmit buffer empty (this is a software DMA)
         data_size_to_transmit--;
         LL_USART_TransmitData8(ROBUS_COM, *(tx_data++));
-        if (data_size_to_transmit == 0)
+        if ((data_size_to_transmit == 0) && (tx_trailer_size != 0))
+        {
+            // The data have been sent, continue with the trailer
+            tx_data               = tx_trailer;
+            data_size_to_transmit = tx_trailer_size;
+            tx_trailer_size       = 0;
+        }
+        else if (data_size_to_transmit == 0)
         {
             // Transmission complete, stop loading data and watch for the end of transmission
             // Disable Transmission empty buffer interrupt
@@ -305,6 +329,21 @@ _CRITICAL void RobusHAL_ComTransmit(uint8_t *data, uint16_t size)
     }
     RobusHAL_ResetTimeout(DEFAULT_TIMEOUT);
 }
+/******************************************************************************
+ * @brief Process data transmit followed by a trailer without copying them in a single buffer
+ * @param data pointer to data to send
+ * @param size size of the data
+ * @param trailer pointer to the trailer to send after the data
+ * @param trailer_size size of the trailer
+ * @return None
+ ******************************************************************************/
+_CRITICAL void RobusHAL_ComTransmitGather(uint8_t *data, uint16_t size, uint8_t *trailer, uint16_t trailer_size)
+{
+    // The trailer will be sent by the IRQ at the end of the data
+    tx_trailer      = trailer;
+    tx_trailer_size = trailer_size;
+    RobusHAL_ComTransmit(data, size);
+}
 /******************************************************************************
  * @brief set state of Txlock detection pin
  * @param None
@@ -642,15 +681,21 @@ _CRITICAL void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc)
     __HAL_CRC_DR_RESET(&hcrc);
     *(uint16_t *)crc = (uint16_t)HAL_CRC_Accumulate(&hcrc, (uint32_t *)data, 1);
 #else
-    uint16_t dbyte = *data;
-    *(uint16_t *)crc ^= dbyte << 8;
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-        uint16_t mix = *(uint16_t *)crc & 0x8000;
-
-        *(uint16_t *)crc = (*(uint16_t *)crc << 1);
-        if (mix)
-            *(uint16_t *)crc = *(uint16_t *)crc ^ 0x0007;
-    }
+    *(uint16_t *)crc = ll_crc_compute(data, 1, *(uint16_t *)crc);
 #endif
 }
+#if (USE_CRC_HW == 1)
+/******************************************************************************
+ * @brief Compute the CRC of a complete buffer
+ * @param data Pointer to the data
+ * @param size Size of the data
+ * @param crc_seed CRC initialization value
+ * @return CRC value
+ ******************************************************************************/
+_CRITICAL uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+{
+    hcrc.Instance->INIT = crc_seed;
+    __HAL_CRC_DR_RESET(&hcrc);
+    return (uint16_t)HAL_CRC_Accumulate(&hcrc, (uint32_t *)data, size);
+}
+#endif
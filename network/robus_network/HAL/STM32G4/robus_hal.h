@@ -20,6 +20,7 @@ void RobusHAL_ComInit(uint32_t Baudrate);
 void RobusHAL_SetTxState(uint8_t Enable);
 void RobusHAL_SetRxState(uint8_t Enable);
 void RobusHAL_ComTransmit(uint8_t *data, uint16_t size);
+void RobusHAL_ComTransmitGather(uint8_t *data, uint16_t size, uint8_t *trailer, uint16_t trailer_size);
 uint8_t RobusHAL_GetTxLockState(void);
 void RobusHAL_SetRxDetecPin(uint8_t Enable);
 void RobusHAL_ResetTimeout(uint16_t nbrbit);
@@ -28,5 +29,6 @@ void RobusHAL_SetPTPReverseState(uint8_t PTPNbr);
 void RobusHAL_PushPTP(uint8_t PTPNbr);
 uint8_t RobusHAL_GetPTPState(uint8_t PTPNbr);
 void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc);
+uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed);
 
 #endif /* _RobusHAL_H_ */
@@ -35,6 +35,11 @@ Port_t PTP[NBR_PORT];
 
 volatile uint8_t *tx_data = 0;
 
+uint8_t stub_robus_tx_data[STUB_ROBUS_TX_BUFFER_SIZE];
+uint16_t stub_robus_tx_size = 0;
+bool stub_robus_tx_hold      = false;
+uint16_t stub_robus_timeout  = 0;
+
 /*******************************************************************************
  * Function
  ******************************************************************************/
@@ -42,6 +47,7 @@ static void RobusHAL_CRCInit(void);
 static void RobusHAL_TimeoutInit(void);
 static void RobusHAL_GPIOInit(void);
 static void RobusHAL_RegisterPTP(void);
+static void RobusHAL_StubKeepTx(uint8_t *data, uint16_t size);
 
 /////////////////////////Luos Library Needed function///////////////////////////
 
@@ -105,8 +111,28 @@ void RobusHAL_SetRxState(uint8_t Enable)
  ******************************************************************************/
 void RobusHAL_ComTransmit(uint8_t *data, uint16_t size)
 {
-    // We consider this information sent
-    Recep_Timeout();
+    RobusHAL_StubKeepTx(data, size);
+    if (stub_robus_tx_hold == false)
+    {
+        // We consider this information sent
+        Recep_Timeout();
+    }
+}
+
+/******************************************************************************
+ * @brief Process data transmit followed by a trailer
+ * @param None
+ * @return None
+ ******************************************************************************/
+void RobusHAL_ComTransmitGather(uint8_t *data, uint16_t size, uint8_t *trailer, uint16_t trailer_size)
+{
+    RobusHAL_StubKeepTx(data, size);
+    RobusHAL_StubKeepTx(trailer, trailer_size);
+    if (stub_robus_tx_hold == false)
+    {
+        // We consider this information sent
+        Recep_Timeout();
+    }
 }
 
 /******************************************************************************
@@ -144,6 +170,7 @@ static void RobusHAL_TimeoutInit(void)
  ******************************************************************************/
 void RobusHAL_ResetTimeout(uint16_t nbrbit)
 {
+    stub_robus_timeout = nbrbit;
 }
 
 /******************************************************************************
@@ -240,17 +267,56 @@ static void RobusHAL_CRCInit(void)
  ******************************************************************************/
 void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc)
 {
-    for (uint8_t i = 0; i < 1; ++i)
+#if (USE_CRC_HW == 1)
+    *(uint16_t *)crc = RobusHAL_ComputeCRCBuffer(data, 1, *(uint16_t *)crc);
+#else
+    *(uint16_t *)crc = ll_crc_compute(data, 1, *(uint16_t *)crc);
+#endif
+}
+#if (USE_CRC_HW == 1)
+/******************************************************************************
+ * @brief Compute the CRC of a complete buffer, like a CRC peripheral would do it bit by bit
+ * @param data Pointer to the data
+ * @param size Size of the data
+ * @param crc_seed CRC initialization value
+ * @return CRC value
+ ******************************************************************************/
+uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+{
+    uint16_t crc_val = crc_seed;
+    for (uint16_t i = 0; i < size; i++)
     {
-        uint16_t dbyte = data[i];
-        *(uint16_t *)crc ^= dbyte << 8;
-        for (uint8_t j = 0; j < 8; ++j)
+        crc_val ^= (uint16_t)data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++)
         {
-            uint16_t mix = *(uint16_t *)crc & 0x8000;
-
-            *(uint16_t *)crc = (*(uint16_t *)crc << 1);
-            if (mix)
-                *(uint16_t *)crc = *(uint16_t *)crc ^ 0x0007;
+            crc_val = (crc_val & 0x8000) ? (uint16_t)((crc_val << 1) ^ 0x0007) : (uint16_t)(crc_val << 1);
         }
     }
+    return crc_val;
+}
+#endif
+
+/******************************************************************************
+ * @brief Keep the data sent
+ * @param data pointer of the data sent
+ * @param size size of the data sent
+ * @return None
+ ******************************************************************************/
+static void RobusHAL_StubKeepTx(uint8_t *data, uint16_t size)
+{
+    if (stub_robus_tx_size + size <= STUB_ROBUS_TX_BUFFER_SIZE)
+    {
+        memcpy(&stub_robus_tx_data[stub_robus_tx_size], data, size);
+        stub_robus_tx_size += size;
+    }
+}
+
+/******************************************************************************
+ * @brief Forget the data sent
+ * @param None
+ * @return None
+ ******************************************************************************/
+void RobusHAL_StubClearTx(void)
+{
+    stub_robus_tx_size = 0;
 }
@@ -9,6 +9,7 @@
 #define _ROBUSHAL_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "robus_hal_config.h"
 
 /*******************************************************************************
@@ -17,9 +18,17 @@
 #define ADDRESS_ALIASES_FLASH   ADDRESS_LAST_PAGE_FLASH
 #define ADDRESS_BOOT_FLAG_FLASH (ADDRESS_LAST_PAGE_FLASH + PAGE_SIZE) - 4
 
+#define STUB_ROBUS_TX_BUFFER_SIZE 1024
+
 /*******************************************************************************
  * Variables
  ******************************************************************************/
+// Data sent by the node, the tests can hold the end of the transmissions to check them
+extern uint8_t stub_robus_tx_data[STUB_ROBUS_TX_BUFFER_SIZE];
+extern uint16_t stub_robus_tx_size;
+extern bool stub_robus_tx_hold;
+// Last timeout asked by the node in bits
+extern uint16_t stub_robus_timeout;
 
 /*******************************************************************************
  * Function
@@ -30,6 +39,7 @@ void RobusHAL_ComInit(uint32_t Baudrate);
 void RobusHAL_SetTxState(uint8_t Enable);
 void RobusHAL_SetRxState(uint8_t Enable);
 void RobusHAL_ComTransmit(uint8_t *data, uint16_t size);
+void RobusHAL_ComTransmitGather(uint8_t *data, uint16_t size, uint8_t *trailer, uint16_t trailer_size);
 uint8_t RobusHAL_GetTxLockState(void);
 void RobusHAL_SetRxDetecPin(uint8_t Enable);
 void RobusHAL_ResetTimeout(uint16_t nbrbit);
@@ -38,5 +48,7 @@ void RobusHAL_SetPTPReverseState(uint8_t PTPNbr);
 void RobusHAL_PushPTP(uint8_t PTPNbr);
 uint8_t RobusHAL_GetPTPState(uint8_t PTPNbr);
 void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc);
+uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed);
+void RobusHAL_StubClearTx(void);
 
 #endif /* _ROBUSHAL_H_ */
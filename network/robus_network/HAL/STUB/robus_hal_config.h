@@ -24,6 +24,11 @@
     #define USE_CRC_HW 0
 #endif
 
+// If your HAL can send the data and the trailer of a message from two different buffers define USE_TX_GATHER 1 and implement RobusHAL_ComTransmitGather
+#ifndef USE_TX_GATHER
+    #define USE_TX_GATHER 1
+#endif
+
 #ifndef TIMERDIV
     #define TIMERDIV 1 // clock divider for timer clock chosen
 #endif
@@ -347,6 +347,32 @@ void RobusHAL_ComTransmit(uint8_t *data, uint16_t size)
     // 4. reset timout to default value
     RobusHAL_ResetTimeout(DEFAULT_TIMEOUT);
 }
+/******************************************************************************
+ * @brief Process data transmit followed by a trailer
+ * @param data pointer to data to send
+ * @param size size of the data
+ * @param trailer pointer to the trailer to send after the data
+ * @param trailer_size size of the trailer
+ * @return None
+ ******************************************************************************/
+void RobusHAL_ComTransmitGather(uint8_t *data, uint16_t size, uint8_t *trailer, uint16_t trailer_size)
+{
+    /*************************************************************************
+     * This function is used only if USE_TX_GATHER is 1 in robus_hal_config.h or node_config.h file.
+     *
+     * Luos engine use this function to send a message directly from the msg buffer.
+     * The data are followed by a small trailer (CRC and timestamp) stored in another buffer.
+     * The receivers must see a single frame, so the trailer have to be sent right after the data :
+     *
+     *  1. Save the trailer pointer and size
+     *
+     *  2. Send the data as RobusHAL_ComTransmit does
+     *
+     *  3. When the last byte of data is loaded
+     *      - without DMA, continue the transmission empty buffer IRQ with the trailer
+     *      - with DMA, setup a new DMA transfert with the trailer
+     ************************************************************************/
+}
 /******************************************************************************
  * @brief set rx accuring detection pin
  * @param None
@@ -715,18 +741,27 @@ void RobusHAL_ComputeCRC(uint8_t *data, uint8_t *crc)
     // CRC init value = uint8_t *crc
     // CRC HW calculation
 #else
-    for (uint8_t i = 0; i < 1; ++i)
-    {
-        uint16_t dbyte = data[i];
-        *(uint16_t *)crc ^= dbyte << 8;
-        for (uint8_t j = 0; j < 8; ++j)
-        {
-            uint16_t mix = *(uint16_t *)crc & 0x8000;
-
-            *(uint16_t *)crc = (*(uint16_t *)crc << 1);
-            if (mix)
-                *(uint16_t *)crc = *(uint16_t *)crc ^ 0x0007;
-        }
-    }
+    *(uint16_t *)crc = ll_crc_compute(data, 1, *(uint16_t *)crc);
 #endif
 }
+#if (USE_CRC_HW == 1)
+/******************************************************************************
+ * @brief Compute the CRC of a complete buffer
+ * @param data Pointer to the data
+ * @param size Size of the data
+ * @param crc_seed CRC initialization value
+ * @return CRC value
+ ******************************************************************************/
+uint16_t RobusHAL_ComputeCRCBuffer(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+{
+    /*************************************************************************
+     * This function compute the CRC of a complete message part.
+     * This function is used only if USE_CRC_HW is defined in robus_hal_config.h or node_config.h file.
+     *
+     * Set the CRC init value to crc_seed, feed the hardware CRC unit with
+     * the size bytes of data and return the result.
+     *
+     ************************************************************************/
+    return crc_seed;
+}
+#endif
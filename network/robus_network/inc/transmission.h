@@ -26,6 +26,11 @@ typedef struct
     const uint8_t *data;              // data to compare for collision detection
     volatile transmitStatus_t status; // status of the transmission
     volatile uint8_t collision;       // true is a collision occure during this transmission.
+    uint8_t window_size;              // Number of messages of the window being sent
+    uint8_t window_sent;              // Number of messages of the window already sent
+    volatile uint8_t window_ack;      // Number of messages of the window acknowledged by the target
+    uint8_t window_seq;               // Sequence number of the window being sent
+    bool window_retry;                // true if the window being sent is a retry of a window partially received
 } TxCom_t;
 
 typedef struct __attribute__((__packed__))
@@ -34,15 +39,31 @@ typedef struct __attribute__((__packed__))
     {
         struct __attribute__((__packed__))
         {
-            time_luos_t timestamp;
+            time_luos_wire_t timestamp;
             uint16_t timestamped_crc;
         };                                               // This form is used if there is a timestamp in the message.
         uint16_t crc;                                    // This form is used if there is no timestamp in the message.
         uint8_t unmaped[sizeof(time_luos_t) + CRC_SIZE]; // This form is used to access the last part to transmit as an array of bytes.
     };
     uint16_t size;
+    uint16_t data_crc; // CRC of the message data, used as seed for the timestamp and the window masks
 } robus_encaps_t;
 
+// Windowed acknowledgement (protocol revision 1)
+// The messages of a window have their CRC xored with a mask giving their index in the window (starting at 1)
+// and if they close the window. Only the closing message is acknowledged, with the number of messages received in order.
+// The mask also carry a 2 bits sequence number incremented at each new window of a source, and a retry bit set when the window is sent again.
+// This way the target don't deliver again the messages of a retried window it already received.
+// Only the sources with an ID up to MAX_SERVICE_NUMBER can send windows, the others are acknowledged message by message.
+// Receivers check the 16 x ROBUS_ACK_WINDOW masks, lowering the CRC strength of these messages by log2(16 x ROBUS_ACK_WINDOW) bits.
+#define WINDOW_CRC_CLOSE                          0x0080
+#define WINDOW_CRC_RETRY                          0x0040
+#define WINDOW_CRC_SEQ                            0x0030
+#define WINDOW_CRC_SEQ_SHIFT                      4
+#define WINDOW_CRC_INDEX                          0x000F
+#define WINDOW_CRC_MASK(index, close, seq, retry) ((uint16_t)(0xA500 | ((close) ? WINDOW_CRC_CLOSE : 0) | ((retry) ? WINDOW_CRC_RETRY : 0) | (((seq) << WINDOW_CRC_SEQ_SHIFT) & WINDOW_CRC_SEQ) | ((index)&WINDOW_CRC_INDEX)))
+#define WINDOW_CRC_MASK_CHECK                     0xFF00
+
 /*******************************************************************************
  * Variables
  ******************************************************************************/
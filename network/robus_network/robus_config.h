@@ -24,10 +24,52 @@
     #define NBR_RETRY 10
 #endif
 
+// After a failed transmission a node wait a random number of slots before retrying.
+// The random window is 2 slots wide and double at each retry until reaching 2^ROBUS_BACKOFF_MAX_EXP slots.
+#ifndef ROBUS_BACKOFF_SLOT
+    #define ROBUS_BACKOFF_SLOT 20 // Duration of a backoff slot in bits
+#endif
+#ifndef ROBUS_BACKOFF_MAX_EXP
+    #define ROBUS_BACKOFF_MAX_EXP 6
+#endif
+
+// Priority messages retry in a smaller window placed before the one of the other messages.
+// By default the Luos reserved commands are prioritized.
+#ifndef ROBUS_BACKOFF_PRIORITY_MAX_EXP
+    #define ROBUS_BACKOFF_PRIORITY_MAX_EXP 2
+#endif
+#ifndef ROBUS_IS_PRIORITY_MSG
+    #define ROBUS_IS_PRIORITY_MSG(msg) ((msg)->header.cmd < LUOS_LAST_RESERVED_CMD)
+#endif
+
+// Maximum number of messages a node can send in a row before letting the other nodes access the bus.
+// 0 disable this limit.
+#ifndef ROBUS_TX_BURST_MAX
+    #define ROBUS_TX_BURST_MAX 4
+#endif
+
+// With the protocol revision 1, consecutive messages needing an acknowledgement and going to the same target
+// can be sent back-to-back and acknowledged once. This is the maximum number of messages of this window.
+// 1 disable the windowed acknowledgement.
+#ifndef ROBUS_ACK_WINDOW
+    #define ROBUS_ACK_WINDOW 4
+#endif
+#if (ROBUS_ACK_WINDOW < 1) || (ROBUS_ACK_WINDOW > 14)
+    #error 'ROBUS_ACK_WINDOW' must be between 1 and 14.
+#endif
+
+// Maximum data size of a message on Robus, bigger data are fragmented.
+// Bigger messages keep the bus busy for a longer time.
+#ifndef ROBUS_MTU
+    #define ROBUS_MTU BASE_DATA_MSG_SIZE
+#endif
+
 #ifndef NBR_PORT
     #define NBR_PORT 2
 #endif
 
 #define CRC_SIZE 2
 
+// Define ROBUS_CRC_SLICE_BY_4 to compute the software CRC 4 bytes at a time, this is faster on 32-bit cores but take 1.5KB more flash.
+
 #endif /* _ROBUS_CONFIG_H_ */
@@ -92,9 +92,10 @@ _CRITICAL void PortMng_PtpHandler(uint8_t PortNbr)
         // Ask Luos_phy to find another node
         Phy_TopologyNext();
     }
-    else if (Port_ExpectedState == POKE)
+    else if ((Port_ExpectedState == POKE) && (Phy_GetNodeId() == 0))
     {
         // We just received a poke
+        // A node having an id is already detected, it ignores the pokes of a branch detection
         // Pull the line to notify your presence
         RobusHAL_PushPTP(PortNbr);
         // Save this port as detected
@@ -64,10 +64,19 @@
  ******************************************************************************/
 uint8_t data_rx[sizeof(msg_t)] = {0}; // Buffer to store the received data
 uint16_t crc_val               = 0;   // CRC value
+#if (ROBUS_ACK_WINDOW > 1)
+// Number of messages received in order in the current window of each source (WINDOW_CRC_INDEX),
+// and the sequence number of this window (WINDOW_CRC_SEQ), indexed by source ID.
+static uint8_t window_index[MAX_SERVICE_NUMBER + 1];
+#endif
 
 /*******************************************************************************
  * Function
  ******************************************************************************/
+#if (ROBUS_ACK_WINDOW > 1)
+_CRITICAL static error_return_t Recep_WindowMsg(luos_phy_t *phy_robus, uint16_t crc_mask);
+#endif
+
 /******************************************************************************
  * @brief Reception init.
  * @param None
@@ -79,6 +88,9 @@ void Recep_Init()
     ctx.rx.status.unmap      = 0;
     ctx.rx.callback          = Recep_GetHeader;
     ctx.rx.status.identifier = 0xF;
+#if (ROBUS_ACK_WINDOW > 1)
+    memset(window_index, 0, sizeof(window_index));
+#endif
 }
 /******************************************************************************
  * @brief Reception init.
@@ -172,6 +184,14 @@ _CRITICAL void Recep_GetData(luos_phy_t *phy_robus, volatile uint8_t *data)
     else if (phy_robus->received_data > phy_robus->rx_size)
     {
         crc = crc | ((uint16_t)(*data) << 8);
+#if (ROBUS_ACK_WINDOW > 1)
+        if ((crc != crc_val) && (phy_robus->rx_ack == true) && (Recep_WindowMsg(phy_robus, crc ^ crc_val) == SUCCEED))
+        {
+            // This message is part of a window, it have been managed.
+            ctx.rx.callback = Recep_Drop;
+            return;
+        }
+#endif
         if (crc == crc_val)
         {
             // Message is OK
@@ -206,6 +226,62 @@ _CRITICAL void Recep_GetData(luos_phy_t *phy_robus, volatile uint8_t *data)
     }
     phy_robus->received_data++;
 }
+#if (ROBUS_ACK_WINDOW > 1)
+/******************************************************************************
+ * @brief Check if a message is part of a window and manage it
+ * @param phy_robus Robus phy
+ * @param crc_mask difference between the received and the computed CRC
+ * @return SUCCEED if the message is part of a window
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static error_return_t Recep_WindowMsg(luos_phy_t *phy_robus, uint16_t crc_mask)
+{
+    uint8_t index = crc_mask & WINDOW_CRC_INDEX;
+    uint8_t seq   = crc_mask & WINDOW_CRC_SEQ;
+    bool retry    = (crc_mask & WINDOW_CRC_RETRY) != 0;
+    if (((crc_mask & WINDOW_CRC_MASK_CHECK) != WINDOW_CRC_MASK(0, false, 0, false))
+        || (index == 0) || (index > ROBUS_ACK_WINDOW)
+        || (Phy_GetProtocolRevision() < 1))
+    {
+        // This is not a window message, the CRC is just wrong
+        return FAILED;
+    }
+    uint16_t source = ((header_t *)phy_robus->rx_buffer_base)->source;
+    if (source > MAX_SERVICE_NUMBER)
+    {
+        // We can't follow the windows of this source, it should not send any.
+        return FAILED;
+    }
+    uint8_t *window = &window_index[source];
+    bool valid      = false;
+    if (((index == 1) && (retry == false)) || (seq != (*window & WINDOW_CRC_SEQ)))
+    {
+        // This is the beginning of a new window
+        *window = seq;
+    }
+    if (index == ((*window & WINDOW_CRC_INDEX) + 1))
+    {
+        // This message is the next one of the window, we can keep it.
+        // The previous ones of a retried window have already been received, they are dropped.
+        *window = seq | index;
+        valid   = true;
+    }
+    if (crc_mask & WINDOW_CRC_CLOSE)
+    {
+        // This message close the window, acknowledge the number of messages received in order
+        ctx.rx.status.identifier = *window & WINDOW_CRC_INDEX;
+        Transmit_SendAck();
+    }
+    if (valid)
+    {
+        // Remove the CRC additional byte
+        phy_robus->received_data--;
+        // Valid the message
+        Phy_ValidMsg(phy_robus);
+    }
+    return SUCCEED;
+}
+#endif
 /******************************************************************************
  * @brief Callback to get a collision beetween RX and Tx
  * @param data come from RX
@@ -314,6 +390,12 @@ _CRITICAL void Recep_CatchAck(luos_phy_t *phy_robus, volatile uint8_t *data)
     {
         ctx.tx.status = TX_OK;
     }
+    else if ((!status.rx_error) && (ctx.tx.window_size > 1) && (status.identifier <= ctx.tx.window_size))
+    {
+        // This is the acknowledgement of a window, it contain the number of messages received in order
+        ctx.tx.window_ack = status.identifier;
+        ctx.tx.status     = (status.identifier == ctx.tx.window_size) ? TX_OK : TX_NOK;
+    }
     else
     {
         ctx.tx.status = TX_NOK;
@@ -55,6 +55,7 @@ void Robus_Init(void)
     // Instantiate the phy struct
     phy_robus = Phy_Create(Robus_JobHandler, Robus_RunTopology, Robus_Reset);
     LUOS_ASSERT(phy_robus);
+    Phy_SetMtu(phy_robus, ROBUS_MTU);
 
     // Init reception of the phy
     Recep_PhyInit(phy_robus);
@@ -82,8 +83,9 @@ void Robus_JobHandler(luos_phy_t *phy_ptr, phy_job_t *job)
     // Luos ask Robus to send a message
 
     // Compute the CRC and create the encapsulation context
-    encaps[encaps_index].crc  = ll_crc_compute(job->data_pt, job->size, 0xFFFF);
-    encaps[encaps_index].size = CRC_SIZE;
+    encaps[encaps_index].data_crc = ll_crc_compute(job->data_pt, job->size, 0xFFFF);
+    encaps[encaps_index].crc      = encaps[encaps_index].data_crc;
+    encaps[encaps_index].size     = CRC_SIZE;
 
     // Save the precomputed encapsulation in the job
     Phy_SetIrqState(false);
@@ -109,6 +111,7 @@ void Robus_JobHandler(luos_phy_t *phy_ptr, phy_job_t *job)
 void Robus_Reset(luos_phy_t *phy_ptr)
 {
     PortMng_Init();
+    Recep_Init();
     Recep_Reset();
     Transmit_Init();
 }
@@ -56,11 +56,130 @@
  * Variables
  ******************************************************************************/
 volatile uint8_t nbrRetry = 0;
+static uint32_t random_state = 0; // State of the pseudo random generator used by the backoff
+static uint8_t burst_nb      = 0; // Number of messages sent in a row
+#if (ROBUS_ACK_WINDOW > 1)
+// 2 bits sequence number of the last window sent by each source, indexed by service id
+static uint8_t window_seq[(MAX_SERVICE_NUMBER / 4) + 1];
+#endif
+
+#ifdef ROBUS_CRC_SLICE_BY_4
+// crc_slice_table[n][byte] is the CRC-16 of this byte followed by n + 1 null bytes.
+static const uint16_t crc_slice_table[3][256] = {
+    {
+        0x0000, 0x0700, 0x0E00, 0x0900, 0x1C00, 0x1B00, 0x1200, 0x1500,
+        0x3800, 0x3F00, 0x3600, 0x3100, 0x2400, 0x2300, 0x2A00, 0x2D00,
+        0x7000, 0x7700, 0x7E00, 0x7900, 0x6C00, 0x6B00, 0x6200, 0x6500,
+        0x4800, 0x4F00, 0x4600, 0x4100, 0x5400, 0x5300, 0x5A00, 0x5D00,
+        0xE000, 0xE700, 0xEE00, 0xE900, 0xFC00, 0xFB00, 0xF200, 0xF500,
+        0xD800, 0xDF00, 0xD600, 0xD100, 0xC400, 0xC300, 0xCA00, 0xCD00,
+        0x9000, 0x9700, 0x9E00, 0x9900, 0x8C00, 0x8B00, 0x8200, 0x8500,
+        0xA800, 0xAF00, 0xA600, 0xA100, 0xB400, 0xB300, 0xBA00, 0xBD00,
+        0xC007, 0xC707, 0xCE07, 0xC907, 0xDC07, 0xDB07, 0xD207, 0xD507,
+        0xF807, 0xFF07, 0xF607, 0xF107, 0xE407, 0xE307, 0xEA07, 0xED07,
+        0xB007, 0xB707, 0xBE07, 0xB907, 0xAC07, 0xAB07, 0xA207, 0xA507,
+        0x8807, 0x8F07, 0x8607, 0x8107, 0x9407, 0x9307, 0x9A07, 0x9D07,
+        0x2007, 0x2707, 0x2E07, 0x2907, 0x3C07, 0x3B07, 0x3207, 0x3507,
+        0x1807, 0x1F07, 0x1607, 0x1107, 0x0407, 0x0307, 0x0A07, 0x0D07,
+        0x5007, 0x5707, 0x5E07, 0x5907, 0x4C07, 0x4B07, 0x4207, 0x4507,
+        0x6807, 0x6F07, 0x6607, 0x6107, 0x7407, 0x7307, 0x7A07, 0x7D07,
+        0x8009, 0x8709, 0x8E09, 0x8909, 0x9C09, 0x9B09, 0x9209, 0x9509,
+        0xB809, 0xBF09, 0xB609, 0xB109, 0xA409, 0xA309, 0xAA09, 0xAD09,
+        0xF009, 0xF709, 0xFE09, 0xF909, 0xEC09, 0xEB09, 0xE209, 0xE509,
+        0xC809, 0xCF09, 0xC609, 0xC109, 0xD409, 0xD309, 0xDA09, 0xDD09,
+        0x6009, 0x6709, 0x6E09, 0x6909, 0x7C09, 0x7B09, 0x7209, 0x7509,
+        0x5809, 0x5F09, 0x5609, 0x5109, 0x4409, 0x4309, 0x4A09, 0x4D09,
+        0x1009, 0x1709, 0x1E09, 0x1909, 0x0C09, 0x0B09, 0x0209, 0x0509,
+        0x2809, 0x2F09, 0x2609, 0x2109, 0x3409, 0x3309, 0x3A09, 0x3D09,
+        0x400E, 0x470E, 0x4E0E, 0x490E, 0x5C0E, 0x5B0E, 0x520E, 0x550E,
+        0x780E, 0x7F0E, 0x760E, 0x710E, 0x640E, 0x630E, 0x6A0E, 0x6D0E,
+        0x300E, 0x370E, 0x3E0E, 0x390E, 0x2C0E, 0x2B0E, 0x220E, 0x250E,
+        0x080E, 0x0F0E, 0x060E, 0x010E, 0x140E, 0x130E, 0x1A0E, 0x1D0E,
+        0xA00E, 0xA70E, 0xAE0E, 0xA90E, 0xBC0E, 0xBB0E, 0xB20E, 0xB50E,
+        0x980E, 0x9F0E, 0x960E, 0x910E, 0x840E, 0x830E, 0x8A0E, 0x8D0E,
+        0xD00E, 0xD70E, 0xDE0E, 0xD90E, 0xCC0E, 0xCB0E, 0xC20E, 0xC50E,
+        0xE80E, 0xEF0E, 0xE60E, 0xE10E, 0xF40E, 0xF30E, 0xFA0E, 0xFD0E,
+    },
+    {
+        0x0000, 0x0015, 0x002A, 0x003F, 0x0054, 0x0041, 0x007E, 0x006B,
+        0x00A8, 0x00BD, 0x0082, 0x0097, 0x00FC, 0x00E9, 0x00D6, 0x00C3,
+        0x0150, 0x0145, 0x017A, 0x016F, 0x0104, 0x0111, 0x012E, 0x013B,
+        0x01F8, 0x01ED, 0x01D2, 0x01C7, 0x01AC, 0x01B9, 0x0186, 0x0193,
+        0x02A0, 0x02B5, 0x028A, 0x029F, 0x02F4, 0x02E1, 0x02DE, 0x02CB,
+        0x0208, 0x021D, 0x0222, 0x0237, 0x025C, 0x0249, 0x0276, 0x0263,
+        0x03F0, 0x03E5, 0x03DA, 0x03CF, 0x03A4, 0x03B1, 0x038E, 0x039B,
+        0x0358, 0x034D, 0x0372, 0x0367, 0x030C, 0x0319, 0x0326, 0x0333,
+        0x0540, 0x0555, 0x056A, 0x057F, 0x0514, 0x0501, 0x053E, 0x052B,
+        0x05E8, 0x05FD, 0x05C2, 0x05D7, 0x05BC, 0x05A9, 0x0596, 0x0583,
+        0x0410, 0x0405, 0x043A, 0x042F, 0x0444, 0x0451, 0x046E, 0x047B,
+        0x04B8, 0x04AD, 0x0492, 0x0487, 0x04EC, 0x04F9, 0x04C6, 0x04D3,
+        0x07E0, 0x07F5, 0x07CA, 0x07DF, 0x07B4, 0x07A1, 0x079E, 0x078B,
+        0x0748, 0x075D, 0x0762, 0x0777, 0x071C, 0x0709, 0x0736, 0x0723,
+        0x06B0, 0x06A5, 0x069A, 0x068F, 0x06E4, 0x06F1, 0x06CE, 0x06DB,
+        0x0618, 0x060D, 0x0632, 0x0627, 0x064C, 0x0659, 0x0666, 0x0673,
+        0x0A80, 0x0A95, 0x0AAA, 0x0ABF, 0x0AD4, 0x0AC1, 0x0AFE, 0x0AEB,
+        0x0A28, 0x0A3D, 0x0A02, 0x0A17, 0x0A7C, 0x0A69, 0x0A56, 0x0A43,
+        0x0BD0, 0x0BC5, 0x0BFA, 0x0BEF, 0x0B84, 0x0B91, 0x0BAE, 0x0BBB,
+        0x0B78, 0x0B6D, 0x0B52, 0x0B47, 0x0B2C, 0x0B39, 0x0B06, 0x0B13,
+        0x0820, 0x0835, 0x080A, 0x081F, 0x0874, 0x0861, 0x085E, 0x084B,
+        0x0888, 0x089D, 0x08A2, 0x08B7, 0x08DC, 0x08C9, 0x08F6, 0x08E3,
+        0x0970, 0x0965, 0x095A, 0x094F, 0x0924, 0x0931, 0x090E, 0x091B,
+        0x09D8, 0x09CD, 0x09F2, 0x09E7, 0x098C, 0x0999, 0x09A6, 0x09B3,
+        0x0FC0, 0x0FD5, 0x0FEA, 0x0FFF, 0x0F94, 0x0F81, 0x0FBE, 0x0FAB,
+        0x0F68, 0x0F7D, 0x0F42, 0x0F57, 0x0F3C, 0x0F29, 0x0F16, 0x0F03,
+        0x0E90, 0x0E85, 0x0EBA, 0x0EAF, 0x0EC4, 0x0ED1, 0x0EEE, 0x0EFB,
+        0x0E38, 0x0E2D, 0x0E12, 0x0E07, 0x0E6C, 0x0E79, 0x0E46, 0x0E53,
+        0x0D60, 0x0D75, 0x0D4A, 0x0D5F, 0x0D34, 0x0D21, 0x0D1E, 0x0D0B,
+        0x0DC8, 0x0DDD, 0x0DE2, 0x0DF7, 0x0D9C, 0x0D89, 0x0DB6, 0x0DA3,
+        0x0C30, 0x0C25, 0x0C1A, 0x0C0F, 0x0C64, 0x0C71, 0x0C4E, 0x0C5B,
+        0x0C98, 0x0C8D, 0x0CB2, 0x0CA7, 0x0CCC, 0x0CD9, 0x0CE6, 0x0CF3,
+    },
+    {
+        0x0000, 0x1500, 0x2A00, 0x3F00, 0x5400, 0x4100, 0x7E00, 0x6B00,
+        0xA800, 0xBD00, 0x8200, 0x9700, 0xFC00, 0xE900, 0xD600, 0xC300,
+        0x5007, 0x4507, 0x7A07, 0x6F07, 0x0407, 0x1107, 0x2E07, 0x3B07,
+        0xF807, 0xED07, 0xD207, 0xC707, 0xAC07, 0xB907, 0x8607, 0x9307,
+        0xA00E, 0xB50E, 0x8A0E, 0x9F0E, 0xF40E, 0xE10E, 0xDE0E, 0xCB0E,
+        0x080E, 0x1D0E, 0x220E, 0x370E, 0x5C0E, 0x490E, 0x760E, 0x630E,
+        0xF009, 0xE509, 0xDA09, 0xCF09, 0xA409, 0xB109, 0x8E09, 0x9B09,
+        0x5809, 0x4D09, 0x7209, 0x6709, 0x0C09, 0x1909, 0x2609, 0x3309,
+        0x401B, 0x551B, 0x6A1B, 0x7F1B, 0x141B, 0x011B, 0x3E1B, 0x2B1B,
+        0xE81B, 0xFD1B, 0xC21B, 0xD71B, 0xBC1B, 0xA91B, 0x961B, 0x831B,
+        0x101C, 0x051C, 0x3A1C, 0x2F1C, 0x441C, 0x511C, 0x6E1C, 0x7B1C,
+        0xB81C, 0xAD1C, 0x921C, 0x871C, 0xEC1C, 0xF91C, 0xC61C, 0xD31C,
+        0xE015, 0xF515, 0xCA15, 0xDF15, 0xB415, 0xA115, 0x9E15, 0x8B15,
+        0x4815, 0x5D15, 0x6215, 0x7715, 0x1C15, 0x0915, 0x3615, 0x2315,
+        0xB012, 0xA512, 0x9A12, 0x8F12, 0xE412, 0xF112, 0xCE12, 0xDB12,
+        0x1812, 0x0D12, 0x3212, 0x2712, 0x4C12, 0x5912, 0x6612, 0x7312,
+        0x8036, 0x9536, 0xAA36, 0xBF36, 0xD436, 0xC136, 0xFE36, 0xEB36,
+        0x2836, 0x3D36, 0x0236, 0x1736, 0x7C36, 0x6936, 0x5636, 0x4336,
+        0xD031, 0xC531, 0xFA31, 0xEF31, 0x8431, 0x9131, 0xAE31, 0xBB31,
+        0x7831, 0x6D31, 0x5231, 0x4731, 0x2C31, 0x3931, 0x0631, 0x1331,
+        0x2038, 0x3538, 0x0A38, 0x1F38, 0x7438, 0x6138, 0x5E38, 0x4B38,
+        0x8838, 0x9D38, 0xA238, 0xB738, 0xDC38, 0xC938, 0xF638, 0xE338,
+        0x703F, 0x653F, 0x5A3F, 0x4F3F, 0x243F, 0x313F, 0x0E3F, 0x1B3F,
+        0xD83F, 0xCD3F, 0xF23F, 0xE73F, 0x8C3F, 0x993F, 0xA63F, 0xB33F,
+        0xC02D, 0xD52D, 0xEA2D, 0xFF2D, 0x942D, 0x812D, 0xBE2D, 0xAB2D,
+        0x682D, 0x7D2D, 0x422D, 0x572D, 0x3C2D, 0x292D, 0x162D, 0x032D,
+        0x902A, 0x852A, 0xBA2A, 0xAF2A, 0xC42A, 0xD12A, 0xEE2A, 0xFB2A,
+        0x382A, 0x2D2A, 0x122A, 0x072A, 0x6C2A, 0x792A, 0x462A, 0x532A,
+        0x6023, 0x7523, 0x4A23, 0x5F23, 0x3423, 0x2123, 0x1E23, 0x0B23,
+        0xC823, 0xDD23, 0xE223, 0xF723, 0x9C23, 0x8923, 0xB623, 0xA323,
+        0x3024, 0x2524, 0x1A24, 0x0F24, 0x6424, 0x7124, 0x4E24, 0x5B24,
+        0x9824, 0x8D24, 0xB224, 0xA724, 0xCC24, 0xD924, 0xE624, 0xF324,
+    },
+};
+#endif
 
 /*******************************************************************************
  * Function
  ******************************************************************************/
 _CRITICAL static uint8_t Transmit_GetLockStatus(void);
+_CRITICAL static uint16_t Transmit_ComputeBackoff(phy_job_t *job);
+_CRITICAL static void Transmit_RmJobs(luos_phy_t *robus_phy, uint8_t job_nb);
+#if (ROBUS_ACK_WINDOW > 1)
+_CRITICAL static uint8_t Transmit_GetWindowSize(luos_phy_t *robus_phy, phy_job_t *job);
+#endif
 /******************************************************************************
  * @brief Transmit_Init
  * @param None
@@ -74,8 +193,15 @@ void Transmit_Init(void)
     ctx.tx.collision = false;
     // Init Tx status
     ctx.tx.status = TX_DISABLE;
+    // Init the acknowledgement window
+    ctx.tx.window_size  = 0;
+    ctx.tx.window_sent  = 0;
+    ctx.tx.window_ack   = 0;
+    ctx.tx.window_seq   = 0;
+    ctx.tx.window_retry = false;
     // Init the transmission retry counter
     nbrRetry = 0;
+    burst_nb = 0;
 }
 /******************************************************************************
  * @brief Transmit an ACK
@@ -99,23 +225,33 @@ _CRITICAL void Transmit_SendAck(void)
  * @param size of data
  * @param crc initialization value
  * @return crc
+ * _CRITICAL function call in IRQ
  ******************************************************************************/
-uint16_t ll_crc_compute(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+_CRITICAL uint16_t ll_crc_compute(const uint8_t *data, uint16_t size, uint16_t crc_seed)
 {
+#if (USE_CRC_HW == 1)
+    // Let the CRC peripheral compute it.
+    // The reception IRQ use the same peripheral for each received byte, keep it out until the end of this computation.
+    Phy_SetIrqState(false);
+    uint16_t crc_val = RobusHAL_ComputeCRCBuffer(data, size, crc_seed);
+    Phy_SetIrqState(true);
+    return crc_val;
+#else
     uint16_t crc_val = crc_seed;
-    for (uint16_t i = 0; i < size; i++)
+    #ifdef ROBUS_CRC_SLICE_BY_4
+    // Compute 4 bytes at a time
+    while (size >= 4)
     {
-        uint16_t dbyte = data[i];
-        crc_val ^= dbyte << 8;
-        for (uint8_t j = 0; j < 8; ++j)
-        {
-            uint16_t mix = crc_val & 0x8000;
-            crc_val      = (crc_val << 1);
-            if (mix)
-                crc_val = crc_val ^ 0x0007;
-        }
+        crc_val = crc_slice_table[2][(crc_val >> 8) ^ data[0]]
+                  ^ crc_slice_table[1][(crc_val & 0xFF) ^ data[1]]
+                  ^ crc_slice_table[0][data[2]]
+                  ^ luos_crc_table[data[3]];
+        data += 4;
+        size -= 4;
     }
-    return crc_val;
+    #endif
+    return Luos_ComputeCRC(data, size, crc_val);
+#endif
 }
 
 /******************************************************************************
@@ -125,36 +261,69 @@ uint16_t ll_crc_compute(const uint8_t *data, uint16_t size, uint16_t crc_seed)
  ******************************************************************************/
 _CRITICAL void Transmit_Process()
 {
-    static uint16_t crc_val = 0;
-    luos_phy_t *robus_phy   = Robus_GetPhy();
-    phy_job_t *job          = Phy_GetJob(robus_phy);
+    luos_phy_t *robus_phy = Robus_GetPhy();
+    phy_job_t *job        = Phy_GetJob(robus_phy);
+    phy_job_t *first_job  = NULL;
+    uint16_t crc_mask     = 0;
+#if (USE_TX_GATHER == 0)
     static uint8_t tx_data[sizeof(msg_t) + sizeof(robus_encaps_t)];
+#endif
     // Get the message encapsulation
     if ((job != NULL) && (Transmit_GetLockStatus() == false) && (job->phy_data != NULL))
     {
-        LUOS_ASSERT((job->phy_data != NULL) && (job->size != 0) && (job->size <= sizeof(msg_t)));
-        robus_encaps_t *jobEncaps = (robus_encaps_t *)job->phy_data;
         // We have something to send
         // Check if we already try to send it multiple times and save it on stats if it is
         if (nbrRetry >= NBR_RETRY)
         {
             // We failed to transmit this message. We can't allow it, there is an issue on this target.
             Phy_FailedJob(robus_phy, job);
-            nbrRetry         = 0;
-            ctx.tx.collision = false;
+            nbrRetry            = 0;
+            ctx.tx.collision    = false;
+            ctx.tx.window_size  = 0;
+            ctx.tx.window_sent  = 0;
+            ctx.tx.window_retry = false;
             // Try to get a new job
             job = Phy_GetJob(robus_phy);
-            if (job == NULL)
+            if ((job == NULL) || (job->phy_data == NULL))
             {
                 // Nothing to transmit anymore, just exit.
                 return;
             }
         }
+        first_job = job;
+#if (ROBUS_ACK_WINDOW > 1)
+        if (ctx.tx.window_sent == 0)
+        {
+            // This is a new transmission, check if we can send a window of messages
+            ctx.tx.window_size = Transmit_GetWindowSize(robus_phy, job);
+            if ((ctx.tx.window_size > 1) && (ctx.tx.window_retry == false))
+            {
+                // This is a new window, increment the sequence number of its source.
+                // All the messages of this window, and its retries, use this sequence number.
+                uint16_t source        = ((header_t *)job->data_pt)->source;
+                uint8_t shift          = (source % 4) * 2;
+                ctx.tx.window_seq      = (((window_seq[source / 4] >> shift) + 1) & 0x03);
+                window_seq[source / 4] = (window_seq[source / 4] & ~(0x03 << shift)) | (ctx.tx.window_seq << shift);
+            }
+        }
+        if (ctx.tx.window_size > 1)
+        {
+            // Get the message of the window to send
+            for (uint8_t i = 0; i < ctx.tx.window_sent; i++)
+            {
+                job = Phy_GetNextJob(robus_phy, job);
+            }
+            crc_mask = WINDOW_CRC_MASK(ctx.tx.window_sent + 1, (ctx.tx.window_sent + 1) == ctx.tx.window_size, ctx.tx.window_seq, ctx.tx.window_retry);
+        }
+#endif
+        LUOS_ASSERT((job != NULL) && (job->phy_data != NULL) && (job->size != 0) && (job->size <= sizeof(msg_t)));
+        robus_encaps_t *jobEncaps = (robus_encaps_t *)job->phy_data;
         // Check if we will need an ACK for this message and compute the transmit status we will need to manage
         transmitStatus_t initial_transmit_status = TX_OK;
-        if (job->ack == true)
+        if ((job->ack == true) && ((ctx.tx.window_size <= 1) || ((ctx.tx.window_sent + 1) == ctx.tx.window_size)))
         {
             // We will need to validate the good reception with a ack.
+            // Only the last message of a window is acknowledged.
             // Switch the tx status as TX_NOK allowing to detect a default at the next Timeout if no ACK have been received.
             initial_transmit_status = TX_NOK;
         }
@@ -168,50 +337,121 @@ _CRITICAL void Transmit_Process()
             // Switch reception in collision detection mode
             Phy_SetIrqState(false);
             ctx.rx.callback = Recep_GetCollision;
+            ctx.tx.window_ack = 0;
             Phy_SetIrqState(true);
-            ctx.tx.data = tx_data;
-
-            if (!nbrRetry)
-            {
-                // This is the first time we try to send this message, we need to backup the original crc value and the job data to the TX_data buffer
-                crc_val = jobEncaps->crc;
-                memcpy(tx_data, job->data_pt, job->size);
-                // Add the end of the message in the end of the buffer
-                memcpy(&tx_data[job->size], jobEncaps->unmaped, jobEncaps->size);
-            }
 
             // Put timestamping on data here
             if (job->timestamp)
             {
-
                 // Convert date to a sendable timestamp and put it on the encapsulation
                 jobEncaps->timestamp = Phy_ComputeMsgTimestamp(robus_phy, job);
 
-                jobEncaps->timestamped_crc = ll_crc_compute(jobEncaps->unmaped, sizeof(time_luos_t), crc_val);
+                jobEncaps->timestamped_crc = ll_crc_compute(jobEncaps->unmaped, sizeof(time_luos_t), jobEncaps->data_crc) ^ crc_mask;
                 jobEncaps->size            = sizeof(time_luos_t) + CRC_SIZE;
-                // Add the end of the message in the end of the buffer
-                memcpy(&tx_data[job->size], jobEncaps->unmaped, jobEncaps->size);
             }
+            else
+            {
+                jobEncaps->crc  = jobEncaps->data_crc ^ crc_mask;
+                jobEncaps->size = CRC_SIZE;
+            }
+#if (USE_TX_GATHER == 1)
+            // The HAL send the message directly from the msg buffer, followed by the encapsulation
+            ctx.tx.data = job->data_pt;
+#else
+            ctx.tx.data = tx_data;
+            if ((!nbrRetry) || (ctx.tx.window_size > 1))
+            {
+                // This is the first time we try to send this message, copy the job data to the TX_data buffer
+                memcpy(tx_data, job->data_pt, job->size);
+            }
+            // Add the end of the message in the end of the buffer
+            memcpy(&tx_data[job->size], jobEncaps->unmaped, jobEncaps->size);
+#endif
 
             // Transmit data
-            if (Phy_GetJob(robus_phy) == job)
+            if (Phy_GetJob(robus_phy) == first_job)
             {
                 LUOS_ASSERT((job->size + jobEncaps->size) >= 9);
                 Phy_SetIrqState(false);
                 // We will prepare to transmit something enable tx status with precomputed value of the initial_transmit_status
                 ctx.tx.status = initial_transmit_status;
                 // We still have something to send, no reset occured
+#if (USE_TX_GATHER == 1)
+                RobusHAL_ComTransmitGather((uint8_t *)job->data_pt, job->size, jobEncaps->unmaped, jobEncaps->size);
+#else
                 RobusHAL_ComTransmit(tx_data, (job->size + jobEncaps->size));
+#endif
                 Phy_SetIrqState(true);
             }
             else
             {
-                nbrRetry = 0;
+                nbrRetry            = 0;
+                ctx.tx.window_size  = 0;
+                ctx.tx.window_sent  = 0;
+                ctx.tx.window_retry = false;
             }
         }
     }
 }
 
+#if (ROBUS_ACK_WINDOW > 1)
+/******************************************************************************
+ * @brief Compute the number of messages we can send in a window
+ * @param robus_phy Robus phy
+ * @param job first job of the window
+ * @return Number of messages of the window
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static uint8_t Transmit_GetWindowSize(luos_phy_t *robus_phy, phy_job_t *job)
+{
+    uint8_t window_size = 1;
+    if ((job->ack == false) || (job->msg_pt == NULL) || (Phy_GetProtocolRevision() < 1))
+    {
+        // The target can't handle windowed acknowledgement
+        return window_size;
+    }
+    if (job->msg_pt->header.source > MAX_SERVICE_NUMBER)
+    {
+        // The target can't follow the windows of this source
+        return window_size;
+    }
+    // All the messages of a window have to come from the same source and go to the same target
+    phy_job_t *next_job = Phy_GetNextJob(robus_phy, job);
+    while ((window_size < ROBUS_ACK_WINDOW)
+           && (next_job != NULL)
+           && (next_job->ack == true)
+           && (next_job->phy_data != NULL)
+           && (next_job->msg_pt != NULL)
+           && (next_job->msg_pt->header.target == job->msg_pt->header.target)
+           && (next_job->msg_pt->header.target_mode == job->msg_pt->header.target_mode)
+           && (next_job->msg_pt->header.source == job->msg_pt->header.source))
+    {
+        window_size++;
+        next_job = Phy_GetNextJob(robus_phy, next_job);
+    }
+    return window_size;
+}
+#endif
+
+/******************************************************************************
+ * @brief Remove the first jobs of the queue
+ * @param robus_phy Robus phy
+ * @param job_nb number of jobs to remove
+ * @return None
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static void Transmit_RmJobs(luos_phy_t *robus_phy, uint8_t job_nb)
+{
+    // We may had a reset during this transmission, so we need to check if we still have something to transmit
+    while ((job_nb > 0) && (Phy_GetJobNumber(robus_phy) > 0))
+    {
+        phy_job_t *job = Phy_GetJob(robus_phy);
+        job->phy_data  = 0;
+        Phy_RmJob(robus_phy, job);
+        job_nb--;
+    }
+}
+
 /******************************************************************************
  * @brief Send ID to others service on network
  * @param None
@@ -227,6 +467,59 @@ _CRITICAL static uint8_t Transmit_GetLockStatus(void)
     return ctx.tx.lock;
 }
 
+/******************************************************************************
+ * @brief Get a pseudo random number
+ * @param None
+ * @return Random value
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static uint16_t Transmit_Random(void)
+{
+    // Mix the date and the node id in the state to decorrelate the nodes that collided together
+    random_state ^= (uint32_t)Phy_GetTimestamp() ^ ((uint32_t)Phy_GetNodeId() << 16);
+    if (random_state == 0)
+    {
+        random_state = 0x2545F491;
+    }
+    // Xorshift generator
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return (uint16_t)random_state;
+}
+
+/******************************************************************************
+ * @brief Compute the delay to wait before retrying a transmission
+ * @param job job to retry
+ * @return Delay in bits
+ * _CRITICAL function call in IRQ
+ ******************************************************************************/
+_CRITICAL static uint16_t Transmit_ComputeBackoff(phy_job_t *job)
+{
+    // Even the first wait is picked in 2 slots, the nodes waiting together have to be separated
+    uint8_t exponent = nbrRetry + 1;
+    uint16_t slot    = 1;
+    if ((job != NULL) && (job->msg_pt != NULL) && ROBUS_IS_PRIORITY_MSG(job->msg_pt))
+    {
+        if (exponent > ROBUS_BACKOFF_PRIORITY_MAX_EXP)
+        {
+            exponent = ROBUS_BACKOFF_PRIORITY_MAX_EXP;
+        }
+    }
+    else
+    {
+        if (exponent > ROBUS_BACKOFF_MAX_EXP)
+        {
+            exponent = ROBUS_BACKOFF_MAX_EXP;
+        }
+        // Let the priority messages retry first
+        slot += (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP);
+    }
+    // Pick a random slot in the window
+    slot += Transmit_Random() & ((1 << exponent) - 1);
+    return slot * ROBUS_BACKOFF_SLOT;
+}
+
 /******************************************************************************
  * @brief finish transmit and try to launch a new one
  * @param None
@@ -235,28 +528,67 @@ _CRITICAL static uint8_t Transmit_GetLockStatus(void)
  ******************************************************************************/
 _CRITICAL void Transmit_End(void)
 {
+    luos_phy_t *robus_phy = Robus_GetPhy();
     if (ctx.tx.status == TX_OK)
     {
-        // A job have been sucessfully transmitted
-        nbrRetry         = 0;
         ctx.tx.collision = false;
         ctx.tx.status    = TX_DISABLE;
-        // Remove the job
-        luos_phy_t *robus_phy = Robus_GetPhy();
-        phy_job_t *job        = Phy_GetJob(robus_phy);
-        // We may had a reset during this transmission, so we need to check if we still have something to transmit
-        if (Phy_GetJobNumber(robus_phy) > 0)
+        if (ctx.tx.window_size > 1)
+        {
+            ctx.tx.window_sent++;
+            if (ctx.tx.window_sent < ctx.tx.window_size)
+            {
+                // This message of the window is not acknowledged alone, directly send the next one.
+                ctx.tx.lock = false;
+                Transmit_Process();
+                return;
+            }
+        }
+        // The job, or the complete window, have been sucessfully transmitted
+        nbrRetry = 0;
+        Transmit_RmJobs(robus_phy, (ctx.tx.window_size > 1) ? ctx.tx.window_size : 1);
+        ctx.tx.window_size  = 0;
+        ctx.tx.window_sent  = 0;
+        ctx.tx.window_retry = false;
+#if (ROBUS_TX_BURST_MAX > 0)
+        burst_nb++;
+        if (Phy_GetJobNumber(robus_phy) == 0)
         {
-            job->phy_data = 0;
-            Phy_RmJob(robus_phy, job);
+            burst_nb = 0;
+        }
+        else if (burst_nb >= ROBUS_TX_BURST_MAX)
+        {
+            // We sent too many messages in a row, give a chance to the other nodes to take the bus before sending the next one.
+            burst_nb = 0;
+            RobusHAL_ResetTimeout(Transmit_ComputeBackoff(Phy_GetJob(robus_phy)));
+            ctx.tx.lock = true;
+            return;
         }
+#endif
     }
     else if (ctx.tx.status == TX_NOK)
     {
         // A tx_task failed
-        nbrRetry++;
-        // compute a delay before retry
-        RobusHAL_ResetTimeout(20 * nbrRetry * (Phy_GetNodeId() + 1));
+        Phy_CountRetry(robus_phy, ctx.tx.collision);
+        ctx.tx.collision = false;
+        if ((ctx.tx.window_size > 1) && (ctx.tx.window_ack > 0))
+        {
+            // The target received the beginning of the window, remove these jobs and retry the others.
+            Transmit_RmJobs(robus_phy, ctx.tx.window_ack);
+            nbrRetry            = 0;
+            ctx.tx.window_retry = false;
+        }
+        else
+        {
+            nbrRetry++;
+            // The target may have received a part of the window, send it again as a retry to avoid any double delivery.
+            ctx.tx.window_retry = (ctx.tx.window_size > 1);
+        }
+        ctx.tx.window_size = 0;
+        ctx.tx.window_sent = 0;
+        burst_nb           = 0;
+        // compute a random delay before retry
+        RobusHAL_ResetTimeout(Transmit_ComputeBackoff(Phy_GetJob(robus_phy)));
         // Lock the trasmission to be sure no one can send something from this node until next timeout.
         ctx.tx.lock   = true;
         ctx.tx.status = TX_DISABLE;
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * @file serial_hal
+ * @brief serial communication hardware abstraction layer
+ * @Family x86/Linux/Mac
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+#include <string.h>
+#include "serial_network_hal.h"
+#include "_serial_network.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+uint8_t stub_tx_data[STUB_TX_BUFFER_SIZE];
+uint16_t stub_tx_size = 0;
+bool stub_tx_hold      = false;
+
+/*******************************************************************************
+ * Function
+ ******************************************************************************/
+
+/******************************************************************************
+ * @brief Initialisation of the Serial communication
+ * @param None
+ * @return None
+ * ****************************************************************************/
+void SerialHAL_Init(uint8_t *rx_buffer, uint32_t buffer_size)
+{
+    stub_tx_hold = false;
+    SerialHAL_StubClearTx();
+}
+
+/******************************************************************************
+ * @brief Loop of the Serial communication
+ * @param None
+ * @return None
+ ******************************************************************************/
+void SerialHAL_Loop(void)
+{
+    // The tests write the received data using Serial_ReceptionWrite
+}
+
+/******************************************************************************
+ * @brief Keep the data to send then end the transmission
+ * @param data pointer of the data to send
+ * @param size size of the data to send
+ * @return None
+ ******************************************************************************/
+void SerialHAL_Send(uint8_t *data, uint16_t size)
+{
+    if (stub_tx_size + size <= STUB_TX_BUFFER_SIZE)
+    {
+        memcpy(&stub_tx_data[stub_tx_size], data, size);
+        stub_tx_size += size;
+    }
+    if (stub_tx_hold == false)
+    {
+        // We consider this information sent
+        Serial_TransmissionEnd();
+    }
+}
+
+/******************************************************************************
+ * @brief Get the port number of the serial communication
+ * @param None
+ * @return Port number
+ ******************************************************************************/
+uint8_t SerialHAL_GetPort(void)
+{
+    return 0;
+}
+
+/******************************************************************************
+ * @brief Forget the data sent
+ * @param None
+ * @return None
+ ******************************************************************************/
+void SerialHAL_StubClearTx(void)
+{
+    stub_tx_size = 0;
+}
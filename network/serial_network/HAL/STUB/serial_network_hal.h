@@ -0,0 +1,29 @@
+/******************************************************************************
+ * @file serial_hal
+ * @brief hardware abstraction layer of serial communication driver for luos framework
+ * @Family x86/Linux/Mac
+ * @author Luos
+ * @version 0.0.0
+ ******************************************************************************/
+
+#ifndef _SERIAL_HAL_H_
+#define _SERIAL_HAL_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define STUB_TX_BUFFER_SIZE 4096
+
+void SerialHAL_Init(uint8_t *rx_buffer, uint32_t buffer_size); // Init the serial communication
+void SerialHAL_Loop(void);                                     // Do your loop stuff if needed
+void SerialHAL_Send(uint8_t *data, uint16_t size);             // Send data trough the DMA
+uint8_t SerialHAL_GetPort(void);                               // Return the port number of the serial communication
+
+// STUB only, the data sent since the last call to SerialHAL_StubClearTx
+extern uint8_t stub_tx_data[STUB_TX_BUFFER_SIZE];
+extern uint16_t stub_tx_size;
+// STUB only, when true the transmissions only end when Serial_TransmissionEnd is called
+extern bool stub_tx_hold;
+void SerialHAL_StubClearTx(void);
+
+#endif /* _SERIAL_HAL_H_ */
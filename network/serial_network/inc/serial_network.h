@@ -16,12 +16,21 @@ extern "C"
     /*******************************************************************************
      * Definitions
      ******************************************************************************/
+    typedef struct
+    {
+        uint32_t resync_number;        // Number of times the reception lost the frame synchronisation
+        uint32_t crc_error_number;     // Number of frames dropped because of a wrong CRC
+        uint32_t timeout_number;       // Number of partial frames dropped after the reception timeout
+        uint32_t dropped_byte_number;  // Number of received bytes dropped without being interpreted
+        uint32_t alloc_failure_number; // Number of received messages dropped because of a lack of memory
+    } serial_stats_t;
 
     /*******************************************************************************
      * Function
      ******************************************************************************/
     void Serial_Init(void);
     void Serial_Loop(void);
+    const serial_stats_t *Serial_GetStatistics(void);
 
 #ifdef __cplusplus
 }
@@ -19,4 +19,30 @@
     #define SERIAL_RX_BUFFER_SIZE 512
 #endif
 
+// Maximum data size of a message on this serial link.
+// The network use the lowest value of all its nodes and phys, bigger data are fragmented.
+// Keep the complete message lower than half of the SERIAL_RX_BUFFER_SIZE.
+#ifndef SERIAL_MTU
+    #define SERIAL_MTU MAX_DATA_MSG_SIZE
+#endif
+
+// Maximum payload size in bytes of a batched frame packing multiple messages in one transfer.
+// 0 disable the batching, receivers always accept batched frames.
+// Keep it lower than half of the SERIAL_RX_BUFFER_SIZE of the receivers.
+#ifndef SERIAL_TX_BATCH_SIZE
+    #define SERIAL_TX_BATCH_SIZE 0
+#endif
+
+// 1 add a CRC-16 to each frame and drop the corrupted ones.
+// All the nodes of a serial link must share the same value.
+#ifndef SERIAL_CRC
+    #define SERIAL_CRC 0
+#endif
+
+// 1 COBS encode each frame and delimit it with a 0x00 byte allowing a fast resynchronisation after a line glitch.
+// All the nodes of a serial link must share the same value.
+#ifndef SERIAL_COBS
+    #define SERIAL_COBS 0
+#endif
+
 #endif /* _ROBUS_CONFIG_H_ */
@@ -26,6 +26,25 @@
  * | SERIAL_HEADER | size    |           data             | SERIAL_FOOTER |
  *  ----------------------------------------------------------------------
  * |     SerialHeader_t      |
+ *
+ * # Batched serial protocol:
+ *  When SERIAL_TX_BATCH_SIZE is not 0, the oldest waiting messages are packed in one frame.
+ *  Each message is preceded by its size on 2 bytes (little endian). The frame size is the sum of all the messages and sub-headers.
+ *  ---------------------------------------------------------------------------------------------------------
+ * | SERIAL_BATCH_HEADER | size    | msg size |     msg     | msg size |     msg     | ... | SERIAL_FOOTER |
+ *  ---------------------------------------------------------------------------------------------------------
+ * |     SerialHeader_t            |
+ *
+ * # Frame integrity:
+ *  When SERIAL_CRC is 1, a CRC-16 of the SerialHeader_t and the data is added before the SERIAL_FOOTER.
+ *  Frames with a wrong CRC are dropped.
+ *
+ * # COBS framing:
+ *  When SERIAL_COBS is 1, the SerialHeader_t, the data and the CRC are COBS encoded and surrounded by 0x00 delimiters instead of the SERIAL_FOOTER.
+ *  The delimiter can't appear in an encoded frame, so after a line glitch the reception restart directly on the next frame.
+ *  ----------------------------------------------
+ * | 0x00 | COBS(SerialHeader_t | data | CRC) | 0x00 |
+ *  ----------------------------------------------
  ******************************************************************************/
 
 #include "luos_phy.h"
@@ -36,14 +55,29 @@
 /*******************************************************************************
  * Definitions
  ******************************************************************************/
-#define SERIAL_HEADER 0x7E
-#define SERIAL_FOOTER 0x81
+#define SERIAL_HEADER       0x7E
+#define SERIAL_BATCH_HEADER 0x7D
+#define SERIAL_FOOTER       0x81
+#define SERIAL_DELIMITER    0x00
+
+#if (SERIAL_CRC == 1)
+    #define SERIAL_CRC_SIZE sizeof(uint16_t)
+#else
+    #define SERIAL_CRC_SIZE 0
+#endif
+
+#define SERIAL_MAX_MSG_SIZE   (sizeof(msg_t) + sizeof(time_luos_t))
+#define SERIAL_SUBHEADER_SIZE sizeof(uint16_t) // Size of a message in a batched frame
+#define SERIAL_TX_BUFFER_SIZE ((SERIAL_TX_BATCH_SIZE > SERIAL_MAX_MSG_SIZE) ? SERIAL_TX_BATCH_SIZE : SERIAL_MAX_MSG_SIZE)
+#define SERIAL_TX_FRAME_SIZE  (SERIAL_TX_BUFFER_SIZE + sizeof(SerialHeader_t) + SERIAL_CRC_SIZE + 1)
+#define SERIAL_RX_DURATION(byte_nb) ((uint64_t)(byte_nb) * 10 * 1000000000 / SERIAL_NETWORK_BAUDRATE) // nbr_byte * 10bits * (1s in ns) / baudrate
 
 // Phy callback definitions
 static void Serial_JobHandler(luos_phy_t *phy_ptr, phy_job_t *job);
 static error_return_t Serial_RunTopology(luos_phy_t *phy_ptr, uint8_t *portId);
 static void Serial_Reset(luos_phy_t *phy_ptr);
 static void Serial_Send(void);
+static void Serial_SendFrame(void);
 
 typedef struct __attribute__((__packed__))
 {
@@ -58,11 +92,17 @@ luos_phy_t *phy_serial;
 volatile bool sending        = false; // This flag is true when TX is busy
 volatile bool wait_reception = false; // This flag is true when we are waiting for a reply to a ping
 
-uint8_t TX_data[sizeof(msg_t) + sizeof(SerialHeader_t) + 1]; // This buffer is used to prepare the message to send
-uint8_t RX_data[SERIAL_RX_BUFFER_SIZE];                      // This buffer is used to store received bytes and used as ring buffer
+uint8_t TX_data[SERIAL_TX_FRAME_SIZE]; // This buffer is used to prepare the messages to send
+#if (SERIAL_COBS == 1)
+uint8_t TX_encoded[SERIAL_TX_FRAME_SIZE + SERIAL_TX_FRAME_SIZE / 254 + 2]; // This buffer is used to encode the frame to send
+#endif
+uint8_t RX_data[SERIAL_RX_BUFFER_SIZE]; // This buffer is used to store received bytes and used as ring buffer
 uint32_t rx_size         = 0;
+uint16_t tx_job_nb       = 0; // Number of jobs sent by the current transmission
 bool we_initiate_ping    = false;
 bool next_ping_is_deping = false;
+serial_stats_t serial_stats;
+
 
 /*******************************************************************************
  * Function
@@ -78,9 +118,13 @@ void Serial_Init(void)
     // Instantiate the phy struct
     phy_serial = Phy_Create(Serial_JobHandler, Serial_RunTopology, Serial_Reset);
     LUOS_ASSERT(phy_serial);
+    // Make sure we can receive 2 complete messages in our buffer
+    LUOS_ASSERT((sizeof(SerialHeader_t) + sizeof(header_t) + SERIAL_MTU + sizeof(time_luos_t) + SERIAL_CRC_SIZE + 2) <= (SERIAL_RX_BUFFER_SIZE / 2));
+    Phy_SetMtu(phy_serial, SERIAL_MTU);
 
     Serial_Reset(phy_serial);
     SerialHAL_Init(RX_data, SERIAL_RX_BUFFER_SIZE);
+    memset(&serial_stats, 0, sizeof(serial_stats_t));
 
     phy_serial->rx_timestamp   = 0;
     phy_serial->rx_buffer_base = RX_data;
@@ -98,16 +142,26 @@ void Serial_Reset(luos_phy_t *phy_ptr)
     sending             = false;
     wait_reception      = false;
     rx_size             = 0;
+    tx_job_nb           = 0;
     we_initiate_ping    = false;
     next_ping_is_deping = false;
 }
 
+/******************************************************************************
+ * @brief Get the reception statistics of the serial communication
+ * @return Pointer to the statistics
+ ******************************************************************************/
+const serial_stats_t *Serial_GetStatistics(void)
+{
+    return &serial_stats;
+}
+
 /******************************************************************************
  * @brief Function called to move the rx buffer pointer
  * @param size size to move the pointer
  * @return None
  ******************************************************************************/
-static void Serial_MoveRxPtr(uint8_t size)
+static void Serial_MoveRxPtr(uint16_t size)
 {
     // Move the rx buffer pointer
     LUOS_ASSERT(rx_size >= size);
@@ -124,108 +178,452 @@ static void Serial_MoveRxPtr(uint8_t size)
 }
 
 /******************************************************************************
- * @brief Loop of the Serial communication
- * @param None
+ * @brief Get a received byte without consuming it
+ * @param offset position of the byte from the rx buffer pointer
+ * @return The byte value
+ ******************************************************************************/
+static uint8_t Serial_GetRxByte(uint16_t offset)
+{
+    uint16_t index = (phy_serial->rx_buffer_base - RX_data) + offset;
+    if (index >= sizeof(RX_data))
+    {
+        index -= sizeof(RX_data);
+    }
+    return RX_data[index];
+}
+
+/******************************************************************************
+ * @brief Drop received bytes because they are not a part of a valid frame
+ * @param size number of bytes to drop
  * @return None
  ******************************************************************************/
-void Serial_Loop(void)
+static void Serial_DropRxBytes(uint16_t size)
 {
-    static uint32_t timeout_systick = 0;
-    SerialHAL_Loop();
+    serial_stats.dropped_byte_number += size;
+    Serial_MoveRxPtr(size);
+}
 
-    // Manage received data
+/******************************************************************************
+ * @brief Get the header of the received frame
+ * @param header where to copy the header
+ * @return None
+ ******************************************************************************/
+static void Serial_GetRxHeader(SerialHeader_t *header)
+{
+    // The header may be cut by the end of the buffer
+    for (uint16_t i = 0; i < sizeof(SerialHeader_t); i++)
+    {
+        ((uint8_t *)header)[i] = Serial_GetRxByte(i);
+    }
+}
+
+/******************************************************************************
+ * @brief Check if the header of a frame is consistent
+ * @param header header to check
+ * @return SUCCEED if the frame size is receivable
+ ******************************************************************************/
+static error_return_t Serial_CheckRxHeader(SerialHeader_t *header)
+{
+    if ((header->header != SERIAL_HEADER) && (header->header != SERIAL_BATCH_HEADER))
+    {
+        return FAILED;
+    }
+    if ((header->header == SERIAL_HEADER) && (header->size > SERIAL_MAX_MSG_SIZE))
+    {
+        return FAILED;
+    }
+    // The complete frame have to fit in our buffer
+    if (header->size + sizeof(SerialHeader_t) + SERIAL_CRC_SIZE + 1 >= sizeof(RX_data))
+    {
+        return FAILED;
+    }
+    return SUCCEED;
+}
+
+#if (SERIAL_CRC == 1)
+/******************************************************************************
+ * @brief Check the CRC of the received frame
+ * @param size size of the frame without its CRC
+ * @return SUCCEED if the CRC is correct
+ ******************************************************************************/
+static error_return_t Serial_CheckRxCRC(uint16_t size)
+{
+    uint16_t crc       = 0xFFFF;
+    uint16_t part_size = RX_data + sizeof(RX_data) - phy_serial->rx_buffer_base;
+    if (part_size >= size)
+    {
+        crc = Luos_ComputeCRC(phy_serial->rx_buffer_base, size, crc);
+    }
+    else
+    {
+        // The frame is cut by the end of the buffer
+        crc = Luos_ComputeCRC(phy_serial->rx_buffer_base, part_size, crc);
+        crc = Luos_ComputeCRC(RX_data, size - part_size, crc);
+    }
+    uint16_t received_crc = (uint16_t)Serial_GetRxByte(size) | ((uint16_t)Serial_GetRxByte(size + 1) << 8);
+    return (crc == received_crc) ? SUCCEED : FAILED;
+}
+#endif
+
+#if (SERIAL_COBS == 1)
+/******************************************************************************
+ * @brief Look for the delimiter ending the received frame
+ * @return Number of bytes before the delimiter, rx_size if there is none
+ ******************************************************************************/
+static uint16_t Serial_FindDelimiter(void)
+{
+    uint16_t part_size = RX_data + sizeof(RX_data) - phy_serial->rx_buffer_base;
+    if (part_size > rx_size)
+    {
+        part_size = rx_size;
+    }
+    uint8_t *delimiter = memchr(phy_serial->rx_buffer_base, SERIAL_DELIMITER, part_size);
+    if (delimiter != NULL)
+    {
+        return delimiter - phy_serial->rx_buffer_base;
+    }
+    // Continue at the beginning of the buffer
+    delimiter = memchr(RX_data, SERIAL_DELIMITER, rx_size - part_size);
+    if (delimiter != NULL)
+    {
+        return part_size + (delimiter - RX_data);
+    }
+    return rx_size;
+}
+
+/******************************************************************************
+ * @brief Decode in place a COBS encoded frame
+ * @param encoded_size size of the encoded frame without its delimiter
+ * @return Size of the decoded frame, 0 if the encoding is wrong
+ ******************************************************************************/
+static uint16_t Serial_CobsDecode(uint16_t encoded_size)
+{
+    uint16_t read  = 0;
+    uint16_t write = 0;
+    while (read < encoded_size)
+    {
+        uint8_t code = Serial_GetRxByte(read++);
+        if (read + code - 1 > encoded_size)
+        {
+            // This block goes after the end of the frame
+            return 0;
+        }
+        // The decoded frame is always shorter than the encoded one, so we can write it at the same place
+        for (uint8_t i = 1; i < code; i++)
+        {
+            RX_data[(phy_serial->rx_buffer_base - RX_data + write++) % sizeof(RX_data)] = Serial_GetRxByte(read++);
+        }
+        if ((code < 0xFF) && (read < encoded_size))
+        {
+            RX_data[(phy_serial->rx_buffer_base - RX_data + write++) % sizeof(RX_data)] = 0;
+        }
+    }
+    return write;
+}
+
+/******************************************************************************
+ * @brief Look for a complete and valid frame in the received data
+ * @param header where to copy the header of the frame
+ * @return Size of the frame in the buffer, 0 if there is no complete frame yet
+ ******************************************************************************/
+static uint16_t Serial_FindFrame(SerialHeader_t *header)
+{
     while (rx_size > 0)
     {
-        if (*phy_serial->rx_buffer_base != SERIAL_HEADER)
+        // The delimiter end the frame
+        uint16_t encoded_size = Serial_FindDelimiter();
+        if (encoded_size == rx_size)
         {
+            if (rx_size >= sizeof(RX_data) * 3 / 4)
+            {
+                // We receive more data than the biggest frame without any delimiter, this is garbage
+                serial_stats.resync_number++;
+                Serial_DropRxBytes(rx_size);
+            }
+            // We don't receive the complete frame yet.
+            return 0;
+        }
+        if (encoded_size == 0)
+        {
+            // Nothing before this delimiter, just remove it
             Serial_MoveRxPtr(1);
             continue;
         }
-        /***********************************************
-         * 1 - Receive the header and check if the message is complete
-         *********************************************/
-        if (rx_size < sizeof(SerialHeader_t))
+        // Decode the frame at the same place
+        uint16_t size = Serial_CobsDecode(encoded_size);
+        if (size >= sizeof(SerialHeader_t) + SERIAL_CRC_SIZE)
         {
-            // We don't receive the complete header yet.
-            return;
+            Serial_GetRxHeader(header);
+            if ((Serial_CheckRxHeader(header) == SUCCEED) && (header->size == size - sizeof(SerialHeader_t) - SERIAL_CRC_SIZE))
+            {
+    #if (SERIAL_CRC == 1)
+                if (Serial_CheckRxCRC(size - SERIAL_CRC_SIZE) == SUCCEED)
+                {
+                    return encoded_size + 1;
+                }
+                serial_stats.crc_error_number++;
+    #else
+                return encoded_size + 1;
+    #endif
+            }
         }
-        SerialHeader_t header;
-        // Check if the header address is after the end of the buffer
-        if (((uintptr_t)RX_data + sizeof(RX_data)) - ((uintptr_t)(phy_serial->rx_buffer_base)) < sizeof(SerialHeader_t))
+        // This frame is corrupted, the next one begins right after the delimiter
+        serial_stats.resync_number++;
+        Serial_DropRxBytes(encoded_size + 1);
+    }
+    return 0;
+}
+#else
+/******************************************************************************
+ * @brief Look for the next byte able to begin a frame
+ * @return Number of bytes before this byte, rx_size if there is none
+ ******************************************************************************/
+static uint16_t Serial_FindHeader(void)
+{
+    uint16_t offset = 0;
+    while (offset < rx_size)
+    {
+        // Look in the contiguous part of the buffer
+        uint16_t index     = (phy_serial->rx_buffer_base - RX_data + offset) % sizeof(RX_data);
+        uint16_t part_size = sizeof(RX_data) - index;
+        if (part_size > rx_size - offset)
         {
-            // Header is cut by the end of the buffer
-            // We need to go back to the beginning of the buffer
-            uint8_t buffer_end_size = ((uintptr_t)RX_data + sizeof(RX_data)) - (uintptr_t)(phy_serial->rx_buffer_base);
-            memcpy(&header, phy_serial->rx_buffer_base, buffer_end_size);
-            memcpy((void *)((uintptr_t)&header + buffer_end_size), RX_data, sizeof(SerialHeader_t) - buffer_end_size);
+            part_size = rx_size - offset;
         }
-        else
+        uint8_t *header = memchr(&RX_data[index], SERIAL_HEADER, part_size);
+        // A batch header is only interesting before the first single message header
+        uint16_t batch_size = (header != NULL) ? header - &RX_data[index] : part_size;
+        uint8_t *batch      = memchr(&RX_data[index], SERIAL_BATCH_HEADER, batch_size);
+        if (batch != NULL)
         {
-            // Header is continuous
-            memcpy(&header, phy_serial->rx_buffer_base, sizeof(SerialHeader_t));
+            return offset + (batch - &RX_data[index]);
         }
-        if (header.size > sizeof(msg_t))
+        if (header != NULL)
+        {
+            return offset + batch_size;
+        }
+        // Continue at the beginning of the buffer
+        offset += part_size;
+    }
+    return rx_size;
+}
+
+/******************************************************************************
+ * @brief Look for a complete and valid frame in the received data
+ * @param header where to copy the header of the frame
+ * @return Size of the frame in the buffer, 0 if there is no complete frame yet
+ ******************************************************************************/
+static uint16_t Serial_FindFrame(SerialHeader_t *header)
+{
+    static uint32_t timeout_systick = 0;
+    while (rx_size > 0)
+    {
+        uint16_t garbage_size = Serial_FindHeader();
+        if (garbage_size > 0)
+        {
+            // Drop everything before the next possible beginning of a frame at once
+            Serial_DropRxBytes(garbage_size);
+            continue;
+        }
+        /***********************************************
+         * 1 - Receive the header and check if the frame is complete
+         *********************************************/
+        if (rx_size < sizeof(SerialHeader_t))
+        {
+            // We don't receive the complete header yet.
+            return 0;
+        }
+        Serial_GetRxHeader(header);
+        if (Serial_CheckRxHeader(header) == FAILED)
         {
             // This data seems to be corrupted or at least we can't receive it with our buffer size, drop it.
-            Serial_MoveRxPtr(1);
+            serial_stats.resync_number++;
+            Serial_DropRxBytes(1);
+            continue;
         }
-        // Now we have the complete header, check if we receive the complete message
-        if (rx_size < header.size + sizeof(SerialHeader_t) + 1)
+        uint16_t frame_size = header->size + sizeof(SerialHeader_t) + SERIAL_CRC_SIZE + 1;
+        if (rx_size < frame_size)
         {
-            // We don't receive the complete message yet.
-            // Manage a timeout to be sure we are not looking for a wrong message
+            // We don't receive the complete frame yet.
+            // Manage a timeout to be sure we are not looking for a wrong frame
             if (timeout_systick == 0)
             {
                 // Start the timeout counter
                 timeout_systick = LuosHAL_GetSystick();
             }
-            else
+            else if ((LuosHAL_GetSystick() - timeout_systick) > 200)
             {
-                // We already start the timeout
-                if ((LuosHAL_GetSystick() - timeout_systick) > 200)
-                {
-                    // We spend the 100ms timeout, remove the byte
-                    Serial_MoveRxPtr(1);
-                    timeout_systick = 0;
-                }
+                // We spend the 200ms timeout, remove the byte and look for the next frame
+                timeout_systick = 0;
+                serial_stats.timeout_number++;
+                serial_stats.resync_number++;
+                Serial_DropRxBytes(1);
+                continue;
             }
-            return;
+            return 0;
         }
+        timeout_systick = 0;
         /***********************************************
-         * 2 - Receive the message
+         * 2 - Check the frame
          *********************************************/
-        timeout_systick          = 0;
-        uint8_t *footer_position = &phy_serial->rx_buffer_base[header.size + sizeof(SerialHeader_t)];
-        // Check if the footer address is after the end of the buffer
-        if ((uintptr_t)footer_position >= (uintptr_t)RX_data + sizeof(RX_data))
+        if (Serial_GetRxByte(frame_size - 1) != SERIAL_FOOTER)
         {
-            // We need to go back to the beginning of the buffer
-            footer_position = (uint8_t *)((uintptr_t)RX_data + ((uintptr_t)footer_position - ((uintptr_t)RX_data + sizeof(RX_data))));
+            // This is not a correct frame, look for the next one
+            serial_stats.resync_number++;
+            Serial_DropRxBytes(1);
+            continue;
         }
-        while ((header.header != SERIAL_HEADER) || (*footer_position != SERIAL_FOOTER))
+    #if (SERIAL_CRC == 1)
+        if (Serial_CheckRxCRC(frame_size - SERIAL_CRC_SIZE - 1) == FAILED)
         {
-            // This is not a correct message, we need to go to the next byte
-            Serial_MoveRxPtr(1);
-            if (rx_size == 0)
+            // This frame is corrupted, look for the next one
+            serial_stats.crc_error_number++;
+            serial_stats.resync_number++;
+            Serial_DropRxBytes(1);
+            continue;
+        }
+    #endif
+        return frame_size;
+    }
+    return 0;
+}
+#endif
+
+/******************************************************************************
+ * @brief Give a complete message to the phy manager then consume it
+ * @param size size of the message
+ * @return None
+ ******************************************************************************/
+static void Serial_ReceiveMsg(uint16_t size)
+{
+    header_t header;
+    uint8_t *rx_buffer_base_bkp = phy_serial->rx_buffer_base;
+    uint16_t part_size          = RX_data + sizeof(RX_data) - phy_serial->rx_buffer_base;
+    // The phy manager need a continuous header to compute it
+    if (part_size < sizeof(header_t))
+    {
+        // The header is cut by the end of the buffer, we need to move it
+        memcpy(&header, phy_serial->rx_buffer_base, part_size);
+        memcpy((uint8_t *)&header + part_size, RX_data, sizeof(header_t) - part_size);
+        phy_serial->rx_buffer_base = (uint8_t *)&header;
+        phy_serial->rx_data        = (uint8_t *)&header;
+    }
+
+    // Give only the header to begin
+    phy_serial->received_data = sizeof(header_t);
+    Phy_ComputeHeader(phy_serial);
+    if (phy_serial->rx_keep == true)
+    {
+        // Header compute ask us to keep this message, to give it to an other phy.
+        // Allocate it now, the phy manager copy the header in the allocated space.
+        Phy_alloc(phy_serial);
+        if ((phy_serial->rx_keep == true) && (phy_serial->rx_data != NULL) && (phy_serial->rx_data != phy_serial->rx_buffer_base))
+        {
+            // Copy the rest of the message directly from the ring buffer to its allocated space
+            uint16_t msg_size = (size < phy_serial->rx_size) ? size : phy_serial->rx_size;
+            for (uint16_t offset = sizeof(header_t); offset < msg_size; offset += part_size)
             {
-                // We don't have data to parse anymore
-                return;
+                uint16_t index = (rx_buffer_base_bkp - RX_data) + offset;
+                if (index >= sizeof(RX_data))
+                {
+                    index -= sizeof(RX_data);
+                }
+                part_size = sizeof(RX_data) - index;
+                if (part_size > msg_size - offset)
+                {
+                    part_size = msg_size - offset;
+                }
+                memcpy((uint8_t *)&phy_serial->rx_data[offset], &RX_data[index], part_size);
             }
+            phy_serial->received_data = msg_size;
+            // We have the complete message, we can validate it
+            Phy_ValidMsg(phy_serial);
         }
-        if (rx_size < sizeof(SerialHeader_t))
+        else if (phy_serial->rx_keep == true)
+        {
+            // The message wasn't kept, there is no more space on the buffer.
+            // Drop it and continue with the next ones.
+            serial_stats.alloc_failure_number++;
+        }
+    }
+    phy_serial->rx_buffer_base = rx_buffer_base_bkp;
+    // The message have been consumed, we can move the rx buffer pointer
+    Serial_MoveRxPtr(size);
+}
+
+/******************************************************************************
+ * @brief Give all the messages of a batched frame to the phy manager then consume the frame
+ * @param size size of the frame payload
+ * @return None
+ ******************************************************************************/
+static void Serial_ReceiveBatch(uint16_t size)
+{
+    // Check all the sub-headers before giving anything to the phy manager
+    uint16_t offset = 0;
+    while (offset + SERIAL_SUBHEADER_SIZE <= size)
+    {
+        uint16_t msg_size = (uint16_t)Serial_GetRxByte(sizeof(SerialHeader_t) + offset) | ((uint16_t)Serial_GetRxByte(sizeof(SerialHeader_t) + offset + 1) << 8);
+        if ((msg_size > SERIAL_MAX_MSG_SIZE) || (msg_size < sizeof(header_t)))
+        {
+            break;
+        }
+        offset += msg_size + SERIAL_SUBHEADER_SIZE;
+    }
+    if (offset != size)
+    {
+        // This frame is corrupted, we need to trash it
+        serial_stats.resync_number++;
+        Serial_DropRxBytes(size + sizeof(SerialHeader_t));
+        return;
+    }
+    // Remove the header encapsulation
+    Serial_MoveRxPtr(sizeof(SerialHeader_t));
+    while (offset > 0)
+    {
+        uint16_t msg_size = (uint16_t)Serial_GetRxByte(0) | ((uint16_t)Serial_GetRxByte(1) << 8);
+        Serial_MoveRxPtr(SERIAL_SUBHEADER_SIZE);
+        Serial_ReceiveMsg(msg_size);
+        offset -= msg_size + SERIAL_SUBHEADER_SIZE;
+        // The next message have been received after this one
+        phy_serial->rx_timestamp += SERIAL_RX_DURATION(msg_size + SERIAL_SUBHEADER_SIZE);
+    }
+}
+
+/******************************************************************************
+ * @brief Loop of the Serial communication
+ * @param None
+ * @return None
+ ******************************************************************************/
+void Serial_Loop(void)
+{
+    SerialHAL_Loop();
+
+    // Manage received data
+    while (rx_size > 0)
+    {
+        SerialHeader_t header;
+        uint16_t frame_size = Serial_FindFrame(&header);
+        if (frame_size == 0)
         {
-            // We don't receive the complete message yet.
+            // We don't have any complete frame yet.
             return;
         }
+        uint64_t frame_timestamp = phy_serial->rx_timestamp;
         /***********************************************
-         * 3 - Process the message
+         * Process the frame
          *********************************************/
-        if ((header.size > sizeof(msg_t)) || (header.size < sizeof(header_t)))
+        if (header.header == SERIAL_BATCH_HEADER)
+        {
+            // This frame contains multiple messages
+            Serial_ReceiveBatch(header.size);
+        }
+        else if ((header.size > SERIAL_MAX_MSG_SIZE) || (header.size < sizeof(header_t)))
         {
             // This is not a standars message.
-            if (header.size == 0)
+            if ((header.size == 0) && ((we_initiate_ping == true) || (Phy_GetNodeId() == 0)))
             {
                 // This is a ping or a de-ping message
+                // A node having an id is already detected, it ignores the pings of a branch detection
                 // - The ping message indicate that a master node is looking for this one
                 // - The de-ping message indicate that we are the master node. We already ping this node by calling Serial_RunTopology and we need to consider this branch as done
 
@@ -239,11 +637,10 @@ void Serial_Loop(void)
                 // By adding 1 data, this message will be received but not interpreted
                 header_rply.size = 1;
                 memcpy(TX_data, &header_rply, sizeof(SerialHeader_t));
-                TX_data[sizeof(SerialHeader_t)]     = 0;
-                TX_data[sizeof(SerialHeader_t) + 1] = SERIAL_FOOTER;
+                TX_data[sizeof(SerialHeader_t)] = 0;
 
                 // Send the message
-                SerialHAL_Send(TX_data, sizeof(SerialHeader_t) + 2);
+                Serial_SendFrame();
 
                 // Did we receive this ping from a master node or are we the node that initiate the ping?
                 if (we_initiate_ping == false)
@@ -263,53 +660,22 @@ void Serial_Loop(void)
                 }
             }
             // This is not a correct message, we need to trash it
-            Serial_MoveRxPtr(header.size + sizeof(SerialHeader_t) + 1);
+            Serial_MoveRxPtr(header.size + sizeof(SerialHeader_t));
         }
         else
         {
             // This message is correct and have actual data to parse, we can process it
             // First, we need to remove the header encapsulation
             Serial_MoveRxPtr(sizeof(SerialHeader_t));
-
-            uint8_t continuous_data[header.size];
-            uint8_t *rx_buffer_base_bkp = phy_serial->rx_buffer_base;
-            // Check if the message is continuous in the buffer
-            if (phy_serial->rx_buffer_base + header.size > RX_data + sizeof(RX_data))
-            {
-                // The message is not continuous in the buffer, we need to move it
-                uint8_t size = RX_data + sizeof(RX_data) - phy_serial->rx_buffer_base;
-                memcpy(continuous_data, phy_serial->rx_buffer_base, size);
-                memcpy(continuous_data + size, RX_data, header.size - size);
-                phy_serial->rx_buffer_base = continuous_data;
-                phy_serial->rx_data        = continuous_data;
-            }
-            // The phy manager will need the data to be continuous in memory, so we need to move it
-
-            // Give only the header to begin
-            phy_serial->received_data = sizeof(header_t);
-            Phy_ComputeHeader(phy_serial);
-            if (phy_serial->rx_keep == true)
-            {
-                // Header compute ask us to keep this message, to give it to an other phy. We already have the complete message, we can give it
-                phy_serial->received_data = header.size;
-                // We want to keep this message, we can validate it
-                Phy_ValidMsg(phy_serial);
-                if (phy_serial->rx_data == NULL)
-                {
-                    // The message wasn't kept, there is no more space on the buffer, or the message is corrupted.
-                    // This is a critical failure
-                    LUOS_ASSERT(0);
-                }
-            }
-            phy_serial->rx_buffer_base = rx_buffer_base_bkp;
-            // The message have been consumed, we can move the rx buffer pointer
-            Serial_MoveRxPtr(header.size + 1);
-            // If we still have data in the buffer after this message we need to move the phy_serial->rx_timestamp accordingly allowing the next message to be correctly timed.
-            if (rx_size > 0)
-            {
-                // Add to the original timestamp value the time needed to receive all the bytes of the current message.
-                phy_serial->rx_timestamp += (header.size + sizeof(SerialHeader_t) + 1) * (uint32_t)10 * (uint32_t)1000000000 / (uint32_t)SERIAL_NETWORK_BAUDRATE;
-            }
+            Serial_ReceiveMsg(header.size);
+        }
+        // Remove the end of the frame
+        Serial_MoveRxPtr(frame_size - header.size - sizeof(SerialHeader_t));
+        // If we still have data in the buffer after this frame we need to move the phy_serial->rx_timestamp accordingly allowing the next message to be correctly timed.
+        if (rx_size > 0)
+        {
+            // Add to the original timestamp value the time needed to receive all the bytes of the current frame.
+            phy_serial->rx_timestamp = frame_timestamp + SERIAL_RX_DURATION(frame_size);
         }
     }
 }
@@ -327,24 +693,129 @@ void Serial_JobHandler(luos_phy_t *phy_ptr, phy_job_t *job)
 }
 
 /******************************************************************************
- * @brief We finished to send the message, try to send another one
+ * @brief We finished to send the messages, try to send others
  * @param None
  * @return None
  ******************************************************************************/
 _CRITICAL void Serial_TransmissionEnd(void)
 {
     sending = false;
-    // We transmitted this message, we can remove it then send another one
+    // We transmitted these messages, we can remove them then send others
     // We may had a reset during this transmission, so we need to check if we still have something to transmit
-    if (Phy_GetJobNumber(phy_serial) > 0)
+    while ((tx_job_nb > 0) && (Phy_GetJobNumber(phy_serial) > 0))
     {
         phy_job_t *job = Phy_GetJob(phy_serial);
         job->phy_data  = 0;
         Phy_RmJob(phy_serial, job);
-        Serial_Send();
+        tx_job_nb--;
     }
+    tx_job_nb = 0;
+    Serial_Send();
 }
 
+/******************************************************************************
+ * @brief Finalize the frame prepared in TX_data then send it
+ * @param None
+ * @return None
+ ******************************************************************************/
+_CRITICAL static void Serial_SendFrame(void)
+{
+    uint16_t size = ((SerialHeader_t *)TX_data)->size + sizeof(SerialHeader_t);
+#if (SERIAL_CRC == 1)
+    uint16_t crc       = Luos_ComputeCRC(TX_data, size, 0xFFFF);
+    TX_data[size++]    = (uint8_t)crc;
+    TX_data[size++]    = (uint8_t)(crc >> 8);
+#endif
+#if (SERIAL_COBS == 1)
+    // Encode the frame to remove all the delimiters from it
+    // The first delimiter end any garbage received before this frame
+    TX_encoded[0]       = SERIAL_DELIMITER;
+    uint16_t code_index = 1;
+    uint16_t encoded    = 2;
+    uint8_t code        = 1;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        if (TX_data[i] != SERIAL_DELIMITER)
+        {
+            TX_encoded[encoded++] = TX_data[i];
+            code++;
+        }
+        if ((TX_data[i] == SERIAL_DELIMITER) || (code == 0xFF))
+        {
+            // End of a block
+            TX_encoded[code_index] = code;
+            code_index             = encoded++;
+            code                   = 1;
+        }
+    }
+    TX_encoded[code_index] = code;
+    TX_encoded[encoded++]  = SERIAL_DELIMITER;
+    SerialHAL_Send(TX_encoded, encoded);
+#else
+    TX_data[size++] = SERIAL_FOOTER;
+    SerialHAL_Send(TX_data, size);
+#endif
+}
+
+/******************************************************************************
+ * @brief Copy the message of a job in the TX buffer
+ * @param tx_pt where to copy the message
+ * @param job job to copy
+ * @return Size of the copied message
+ ******************************************************************************/
+_CRITICAL static uint16_t Serial_PrepareMsg(uint8_t *tx_pt, phy_job_t *job)
+{
+    memcpy(tx_pt, job->data_pt, job->size);
+    if (job->timestamp)
+    {
+        // Convert date to a sendable timestamp and put it in the end of the message
+        time_luos_wire_t timestamp = Phy_ComputeMsgTimestamp(phy_serial, job);
+        memcpy(&tx_pt[job->size - sizeof(time_luos_t)], &timestamp, sizeof(time_luos_t));
+    }
+    return job->size;
+}
+
+/******************************************************************************
+ * @brief Prepare a frame containing the message of a job
+ * @param job job to send
+ * @return None
+ ******************************************************************************/
+_CRITICAL static void Serial_PrepareFrame(phy_job_t *job)
+{
+    // Add the encapsulation to the message
+    SerialHeader_t header;
+    header.header = SERIAL_HEADER;
+    header.size   = Serial_PrepareMsg(&TX_data[sizeof(SerialHeader_t)], job);
+    memcpy(TX_data, &header, sizeof(SerialHeader_t));
+    tx_job_nb = 1;
+}
+
+#if (SERIAL_TX_BATCH_SIZE > 0)
+/******************************************************************************
+ * @brief Prepare a frame packing the messages of the oldest jobs
+ * @param job oldest job to send
+ * @return None
+ ******************************************************************************/
+_CRITICAL static void Serial_PrepareBatch(phy_job_t *job)
+{
+    uint8_t *payload = &TX_data[sizeof(SerialHeader_t)];
+    SerialHeader_t header;
+    header.header = SERIAL_BATCH_HEADER;
+    header.size   = 0;
+    tx_job_nb     = 0;
+    // Pack the jobs in order as long as they fit in the frame
+    while ((job != NULL) && (header.size + job->size + SERIAL_SUBHEADER_SIZE <= SERIAL_TX_BATCH_SIZE))
+    {
+        payload[header.size]     = (uint8_t)job->size;
+        payload[header.size + 1] = (uint8_t)(job->size >> 8);
+        header.size += Serial_PrepareMsg(&payload[header.size + SERIAL_SUBHEADER_SIZE], job) + SERIAL_SUBHEADER_SIZE;
+        tx_job_nb++;
+        job = Phy_GetNextJob(phy_serial, job);
+    }
+    memcpy(TX_data, &header, sizeof(SerialHeader_t));
+}
+#endif
+
 /******************************************************************************
  * @brief Try to send a message
  * @param None
@@ -363,25 +834,19 @@ _CRITICAL void Serial_Send(void)
         sending = true;
         Phy_SetIrqState(true);
         // We can send the message
-        // Add the encapsulation to the message
-        SerialHeader_t header;
-        header.header = SERIAL_HEADER;
-        header.size   = job->size;
-        memcpy(TX_data, &header, sizeof(SerialHeader_t));
-        memcpy(TX_data + sizeof(SerialHeader_t), job->msg_pt, sizeof(msg_t));
-        if (job->timestamp)
+#if (SERIAL_TX_BATCH_SIZE > 0)
+        phy_job_t *next_job = Phy_GetNextJob(phy_serial, job);
+        if ((next_job != NULL) && (job->size + next_job->size + 2 * SERIAL_SUBHEADER_SIZE <= SERIAL_TX_BATCH_SIZE))
         {
-            // Convert date to a sendable timestamp and put it in the end of the message
-            time_luos_t timestamp = Phy_ComputeMsgTimestamp(phy_serial, job);
-            memcpy(&TX_data[sizeof(SerialHeader_t) + job->size - +sizeof(timestamp)], &timestamp, sizeof(time_luos_t));
-            TX_data[sizeof(SerialHeader_t) + job->size] = SERIAL_FOOTER;
+            // Multiple messages are waiting, send them in a single frame
+            Serial_PrepareBatch(job);
         }
         else
+#endif
         {
-            TX_data[sizeof(SerialHeader_t) + job->size] = SERIAL_FOOTER;
-            // Send the message
+            Serial_PrepareFrame(job);
         }
-        SerialHAL_Send(TX_data, job->size + sizeof(SerialHeader_t) + 1);
+        Serial_SendFrame();
     }
     Phy_SetIrqState(true);
 }
@@ -399,14 +864,16 @@ _CRITICAL void Serial_ReceptionWrite(uint8_t *data, uint32_t size)
     {
         // This is probably the first data we received for this message, we need to timestamp the reception date.
         // Watch out, if the loop is executed very slowly we may receive multiple messages in the same loop. This could result in a wrong timestamp for the second message. Their is no way to avoid this problem, so we need to accept it. Anyway we even didn't have any way to store multiple timestamp...
-        phy_serial->rx_timestamp = Phy_GetTimestamp() - (size * (uint32_t)10 * (uint32_t)1000000000 / (uint32_t)SERIAL_NETWORK_BAUDRATE); // now - (nbr_byte * 10bits * (1s in ns) / baudrate)
+        phy_serial->rx_timestamp = Phy_GetTimestamp() - SERIAL_RX_DURATION(size);
     }
-    uint32_t copy_size = (uintptr_t)&RX_data + sizeof(RX_data) - (uintptr_t)phy_serial->rx_buffer_base + rx_size;
+    // Write after the bytes already received, looping in the ring buffer
+    uint32_t write_index = ((uintptr_t)phy_serial->rx_buffer_base - (uintptr_t)RX_data + rx_size) % sizeof(RX_data);
+    uint32_t copy_size   = sizeof(RX_data) - write_index;
     if (copy_size > size)
     {
         copy_size = size;
     }
-    memcpy(phy_serial->rx_buffer_base + rx_size, data, copy_size);
+    memcpy(&RX_data[write_index], data, copy_size);
     if (copy_size < size)
     {
         memcpy(RX_data, data + copy_size, size - copy_size);
@@ -432,7 +899,7 @@ _CRITICAL void Serial_ReceptionIncrease(uint32_t size)
     {
         // We consider this as the end of a complete message
         // If we received multiple messages in this call, this could result in a wrong timestamp for the second message. Their is no way to avoid this problem, so we need to accept it.
-        phy_serial->rx_timestamp = Phy_GetTimestamp() - (size * (uint32_t)10 * (uint32_t)1000000000 / (uint32_t)SERIAL_NETWORK_BAUDRATE); // now - (nbr_byte * 10bits * (1s in ns) / baudrate)
+        phy_serial->rx_timestamp = Phy_GetTimestamp() - SERIAL_RX_DURATION(size);
     }
     rx_size += size;
     LUOS_ASSERT(rx_size < sizeof(RX_data));
@@ -466,10 +933,9 @@ error_return_t Serial_RunTopology(luos_phy_t *phy_ptr, uint8_t *portId)
         header.header = SERIAL_HEADER;
         header.size   = 0;
         memcpy(TX_data, &header, sizeof(SerialHeader_t));
-        TX_data[sizeof(SerialHeader_t)] = SERIAL_FOOTER;
 
         // Send the message
-        SerialHAL_Send(TX_data, sizeof(SerialHeader_t) + 1);
+        Serial_SendFrame();
     }
     else
     {
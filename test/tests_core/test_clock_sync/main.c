@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include "default_scenario.h"
+#include "_clock_sync.h"
+#include "node.h"
+#include "robus_hal.h"
+
+extern default_scenario_t default_sc;
+
+static void clock_sync_msg(msg_t *msg, int64_t local_date, int64_t master_date)
+{
+    msg->header.config      = TIMESTAMP_PROTOCOL;
+    msg->header.target_mode = BROADCAST;
+    msg->header.target      = BROADCAST_VAL;
+    msg->header.cmd         = CLOCK_SYNC;
+    msg->header.size        = sizeof(int64_t);
+    memcpy(msg->data, &master_date, sizeof(int64_t));
+    // The timestamp is the local date of the master sampling, as computed by the reception phy.
+    time_luos_t date = TimeOD_TimeFrom_ns((double)local_date);
+    memcpy(&msg->data[msg->header.size], &date, sizeof(time_luos_t));
+}
+
+static double network_offset(int64_t local_date)
+{
+    time_luos_t date = TimeOD_TimeFrom_ns((double)local_date);
+    return TimeOD_TimeTo_ns(Luos_ConvertToNetworkTime(date)) - TimeOD_TimeTo_ns(date);
+}
+
+// Check if the master sends a CLOCK_SYNC message during two periods
+static bool clock_sync_sent(void)
+{
+    uint32_t started_time = Luos_GetSystick();
+    RobusHAL_StubClearTx();
+    while (Luos_GetSystick() - started_time < 2 * CLOCK_SYNC_PERIOD_MS)
+    {
+        Luos_Loop();
+        if ((stub_robus_tx_size >= sizeof(header_t)) && (((header_t *)stub_robus_tx_data)->cmd == CLOCK_SYNC))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void unittest_ClockSync_Update(void)
+{
+    NEW_TEST_CASE("Test ClockSync_Update assert conditions");
+    {
+        TRY
+        {
+            ClockSync_Update(NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Offset and drift estimation");
+    {
+        TRY
+        {
+            msg_t msg;
+            Init_Context();
+            // This node is not the master anymore
+            Node_Get()->node_id = 2;
+            ClockSync_Reset();
+
+            NEW_STEP("Without sample the network time is the local one");
+            TEST_ASSERT_FALSE(Luos_IsNetworkTimeSynced());
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, network_offset(1000000000));
+
+            NEW_STEP("The first sample gives the offset");
+            // Master clock is 5us ahead and 100ppb faster
+            clock_sync_msg(&msg, 1000000000, 1000000000 + 5000);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FALSE(Luos_IsNetworkTimeSynced());
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5000.0, network_offset(1000000000));
+
+            NEW_STEP("The second sample gives the drift");
+            clock_sync_msg(&msg, 2000000000, 2000000000 + 5100);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_TRUE(Luos_IsNetworkTimeSynced());
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5100.0, network_offset(2000000000));
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5400.0, network_offset(5000000000));
+
+            NEW_STEP("Filter the reception jitter");
+            clock_sync_msg(&msg, 3000000000, 3000000000 + 5200 + 400);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_TRUE(Luos_IsNetworkTimeSynced());
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5300.0, network_offset(3000000000));
+
+            NEW_STEP("Ignore messages without timestamp");
+            clock_sync_msg(&msg, 4000000000, 4000000000 + 100000);
+            msg.header.config = BASE_PROTOCOL;
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5300.0, network_offset(3000000000));
+
+            NEW_STEP("Restart the estimation on clock jump");
+            clock_sync_msg(&msg, 4000000000, 4000000000 + 2000000);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FALSE(Luos_IsNetworkTimeSynced());
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 2000000.0, network_offset(5000000000));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_ClockSync_LongDuration(void)
+{
+    NEW_TEST_CASE("The drift is applied after days without sample");
+    {
+        TRY
+        {
+            msg_t msg;
+            Init_Context();
+            Node_Get()->node_id = 2;
+            ClockSync_Reset();
+            // Master clock is 100ppm faster
+            clock_sync_msg(&msg, 1000000000, 1000000000 + 5000);
+            ClockSync_Update(&msg);
+            clock_sync_msg(&msg, 2000000000, 2000000000 + 105000);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 105000.0, network_offset(2000000000));
+            // 100 hours later the master is 36s ahead
+            TEST_ASSERT_FLOAT_WITHIN(1000.0, 105000.0 + 36000000000.0, network_offset(2000000000 + 360000000000000));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_ClockSync_Master(void)
+{
+    NEW_TEST_CASE("The detection master is the reference clock");
+    {
+        TRY
+        {
+            msg_t msg;
+            Init_Context();
+            ClockSync_Reset();
+            TEST_ASSERT_EQUAL(1, Node_Get()->node_id);
+            TEST_ASSERT_TRUE(Luos_IsNetworkTimeSynced());
+            // The master ignore the sync messages
+            clock_sync_msg(&msg, 1000000000, 1000000000 + 5000);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, network_offset(1000000000));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("The master only send its date to the nodes knowing it");
+    {
+        TRY
+        {
+            Init_Context();
+            TEST_ASSERT_EQUAL(1, Node_Get()->node_id);
+            Node_SetProtocolRevision(6);
+            TEST_ASSERT_FALSE(clock_sync_sent());
+            Node_SetProtocolRevision(PROTOCOL_REVISION);
+            TEST_ASSERT_TRUE(clock_sync_sent());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("Detection reset the estimation");
+    {
+        TRY
+        {
+            msg_t msg;
+            Init_Context();
+            Node_Get()->node_id = 2;
+            clock_sync_msg(&msg, 1000000000, 1000000000 + 5000);
+            ClockSync_Update(&msg);
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 5000.0, network_offset(1000000000));
+            // A new detection start
+            Init_Context();
+            Node_Get()->node_id = 2;
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, network_offset(1000000000));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Clock synchronization function
+    UNIT_TEST_RUN(unittest_ClockSync_Update);
+    UNIT_TEST_RUN(unittest_ClockSync_LongDuration);
+    UNIT_TEST_RUN(unittest_ClockSync_Master);
+
+    UNITY_END();
+}
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <default_scenario.h>
 #include "luos_engine.c"
+#include "_routing_table.h"
 
 extern default_scenario_t default_sc;
+extern volatile uint8_t msg_buffer[MSG_BUFFER_SIZE];
 
 // Init and Loop are used and tested in the default scenario
 
@@ -117,6 +119,69 @@ void unittest_Luos_SendMsg(void)
     }
 }
 
+void unittest_Luos_SendMsgSegments(void)
+{
+    NEW_TEST_CASE("Test Luos_SendMsgSegments assert conditions");
+    {
+        TRY
+        {
+            NEW_STEP("Try to send a void message argument");
+            msg_segment_t segment = {.data = NULL, .size = 0};
+            Luos_SendMsgSegments(NULL, 0, &segment, 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            NEW_STEP("Try to send segments not matching the message size");
+            //  Init default scenario context
+            Init_Context();
+            uint8_t data[4]       = {1, 2, 3, 4};
+            msg_segment_t segment = {.data = data, .size = sizeof(data)};
+            msg_t msg;
+            msg.header.target      = default_sc.App_2.app->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            msg.header.size        = 2;
+            Luos_SendMsgSegments(default_sc.App_3.app, &msg, &segment, 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Test Luos_SendMsgSegments normal conditions");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            uint8_t first[3]          = {1, 2, 3};
+            uint8_t second[2]         = {4, 5};
+            msg_segment_t segments[2] = {{.data = first, .size = sizeof(first)}, {.data = second, .size = sizeof(second)}};
+            msg_t msg;
+            msg.header.target      = default_sc.App_2.app->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            msg.header.size        = sizeof(first) + sizeof(second);
+            memset(msg.data, 0, sizeof(msg.data));
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendMsgSegments(default_sc.App_3.app, &msg, segments, 2));
+            TEST_ASSERT_EQUAL(default_sc.App_3.app->id, msg.header.source);
+            TEST_ASSERT_EQUAL(BASE_PROTOCOL, msg.header.config);
+            // The message data field is not used
+            TEST_ASSERT_EQUAL(0, msg.data[0]);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(default_sc.App_3.app->id, default_sc.App_2.last_rx_msg.header.source);
+            TEST_ASSERT_EQUAL(sizeof(first) + sizeof(second), default_sc.App_2.last_rx_msg.header.size);
+            uint8_t expected[5] = {1, 2, 3, 4, 5};
+            TEST_ASSERT_EQUAL_MEMORY(expected, default_sc.App_2.last_rx_msg.data, sizeof(expected));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_Luos_SendTimestampMsg(void)
 {
     NEW_TEST_CASE("Test Luos_SendTimestampMsg assert conditions");
@@ -308,6 +373,131 @@ void unittest_Luos_ReadFromService(void)
     }
 }
 
+void unittest_Luos_BorrowMsg(void)
+{
+    NEW_TEST_CASE("Test Luos_BorrowMsg assert conditions");
+    {
+        TRY
+        {
+            NEW_STEP("Try to missspecify the service pointer");
+            const msg_t *msg;
+            Luos_BorrowMsg(NULL, &msg);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            NEW_STEP("Try to miss-specify the message pointer");
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            Luos_BorrowMsg(service, NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            NEW_STEP("Try to miss-specify the targeted service id");
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            const msg_t *msg;
+            Luos_BorrowFromService(service, 0, &msg);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Test Luos_BorrowMsg normal conditions");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+
+            NEW_STEP("Check end detection reception");
+            const msg_t *rx_msg;
+            TEST_ASSERT_EQUAL(FAILED, Luos_BorrowFromService(service, 2, &rx_msg));
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_BorrowFromService(service, 1, &rx_msg));
+            TEST_ASSERT_EQUAL(END_DETECTION, rx_msg->header.cmd);
+            Luos_ReleaseMsg(service, rx_msg);
+            TEST_ASSERT_EQUAL(0, Luos_NbrAvailableMsg());
+
+            NEW_STEP("Check the borrowed message is not copied");
+            msg_t msg;
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            msg.header.size        = 1;
+            msg.data[0]            = 0xAA;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendMsg(default_sc.App_3.app, &msg));
+            msg.data[0] = 0xBB;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendMsg(default_sc.App_3.app, &msg));
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_BorrowMsg(service, &rx_msg));
+            TEST_ASSERT_TRUE(((uintptr_t)rx_msg >= (uintptr_t)msg_buffer) && ((uintptr_t)rx_msg < (uintptr_t)msg_buffer + MSG_BUFFER_SIZE));
+            TEST_ASSERT_EQUAL(msg.header.source, rx_msg->header.source);
+            TEST_ASSERT_EQUAL(0xAA, rx_msg->data[0]);
+
+            NEW_STEP("Check the borrowed message is skipped by the other readers");
+            msg_t copied_msg;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &copied_msg));
+            TEST_ASSERT_EQUAL(0xBB, copied_msg.data[0]);
+            TEST_ASSERT_EQUAL(FAILED, Luos_ReadFromService(service, msg.header.source, &copied_msg));
+            TEST_ASSERT_EQUAL(1, Luos_NbrAvailableMsg());
+
+            NEW_STEP("Check release free the message");
+            Luos_ReleaseMsg(service, rx_msg);
+            TEST_ASSERT_EQUAL(0, Luos_NbrAvailableMsg());
+
+            NEW_STEP("Try to borrow but no message available");
+            TEST_ASSERT_EQUAL(FAILED, Luos_BorrowMsg(service, &rx_msg));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("Test Luos_ReleaseMsg assert conditions");
+    {
+        TRY
+        {
+            NEW_STEP("Try to borrow twice without release");
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+            const msg_t *rx_msg;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_BorrowMsg(service, &rx_msg));
+            Luos_BorrowMsg(service, &rx_msg);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            NEW_STEP("Try to release a message not borrowed");
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            msg_t msg;
+            Luos_ReleaseMsg(service, &msg);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+}
+
 void unittest_Luos_Send_ReceiveData()
 {
     NEW_TEST_CASE("Test Luos_SendData assert condition");
@@ -535,6 +725,219 @@ void unittest_Luos_Send_ReceiveData()
     }
 }
 
+static data_transfer_t *end_transfer = NULL;
+static error_return_t end_status     = PROHIBITED;
+static uint8_t end_nb                = 0;
+
+static void Transfer_End(data_transfer_t *transfer, error_return_t status)
+{
+    end_transfer = transfer;
+    end_status   = status;
+    end_nb++;
+}
+
+void unittest_Luos_SendDataAsync(void)
+{
+    NEW_TEST_CASE("Test Luos_SendDataAsync assert conditions");
+    {
+        //  Init default scenario context
+        Init_Context();
+        data_transfer_t transfer = {0};
+        uint8_t bin_data[10]     = {0};
+        msg_t msg;
+        RESET_ASSERT();
+        TRY
+        {
+            Luos_SendDataAsync(default_sc.App_1.app, 0, &transfer, bin_data, 10, Transfer_End);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            Luos_SendDataAsync(default_sc.App_1.app, &msg, 0, bin_data, 10, Transfer_End);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, NULL, 10, Transfer_End);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, bin_data, 0, Transfer_End);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        RESET_ASSERT();
+    }
+
+    NEW_TEST_CASE("Test Luos_SendDataAsync with flow control");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+            data_transfer_t transfer = {0};
+            msg_t msg;
+            uint8_t tx_data[1024] = {0};
+            uint8_t rx_data[1024] = {0};
+            msg_t rx_msg;
+            // Catch the end of detection
+            Luos_ReadMsg(service, &rx_msg);
+            for (uint16_t i = 0; i < sizeof(tx_data); i++)
+            {
+                tx_data[i] = (uint8_t)i;
+            }
+            end_nb = 0;
+
+            NEW_STEP("Check that only the first window of chunks is sent");
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, tx_data, sizeof(tx_data), Transfer_End));
+            TEST_ASSERT_TRUE(transfer.active);
+            TEST_ASSERT_EQUAL(DATA_TRANSFER_WINDOW * 128, transfer.sent_size);
+            TEST_ASSERT_EQUAL(0, transfer.credit);
+
+            NEW_STEP("Check that the receiver credits allow the sender to finish the transfer");
+            int size = 0;
+            for (uint16_t i = 0; (i < 100) && (size == 0); i++)
+            {
+                while (Luos_ReadMsg(service, &rx_msg) == SUCCEED)
+                {
+                    TEST_ASSERT_EQUAL(CREDIT_PROTOCOL, rx_msg.header.config);
+                    size = Luos_ReceiveData(service, &rx_msg, rx_data);
+                    TEST_ASSERT_TRUE(size >= 0);
+                }
+                Luos_Loop();
+            }
+            TEST_ASSERT_EQUAL(1, end_nb);
+            TEST_ASSERT_EQUAL(&transfer, end_transfer);
+            TEST_ASSERT_EQUAL(SUCCEED, end_status);
+            TEST_ASSERT_FALSE(transfer.active);
+            TEST_ASSERT_EQUAL(sizeof(tx_data), size);
+            TEST_ASSERT_EQUAL_MEMORY(tx_data, rx_data, sizeof(tx_data));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Test Luos_GiveDataCredit with chunks handled by the receiver");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+            data_transfer_t transfer = {0};
+            msg_t msg;
+            uint8_t tx_data[1024] = {0};
+            uint8_t rx_data[1024] = {0};
+            msg_t rx_msg;
+            // Catch the end of detection
+            Luos_ReadMsg(service, &rx_msg);
+            for (uint16_t i = 0; i < sizeof(tx_data); i++)
+            {
+                tx_data[i] = (uint8_t)i;
+            }
+            end_nb                 = 0;
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, tx_data, sizeof(tx_data), Transfer_End));
+
+            NEW_STEP("Check that the credits given for each chunk allow the sender to finish the transfer");
+            uint16_t size = 0;
+            for (uint16_t i = 0; (i < 100) && (size < sizeof(tx_data)); i++)
+            {
+                while (Luos_ReadMsg(service, &rx_msg) == SUCCEED)
+                {
+                    uint16_t chunk_size = (rx_msg.header.size > 128) ? 128 : rx_msg.header.size;
+                    memcpy(&rx_data[size], rx_msg.data, chunk_size);
+                    size += chunk_size;
+                    Luos_GiveDataCredit(service, &rx_msg);
+                }
+                Luos_Loop();
+            }
+            TEST_ASSERT_EQUAL(1, end_nb);
+            TEST_ASSERT_EQUAL(SUCCEED, end_status);
+            TEST_ASSERT_EQUAL(sizeof(tx_data), size);
+            TEST_ASSERT_EQUAL_MEMORY(tx_data, rx_data, sizeof(tx_data));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Test Luos_SendDataAsync timeout and cancel");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+            data_transfer_t transfer = {0};
+            msg_t msg;
+            uint8_t tx_data[1024] = {0};
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            end_nb                 = 0;
+
+            NEW_STEP("Check that a transfer without credit fail after the timeout");
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, tx_data, sizeof(tx_data), Transfer_End));
+            uint32_t start = Luos_GetSystick();
+            while ((end_nb == 0) && ((Luos_GetSystick() - start) < (2 * DATA_TRANSFER_TIMEOUT_MS)))
+            {
+                Luos_Loop();
+            }
+            TEST_ASSERT_EQUAL(1, end_nb);
+            TEST_ASSERT_EQUAL(FAILED, end_status);
+            TEST_ASSERT_FALSE(transfer.active);
+
+            NEW_STEP("Check that a canceled transfer stop without calling the callback");
+            // Consume the chunks of the previous transfer
+            while (Luos_ReadMsg(service, &msg) == SUCCEED)
+                ;
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_SendDataAsync(default_sc.App_1.app, &msg, &transfer, tx_data, sizeof(tx_data), Transfer_End));
+            Luos_CancelDataAsync(&transfer);
+            TEST_ASSERT_FALSE(transfer.active);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(1, end_nb);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_Luos_NbrAvailableMsg(void)
 {
 
@@ -568,6 +971,59 @@ void unittest_Luos_NbrAvailableMsg(void)
     }
 }
 
+void unittest_Luos_DetectBranch(void)
+{
+    NEW_TEST_CASE("Test Luos_DetectBranch assert conditions");
+    {
+        TRY
+        {
+            Luos_DetectBranch(NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Test Luos_DetectBranch without new node");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, STATE_TYPE, "mycustom_service", revision);
+            Luos_Detect(default_sc.App_1.app);
+            do
+            {
+                Luos_Loop();
+            } while (!Luos_IsDetected());
+            msg_t rx_msg;
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &rx_msg));
+            uint16_t service_id = service->id;
+            uint16_t entry_nb   = RoutingTB_GetLastEntry();
+
+            NEW_STEP("Check that the network stay detected during the branch detection");
+            Luos_DetectBranch(service);
+            uint16_t loop_nb = 0;
+            do
+            {
+                Luos_Loop();
+                TEST_ASSERT_TRUE(Luos_IsDetected());
+                TEST_ASSERT_TRUE(++loop_nb < 1000);
+            } while (Luos_ReadMsg(service, &rx_msg) != SUCCEED);
+
+            NEW_STEP("Check that the end of the detection is received and nothing changed");
+            TEST_ASSERT_EQUAL(END_DETECTION, rx_msg.header.cmd);
+            TEST_ASSERT_EQUAL(service_id, service->id);
+            TEST_ASSERT_EQUAL(1, Node_Get()->node_id);
+            TEST_ASSERT_EQUAL(entry_nb, RoutingTB_GetLastEntry());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 int main(int argc, char **argv)
 {
     UNITY_BEGIN();
@@ -576,11 +1032,15 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_Luos_GetVersion);
     UNIT_TEST_RUN(unittest_Luos_Send);
     UNIT_TEST_RUN(unittest_Luos_SendMsg);
+    UNIT_TEST_RUN(unittest_Luos_SendMsgSegments);
     UNIT_TEST_RUN(unittest_Luos_SendTimestampMsg);
     UNIT_TEST_RUN(unittest_Luos_ReadMsg);
     UNIT_TEST_RUN(unittest_Luos_ReadFromService);
+    UNIT_TEST_RUN(unittest_Luos_BorrowMsg);
     UNIT_TEST_RUN(unittest_Luos_Send_ReceiveData);
+    UNIT_TEST_RUN(unittest_Luos_SendDataAsync);
     UNIT_TEST_RUN(unittest_Luos_NbrAvailableMsg);
+    UNIT_TEST_RUN(unittest_Luos_DetectBranch);
 
     UNITY_END();
 }
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <default_scenario.h>
+#include "routing_table.c"
+#include "_luos_phy.h"
+#include "_robus_network.h"
+
+// This test is built by the native env with the base message size, and by the native_large_msg env with a bigger MAX_DATA_MSG_SIZE.
+#define DATA_SIZE ((2 * MAX_DATA_MSG_SIZE) + (MAX_DATA_MSG_SIZE / 2))
+
+extern default_scenario_t default_sc;
+
+/******************************************************************************
+ * @brief Run a detection and get the END_DETECTION message
+ * @param service Service receiving the END_DETECTION message
+ * @param rx_msg Received END_DETECTION message
+ * @return None
+ ******************************************************************************/
+static void Detect(service_t *service, msg_t *rx_msg)
+{
+    Luos_Detect(default_sc.App_1.app);
+    uint32_t started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 10000);
+    } while (!Luos_IsDetected());
+    TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, rx_msg));
+    TEST_ASSERT_EQUAL(END_DETECTION, rx_msg->header.cmd);
+    TEST_ASSERT_EQUAL(sizeof(uint8_t) + sizeof(uint16_t), rx_msg->header.size);
+}
+
+/******************************************************************************
+ * @brief Get the message size sent in an END_DETECTION message
+ * @param rx_msg END_DETECTION message
+ * @return Message size of the network
+ ******************************************************************************/
+static uint16_t Get_EndDetectionMtu(msg_t *rx_msg)
+{
+    uint16_t mtu;
+    memcpy(&mtu, &rx_msg->data[1], sizeof(uint16_t));
+    return mtu;
+}
+
+void unittest_Mtu_Negotiation(void)
+{
+    NEW_TEST_CASE("Check that a network with a base phy use the base message size");
+    {
+        TRY
+        {
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            msg_t rx_msg;
+            Phy_SetMtu(Robus_GetPhy(), BASE_DATA_MSG_SIZE);
+            Detect(service, &rx_msg);
+            TEST_ASSERT_EQUAL(PROTOCOL_REVISION, rx_msg.data[0]);
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Get_EndDetectionMtu(&rx_msg));
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Luos_GetMtu());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a network with only big phys use the node message size");
+    {
+        TRY
+        {
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            msg_t rx_msg;
+            Phy_SetMtu(Robus_GetPhy(), MAX_DATA_MSG_SIZE);
+            Detect(service, &rx_msg);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, Get_EndDetectionMtu(&rx_msg));
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, Luos_GetMtu());
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, RoutingTB_Get()[0].mtu);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that the lowest message size of the nodes is sent");
+    {
+        TRY
+        {
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            msg_t rx_msg;
+            Phy_SetMtu(Robus_GetPhy(), MAX_DATA_MSG_SIZE);
+            Detect(service, &rx_msg);
+            routing_table_t *node_entry = &RoutingTB_Get()[0];
+            TEST_ASSERT_EQUAL(NODE, node_entry->mode);
+
+            NEW_STEP("Check a node with a smaller message size");
+            node_entry->mtu = BASE_DATA_MSG_SIZE + ((MAX_DATA_MSG_SIZE - BASE_DATA_MSG_SIZE) / 2);
+            RoutingTB_SendEndDetection(default_sc.App_1.app);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &rx_msg));
+            TEST_ASSERT_EQUAL(END_DETECTION, rx_msg.header.cmd);
+            TEST_ASSERT_EQUAL(node_entry->mtu, Get_EndDetectionMtu(&rx_msg));
+            TEST_ASSERT_EQUAL(node_entry->mtu, Luos_GetMtu());
+
+            NEW_STEP("Check an old node not giving its message size");
+            node_entry->mtu = 0;
+            RoutingTB_SendEndDetection(default_sc.App_1.app);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &rx_msg));
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Get_EndDetectionMtu(&rx_msg));
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Luos_GetMtu());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Mtu_Fragmentation(void)
+{
+    NEW_TEST_CASE("Check that data are fragmented at the network message size");
+    {
+        TRY
+        {
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            msg_t rx_msg;
+            Phy_SetMtu(Robus_GetPhy(), MAX_DATA_MSG_SIZE);
+            Detect(service, &rx_msg);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, Luos_GetMtu());
+
+            static uint8_t tx_data[DATA_SIZE];
+            static uint8_t rx_data[DATA_SIZE];
+            for (uint16_t i = 0; i < DATA_SIZE; i++)
+            {
+                tx_data[i] = (uint8_t)i;
+            }
+            memset(rx_data, 0, DATA_SIZE);
+            msg_t msg;
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            Luos_SendData(default_sc.App_1.app, &msg, tx_data, DATA_SIZE);
+
+            NEW_STEP("Check that each message carry the remaining size and a complete chunk");
+            uint16_t remaining = DATA_SIZE;
+            while (remaining > MAX_DATA_MSG_SIZE)
+            {
+                TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &rx_msg));
+                TEST_ASSERT_EQUAL(remaining, rx_msg.header.size);
+                TEST_ASSERT_EQUAL_MEMORY(&tx_data[DATA_SIZE - remaining], rx_msg.data, MAX_DATA_MSG_SIZE);
+                TEST_ASSERT_EQUAL(0, Luos_ReceiveData(service, &rx_msg, rx_data));
+                remaining -= MAX_DATA_MSG_SIZE;
+            }
+            NEW_STEP("Check that the last message complete the data");
+            TEST_ASSERT_EQUAL(SUCCEED, Luos_ReadMsg(service, &rx_msg));
+            TEST_ASSERT_EQUAL(remaining, rx_msg.header.size);
+            TEST_ASSERT_EQUAL(DATA_SIZE, Luos_ReceiveData(service, &rx_msg, rx_data));
+            TEST_ASSERT_EQUAL_MEMORY(tx_data, rx_data, DATA_SIZE);
+            TEST_ASSERT_EQUAL(FAILED, Luos_ReadMsg(service, &rx_msg));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that data are fragmented at the base message size with a base phy");
+    {
+        TRY
+        {
+            Init_Context();
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(0, VOID_TYPE, "Dummy_App", revision);
+            msg_t rx_msg;
+            Phy_SetMtu(Robus_GetPhy(), BASE_DATA_MSG_SIZE);
+            Detect(service, &rx_msg);
+
+            static uint8_t tx_data[DATA_SIZE];
+            static uint8_t rx_data[DATA_SIZE];
+            memset(tx_data, 0x55, DATA_SIZE);
+            memset(rx_data, 0, DATA_SIZE);
+            msg_t msg;
+            msg.header.target      = service->id;
+            msg.header.target_mode = SERVICEIDACK;
+            msg.header.cmd         = LUOS_LAST_RESERVED_CMD + 1;
+            Luos_SendData(default_sc.App_1.app, &msg, tx_data, DATA_SIZE);
+
+            uint16_t msg_nb = 0;
+            int size        = 0;
+            while (Luos_ReadMsg(service, &rx_msg) == SUCCEED)
+            {
+                msg_nb++;
+                size = Luos_ReceiveData(service, &rx_msg, rx_data);
+            }
+            TEST_ASSERT_EQUAL((DATA_SIZE + BASE_DATA_MSG_SIZE - 1) / BASE_DATA_MSG_SIZE, msg_nb);
+            TEST_ASSERT_EQUAL(DATA_SIZE, size);
+            TEST_ASSERT_EQUAL_MEMORY(tx_data, rx_data, DATA_SIZE);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    UNIT_TEST_RUN(unittest_Mtu_Negotiation);
+    UNIT_TEST_RUN(unittest_Mtu_Fragmentation);
+
+    UNITY_END();
+}
@@ -51,7 +51,7 @@ void unittest_Node_Init(void)
             Node_Init();
             TEST_ASSERT_EQUAL(DEFAULTID, node_ctx.info.node_id);
             TEST_ASSERT_EQUAL(false, node_ctx.info.certified);
-            TEST_ASSERT_EQUAL(0, node_ctx.info.node_info);
+            TEST_ASSERT_EQUAL(PROTOCOL_REVISION << 4, node_ctx.info.node_info);
             TEST_ASSERT_EQUAL(false, node_ctx.timeout_run);
             TEST_ASSERT_EQUAL(0, node_ctx.timeout);
         }
@@ -148,6 +148,32 @@ void unittest_Node_Loop(void)
     }
 }
 
+void unittest_Node_ProtocolRevision(void)
+{
+    NEW_TEST_CASE("Test Node_SetProtocolRevision");
+    {
+        TRY
+        {
+            Node_SetState(DETECTION_OK);
+            Node_SetProtocolRevision(0);
+            TEST_ASSERT_EQUAL(0, Node_GetProtocolRevision());
+            Node_SetProtocolRevision(PROTOCOL_REVISION);
+            TEST_ASSERT_EQUAL(PROTOCOL_REVISION, Node_GetProtocolRevision());
+            // We can't use a revision newer than ours
+            Node_SetProtocolRevision(PROTOCOL_REVISION + 1);
+            TEST_ASSERT_EQUAL(PROTOCOL_REVISION, Node_GetProtocolRevision());
+            // A new detection go back to the base revision
+            Node_SetState(EXTERNAL_DETECTION);
+            TEST_ASSERT_EQUAL(0, Node_GetProtocolRevision());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_Luos_IsDetected(void)
 {
     NEW_TEST_CASE("Test Luos_IsDetected");
@@ -178,6 +204,7 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_Node_Init);
     UNIT_TEST_RUN(unittest_Node_SetState);
     UNIT_TEST_RUN(unittest_Node_Loop);
+    UNIT_TEST_RUN(unittest_Node_ProtocolRevision);
     UNIT_TEST_RUN(unittest_Luos_IsDetected);
 
     UNITY_END();
@@ -1,8 +1,34 @@
+// Room for a routing table of hundreds of services
+#define MAX_SERVICE_NUMBER 300
 #include <stdio.h>
 #include <default_scenario.h>
 #include "routing_table.c"
+#include "_luos_phy.h"
+#include "robus_hal.h"
+#include "stats.h"
 
 extern default_scenario_t default_sc;
+extern luos_phy_t *phy_robus;
+
+static uint8_t tx_release_countdown = 0;
+
+// End the held Robus transmissions after a few tries, like the Tx IRQ would
+static void Test_TxIrq(void)
+{
+    if (tx_release_countdown == 0)
+    {
+        return;
+    }
+    tx_release_countdown--;
+    if (tx_release_countdown == 0)
+    {
+        stub_robus_tx_hold = false;
+        while (Phy_GetJobNumber(phy_robus) > 0)
+        {
+            Phy_RmJob(phy_robus, Phy_GetJob(phy_robus));
+        }
+    }
+}
 
 void unittest_RoutingTB_IDFromAlias(void)
 {
@@ -162,6 +188,7 @@ void unittest_RoutingTB_BigestID(void)
         }
         CATCH
         {
+            stub_irq_handler = NULL;
             TEST_ASSERT_TRUE(false);
         }
         END_TRY;
@@ -226,6 +253,140 @@ void unittest_RoutingTB_AddNumToAlias(void)
     }
 }
 
+static void set_services(uint16_t service_nb, const char *alias)
+{
+    RoutingTB_Erase();
+    routing_table[0].mode    = NODE;
+    routing_table[0].node_id = 1;
+    for (uint16_t i = 1; i <= service_nb; i++)
+    {
+        routing_table[i].mode = SERVICE;
+        routing_table[i].id   = i;
+        memcpy(routing_table[i].alias, alias, strlen(alias) + 1);
+    }
+    RoutingTB_ComputeRoutingTableEntryNB();
+}
+
+void unittest_RoutingTB_CheckAliases(void)
+{
+    NEW_TEST_CASE("check RoutingTB_CheckAliases with a few services");
+    {
+        TRY
+        {
+            set_services(4, "app");
+            memcpy(routing_table[3].alias, "app1", sizeof("app1"));
+            memcpy(routing_table[4].alias, "other", sizeof("other"));
+            RoutingTB_CheckAliases();
+            TEST_ASSERT_EQUAL_STRING("app", RoutingTB_AliasFromId(1));
+            TEST_ASSERT_EQUAL_STRING("app1", RoutingTB_AliasFromId(2));
+            TEST_ASSERT_EQUAL_STRING("app11", RoutingTB_AliasFromId(3));
+            TEST_ASSERT_EQUAL_STRING("other", RoutingTB_AliasFromId(4));
+            TEST_ASSERT_EQUAL(3, RoutingTB_IDFromAlias("app11"));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("check RoutingTB_CheckAliases with hundreds of identical aliases");
+    {
+        TRY
+        {
+            char alias[MAX_ALIAS_SIZE];
+            set_services(250, "app");
+            RoutingTB_CheckAliases();
+            TEST_ASSERT_EQUAL_STRING("app", RoutingTB_AliasFromId(1));
+            for (uint16_t i = 1; i <= 99; i++)
+            {
+                sprintf(alias, "app%d", i);
+                TEST_ASSERT_EQUAL_STRING(alias, RoutingTB_AliasFromId(i + 1));
+                TEST_ASSERT_EQUAL(i + 1, RoutingTB_IDFromAlias(alias));
+            }
+
+            NEW_STEP("Check that aliases without free number are renamed as error");
+            TEST_ASSERT_EQUAL_STRING("error", RoutingTB_AliasFromId(101));
+            for (uint16_t i = 1; i <= 99; i++)
+            {
+                sprintf(alias, "error%d", i);
+                TEST_ASSERT_EQUAL_STRING(alias, RoutingTB_AliasFromId(i + 101));
+                TEST_ASSERT_EQUAL(i + 101, RoutingTB_IDFromAlias(alias));
+            }
+
+            NEW_STEP("Check that the error aliases are numbered above 99");
+            for (uint16_t i = 100; i <= 149; i++)
+            {
+                sprintf(alias, "error%d", i);
+                TEST_ASSERT_EQUAL_STRING(alias, RoutingTB_AliasFromId(i + 101));
+                TEST_ASSERT_EQUAL(i + 101, RoutingTB_IDFromAlias(alias));
+            }
+            TEST_ASSERT_EQUAL(101, RoutingTB_IDFromAlias("error"));
+            TEST_ASSERT_EQUAL(251, last_routing_table_entry);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_RoutingTB_GenerateWindow(void)
+{
+    NEW_TEST_CASE("check RoutingTB_GenerateWindow with a saturated Tx buffer");
+    {
+        TRY
+        {
+            Init_Context();
+            service_t *service = default_sc.App_1.app;
+            connection_t connection_table[MAX_NODE_NUMBER];
+            memset(connection_table, 0xFF, sizeof(connection_table));
+            // Fill the Tx buffer with transmissions held by Robus, down to the size of the request
+            msg_t msg;
+            msg.header.target_mode = SERVICEID;
+            msg.header.target      = 50;
+            msg.header.cmd         = LUOS_LAST_STD_CMD;
+            Phy_IndexSet(phy_robus->services, 50);
+            stub_robus_tx_hold = true;
+            for (msg.header.size = MAX_DATA_MSG_SIZE; msg.header.size >= 2 * sizeof(uint16_t); msg.header.size /= 2)
+            {
+                while (Luos_SendMsg(service, &msg) == SUCCEED)
+                    ;
+            }
+            uint32_t alloc_failure_number = Stats_GetIO()->alloc_failure_number;
+            tx_release_countdown = 5;
+            stub_irq_handler     = Test_TxIrq;
+
+            NEW_STEP("Check that the request of the local routing table waits for space");
+            RoutingTB_Erase();
+            memset(&rtb_window, 0, sizeof(rtb_window));
+            rtb_window.node_id    = 1;
+            rtb_window.service_id = 1;
+            TEST_ASSERT_EQUAL(0, RoutingTB_GenerateWindow(service, 1, connection_table));
+            TEST_ASSERT_EQUAL(0, tx_release_countdown);
+            TEST_ASSERT_TRUE(Stats_GetIO()->alloc_failure_number > alloc_failure_number);
+            stub_irq_handler = NULL;
+
+            NEW_STEP("Check that the node answers the request");
+            int result = 0;
+            for (uint16_t i = 0; (i < 10) && (result == 0); i++)
+            {
+                Luos_Loop();
+                result = RoutingTB_GenerateWindow(service, 1, connection_table);
+            }
+            TEST_ASSERT_EQUAL(1, result);
+            TEST_ASSERT_EQUAL(4, last_routing_table_entry);
+            TEST_ASSERT_EQUAL(3, RoutingTB_BigestID());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_RoutingTB_ConvertNodeToRoutingTable(void)
 {
     NEW_TEST_CASE("Test RoutingTB_ConvertNodeToRoutingTable assert conditions");
@@ -397,6 +558,212 @@ void unittest_RoutingTB_RemoveNode(void)
     }
 }
 
+void unittest_RoutingTB_AddNode(void)
+{
+    NEW_TEST_CASE("Test RoutingTB_AddNode assert conditions");
+    {
+        TRY
+        {
+            RoutingTB_AddNode(NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            routing_table_t entry = {0};
+            entry.mode            = SERVICE;
+            entry.node_id         = 2;
+            RoutingTB_AddNode(&entry);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("check RoutingTB_AddNode return value");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            routing_table_t entry = {0};
+            entry.mode            = NODE;
+            entry.node_id         = 2;
+            RoutingTB_AddNode(&entry);
+            TEST_ASSERT_EQUAL(5, last_routing_table_entry);
+            TEST_ASSERT_EQUAL(NODE, routing_table[4].mode);
+            TEST_ASSERT_EQUAL(2, routing_table[4].node_id);
+            TEST_ASSERT_EQUAL(2, RoutingTB_BigestNodeID());
+
+            NEW_STEP("Check that a known node is not added again");
+            RoutingTB_AddNode(&entry);
+            TEST_ASSERT_EQUAL(5, last_routing_table_entry);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_RoutingTB_AddService(void)
+{
+    NEW_TEST_CASE("Test RoutingTB_AddService assert conditions");
+    {
+        TRY
+        {
+            RoutingTB_AddService(1, NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+        TRY
+        {
+            routing_table_t entry = {0};
+            entry.mode            = SERVICE;
+            RoutingTB_AddService(1, &entry);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("check RoutingTB_AddService return value");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            routing_table_t node = {0};
+            node.mode            = NODE;
+            node.node_id         = 2;
+            RoutingTB_AddNode(&node);
+            routing_table_t entry = {0};
+            entry.mode            = SERVICE;
+            entry.id              = 4;
+            memcpy(entry.alias, "new_app", sizeof("new_app"));
+            RoutingTB_AddService(2, &entry);
+            TEST_ASSERT_EQUAL(6, last_routing_table_entry);
+            TEST_ASSERT_EQUAL(4, routing_table[5].id);
+            TEST_ASSERT_EQUAL(4, last_service);
+            TEST_ASSERT_EQUAL(4, RoutingTB_IDFromAlias("new_app"));
+            TEST_ASSERT_EQUAL(2, RoutingTB_NodeIDFromID(4));
+
+            NEW_STEP("Check that a service is added after the other services of its node");
+            entry.id = 5;
+            memcpy(entry.alias, "local_app", sizeof("local_app"));
+            RoutingTB_AddService(1, &entry);
+            TEST_ASSERT_EQUAL(7, last_routing_table_entry);
+            TEST_ASSERT_EQUAL(5, routing_table[4].id);
+            TEST_ASSERT_EQUAL(NODE, routing_table[5].mode);
+            TEST_ASSERT_EQUAL(4, routing_table[6].id);
+            TEST_ASSERT_EQUAL(5, last_service);
+            TEST_ASSERT_EQUAL(1, RoutingTB_NodeIDFromID(5));
+            TEST_ASSERT_EQUAL(4, RoutingTB_IDFromAlias("new_app"));
+
+            NEW_STEP("Check that a known service or a service of an unknown node is not added");
+            RoutingTB_AddService(1, &entry);
+            TEST_ASSERT_EQUAL(7, last_routing_table_entry);
+            entry.id = 6;
+            RoutingTB_AddService(3, &entry);
+            TEST_ASSERT_EQUAL(7, last_routing_table_entry);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_RoutingTB_ReceiveDelta(void)
+{
+    NEW_TEST_CASE("Test RoutingTB_ReceiveDelta assert conditions");
+    {
+        TRY
+        {
+            RoutingTB_ReceiveDelta(NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("check RoutingTB_ReceiveDelta return value");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            msg_t msg;
+            routing_table_t entries[3];
+            memset(entries, 0, sizeof(entries));
+            entries[0].mode    = NODE;
+            entries[0].node_id = 2;
+            entries[1].mode    = SERVICE;
+            entries[1].id      = 4;
+            memcpy(entries[1].alias, "app_4", sizeof("app_4"));
+            entries[2].mode = SERVICE;
+            entries[2].id   = 5;
+            memcpy(entries[2].alias, "app_5", sizeof("app_5"));
+            msg.header.cmd  = RTB_DELTA;
+            msg.header.size = 2 * sizeof(routing_table_t);
+            memcpy(msg.data, entries, msg.header.size);
+            RoutingTB_ReceiveDelta(&msg);
+            TEST_ASSERT_EQUAL(6, last_routing_table_entry);
+
+            NEW_STEP("Check that the services of the next message are added to the same node");
+            msg.header.size = sizeof(routing_table_t);
+            memcpy(msg.data, &entries[2], msg.header.size);
+            RoutingTB_ReceiveDelta(&msg);
+            TEST_ASSERT_EQUAL(7, last_routing_table_entry);
+            TEST_ASSERT_EQUAL(5, RoutingTB_BigestID());
+            TEST_ASSERT_EQUAL(2, RoutingTB_NodeIDFromID(4));
+            TEST_ASSERT_EQUAL(2, RoutingTB_NodeIDFromID(5));
+            TEST_ASSERT_EQUAL(5, RoutingTB_IDFromAlias("app_5"));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_RoutingTB_PhyToward(void)
+{
+    NEW_TEST_CASE("check RoutingTB_PhyToward with a branch added to a network");
+    {
+        TRY
+        {
+            // Node 1 is connected to node 2 on its phy 1, node 2 is connected to node 3 on its phy 1.
+            // The new node 4 is connected to node 2 on its phy 2.
+            connection_t connection_table[MAX_NODE_NUMBER];
+            memset(connection_table, 0xFF, sizeof(connection_table));
+            uint16_t parents[4]     = {0xFFFF, 1, 2, 2};
+            uint8_t parent_phys[4]  = {0xFF, 1, 1, 2};
+            for (uint16_t i = 1; i < 4; i++)
+            {
+                connection_table[i].parent.node_id = parents[i];
+                connection_table[i].parent.phy_id  = parent_phys[i];
+                connection_table[i].child.node_id  = i + 1;
+                connection_table[i].child.phy_id   = 1;
+            }
+            TEST_ASSERT_EQUAL(1, RoutingTB_PhyToward(1, 4, connection_table));
+            TEST_ASSERT_EQUAL(1, RoutingTB_PhyToward(2, 1, connection_table));
+            TEST_ASSERT_EQUAL(1, RoutingTB_PhyToward(2, 3, connection_table));
+            TEST_ASSERT_EQUAL(2, RoutingTB_PhyToward(2, 4, connection_table));
+            TEST_ASSERT_EQUAL(1, RoutingTB_PhyToward(3, 4, connection_table));
+            TEST_ASSERT_EQUAL(1, RoutingTB_PhyToward(4, 3, connection_table));
+
+            NEW_STEP("Check that the phy of the detecting node parent is unknown");
+            TEST_ASSERT_EQUAL(0xFF, RoutingTB_PhyToward(1, 1, connection_table));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_RoutingTB_Erase(void)
 {
     NEW_TEST_CASE("check RoutingTB_Erase return value");
@@ -418,6 +785,66 @@ void unittest_RoutingTB_Erase(void)
     }
 }
 
+void unittest_RoutingTB_Index(void)
+{
+    NEW_TEST_CASE("check index after a service removal");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+
+            RoutingTB_RemoveService(2);
+            TEST_ASSERT_EQUAL(0, RoutingTB_IDFromAlias("Dummy_App_2"));
+            TEST_ASSERT_EQUAL(3, RoutingTB_IDFromAlias("Dummy_App_3"));
+            TEST_ASSERT_EQUAL(2, RoutingTB_GetServiceIndex(3));
+            TEST_ASSERT_EQUAL_STRING("Dummy_App_3", RoutingTB_AliasFromId(3));
+            TEST_ASSERT_EQUAL(0, RoutingTB_AliasFromId(2));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("check index with duplicated aliases");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+
+            // Add services with the same alias at the end of the routing table
+            for (uint16_t i = 0; i < 3; i++)
+            {
+                routing_table[4 + i].mode = SERVICE;
+                routing_table[4 + i].id   = 4 + i;
+                memcpy(routing_table[4 + i].alias, "Same_Alias", sizeof("Same_Alias"));
+            }
+            RoutingTB_ComputeRoutingTableEntryNB();
+            TEST_ASSERT_EQUAL(7, last_routing_table_entry);
+            // The first entry with this alias is the one we get
+            TEST_ASSERT_EQUAL(4, RoutingTB_IDFromAlias("Same_Alias"));
+            TEST_ASSERT_EQUAL(6, RoutingTB_GetServiceIndex(6));
+
+            // Modify the routing table without any index update
+            routing_table[5].id = 10;
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetServiceIndex(5));
+            TEST_ASSERT_EQUAL(5, RoutingTB_GetServiceIndex(10));
+
+            RoutingTB_Erase();
+            TEST_ASSERT_EQUAL(0, RoutingTB_IDFromAlias("Same_Alias"));
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetServiceIndex(4));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_RoutingTB_Get(void)
 {
     NEW_TEST_CASE("check RoutingTB_Get return value");
@@ -820,11 +1247,18 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_RoutingTB_BigestNodeID);
     UNIT_TEST_RUN(unittest_RoutingTB_ComputeRoutingTableEntryNB);
     UNIT_TEST_RUN(unittest_RoutingTB_AddNumToAlias);
+    UNIT_TEST_RUN(unittest_RoutingTB_CheckAliases);
+    UNIT_TEST_RUN(unittest_RoutingTB_GenerateWindow);
     UNIT_TEST_RUN(unittest_RoutingTB_ConvertNodeToRoutingTable);
     UNIT_TEST_RUN(unittest_RoutingTB_ConvertServiceToRoutingTable);
     UNIT_TEST_RUN(unittest_RoutingTB_RemoveService);
     UNIT_TEST_RUN(unittest_RoutingTB_RemoveNode);
+    UNIT_TEST_RUN(unittest_RoutingTB_AddNode);
+    UNIT_TEST_RUN(unittest_RoutingTB_AddService);
+    UNIT_TEST_RUN(unittest_RoutingTB_ReceiveDelta);
+    UNIT_TEST_RUN(unittest_RoutingTB_PhyToward);
     UNIT_TEST_RUN(unittest_RoutingTB_Erase);
+    UNIT_TEST_RUN(unittest_RoutingTB_Index);
     UNIT_TEST_RUN(unittest_RoutingTB_Get);
     UNIT_TEST_RUN(unittest_RoutingTB_GetLastEntry);
     UNIT_TEST_RUN(unittest_RTFilter_Reset);
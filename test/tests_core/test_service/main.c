@@ -373,6 +373,71 @@ void unittest_Service_GetFilter(void)
     }
 }
 
+void unittest_Service_UpdateLookup(void)
+{
+    NEW_TEST_CASE("Test Service lookup tables");
+    {
+        TRY
+        {
+            //  Init default scenario context
+            Init_Context();
+            Luos_Loop();
+            msg_t msg;
+
+            NEW_STEP("Check type lookup with multiple types");
+            revision_t revision = {.major = 1, .minor = 0, .build = 0};
+            service_t *service  = Luos_CreateService(NULL, STATE_TYPE, "state_service", revision);
+            msg.header.target_mode = TYPE;
+            msg.header.target      = STATE_TYPE;
+            TEST_ASSERT_EQUAL(0b00001000, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(service, Service_GetConcerned(&msg.header));
+            msg.header.target = default_sc.App_1.app->type;
+            TEST_ASSERT_EQUAL(0b00000111, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(default_sc.App_1.app, Service_GetConcerned(&msg.header));
+            msg.header.target = LUOS_LAST_TYPE;
+            TEST_ASSERT_EQUAL(0b00000000, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(NULL, Service_GetConcerned(&msg.header));
+
+            NEW_STEP("Check id lookup after id generation");
+            // The detector keep the id 1, other services start from 10
+            Service_GenerateId(10);
+            msg.header.target_mode = SERVICEID;
+            msg.header.target      = 12;
+            TEST_ASSERT_EQUAL(0b00001000, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(service, Service_GetConcerned(&msg.header));
+            msg.header.target = 1;
+            TEST_ASSERT_EQUAL(0b00000001, Service_GetFilter(&msg));
+            msg.header.target = 13;
+            TEST_ASSERT_EQUAL(0b00000000, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(NULL, Service_GetConcerned(&msg.header));
+            msg.header.target = 9;
+            TEST_ASSERT_EQUAL(0b00000000, Service_GetFilter(&msg));
+
+            NEW_STEP("Check id set outside of the id generation");
+            service->id       = 100;
+            msg.header.target = 100;
+            TEST_ASSERT_EQUAL(0b00001000, Service_GetFilter(&msg));
+
+            NEW_STEP("Check topic lookup follow subscriptions");
+            msg.header.target_mode = TOPIC;
+            msg.header.target      = 3;
+            TEST_ASSERT_EQUAL(0b00000000, Service_GetFilter(&msg));
+            Luos_Subscribe(default_sc.App_2.app, 3);
+            Luos_Subscribe(service, 3);
+            TEST_ASSERT_EQUAL(0b00001010, Service_GetFilter(&msg));
+            Luos_Unsubscribe(default_sc.App_2.app, 3);
+            TEST_ASSERT_EQUAL(0b00001000, Service_GetFilter(&msg));
+            Luos_Unsubscribe(service, 3);
+            TEST_ASSERT_EQUAL(0b00000000, Service_GetFilter(&msg));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_Service_Deliver(void)
 {
     NEW_TEST_CASE("Test Service_Deliver assert conditions");
@@ -514,6 +579,16 @@ void unittest_Luos_ServicesClear(void)
             TEST_ASSERT_EQUAL(0, service_ctx.number);
             TEST_ASSERT_EQUAL(0, service_ctx.list[0].id);
             TEST_ASSERT_EQUAL(0, service_ctx.list[3].id);
+
+            NEW_STEP("Check that the cleared services are not found anymore");
+            msg_t msg;
+            msg.header.target_mode = TYPE;
+            msg.header.target      = default_sc.App_1.app->type;
+            TEST_ASSERT_EQUAL(0, Service_GetFilter(&msg));
+            TEST_ASSERT_EQUAL(NULL, Service_GetConcerned(&msg.header));
+            msg.header.target_mode = SERVICEID;
+            msg.header.target      = 1;
+            TEST_ASSERT_EQUAL(0, Service_GetFilter(&msg));
         }
         CATCH
         {
@@ -538,6 +613,7 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_Service_AutoUpdateManager);
     UNIT_TEST_RUN(unittest_Service_GetConcerned);
     UNIT_TEST_RUN(unittest_Service_GetFilter);
+    UNIT_TEST_RUN(unittest_Service_UpdateLookup);
     UNIT_TEST_RUN(unittest_Service_Deliver);
     UNIT_TEST_RUN(unittest_Luos_UpdateAlias);
     UNIT_TEST_RUN(unittest_Luos_ServicesClear);
@@ -695,6 +695,47 @@ void unittest_Luos_Send_and_receive_Streaming(void)
             TEST_ASSERT_TRUE(false);
         }
     }
+    NEW_TEST_CASE("Test send receive streaming of multi bytes samples");
+    {
+        uint16_t samples[150];
+        uint16_t tx_samples[200];
+        uint16_t rx_samples[200];
+        uint16_t received[150];
+        Init_Context();
+        channel   = Streaming_CreateChannel(tx_samples, 200, sizeof(uint16_t));
+        rxchannel = Streaming_CreateChannel(rx_samples, 200, sizeof(uint16_t));
+        for (uint16_t i = 0; i < 150; i++)
+        {
+            samples[i] = 0x0100 + i;
+        }
+        revision_t revision = {.major = 1, .minor = 0, .build = 0};
+        service_t *service  = Luos_CreateService(MessageHandler, VOID_TYPE, "Test_App", revision);
+        // Detection
+        Luos_Detect(service);
+        do
+        {
+            Luos_Loop();
+        } while (!Luos_IsDetected());
+        msg_t msg;
+        msg.header.target      = service->id;
+        msg.header.target_mode = SERVICEIDACK;
+        msg.header.cmd         = IO_STATE;
+        TRY
+        {
+            // 150 samples of 2 bytes need 3 messages
+            TEST_ASSERT_EQUAL(150, Streaming_PutSample(&channel, samples, 150));
+            Luos_SendStreaming(default_sc.App_1.app, &msg, &channel);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(0, Streaming_GetAvailableSampleNB(&channel));
+            TEST_ASSERT_EQUAL(150, Streaming_GetAvailableSampleNB(&rxchannel));
+            TEST_ASSERT_EQUAL(0, Streaming_GetSample(&rxchannel, received, 150));
+            TEST_ASSERT_EQUAL_MEMORY(samples, received, sizeof(samples));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
 }
 
 int main(int argc, char **argv)
@@ -0,0 +1,252 @@
+#define WITH_TOPOLOGY_CACHE
+// Give a flash region fitting the routing table of the tested network only
+#define TOPOLOGY_CACHE_SIZE (sizeof(topology_cache_t) + 5 * sizeof(routing_table_t))
+#include <stdio.h>
+#include "unit_test.h"
+#include "routing_table.h"
+#include "../src/topology_cache.c"
+
+extern uint16_t node_service_nb[MAX_NODE_NUMBER];
+extern uint32_t node_signature[MAX_NODE_NUMBER];
+
+static connection_t connection_table[MAX_NODE_NUMBER];
+
+static void set_service_entry(routing_table_t *entry, uint16_t id, char *alias)
+{
+    memset(entry, 0, sizeof(routing_table_t));
+    entry->mode = SERVICE;
+    entry->id   = id;
+    entry->type = VOID_TYPE;
+    memcpy(entry->alias, alias, strlen(alias));
+}
+
+// Create the routing table of 2 nodes, the first one with 2 services and the second one with 1.
+static void set_network(void)
+{
+    routing_table_t *rtb = RoutingTB_Get();
+    RoutingTB_Erase();
+    rtb[0].mode    = NODE;
+    rtb[0].node_id = 1;
+    set_service_entry(&rtb[1], 1, "gate");
+    set_service_entry(&rtb[2], 2, "app");
+    rtb[3].mode    = NODE;
+    rtb[3].node_id = 2;
+    set_service_entry(&rtb[4], 3, "app1");
+    RoutingTB_ComputeRoutingTableEntryNB();
+
+    memset(connection_table, 0xFF, sizeof(connection_table));
+    connection_table[1].parent.node_id = 1;
+    connection_table[1].parent.phy_id  = 1;
+    connection_table[1].parent.port_id = 0;
+    connection_table[1].child.node_id  = 2;
+    connection_table[1].child.phy_id   = 1;
+    connection_table[1].child.port_id  = 0;
+
+    memset(node_service_nb, 0xFF, sizeof(uint16_t) * MAX_NODE_NUMBER);
+    memset(node_signature, 0, sizeof(uint32_t) * MAX_NODE_NUMBER);
+    node_service_nb[0] = 2;
+    node_service_nb[1] = 1;
+    node_signature[0]  = 0x11111111;
+    node_signature[1]  = 0x22222222;
+}
+
+static void erase_cache(void)
+{
+    topology_cache_t cache;
+    memset(&cache, 0xFF, sizeof(topology_cache_t));
+    LuosHAL_FlashWriteLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+}
+
+void unittest_TopologyCache_LocalSignature(void)
+{
+    NEW_TEST_CASE("Test TopologyCache_LocalSignature assert conditions");
+    {
+        TRY
+        {
+            TopologyCache_LocalSignature(NULL, 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check the signature of a local routing table");
+    {
+        TRY
+        {
+            routing_table_t local[2];
+            memset(local, 0, sizeof(local));
+            local[0].mode      = NODE;
+            local[0].node_info = 0x50;
+            local[0].mtu       = 128;
+            set_service_entry(&local[1], 0, "app");
+            uint32_t signature = TopologyCache_LocalSignature(local, 2);
+            TEST_ASSERT_NOT_EQUAL(0, signature);
+
+            NEW_STEP("Check that ids and connections don't change the signature");
+            local[0].node_id                   = 4;
+            local[0].connection.parent.node_id = 3;
+            local[1].id                        = 12;
+            TEST_ASSERT_EQUAL(signature, TopologyCache_LocalSignature(local, 2));
+
+            NEW_STEP("Check that an alias change modify the signature");
+            set_service_entry(&local[1], 12, "app2");
+            TEST_ASSERT_NOT_EQUAL(signature, TopologyCache_LocalSignature(local, 2));
+
+            NEW_STEP("Check that the message size modify the signature");
+            set_service_entry(&local[1], 12, "app");
+            local[0].mtu = 256;
+            TEST_ASSERT_NOT_EQUAL(signature, TopologyCache_LocalSignature(local, 2));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_TopologyCache_NetworkHash(void)
+{
+    NEW_TEST_CASE("Test TopologyCache_NetworkHash assert conditions");
+    {
+        TRY
+        {
+            TopologyCache_NetworkHash(1, NULL);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check the hash of a network");
+    {
+        TRY
+        {
+            set_network();
+            uint32_t hash = TopologyCache_NetworkHash(2, connection_table);
+            TEST_ASSERT_NOT_EQUAL(0, hash);
+            TEST_ASSERT_EQUAL(hash, TopologyCache_NetworkHash(2, connection_table));
+
+            NEW_STEP("Check that a node moved to another port modify the hash");
+            connection_table[1].parent.port_id = 1;
+            TEST_ASSERT_NOT_EQUAL(hash, TopologyCache_NetworkHash(2, connection_table));
+            connection_table[1].parent.port_id = 0;
+
+            NEW_STEP("Check that a node signature modify the hash");
+            node_signature[1] = 0x33333333;
+            TEST_ASSERT_NOT_EQUAL(hash, TopologyCache_NetworkHash(2, connection_table));
+
+            NEW_STEP("Check that a network with an unknown node can't be hashed");
+            node_signature[1] = 0;
+            TEST_ASSERT_EQUAL(0, TopologyCache_NetworkHash(2, connection_table));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_TopologyCache_SaveLoad(void)
+{
+    NEW_TEST_CASE("Check that a saved routing table is loaded on the same network");
+    {
+        TRY
+        {
+            routing_table_t saved_rtb[5];
+            set_network();
+            erase_cache();
+            TEST_ASSERT_EQUAL(FAILED, TopologyCache_Load(2, connection_table));
+
+            TopologyCache_Save(2, connection_table);
+            memcpy(saved_rtb, RoutingTB_Get(), sizeof(saved_rtb));
+            RoutingTB_Erase();
+            TEST_ASSERT_EQUAL(SUCCEED, TopologyCache_Load(2, connection_table));
+            TEST_ASSERT_EQUAL(5, RoutingTB_GetLastEntry());
+            TEST_ASSERT_EQUAL_MEMORY(saved_rtb, RoutingTB_Get(), sizeof(saved_rtb));
+            TEST_ASSERT_EQUAL(3, RoutingTB_IDFromAlias("app1"));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check that a saved routing table is not loaded on another network");
+    {
+        TRY
+        {
+            set_network();
+            erase_cache();
+            TopologyCache_Save(2, connection_table);
+            RoutingTB_Erase();
+
+            NEW_STEP("Check a node with modified services");
+            node_signature[1] = 0x33333333;
+            TEST_ASSERT_EQUAL(FAILED, TopologyCache_Load(2, connection_table));
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetLastEntry());
+
+            NEW_STEP("Check a missing node");
+            node_signature[1] = 0x22222222;
+            TEST_ASSERT_EQUAL(FAILED, TopologyCache_Load(1, connection_table));
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetLastEntry());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check that a routing table bigger than the flash region is not saved");
+    {
+        TRY
+        {
+            set_network();
+            erase_cache();
+            // Add a service to the second node, the routing table needs one more entry than the flash region have
+            set_service_entry(&RoutingTB_Get()[5], 4, "app2");
+            RoutingTB_ComputeRoutingTableEntryNB();
+            node_service_nb[1] = 2;
+            TEST_ASSERT_EQUAL(6, RoutingTB_GetLastEntry());
+            TopologyCache_Save(2, connection_table);
+            topology_cache_t cache;
+            LuosHAL_FlashReadLuosMemoryInfo(TOPOLOGY_CACHE_ADDRESS, sizeof(topology_cache_t), (uint8_t *)&cache);
+            TEST_ASSERT_EQUAL(0xFFFFFFFF, cache.hash);
+            RoutingTB_Erase();
+            TEST_ASSERT_EQUAL(FAILED, TopologyCache_Load(2, connection_table));
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetLastEntry());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check that an incomplete routing table is not saved");
+    {
+        TRY
+        {
+            set_network();
+            erase_cache();
+            // The second node didn't answer during the routing table generation
+            RoutingTB_RemoveNode(2);
+            TopologyCache_Save(2, connection_table);
+            TEST_ASSERT_EQUAL(FAILED, TopologyCache_Load(2, connection_table));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Topology cache functions
+    UNIT_TEST_RUN(unittest_TopologyCache_LocalSignature);
+    UNIT_TEST_RUN(unittest_TopologyCache_NetworkHash);
+    UNIT_TEST_RUN(unittest_TopologyCache_SaveLoad);
+
+    UNITY_END();
+}
@@ -7,33 +7,33 @@ void unittest_Od_time(void)
     NEW_TEST_CASE("Time FROM test");
     {
         time_luos_t time;
-        time_luos_t time_ref = {1000.5f};
+        time_luos_t time_ref = TimeOD_TimeFrom_s(1000.5f);
 
         NEW_STEP("Time FROM seconds test");
         time = TimeOD_TimeFrom_s(1000.5f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM ms test");
         time = TimeOD_TimeFrom_ms(1000500.0f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM us test");
         time = TimeOD_TimeFrom_us(1000500000.0f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM ns test");
         time = TimeOD_TimeFrom_ns(1000500000000.0f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM min test");
         time = TimeOD_TimeFrom_min(16.675f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM hour test");
         time = TimeOD_TimeFrom_h(0.2779166666666667f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
         NEW_STEP("Time FROM day test");
         time = TimeOD_TimeFrom_day(0.0115798611f);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_s(time_ref), (uint32_t)TimeOD_TimeTo_s(time));
     }
     NEW_TEST_CASE("Time TO test");
     {
-        time_luos_t time = {1000.0f};
+        time_luos_t time = TimeOD_TimeFrom_s(1000.0f);
 
         NEW_STEP("Time TO seconds test");
         float s = TimeOD_TimeTo_s(time);
@@ -60,21 +60,41 @@ void unittest_Od_time(void)
     NEW_TEST_CASE("Time msg conversion test");
     {
         time_luos_t time;
-        time_luos_t time_ref = {1000.0f};
+        time_luos_t time_ref      = TimeOD_TimeFrom_s(1000.0f);
+        time_luos_wire_t wire_ref = 1000.0;
+        time_luos_wire_t wire;
         msg_t msg_ref;
         msg_t msg;
 
         NEW_STEP("Time msg conversion FROM test");
         msg_ref.header.cmd  = TIME;
-        msg_ref.header.size = sizeof(time_luos_t);
-        memcpy(msg_ref.data, &time_ref, sizeof(time_luos_t));
+        msg_ref.header.size = sizeof(time_luos_wire_t);
+        memcpy(msg_ref.data, &wire_ref, sizeof(time_luos_wire_t));
         TimeOD_TimeFromMsg(&time, &msg_ref);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        TEST_ASSERT_EQUAL((uint32_t)TimeOD_TimeTo_ms(time_ref), (uint32_t)TimeOD_TimeTo_ms(time));
         NEW_STEP("Time msg conversion TO test");
         TimeOD_TimeToMsg(&time, &msg);
         TEST_ASSERT_EQUAL(msg_ref.header.cmd, msg.header.cmd);
         TEST_ASSERT_EQUAL(msg_ref.header.size, msg.header.size);
-        TEST_ASSERT_EQUAL((uint32_t)time_ref.raw, (uint32_t)time.raw);
+        memcpy(&wire, msg.data, sizeof(time_luos_wire_t));
+        TEST_ASSERT_EQUAL((uint32_t)(wire_ref * 1000.0), (uint32_t)(wire * 1000.0));
+    }
+    NEW_TEST_CASE("Time msg wire format test");
+    {
+        time_luos_t time = TimeOD_TimeFrom_ms(1500.0f);
+        time_luos_wire_t wire;
+        msg_t msg;
+
+        NEW_STEP("Time is sent as a double number of seconds");
+        TimeOD_TimeToMsg(&time, &msg);
+        TEST_ASSERT_EQUAL(sizeof(double), msg.header.size);
+        memcpy(&wire, msg.data, sizeof(time_luos_wire_t));
+        TEST_ASSERT_EQUAL(1.5, wire);
+        NEW_STEP("Time is received from a double number of seconds");
+        wire = 2.25;
+        memcpy(msg.data, &wire, sizeof(time_luos_wire_t));
+        TimeOD_TimeFromMsg(&time, &msg);
+        TEST_ASSERT_EQUAL(2250, (uint32_t)TimeOD_TimeTo_ms(time));
     }
     NEW_TEST_CASE("Time msg conversion wrong values test");
     {
@@ -220,6 +220,7 @@ void unittest_Filter_Type()
         TRY
         {
             service_ctx.number = 0;
+            Service_UpdateLookup();
             TEST_ASSERT_EQUAL(false, Phy_FilterType(0));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(1));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(2));
@@ -237,6 +238,7 @@ void unittest_Filter_Type()
         {
             service_ctx.number       = 1;
             service_ctx.list[0].type = 0;
+            Service_UpdateLookup();
             TEST_ASSERT_EQUAL(true, Phy_FilterType(0));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(1));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(2));
@@ -251,6 +253,7 @@ void unittest_Filter_Type()
         {
             service_ctx.number       = 1;
             service_ctx.list[0].type = 1;
+            Service_UpdateLookup();
             TEST_ASSERT_EQUAL(false, Phy_FilterType(0));
             TEST_ASSERT_EQUAL(true, Phy_FilterType(1));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(2));
@@ -265,6 +268,7 @@ void unittest_Filter_Type()
         {
             service_ctx.number       = 1;
             service_ctx.list[0].type = 12;
+            Service_UpdateLookup();
             TEST_ASSERT_EQUAL(false, Phy_FilterType(0));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(1));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(2));
@@ -280,6 +284,7 @@ void unittest_Filter_Type()
             service_ctx.number       = 2;
             service_ctx.list[0].type = 1;
             service_ctx.list[1].type = 12;
+            Service_UpdateLookup();
             TEST_ASSERT_EQUAL(false, Phy_FilterType(0));
             TEST_ASSERT_EQUAL(true, Phy_FilterType(1));
             TEST_ASSERT_EQUAL(false, Phy_FilterType(2));
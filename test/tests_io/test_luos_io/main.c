@@ -36,6 +36,88 @@ static void luosIO_reset_overlap_callback(void)
     TEST_ASSERT_EQUAL(&phy_ctx.phy[0], luos_phy);
 }
 
+// Count the messages queued on the robus phy with this command and target, 0 for any target.
+static uint16_t luosIO_count_jobs(uint8_t cmd, uint16_t target)
+{
+    uint16_t msg_nb = 0;
+    phy_job_t *job  = NULL;
+    while ((job = Phy_GetNextJob(&phy_ctx.phy[1], job)) != NULL)
+    {
+        if ((job->msg_pt->header.cmd == cmd) && ((target == 0) || (job->msg_pt->header.target == target)))
+        {
+            msg_nb++;
+        }
+    }
+    return msg_nb;
+}
+
+// Consider all the queued messages as sent
+static void luosIO_flush_jobs(void)
+{
+    phy_job_t *job;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        while ((job = Phy_GetJob(&phy_ctx.phy[i])) != NULL)
+        {
+            Phy_RmJob(&phy_ctx.phy[i], job);
+        }
+    }
+}
+
+// Wait for the end of a repair pass
+static void luosIO_wait_repair_timeout(void)
+{
+    uint32_t start_tick = LuosHAL_GetSystick();
+    while ((LuosHAL_GetSystick() - start_tick) <= RTB_REPAIR_TIMEOUT_MS)
+        ;
+}
+
+// Report the missed chunks of a node to the detecting node, without chunks the node confirm the reception.
+static void luosIO_send_nack(uint8_t pass, uint16_t node_id, uint8_t chunks, bool complete)
+{
+    msg_t msg;
+    msg.header.cmd         = RTB_NACK;
+    msg.header.target_mode = NODEIDACK;
+    msg.header.target      = 1;
+    msg.header.size        = complete ? RTB_NACK_HEADER_SIZE : RTB_NACK_HEADER_SIZE + 1;
+    msg.data[0]            = pass;
+    memcpy(&msg.data[1], &node_id, sizeof(uint16_t));
+    msg.data[RTB_NACK_HEADER_SIZE] = chunks;
+    TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+}
+
+// Create a detecting node and 2 other nodes each having a service, the routing table need 2 chunks.
+static service_t *luosIO_share_context(void)
+{
+    luosIO_reset_overlap_callback();
+    RoutingTB_Erase();
+    Node_Get()->node_id    = 1;
+    Node_Get()->node_info  = 0;
+    service_ctx.number     = 1;
+    service_ctx.list[0].id = 1;
+    // Allow us to reach the other nodes through the robus phy
+    phy_ctx.phy_nb = 2;
+    Phy_IndexSet(phy_ctx.phy[1].nodes, 2);
+    Phy_IndexSet(phy_ctx.phy[1].nodes, 3);
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        routing_table_t *node    = &routing_table[2 * i];
+        routing_table_t *service = &routing_table[2 * i + 1];
+        memset(node, 0, 2 * sizeof(routing_table_t));
+        node->mode                      = NODE;
+        node->node_id                   = i + 1;
+        node->node_info                 = PROTOCOL_REVISION << 4;
+        node->connection.parent.node_id = i;
+        node->connection.parent.phy_id  = (i == 0) ? 0 : 1;
+        service->mode                   = SERVICE;
+        service->id                     = i + 1;
+    }
+    last_routing_table_entry = 6;
+    last_service             = 3;
+    TEST_ASSERT_EQUAL(2, (last_routing_table_entry * sizeof(routing_table_t) + RTB_CHUNK_SIZE - 1) / RTB_CHUNK_SIZE);
+    return &service_ctx.list[0];
+}
+
 /*******************************************************************************
  * File function
  ******************************************************************************/
@@ -246,6 +328,61 @@ void unittest_luosIO_ConsumeMsg()
         END_TRY;
     }
 
+    NEW_TEST_CASE("Check PORT_DATA treatment with the number of services");
+    {
+        TRY
+        {
+            luosIO_reset_overlap_callback();
+            Luos_handled_job                       = NULL;
+            last_node                              = 2;
+            connection_table_ptr[1].parent.node_id = 2;
+            Node_Get()->node_id                    = 1;
+            memset(node_service_nb, 0xFF, sizeof(node_service_nb));
+            memset(node_signature, 0, sizeof(node_signature));
+            msg_t msg;
+            uint16_t service_nb;
+            uint32_t signature;
+            msg.header.cmd  = PORT_DATA;
+            msg.header.size = sizeof(port_t);
+            port_t port;
+            port.node_id = 1;
+            port.phy_id  = 2;
+            port.port_id = 3;
+            memcpy(msg.data, &port, sizeof(port_t));
+
+            NEW_STEP("Check that an old node don't give its number of services");
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(FAILED, LuosIO_GetNodeServiceNb(2, &service_nb));
+
+            NEW_STEP("Check that a recent node give its number of services");
+            service_nb = 7;
+            memcpy(&msg.data[sizeof(port_t)], &service_nb, sizeof(uint16_t));
+            msg.header.size = sizeof(port_t) + sizeof(uint16_t);
+            service_nb      = 0;
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(3, connection_table_ptr[1].child.port_id);
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_GetNodeServiceNb(2, &service_nb));
+            TEST_ASSERT_EQUAL(7, service_nb);
+            TEST_ASSERT_EQUAL(FAILED, LuosIO_GetNodeSignature(2, &signature));
+
+            NEW_STEP("Check that a node supporting the topology cache give its signature");
+            signature = 0x12345678;
+            memcpy(&msg.data[sizeof(port_t) + sizeof(uint16_t)], &signature, sizeof(uint32_t));
+            msg.header.size = sizeof(port_t) + sizeof(uint16_t) + sizeof(uint32_t);
+            signature       = 0;
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_GetNodeServiceNb(2, &service_nb));
+            TEST_ASSERT_EQUAL(7, service_nb);
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_GetNodeSignature(2, &signature));
+            TEST_ASSERT_EQUAL(0x12345678, signature);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
     NEW_TEST_CASE("Check LOCAL_RTB assert condition");
     {
         TRY
@@ -346,13 +483,213 @@ void unittest_luosIO_ConsumeMsg()
         END_TRY;
     }
 
+    NEW_TEST_CASE("Check LOCAL_RTB size 4 treatment (generation of service id + send of local rtb entries)");
+    {
+        TRY
+        {
+            msg_t msg;
+            luosIO_reset_overlap_callback();
+            Luos_handled_job       = NULL;
+            Robus_handled_job      = NULL;
+            Node_Get()->node_id    = 1;
+            service_ctx.number     = 2;
+            service_ctx.list[0].id = 0;
+            service_ctx.list[1].id = 0;
+
+            msg.header.cmd    = LOCAL_RTB;
+            msg.header.size   = 4;
+            msg.header.source = 1;
+            uint16_t first_id = 4;
+            uint16_t entry    = 6;
+            memcpy((void *)msg.data, (void *)&first_id, sizeof(uint16_t));
+            memcpy((void *)&msg.data[2], (void *)&entry, sizeof(uint16_t));
+
+            error_return_t ret_val = LuosIO_ConsumeMsg(&msg);
+
+            // Check received message content
+            TEST_ASSERT_EQUAL(SUCCEED, ret_val);
+            TEST_ASSERT_NOT_EQUAL(NULL, Luos_handled_job);
+            TEST_ASSERT_EQUAL(NULL, Robus_handled_job);
+            TEST_ASSERT_EQUAL(RTB_ENTRIES, Luos_handled_job->msg_pt->header.cmd);
+            TEST_ASSERT_EQUAL(1, Luos_handled_job->msg_pt->header.target);
+            TEST_ASSERT_EQUAL(sizeof(uint16_t) + 3 * sizeof(routing_table_t), Luos_handled_job->msg_pt->header.size);
+            TEST_ASSERT_EQUAL(NODEIDACK, Luos_handled_job->msg_pt->header.target_mode);
+            memcpy((void *)&entry, (void *)Luos_handled_job->msg_pt->data, sizeof(uint16_t));
+            TEST_ASSERT_EQUAL(6, entry);
+            routing_table_t rtb[3];
+            memcpy((void *)rtb, (void *)&Luos_handled_job->msg_pt->data[2], 3 * sizeof(routing_table_t));
+            TEST_ASSERT_EQUAL(NODE, rtb[0].mode);
+            TEST_ASSERT_EQUAL(SERVICE, rtb[1].mode);
+            TEST_ASSERT_EQUAL(SERVICE, rtb[2].mode);
+            TEST_ASSERT_EQUAL(4, rtb[1].id);
+            TEST_ASSERT_EQUAL(5, rtb[2].id);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check SERVICE_BASE_ID treatment (generation of service id without answer)");
+    {
+        TRY
+        {
+            msg_t msg;
+            luosIO_reset_overlap_callback();
+            Luos_handled_job       = NULL;
+            Robus_handled_job      = NULL;
+            Node_Get()->node_id    = 3;
+            service_ctx.number     = 2;
+            service_ctx.list[0].id = 0;
+            service_ctx.list[1].id = 0;
+
+            msg.header.cmd    = SERVICE_BASE_ID;
+            msg.header.size   = sizeof(uint16_t);
+            msg.header.source = 1;
+            uint16_t first_id = 7;
+            memcpy((void *)msg.data, (void *)&first_id, sizeof(uint16_t));
+
+            error_return_t ret_val = LuosIO_ConsumeMsg(&msg);
+
+            TEST_ASSERT_EQUAL(SUCCEED, ret_val);
+            TEST_ASSERT_EQUAL(NULL, Luos_handled_job);
+            TEST_ASSERT_EQUAL(NULL, Robus_handled_job);
+            TEST_ASSERT_EQUAL(7, service_ctx.list[0].id);
+            TEST_ASSERT_EQUAL(8, service_ctx.list[1].id);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check broadcasted RTB reception and repair");
+    {
+        TRY
+        {
+            msg_t msg;
+            luosIO_reset_overlap_callback();
+            RoutingTB_Erase();
+            Node_Get()->node_id    = 2;
+            Node_Get()->node_info  = 0;
+            service_ctx.number     = 1;
+            service_ctx.list[0].id = 2;
+            Service_GenerateId(2);
+            // Allow us to reach the detecting node through the robus phy
+            phy_ctx.phy_nb = 2;
+            Phy_IndexSet(phy_ctx.phy[1].nodes, 1);
+
+            // Create a routing table needing 2 chunks
+            routing_table_t rtb[10];
+            uint16_t size = sizeof(rtb);
+            memset(rtb, 0, sizeof(rtb));
+            for (uint16_t i = 0; i < 10; i++)
+            {
+                rtb[i].mode = SERVICE;
+                rtb[i].id   = i + 1;
+            }
+            msg.header.cmd = RTB_CHUNK;
+            memcpy(&msg.data[2], &size, sizeof(uint16_t));
+
+            NEW_STEP("Receive the second chunk only");
+            uint16_t seq = 1;
+            memcpy(msg.data, &seq, sizeof(uint16_t));
+            memcpy(&msg.data[4], (uint8_t *)rtb + RTB_CHUNK_SIZE, size - RTB_CHUNK_SIZE);
+            msg.header.size = 4 + size - RTB_CHUNK_SIZE;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(0, RoutingTB_GetLastEntry());
+
+            NEW_STEP("Check that the missing chunk is reported to the detecting node");
+            uint16_t node_id;
+            Luos_handled_job  = NULL;
+            Robus_handled_job = NULL;
+            msg.header.cmd    = RTB_REPAIR;
+            msg.header.size   = RTB_REPAIR_SIZE;
+            memcpy(msg.data, &size, sizeof(uint16_t));
+            msg.data[2] = 7;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_NOT_EQUAL(NULL, Robus_handled_job);
+            TEST_ASSERT_EQUAL(RTB_NACK, Robus_handled_job->msg_pt->header.cmd);
+            TEST_ASSERT_EQUAL(1, Robus_handled_job->msg_pt->header.target);
+            TEST_ASSERT_EQUAL(RTB_NACK_HEADER_SIZE + 1, Robus_handled_job->msg_pt->header.size);
+            TEST_ASSERT_EQUAL(7, Robus_handled_job->msg_pt->data[0]);
+            memcpy(&node_id, &Robus_handled_job->msg_pt->data[1], sizeof(uint16_t));
+            TEST_ASSERT_EQUAL(2, node_id);
+            TEST_ASSERT_EQUAL(0x01, Robus_handled_job->msg_pt->data[RTB_NACK_HEADER_SIZE]);
+
+            NEW_STEP("Receive the missing chunk and check the routing table");
+            msg.header.cmd = RTB_CHUNK;
+            seq            = 0;
+            memcpy(msg.data, &seq, sizeof(uint16_t));
+            memcpy(&msg.data[2], &size, sizeof(uint16_t));
+            memcpy(&msg.data[4], (uint8_t *)rtb, RTB_CHUNK_SIZE);
+            msg.header.size = 4 + RTB_CHUNK_SIZE;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(10, RoutingTB_GetLastEntry());
+            TEST_ASSERT_EQUAL_MEMORY(rtb, RoutingTB_Get(), sizeof(rtb));
+
+            NEW_STEP("Check that a complete node confirm the reception");
+            Luos_handled_job  = NULL;
+            Robus_handled_job = NULL;
+            msg.header.cmd    = RTB_REPAIR;
+            msg.header.size   = RTB_REPAIR_SIZE;
+            memcpy(msg.data, &size, sizeof(uint16_t));
+            msg.data[2] = 8;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_NOT_EQUAL(NULL, Robus_handled_job);
+            TEST_ASSERT_EQUAL(RTB_NACK, Robus_handled_job->msg_pt->header.cmd);
+            TEST_ASSERT_EQUAL(RTB_NACK_HEADER_SIZE, Robus_handled_job->msg_pt->header.size);
+            TEST_ASSERT_EQUAL(8, Robus_handled_job->msg_pt->data[0]);
+
+            NEW_STEP("Check that the detecting node gather the missing chunks of the current pass");
+            memset(&rtb_repair, 0, sizeof(rtb_repair));
+            rtb_repair.pass       = 8;
+            rtb_repair.collecting = true;
+            msg.header.cmd        = RTB_NACK;
+            msg.header.size       = RTB_NACK_HEADER_SIZE + 1;
+            msg.data[0]           = 8;
+            memcpy(&msg.data[1], &node_id, sizeof(uint16_t));
+            msg.data[RTB_NACK_HEADER_SIZE] = 0x01;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            msg.data[RTB_NACK_HEADER_SIZE] = 0x04;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(0x05, rtb_repair.missing_chunks[0]);
+            TEST_ASSERT_EQUAL(0, rtb_repair.confirmed_nodes[0]);
+
+            NEW_STEP("Check that the reports of another pass are ignored");
+            msg.data[0]                    = 7;
+            msg.data[RTB_NACK_HEADER_SIZE] = 0x02;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(0x05, rtb_repair.missing_chunks[0]);
+
+            NEW_STEP("Check that the reports coming after the end of the pass are ignored");
+            rtb_repair.collecting = false;
+            msg.data[0]           = 8;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(0x05, rtb_repair.missing_chunks[0]);
+
+            NEW_STEP("Check that the detecting node save the confirmations");
+            rtb_repair.collecting = true;
+            msg.header.size       = RTB_NACK_HEADER_SIZE;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(1 << 2, rtb_repair.confirmed_nodes[0]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
     NEW_TEST_CASE("Check START_DETECTION");
     {
         TRY
         {
             msg_t msg;
             luosIO_reset_overlap_callback();
-            phy_ctx.io_job_nb = 3;
+            phy_ctx.io_job[0].head = 3;
             Node_SetState(DETECTION_OK);
             service_ctx.list[0].id = 1;
             service_ctx.list[1].id = 2;
@@ -365,7 +702,7 @@ void unittest_luosIO_ConsumeMsg()
 
             // Check received message content
             TEST_ASSERT_EQUAL(SUCCEED, ret_val);
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
         }
         CATCH
         {
@@ -398,6 +735,45 @@ void unittest_luosIO_ConsumeMsg()
         }
     }
 
+    NEW_TEST_CASE("Check END_DETECTION protocol revision and message size");
+    {
+        TRY
+        {
+            msg_t msg;
+            luosIO_reset_overlap_callback();
+            Node_SetState(EXTERNAL_DETECTION);
+
+            // An old master don't send any revision
+            msg.header.cmd  = END_DETECTION;
+            msg.header.size = 0;
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(0, Node_GetProtocolRevision());
+
+            Node_SetState(EXTERNAL_DETECTION);
+            msg.header.size = 1;
+            msg.data[0]     = PROTOCOL_REVISION;
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(PROTOCOL_REVISION, Node_GetProtocolRevision());
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Luos_GetMtu());
+
+            // The message size can't be out of the range this node can handle
+            uint16_t mtu = BASE_DATA_MSG_SIZE / 2;
+            Node_SetState(EXTERNAL_DETECTION);
+            msg.header.size = 3;
+            memcpy(&msg.data[1], &mtu, sizeof(uint16_t));
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Luos_GetMtu());
+            mtu = MAX_DATA_MSG_SIZE + 1;
+            memcpy(&msg.data[1], &mtu, sizeof(uint16_t));
+            LuosIO_ConsumeMsg(&msg);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, Luos_GetMtu());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+
     NEW_TEST_CASE("Check ASK_DETECTION");
     {
         // No detection running
@@ -801,6 +1177,310 @@ void unittest_luosIO_ConsumeMsg()
     }
 }
 
+void unittest_luosIO_ShareRoutingTable()
+{
+    NEW_TEST_CASE("Check the repair passes of a broadcasted RTB and the unicast fallback");
+    {
+        TRY
+        {
+            service_t *service = luosIO_share_context();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that all the chunks are broadcasted followed by a repair request");
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_EQUAL(2, luosIO_count_jobs(RTB_CHUNK, 0));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_REPAIR, 0));
+            uint8_t pass = rtb_repair.pass;
+
+            NEW_STEP("Check that the repair timeout don't start before the end of the transmission");
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_wait_repair_timeout();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_REPAIR, 0));
+            luosIO_flush_jobs();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+
+            NEW_STEP("Check that only the chunks missed during this pass are broadcasted again");
+            luosIO_send_nack(pass - 1, 2, 0x02, false);
+            luosIO_send_nack(pass, 2, 0x01, false);
+            luosIO_send_nack(pass, 3, 0x00, true);
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_wait_repair_timeout();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_CHUNK, 0));
+            TEST_ASSERT_EQUAL(0, Phy_GetJob(&phy_ctx.phy[1])->msg_pt->data[0]);
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_REPAIR, 0));
+            TEST_ASSERT_EQUAL(pass + 1, rtb_repair.pass);
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that a silent node is asked again, ignoring the late reports");
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_send_nack(pass, 2, 0x02, false);
+            luosIO_wait_repair_timeout();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB_CHUNK, 0));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_REPAIR, 0));
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that the routing table is sent only to the node not confirming after the last pass");
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_wait_repair_timeout();
+            TEST_ASSERT_TRUE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_NOT_EQUAL(0, luosIO_count_jobs(RTB, 2));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB, 3));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB_REPAIR, 0));
+            luosIO_flush_jobs();
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that the RTB share end when all the nodes confirmed the reception");
+    {
+        TRY
+        {
+            service_t *service = luosIO_share_context();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_flush_jobs();
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_send_nack(rtb_repair.pass, 2, 0x00, true);
+            TEST_ASSERT_FALSE(RoutingTB_Share(service, 3));
+            luosIO_send_nack(rtb_repair.pass, 3, 0x00, true);
+            TEST_ASSERT_TRUE(RoutingTB_Share(service, 3));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB, 0));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB_REPAIR, 0));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+// Create a detected network of 2 nodes each having a service, node 1 is the detecting node.
+static void luosIO_branch_context(void)
+{
+    luosIO_reset_overlap_callback();
+    RoutingTB_Erase();
+    Node_Get()->node_id = 1;
+    Node_SetState(DETECTION_OK);
+    Node_SetProtocolRevision(PROTOCOL_REVISION);
+    service_ctx.number     = 1;
+    service_ctx.list[0].id = 1;
+    branch_node            = 0;
+    detection_service      = NULL;
+    Flag_DetectServices    = false;
+    // Allow us to reach the other nodes through the robus phy
+    phy_ctx.phy_nb = 2;
+    Phy_IndexSet(phy_ctx.phy[1].nodes, 2);
+    Phy_IndexSet(phy_ctx.phy[1].nodes, 3);
+    for (uint16_t i = 0; i < 2; i++)
+    {
+        routing_table_t *node    = &routing_table[2 * i];
+        routing_table_t *service = &routing_table[2 * i + 1];
+        memset(node, 0, 2 * sizeof(routing_table_t));
+        memset(&node->connection, 0xFF, sizeof(connection_t));
+        node->mode      = NODE;
+        node->node_id   = i + 1;
+        node->node_info = PROTOCOL_REVISION << 4;
+        service->mode   = SERVICE;
+        service->id     = i + 1;
+    }
+    routing_table[2].connection.parent.node_id = 1;
+    routing_table[2].connection.parent.phy_id  = 1;
+    routing_table[2].connection.parent.port_id = 0;
+    routing_table[2].connection.child.node_id  = 2;
+    routing_table[2].connection.child.phy_id   = 1;
+    routing_table[2].connection.child.port_id  = 0;
+    last_routing_table_entry                   = 4;
+    last_service                               = 2;
+}
+
+// Send an ASK_DETECTION message asking for the new nodes connected to a node
+static void luosIO_ask_branch_detection(uint16_t node_id)
+{
+    msg_t msg;
+    msg.header.cmd         = ASK_DETECTION;
+    msg.header.target_mode = BROADCAST;
+    msg.header.target      = BROADCAST_VAL;
+    msg.header.size        = sizeof(uint16_t);
+    memcpy(msg.data, &node_id, sizeof(uint16_t));
+    TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+}
+
+void unittest_luosIO_BranchDetection()
+{
+    NEW_TEST_CASE("Check the detection of a new branch from ASK_DETECTION to END_DETECTION");
+    {
+        TRY
+        {
+            luosIO_branch_context();
+            msg_t msg;
+            port_t port;
+            uint16_t node_id;
+
+            NEW_STEP("Check that ASK_DETECTION start a branch detection without full detection");
+            luosIO_ask_branch_detection(2);
+            TEST_ASSERT_EQUAL(2, branch_node);
+            TEST_ASSERT_EQUAL(&service_ctx.list[0], detection_service);
+            TEST_ASSERT_EQUAL(false, Flag_DetectServices);
+
+            NEW_STEP("Check that the node is asked to look for new nodes");
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(BRANCH_DETECTION, 0));
+            memcpy(&node_id, Phy_GetJob(&phy_ctx.phy[1])->msg_pt->data, sizeof(uint16_t));
+            TEST_ASSERT_EQUAL(2, node_id);
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that a new node get the id following the ones of the network");
+            msg.header.cmd  = CONNECTION_DATA;
+            msg.header.size = sizeof(port_t);
+            port.node_id    = 2;
+            port.phy_id     = 1;
+            port.port_id    = 1;
+            memcpy(msg.data, &port, sizeof(port_t));
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(NODE_ID, 0));
+            memcpy(&node_id, Phy_GetJob(&phy_ctx.phy[1])->msg_pt->data, sizeof(uint16_t));
+            TEST_ASSERT_EQUAL(3, node_id);
+            luosIO_flush_jobs();
+            msg.header.cmd  = PORT_DATA;
+            msg.header.size = sizeof(port_t);
+            port.node_id    = 3;
+            port.phy_id     = 1;
+            port.port_id    = 0;
+            memcpy(msg.data, &port, sizeof(port_t));
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+
+            NEW_STEP("Check that the local routing table of the new node is asked when the node is done");
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(LOCAL_RTB, 0));
+            msg.header.cmd         = BRANCH_DETECTION;
+            msg.header.target_mode = NODEIDACK;
+            msg.header.target      = 1;
+            msg.header.size        = 0;
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(LOCAL_RTB, 3));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(END_DETECTION, 0));
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that the new node answer is added to the routing table");
+            routing_table_t local_rtb[2];
+            memset(local_rtb, 0, sizeof(local_rtb));
+            local_rtb[0].mode      = NODE;
+            local_rtb[0].node_id   = 3;
+            local_rtb[0].node_info = PROTOCOL_REVISION << 4;
+            local_rtb[1].mode      = SERVICE;
+            local_rtb[1].id        = 3;
+            msg.header.cmd         = RTB;
+            msg.header.target_mode = NODEIDACK;
+            msg.header.target      = 1;
+            msg.header.source      = 3;
+            msg.header.size        = sizeof(local_rtb);
+            memcpy(msg.data, local_rtb, sizeof(local_rtb));
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(6, last_routing_table_entry);
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(2, routing_table[4].connection.parent.node_id);
+            TEST_ASSERT_EQUAL(1, routing_table[4].connection.parent.port_id);
+            TEST_ASSERT_EQUAL(3, routing_table[4].connection.child.node_id);
+            luosIO_flush_jobs();
+
+            NEW_STEP("Check that only the new entries are sent to the old nodes before the end of the detection");
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(2, branch_node);
+            LuosIO_Loop();
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(RTB_DELTA, 2));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB_DELTA, 3));
+            TEST_ASSERT_NOT_EQUAL(0, luosIO_count_jobs(RTB, 3));
+            TEST_ASSERT_EQUAL(0, luosIO_count_jobs(RTB, 2));
+            TEST_ASSERT_EQUAL(1, luosIO_count_jobs(END_DETECTION, 0));
+            phy_job_t *job = NULL;
+            while ((job = Phy_GetNextJob(&phy_ctx.phy[1], job)) != NULL)
+            {
+                if (job->msg_pt->header.cmd == RTB_DELTA)
+                {
+                    TEST_ASSERT_EQUAL(2 * sizeof(routing_table_t), job->msg_pt->header.size);
+                    TEST_ASSERT_EQUAL_MEMORY(&routing_table[4], job->msg_pt->data, 2 * sizeof(routing_table_t));
+                }
+            }
+            TEST_ASSERT_EQUAL(0, branch_node);
+            TEST_ASSERT_EQUAL(NULL, detection_service);
+            luosIO_flush_jobs();
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a network using an older protocol revision fallback to a full detection");
+    {
+        TRY
+        {
+            luosIO_branch_context();
+            Node_SetProtocolRevision(5);
+            luosIO_ask_branch_detection(2);
+            TEST_ASSERT_EQUAL(0, branch_node);
+            TEST_ASSERT_EQUAL(true, Flag_DetectServices);
+            TEST_ASSERT_EQUAL(&service_ctx.list[0], detection_service);
+
+            NEW_STEP("Check that a node not detected yet also run a full detection");
+            luosIO_branch_context();
+            Node_SetState(NO_DETECTION);
+            luosIO_ask_branch_detection(2);
+            TEST_ASSERT_EQUAL(0, branch_node);
+            TEST_ASSERT_EQUAL(true, Flag_DetectServices);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a branch detection never ended by END_DETECTION is stopped");
+    {
+        TRY
+        {
+            luosIO_reset_overlap_callback();
+            Node_Get()->node_id = 2;
+            msg_t msg;
+            uint16_t node_id       = 3;
+            msg.header.cmd         = BRANCH_DETECTION;
+            msg.header.target_mode = BROADCAST;
+            msg.header.target      = BROADCAST_VAL;
+            msg.header.size        = sizeof(uint16_t);
+            memcpy(msg.data, &node_id, sizeof(uint16_t));
+            TEST_ASSERT_EQUAL(SUCCEED, LuosIO_ConsumeMsg(&msg));
+            TEST_ASSERT_EQUAL(true, phy_ctx.branch_detection);
+            TEST_ASSERT_EQUAL(false, branch_scan);
+            Phy_Loop();
+            TEST_ASSERT_EQUAL(true, phy_ctx.branch_detection);
+
+            NEW_STEP("Check that the flag is cleared after the timeout");
+            phy_ctx.branch_date = LuosHAL_GetSystick() - BRANCH_DETECTION_END_TIMEOUT_MS - 1;
+            Phy_Loop();
+            TEST_ASSERT_EQUAL(false, phy_ctx.branch_detection);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_luosIO_DetectNextNodes()
 {
     NEW_TEST_CASE("This function is highly intricated with Robus for now. It makes it difficult to test. We will keep it for later");
@@ -948,6 +1628,8 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_luosIO_loop);
     UNIT_TEST_RUN(unittest_luosIO_TransmitLocalRoutingTable);
     UNIT_TEST_RUN(unittest_luosIO_ConsumeMsg);
+    UNIT_TEST_RUN(unittest_luosIO_ShareRoutingTable);
+    UNIT_TEST_RUN(unittest_luosIO_BranchDetection);
     UNIT_TEST_RUN(unittest_luosIO_DetectNextNodes);
     UNIT_TEST_RUN(unittest_luosIO_GetNextJob);
     UNIT_TEST_RUN(unittest_luosIO_RmJob);
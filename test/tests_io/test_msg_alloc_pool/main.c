@@ -0,0 +1,311 @@
+#define WITH_MSGALLOC_POOLS
+#include "unit_test.h"
+#include "../src/msg_alloc.c"
+
+void unittest_MsgAlloc_Init(void)
+{
+    NEW_TEST_CASE("Check the pools layout");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            // Pools are sorted from the smallest blocks to the biggest
+            TEST_ASSERT_EQUAL(POOL_SMALL_BLOCK_SIZE, pools[POOL_SMALL].block_size);
+            TEST_ASSERT_EQUAL(POOL_MEDIUM_BLOCK_SIZE, pools[POOL_MEDIUM].block_size);
+            TEST_ASSERT_EQUAL(POOL_LARGE_BLOCK_SIZE, pools[POOL_LARGE].block_size);
+            TEST_ASSERT_NOT_EQUAL(0, pools[POOL_SMALL].block_nb);
+            TEST_ASSERT_NOT_EQUAL(0, pools[POOL_MEDIUM].block_nb);
+            TEST_ASSERT_NOT_EQUAL(0, pools[POOL_LARGE].block_nb);
+            // Large blocks are at the begining of the buffer, and every pools fit in it
+            TEST_ASSERT_EQUAL(0, pools[POOL_LARGE].offset);
+            TEST_ASSERT_EQUAL(pools[POOL_MEDIUM].offset, pools[POOL_LARGE].block_nb * pools[POOL_LARGE].block_size);
+            TEST_ASSERT_EQUAL(pools[POOL_SMALL].offset, pools[POOL_MEDIUM].offset + pools[POOL_MEDIUM].block_nb * pools[POOL_MEDIUM].block_size);
+            TEST_ASSERT_TRUE(pools[POOL_SMALL].offset + pools[POOL_SMALL].block_nb * pools[POOL_SMALL].block_size <= MSG_BUFFER_SIZE);
+            TEST_ASSERT_EQUAL(SUCCEED, MsgAlloc_IsEmpty());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+void unittest_MsgAlloc_Alloc(void)
+{
+    NEW_TEST_CASE("Check if we assert when we try to allocate a bad size or without phy");
+    {
+        MsgAlloc_Init(NULL);
+        TRY
+        {
+            MsgAlloc_Alloc(0, 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            MsgAlloc_Alloc(MSG_BUFFER_SIZE + 1, 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            MsgAlloc_Alloc(sizeof(header_t), 0);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that messages are allocated in the smallest pool able to store them");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            NEW_STEP("Small message");
+            TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_SMALL].offset], MsgAlloc_Alloc(sizeof(header_t), 1));
+            NEW_STEP("Medium message");
+            TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_MEDIUM].offset], MsgAlloc_Alloc(POOL_SMALL_BLOCK_SIZE + 1, 1));
+            NEW_STEP("Large message");
+            TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_LARGE].offset], MsgAlloc_Alloc(sizeof(msg_t), 1));
+            NEW_STEP("Next small message take the next small block");
+            TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_SMALL].offset + POOL_SMALL_BLOCK_SIZE], MsgAlloc_Alloc(sizeof(header_t), 1));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+
+    NEW_TEST_CASE("Check that messages spill over bigger pools when their pool is full");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            for (uint16_t i = 0; i < pools[POOL_SMALL].block_nb; i++)
+            {
+                TEST_ASSERT_NOT_EQUAL(NULL, MsgAlloc_Alloc(sizeof(header_t), 1));
+            }
+            NEW_STEP("Small pool is full, use the medium one");
+            for (uint16_t i = 0; i < pools[POOL_MEDIUM].block_nb; i++)
+            {
+                TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_MEDIUM].offset + i * POOL_MEDIUM_BLOCK_SIZE], MsgAlloc_Alloc(sizeof(header_t), 1));
+            }
+            NEW_STEP("Medium pool is full, use the large one");
+            for (uint16_t i = 0; i < pools[POOL_LARGE].block_nb; i++)
+            {
+                TEST_ASSERT_EQUAL(&msg_buffer[pools[POOL_LARGE].offset + i * POOL_LARGE_BLOCK_SIZE], MsgAlloc_Alloc(sizeof(header_t), 1));
+            }
+            NEW_STEP("Everything is full");
+            TEST_ASSERT_EQUAL(NULL, MsgAlloc_Alloc(sizeof(header_t), 1));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+void unittest_MsgAlloc_Reference(void)
+{
+    NEW_TEST_CASE("Check if we assert when we try to reference a message with a bad data and/or no phy");
+    {
+        MsgAlloc_Init(NULL);
+        TRY
+        {
+            MsgAlloc_Reference((uint8_t *)(msg_buffer - 1), 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            MsgAlloc_Reference((uint8_t *)&msg_buffer[MSG_BUFFER_SIZE], 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            MsgAlloc_Reference((uint8_t *)&msg_buffer[0], 0);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check if we assert when we reference a message that is not allocated or not at the begining of a block");
+    {
+        MsgAlloc_Init(NULL);
+        TRY
+        {
+            MsgAlloc_Reference((uint8_t *)&msg_buffer[pools[POOL_SMALL].offset], 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            MsgAlloc_Alloc(sizeof(header_t), 1);
+            MsgAlloc_Reference((uint8_t *)&msg_buffer[pools[POOL_SMALL].offset + 1], 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check normal referencing condition");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            uint8_t *data = MsgAlloc_Alloc(sizeof(header_t), 1);
+            TEST_ASSERT_EQUAL(SUCCEED, MsgAlloc_IsEmpty());
+            MsgAlloc_Reference(data, 3);
+            TEST_ASSERT_EQUAL(BLOCK_USED, alloc_blocks[pools[POOL_SMALL].first].state);
+            TEST_ASSERT_EQUAL(3, alloc_blocks[pools[POOL_SMALL].first].phy_filter);
+            TEST_ASSERT_EQUAL(FAILED, MsgAlloc_IsEmpty());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+void unittest_MsgAlloc_Free(void)
+{
+    NEW_TEST_CASE("Check if we assert when we pass a null pointer or a phy that is not in the filter");
+    {
+        MsgAlloc_Init(NULL);
+        TRY
+        {
+            MsgAlloc_Free(0, 0);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        TRY
+        {
+            uint8_t *data = MsgAlloc_Alloc(sizeof(header_t), 1);
+            MsgAlloc_Reference(data, 1);
+            MsgAlloc_Free(1, data);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a message is released only when all its phys freed it");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            uint8_t *data = MsgAlloc_Alloc(sizeof(header_t), 3);
+            MsgAlloc_Reference(data, 3);
+            MsgAlloc_Free(0, data);
+            TEST_ASSERT_EQUAL(FAILED, MsgAlloc_IsEmpty());
+            TEST_ASSERT_EQUAL(2, alloc_blocks[pools[POOL_SMALL].first].phy_filter);
+            MsgAlloc_Free(1, data);
+            TEST_ASSERT_EQUAL(SUCCEED, MsgAlloc_IsEmpty());
+            TEST_ASSERT_EQUAL(BLOCK_FREE, alloc_blocks[pools[POOL_SMALL].first].state);
+            NEW_STEP("Check that a second free is ignored");
+            MsgAlloc_Free(1, data);
+            TEST_ASSERT_EQUAL(SUCCEED, MsgAlloc_IsEmpty());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+
+    NEW_TEST_CASE("Check that a newer message can be reused while an older one is still in use");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            uint8_t *slow_msg = MsgAlloc_Alloc(sizeof(msg_t), 1);
+            MsgAlloc_Reference(slow_msg, 1);
+            // Fill all the other blocks
+            uint8_t *last_msg = NULL;
+            uint8_t *data     = MsgAlloc_Alloc(sizeof(header_t), 1);
+            while (data != NULL)
+            {
+                MsgAlloc_Reference(data, 1);
+                last_msg = data;
+                data     = MsgAlloc_Alloc(sizeof(header_t), 1);
+            }
+            // Free the last one, the slow message is still there
+            MsgAlloc_Free(0, last_msg);
+            TEST_ASSERT_EQUAL(last_msg, MsgAlloc_Alloc(sizeof(header_t), 1));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+void unittest_MsgAlloc_Drop(void)
+{
+    NEW_TEST_CASE("Check that a dropped allocation is given back to its pool");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            uint8_t *data = MsgAlloc_Alloc(sizeof(header_t), 1);
+            MsgAlloc_Drop(data);
+            TEST_ASSERT_EQUAL(BLOCK_FREE, alloc_blocks[pools[POOL_SMALL].first].state);
+            TEST_ASSERT_EQUAL(data, MsgAlloc_Alloc(sizeof(header_t), 1));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+
+    NEW_TEST_CASE("Check that referenced messages and pointers out of the buffer are not dropped");
+    {
+        TRY
+        {
+            MsgAlloc_Init(NULL);
+            uint8_t rx_buffer[sizeof(msg_t)];
+            uint8_t *data = MsgAlloc_Alloc(sizeof(header_t), 1);
+            MsgAlloc_Reference(data, 1);
+            MsgAlloc_Drop(data);
+            MsgAlloc_Drop(rx_buffer);
+            MsgAlloc_Drop(NULL);
+            TEST_ASSERT_EQUAL(BLOCK_USED, alloc_blocks[pools[POOL_SMALL].first].state);
+            TEST_ASSERT_EQUAL(FAILED, MsgAlloc_IsEmpty());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+void unittest_MsgAlloc_Loop(void)
+{
+    NEW_TEST_CASE("Verify buffer occupation rate stat computing");
+    {
+        memory_stats_t memory_stats;
+        memset(&memory_stats, 0, sizeof(memory_stats));
+        TRY
+        {
+            MsgAlloc_Init(&memory_stats);
+            MsgAlloc_Loop();
+            TEST_ASSERT_EQUAL(0, memory_stats.buffer_occupation_ratio);
+            NEW_STEP("The peak occupation is kept even if the message have been freed before the loop");
+            uint8_t *data = MsgAlloc_Alloc(sizeof(msg_t), 1);
+            MsgAlloc_Reference(data, 1);
+            MsgAlloc_Free(0, data);
+            MsgAlloc_Loop();
+            TEST_ASSERT_EQUAL((POOL_LARGE_BLOCK_SIZE * 100) / (MSG_BUFFER_SIZE), memory_stats.buffer_occupation_ratio);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Generic functions
+    UNIT_TEST_RUN(unittest_MsgAlloc_Init);
+    UNIT_TEST_RUN(unittest_MsgAlloc_Loop);
+    UNIT_TEST_RUN(unittest_MsgAlloc_Alloc);
+    UNIT_TEST_RUN(unittest_MsgAlloc_Reference);
+    UNIT_TEST_RUN(unittest_MsgAlloc_Free);
+    UNIT_TEST_RUN(unittest_MsgAlloc_Drop);
+
+    UNITY_END();
+}
@@ -15,9 +15,9 @@ bool Robus_get_deadTarget    = false;
 static void phy_luos_MsgHandler(luos_phy_t *phy_ptr, phy_job_t *job)
 {
     // Test dispatch re-entry protection
-    volatile uint16_t initial_job_nb = phy_ctx.io_job_nb;
+    volatile uint16_t initial_job_nb = Phy_GetIoJobNumber();
     Phy_Dispatch();
-    TEST_ASSERT_EQUAL(initial_job_nb, phy_ctx.io_job_nb);
+    TEST_ASSERT_EQUAL(initial_job_nb, Phy_GetIoJobNumber());
     Luos_handled_job = job;
     if (job->msg_pt->header.cmd == DEADTARGET)
     {
@@ -28,9 +28,9 @@ static void phy_luos_MsgHandler(luos_phy_t *phy_ptr, phy_job_t *job)
 static void phy_robus_MsgHandler(luos_phy_t *phy_ptr, phy_job_t *job)
 {
     // Test dispatch re-entry protection
-    volatile uint16_t initial_job_nb = phy_ctx.io_job_nb;
+    volatile uint16_t initial_job_nb = Phy_GetIoJobNumber();
     Phy_Dispatch();
-    TEST_ASSERT_EQUAL(initial_job_nb, phy_ctx.io_job_nb);
+    TEST_ASSERT_EQUAL(initial_job_nb, Phy_GetIoJobNumber());
     Robus_handled_job = job;
     if (job->msg_pt->header.cmd == DEADTARGET)
     {
@@ -311,22 +311,22 @@ void unittest_phy_dispatch()
         TRY
         {
             phy_test_reset();
-            // Create a fake job
-            phy_ctx.io_job_nb = 1;
+            // Create a fake job received by robus
+            phy_ctx.io_job[1].head = 1;
             /// Create msg data
-            phy_ctx.io_job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
-            phy_ctx.io_job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
-            phy_ctx.io_job[0].alloc_msg->header.size        = 3;
-            phy_ctx.io_job[0].alloc_msg->header.target_mode = NODEIDACK;
-            phy_ctx.io_job[0].size                          = 10;
-            phy_ctx.io_job[0].phy_filter                    = 0x01; // Target Luos phy only
-            phy_ctx.io_job[0].timestamp                     = 10;   // This represent the reception date
-            time_luos_t timestamp_latency                   = TimeOD_TimeFrom_ns(10);
-            memcpy(&phy_ctx.io_job[0].alloc_msg->data[phy_ctx.io_job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_t));
+            phy_ctx.io_job[1].job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
+            phy_ctx.io_job[1].job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
+            phy_ctx.io_job[1].job[0].alloc_msg->header.size        = 3;
+            phy_ctx.io_job[1].job[0].alloc_msg->header.target_mode = NODEIDACK;
+            phy_ctx.io_job[1].job[0].size                          = 10;
+            phy_ctx.io_job[1].job[0].phy_filter                    = 0x01; // Target Luos phy only
+            phy_ctx.io_job[1].job[0].timestamp                     = 10;   // This represent the reception date
+            time_luos_wire_t timestamp_latency              = TimeOD_TimeToWire(TimeOD_TimeFrom_ns(10));
+            memcpy(&phy_ctx.io_job[1].job[0].alloc_msg->data[phy_ctx.io_job[1].job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_wire_t));
 
             Phy_Dispatch();
 
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
             TEST_ASSERT_EQUAL(1, luos_phy->job_nb);
             TEST_ASSERT_EQUAL(&luos_phy->job[0], Luos_handled_job);
             TEST_ASSERT_EQUAL(&msg_buffer[0], luos_phy->job[0].data_pt);
@@ -334,7 +334,7 @@ void unittest_phy_dispatch()
             TEST_ASSERT_EQUAL(true, luos_phy->job[0].ack);
             TEST_ASSERT_EQUAL(true, luos_phy->job[0].timestamp);
             time_luos_t timestamp_date;
-            memcpy(&timestamp_date, &phy_ctx.io_job[0].alloc_msg->data[phy_ctx.io_job[0].alloc_msg->header.size], sizeof(time_luos_t));
+            memcpy(&timestamp_date, &phy_ctx.io_job[1].job[0].alloc_msg->data[phy_ctx.io_job[1].job[0].alloc_msg->header.size], sizeof(time_luos_t));
             TEST_ASSERT_FLOAT_WITHIN(1.0, 20.0, TimeOD_TimeTo_ns(timestamp_date));
         }
         CATCH
@@ -354,23 +354,23 @@ void unittest_phy_dispatch()
             luos_phy->oldest_job_index    = 0;
             luos_phy->available_job_index = 0;
 
-            // Create a fake job
-            phy_ctx.io_job_nb = 1;
+            // Create a fake job received by robus
+            phy_ctx.io_job[1].head = 1;
             /// Create msg data
-            phy_ctx.io_job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
-            phy_ctx.io_job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
-            phy_ctx.io_job[0].alloc_msg->header.size        = 3;
-            phy_ctx.io_job[0].alloc_msg->header.target_mode = NODEIDACK;
-            phy_ctx.io_job[0].size                          = 10;
-            phy_ctx.io_job[0].phy_filter                    = 0x03; // Target Luos and Robus phy
-            phy_ctx.io_job[0].timestamp                     = 10;   // This represent the reception date
-            time_luos_t timestamp_latency                   = TimeOD_TimeFrom_ns(10);
-            memcpy(&phy_ctx.io_job[0].alloc_msg->data[phy_ctx.io_job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_t));
+            phy_ctx.io_job[1].job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
+            phy_ctx.io_job[1].job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
+            phy_ctx.io_job[1].job[0].alloc_msg->header.size        = 3;
+            phy_ctx.io_job[1].job[0].alloc_msg->header.target_mode = NODEIDACK;
+            phy_ctx.io_job[1].job[0].size                          = 10;
+            phy_ctx.io_job[1].job[0].phy_filter                    = 0x03; // Target Luos and Robus phy
+            phy_ctx.io_job[1].job[0].timestamp                     = 10;   // This represent the reception date
+            time_luos_wire_t timestamp_latency              = TimeOD_TimeToWire(TimeOD_TimeFrom_ns(10));
+            memcpy(&phy_ctx.io_job[1].job[0].alloc_msg->data[phy_ctx.io_job[1].job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_wire_t));
 
             Phy_Dispatch();
 
             time_luos_t timestamp_date;
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
 
             TEST_ASSERT_EQUAL(1, luos_phy->job_nb);
             TEST_ASSERT_EQUAL(0, luos_phy->oldest_job_index);
@@ -399,18 +399,51 @@ void unittest_phy_dispatch()
         END_TRY;
     }
 
+    NEW_TEST_CASE("Check that a message sent by Luos keeps its date");
+    {
+        TRY
+        {
+            phy_test_reset();
+            // Create a fake job sent by Luos
+            phy_ctx.io_job[0].head = 1;
+            /// Create msg data
+            phy_ctx.io_job[0].job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
+            phy_ctx.io_job[0].job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
+            phy_ctx.io_job[0].job[0].alloc_msg->header.size        = 3;
+            phy_ctx.io_job[0].job[0].alloc_msg->header.target_mode = NODEIDACK;
+            phy_ctx.io_job[0].job[0].size                          = 10;
+            phy_ctx.io_job[0].job[0].phy_filter                    = 0x02; // Target Robus phy only
+            phy_ctx.io_job[0].job[0].timestamp                     = 0;
+            time_luos_t timestamp_date                             = TimeOD_TimeFrom_ns(10);
+            memcpy(&phy_ctx.io_job[0].job[0].alloc_msg->data[phy_ctx.io_job[0].job[0].alloc_msg->header.size], &timestamp_date, sizeof(time_luos_t));
+
+            Phy_Dispatch();
+
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
+            TEST_ASSERT_EQUAL(1, robus_phy->job_nb);
+            TEST_ASSERT_EQUAL(true, robus_phy->job[0].timestamp);
+            memcpy(&timestamp_date, &robus_phy->job[0].msg_pt->data[robus_phy->job[0].msg_pt->header.size], sizeof(time_luos_t));
+            TEST_ASSERT_FLOAT_WITHIN(1.0, 10.0, TimeOD_TimeTo_ns(timestamp_date));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
     NEW_TEST_CASE("Try to dispatch corrupted jobs");
     {
         TRY
         {
             phy_test_reset();
             // Create a fake job
-            phy_ctx.io_job_nb = 1;
+            phy_ctx.io_job[0].head = 1;
             /// Create msg data
-            phy_ctx.io_job[0].alloc_msg  = 0;
-            phy_ctx.io_job[0].size       = 10;
-            phy_ctx.io_job[0].phy_filter = 0x01; // Target Luos phy only
-            phy_ctx.io_job[0].timestamp  = 10;   // This represent the reception date
+            phy_ctx.io_job[0].job[0].alloc_msg  = 0;
+            phy_ctx.io_job[0].job[0].size       = 10;
+            phy_ctx.io_job[0].job[0].phy_filter = 0x01; // Target Luos phy only
+            phy_ctx.io_job[0].job[0].timestamp  = 10;   // This represent the reception date
 
             Phy_Dispatch();
         }
@@ -421,17 +454,17 @@ void unittest_phy_dispatch()
         {
             phy_test_reset();
             // Create a fake job
-            phy_ctx.io_job_nb = 1;
+            phy_ctx.io_job[0].head = 1;
             /// Create msg data
-            phy_ctx.io_job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
-            phy_ctx.io_job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
-            phy_ctx.io_job[0].alloc_msg->header.size        = 3;
-            phy_ctx.io_job[0].alloc_msg->header.target_mode = NODEIDACK;
-            phy_ctx.io_job[0].size                          = 0;
-            phy_ctx.io_job[0].phy_filter                    = 0x01; // Target Luos phy only
-            phy_ctx.io_job[0].timestamp                     = 10;   // This represent the reception date
+            phy_ctx.io_job[0].job[0].alloc_msg                     = (msg_t *)&msg_buffer[0];
+            phy_ctx.io_job[0].job[0].alloc_msg->header.config      = TIMESTAMP_PROTOCOL;
+            phy_ctx.io_job[0].job[0].alloc_msg->header.size        = 3;
+            phy_ctx.io_job[0].job[0].alloc_msg->header.target_mode = NODEIDACK;
+            phy_ctx.io_job[0].job[0].size                          = 0;
+            phy_ctx.io_job[0].job[0].phy_filter                    = 0x01; // Target Luos phy only
+            phy_ctx.io_job[0].job[0].timestamp                     = 10;   // This represent the reception date
             time_luos_t timestamp_latency                   = TimeOD_TimeFrom_ns(10);
-            memcpy(&phy_ctx.io_job[0].alloc_msg->data[phy_ctx.io_job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_t));
+            memcpy(&phy_ctx.io_job[0].job[0].alloc_msg->data[phy_ctx.io_job[0].job[0].alloc_msg->header.size], &timestamp_latency, sizeof(time_luos_t));
 
             Phy_Dispatch();
         }
@@ -1064,7 +1097,7 @@ void unittest_phy_ComputeHeader()
             luos_phy->rx_size       = 0;
             luos_phy->rx_phy_filter = 0x00;
             Phy_ComputeHeader(luos_phy);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t), luos_phy->rx_size);
+            TEST_ASSERT_EQUAL(Luos_GetMtu() + sizeof(header_t), luos_phy->rx_size);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_keep);
             TEST_ASSERT_EQUAL(false, luos_phy->rx_ack);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_alloc_job);
@@ -1104,7 +1137,7 @@ void unittest_phy_ComputeHeader()
             luos_phy->rx_size       = 0;
             luos_phy->rx_phy_filter = 0x00;
             Phy_ComputeHeader(luos_phy);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
+            TEST_ASSERT_EQUAL(Luos_GetMtu() + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_keep);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_ack);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_alloc_job);
@@ -1143,7 +1176,7 @@ void unittest_phy_ComputeHeader()
             luos_phy->rx_size       = 0;
             luos_phy->rx_phy_filter = 0x00;
             Phy_ComputeHeader(luos_phy);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
+            TEST_ASSERT_EQUAL(Luos_GetMtu() + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_keep);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_ack);
             TEST_ASSERT_EQUAL(true, luos_phy->rx_alloc_job);
@@ -1183,7 +1216,7 @@ void unittest_phy_ComputeHeader()
             robus_phy->rx_size       = 0;
             robus_phy->rx_phy_filter = 0x00;
             Phy_ComputeHeader(robus_phy);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
+            TEST_ASSERT_EQUAL(Luos_GetMtu() + sizeof(header_t) + sizeof(time_luos_t), luos_phy->rx_size);
             TEST_ASSERT_EQUAL(false, robus_phy->rx_keep);
             TEST_ASSERT_EQUAL(false, robus_phy->rx_ack);
             TEST_ASSERT_EQUAL(false, robus_phy->rx_alloc_job);
@@ -1228,13 +1261,13 @@ void unittest_phy_ValidMsg()
             luos_phy->rx_phy_filter = 0x02; // A Robus node is targeted
             luos_phy->rx_timestamp  = 10;
 
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
             Phy_ValidMsg(luos_phy);
-            TEST_ASSERT_EQUAL(1, phy_ctx.io_job_nb);
-            TEST_ASSERT_EQUAL(10, phy_ctx.io_job[0].timestamp);
-            TEST_ASSERT_EQUAL(msg_buffer, phy_ctx.io_job[0].alloc_msg);
-            TEST_ASSERT_EQUAL(0x02, phy_ctx.io_job[0].phy_filter);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), phy_ctx.io_job[0].size);
+            TEST_ASSERT_EQUAL(1, Phy_GetIoJobNumber());
+            TEST_ASSERT_EQUAL(10, phy_ctx.io_job[0].job[0].timestamp);
+            TEST_ASSERT_EQUAL(msg_buffer, phy_ctx.io_job[0].job[0].alloc_msg);
+            TEST_ASSERT_EQUAL(0x02, phy_ctx.io_job[0].job[0].phy_filter);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), phy_ctx.io_job[0].job[0].size);
             TEST_ASSERT_EQUAL(0, luos_phy->received_data);
             TEST_ASSERT_EQUAL(luos_phy->rx_buffer_base, luos_phy->rx_data);
         }
@@ -1265,9 +1298,9 @@ void unittest_phy_ValidMsg()
             luos_phy->rx_phy_filter = 0x02; // A Robus node is targeted
             luos_phy->rx_timestamp  = 10;
 
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
             Phy_ValidMsg(luos_phy);
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
         }
         CATCH
         {
@@ -1307,14 +1340,14 @@ void unittest_phy_ValidMsg()
             luos_phy->services[0]   = 0x01; // Configure service 1 as accessible from Luos
             robus_phy->services[0]  = 0x02; // Configure this service as accessible from Robus
 
-            TEST_ASSERT_EQUAL(0, phy_ctx.io_job_nb);
+            TEST_ASSERT_EQUAL(0, Phy_GetIoJobNumber());
             Phy_ValidMsg(luos_phy);
-            TEST_ASSERT_EQUAL(1, phy_ctx.io_job_nb);
-            TEST_ASSERT_EQUAL(10, phy_ctx.io_job[0].timestamp);
+            TEST_ASSERT_EQUAL(1, Phy_GetIoJobNumber());
+            TEST_ASSERT_EQUAL(10, phy_ctx.io_job[0].job[0].timestamp);
             TEST_ASSERT_EQUAL(false, luos_phy->rx_alloc_job);
-            TEST_ASSERT_EQUAL(msg_buffer, phy_ctx.io_job[0].alloc_msg);
-            TEST_ASSERT_EQUAL(0x02, phy_ctx.io_job[0].phy_filter);
-            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), phy_ctx.io_job[0].size);
+            TEST_ASSERT_EQUAL(msg_buffer, phy_ctx.io_job[0].job[0].alloc_msg);
+            TEST_ASSERT_EQUAL(0x02, phy_ctx.io_job[0].job[0].phy_filter);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE + sizeof(header_t) + sizeof(time_luos_t), phy_ctx.io_job[0].job[0].size);
             TEST_ASSERT_EQUAL(0, luos_phy->received_data);
             TEST_ASSERT_EQUAL(luos_phy->rx_buffer_base, luos_phy->rx_data);
         }
@@ -1324,6 +1357,76 @@ void unittest_phy_ValidMsg()
         }
         END_TRY;
     }
+
+    NEW_TEST_CASE("Check ValidMsg job creation on each phy io_job ring");
+    {
+        TRY
+        {
+            phy_test_reset();
+
+            msg_t msg;
+            // Put the Luos phy ring at the end of its table to check the ring wrap.
+            phy_ctx.io_job[0].head = IO_JOB_RING_SIZE - 1;
+            phy_ctx.io_job[0].tail = IO_JOB_RING_SIZE - 1;
+            for (int i = 0; i < 2; i++)
+            {
+                luos_phy->rx_buffer_base = (uint8_t *)&msg;
+                luos_phy->rx_data        = msg_buffer;
+                luos_phy->received_data  = sizeof(header_t);
+                luos_phy->rx_keep        = true;
+                luos_phy->rx_alloc_job   = false;
+                luos_phy->rx_size        = sizeof(header_t);
+                luos_phy->rx_phy_filter  = 0x02;
+                luos_phy->rx_timestamp   = i;
+                Phy_ValidMsg(luos_phy);
+            }
+            // Robus phy have its own ring.
+            robus_phy->rx_buffer_base = (uint8_t *)&msg;
+            robus_phy->rx_data        = msg_buffer;
+            robus_phy->received_data  = sizeof(header_t);
+            robus_phy->rx_keep        = true;
+            robus_phy->rx_alloc_job   = false;
+            robus_phy->rx_size        = sizeof(header_t);
+            robus_phy->rx_phy_filter  = 0x01;
+            robus_phy->rx_timestamp   = 2;
+            Phy_ValidMsg(robus_phy);
+
+            TEST_ASSERT_EQUAL(3, Phy_GetIoJobNumber());
+            TEST_ASSERT_EQUAL(1, phy_ctx.io_job[0].head);
+            TEST_ASSERT_EQUAL(0, phy_ctx.io_job[0].job[IO_JOB_RING_SIZE - 1].timestamp);
+            TEST_ASSERT_EQUAL(1, phy_ctx.io_job[0].job[0].timestamp);
+            TEST_ASSERT_EQUAL(1, phy_ctx.io_job[1].head);
+            TEST_ASSERT_EQUAL(2, phy_ctx.io_job[1].job[0].timestamp);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check ValidMsg assert on a full io_job ring");
+    {
+        TRY
+        {
+            phy_test_reset();
+
+            msg_t msg;
+            phy_ctx.io_job[0].head = MAX_MSG_NB;
+            phy_ctx.io_job[0].tail = 0;
+
+            luos_phy->rx_buffer_base = (uint8_t *)&msg;
+            luos_phy->rx_data        = msg_buffer;
+            luos_phy->received_data  = sizeof(header_t);
+            luos_phy->rx_keep        = true;
+            luos_phy->rx_alloc_job   = false;
+            luos_phy->rx_size        = sizeof(header_t);
+            luos_phy->rx_phy_filter  = 0x02;
+            Phy_ValidMsg(luos_phy);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
 }
 
 void unittest_phy_ComputeTimestamp()
@@ -1389,16 +1492,16 @@ void unittest_phy_ComputeTimestamp()
             volatile time_luos_t timestamp = TimeOD_TimeFrom_ns(10);
             memcpy(&msg->data[msg->header.size], (void *)&timestamp, sizeof(time_luos_t));
 
-            volatile time_luos_t resulting_latency = Phy_ComputeMsgTimestamp(luos_phy, &job);
+            volatile time_luos_wire_t resulting_latency = Phy_ComputeMsgTimestamp(luos_phy, &job);
 
 #ifndef _WIN32
-            TEST_ASSERT_NOT_EQUAL(TimeOD_TimeTo_ns(timestamp), TimeOD_TimeTo_ns(resulting_latency));
+            TEST_ASSERT_NOT_EQUAL(TimeOD_TimeTo_ns(timestamp), TimeOD_TimeTo_ns(TimeOD_TimeFromWire(resulting_latency)));
 #endif
             Phy_DisableSynchro(luos_phy);
             resulting_latency = Phy_ComputeMsgTimestamp(luos_phy, &job);
 
 #ifndef _WIN32
-            TEST_ASSERT_EQUAL(TimeOD_TimeTo_ns(timestamp), TimeOD_TimeTo_ns(resulting_latency));
+            TEST_ASSERT_EQUAL(TimeOD_TimeTo_ns(timestamp), TimeOD_TimeTo_ns(TimeOD_TimeFromWire(resulting_latency)));
 #endif
         }
         CATCH
@@ -1426,6 +1529,35 @@ void unittest_phy_GetNodeId()
     }
 }
 
+void unittest_phy_Mtu()
+{
+    NEW_TEST_CASE("Check that a phy MTU can't be lower than the base message size");
+    {
+        TRY
+        {
+            Phy_SetMtu(robus_phy, BASE_DATA_MSG_SIZE - 1);
+        }
+        TEST_ASSERT_TRUE(IS_ASSERT());
+        END_TRY;
+    }
+    NEW_TEST_CASE("Check that a node MTU is the lowest MTU of its phys");
+    {
+        TRY
+        {
+            Phy_SetMtu(robus_phy, MAX_DATA_MSG_SIZE + 1);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, robus_phy->mtu);
+            TEST_ASSERT_EQUAL(MAX_DATA_MSG_SIZE, Phy_GetMtu());
+            Phy_SetMtu(robus_phy, BASE_DATA_MSG_SIZE);
+            TEST_ASSERT_EQUAL(BASE_DATA_MSG_SIZE, Phy_GetMtu());
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 void unittest_phy_AddJob()
 {
     NEW_TEST_CASE("Check AddJob assertion conditions");
@@ -1893,6 +2025,104 @@ void unittest_phy_TxAllComplete()
     }
 }
 
+void unittest_phy_Statistics()
+{
+    NEW_TEST_CASE("Check allocation statistics");
+    {
+        memory_stats_t memory_stats;
+        MsgAlloc_Init(&memory_stats);
+        Stats_Init();
+        io_stats_t *io_stats = Stats_GetIO();
+        TRY
+        {
+            phy_test_reset();
+            luos_phy->rx_alloc_job   = true;
+            luos_phy->received_data  = sizeof(header_t);
+            luos_phy->rx_buffer_base = buffer;
+            luos_phy->rx_data        = buffer;
+            luos_phy->rx_keep        = true;
+            luos_phy->rx_size        = 40;
+            luos_phy->rx_phy_filter  = 1;
+            Phy_alloc(luos_phy);
+            TEST_ASSERT_EQUAL(1, io_stats->msg_size[2]);
+            TEST_ASSERT_EQUAL(0, io_stats->alloc_failure_number);
+
+            NEW_STEP("Check allocation failure counting");
+            // Put a fake message just after the first one
+            oldest_alloc_slot       = 0;
+            available_alloc_slot    = 1;
+            alloc_slots[0].data     = (uint8_t *)&msg_buffer[47];
+            luos_phy->rx_alloc_job  = true;
+            luos_phy->rx_data       = buffer;
+            luos_phy->rx_keep       = true;
+            luos_phy->rx_phy_filter = 1;
+            luos_phy->rx_size       = 10;
+            Phy_alloc(luos_phy);
+            TEST_ASSERT_EQUAL(NULL, luos_phy->rx_data);
+            TEST_ASSERT_EQUAL(1, io_stats->alloc_failure_number);
+            TEST_ASSERT_EQUAL(1, io_stats->msg_size[2]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check tx queue depth histogram");
+    {
+        Stats_Init();
+        io_stats_t *io_stats = Stats_GetIO();
+        TRY
+        {
+            phy_test_reset();
+            phy_job_t phy_job;
+            for (int i = 0; i < 5; i++)
+            {
+                Phy_AddJob(robus_phy, &phy_job);
+            }
+            // Depths 1, 2-3, 4-5
+            TEST_ASSERT_EQUAL(1, io_stats->phy[1].tx_queue_depth[0]);
+            TEST_ASSERT_EQUAL(2, io_stats->phy[1].tx_queue_depth[1]);
+            TEST_ASSERT_EQUAL(2, io_stats->phy[1].tx_queue_depth[2]);
+            TEST_ASSERT_EQUAL(0, io_stats->phy[0].tx_queue_depth[0]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check drop counting of an allocated message never validated");
+    {
+        memory_stats_t *memory_stats = Stats_GetMemory();
+        MsgAlloc_Init(memory_stats);
+        Stats_Init();
+        io_stats_t *io_stats = Stats_GetIO();
+        TRY
+        {
+            phy_test_reset();
+            robus_phy->rx_buffer_base = buffer;
+            robus_phy->rx_data        = buffer;
+            NEW_STEP("Nothing is dropped if nothing have been allocated");
+            Phy_ResetMsg(robus_phy);
+            TEST_ASSERT_EQUAL(0, io_stats->phy[1].drop_number);
+            NEW_STEP("A message is dropped if it have been allocated");
+            robus_phy->rx_data = MsgAlloc_Alloc(10, 2);
+            Phy_ResetMsg(robus_phy);
+            TEST_ASSERT_EQUAL(1, io_stats->phy[1].drop_number);
+            TEST_ASSERT_EQUAL(1, memory_stats->msg_drop_number);
+            TEST_ASSERT_EQUAL(buffer, robus_phy->rx_data);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
 int main(int argc, char **argv)
 {
     UNITY_BEGIN();
@@ -1905,6 +2135,7 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_phy_ValidMsg);
     UNIT_TEST_RUN(unittest_phy_ComputeTimestamp);
     UNIT_TEST_RUN(unittest_phy_GetNodeId);
+    UNIT_TEST_RUN(unittest_phy_Mtu);
     UNIT_TEST_RUN(unittest_phy_AddJob);
     UNIT_TEST_RUN(unittest_phy_GetJob);
     UNIT_TEST_RUN(unittest_phy_GetNextJob);
@@ -1913,6 +2144,7 @@ int main(int argc, char **argv)
     UNIT_TEST_RUN(unittest_phy_RmJob);
     UNIT_TEST_RUN(unittest_add_and_remove_jobs);
     UNIT_TEST_RUN(unittest_phy_TxAllComplete);
+    UNIT_TEST_RUN(unittest_phy_Statistics);
 
     UNITY_END();
 }
@@ -0,0 +1,234 @@
+#include "unit_test.h"
+#include "msg_alloc.h"
+#include "../src/transmission.c"
+#include "stats.h"
+
+#define TEST_MSG_NB (ROBUS_TX_BURST_MAX + 2)
+
+static msg_t *test_msg[TEST_MSG_NB];
+static robus_encaps_t test_encaps[TEST_MSG_NB];
+
+/******************************************************************************
+ * @brief Queue messages on the robus phy
+ * @param phy_robus Robus phy
+ * @param nb number of messages to queue
+ * @param ack true if the messages need to be acknowledged
+ * @return None
+ ******************************************************************************/
+static void Test_QueueMsgs(luos_phy_t *phy_robus, uint8_t nb, bool ack)
+{
+    for (uint8_t i = 0; i < nb; i++)
+    {
+        // The jobs are freed from the allocator of the robus phy, the only phy of this test
+        test_msg[i] = (msg_t *)MsgAlloc_Alloc(sizeof(header_t) + 2, 0x01);
+        MsgAlloc_Reference((uint8_t *)test_msg[i], 0x01);
+        memset(test_msg[i], 0, sizeof(header_t) + 2);
+        test_msg[i]->header.target      = ack ? 3 : BROADCAST_VAL;
+        test_msg[i]->header.target_mode = ack ? SERVICEIDACK : BROADCAST;
+        test_msg[i]->header.source      = 5;
+        test_msg[i]->header.cmd         = LUOS_LAST_STD_CMD;
+        test_msg[i]->header.size        = 2;
+        test_msg[i]->data[0]            = i;
+
+        phy_job_t *job = &phy_robus->job[i];
+        memset(job, 0, sizeof(phy_job_t));
+        job->msg_pt             = test_msg[i];
+        job->size               = sizeof(header_t) + test_msg[i]->header.size;
+        job->ack                = ack;
+        job->phy_data           = &test_encaps[i];
+        test_encaps[i].data_crc = ll_crc_compute(job->data_pt, job->size, 0xFFFF);
+    }
+    phy_robus->job_nb              = nb;
+    phy_robus->oldest_job_index    = 0;
+    phy_robus->available_job_index = nb;
+}
+
+/******************************************************************************
+ * @brief End the current transmission or the current backoff
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Test_TransmitEnd(void)
+{
+    RobusHAL_StubClearTx();
+    Recep_Timeout();
+}
+
+void unittest_Transmit_ComputeBackoff(void)
+{
+    phy_job_t job;
+    msg_t msg;
+    job.msg_pt = &msg;
+
+    NEW_TEST_CASE("Check the backoff window of a standard message");
+    {
+        msg.header.cmd = LUOS_LAST_STD_CMD;
+        for (nbrRetry = 0; nbrRetry < NBR_RETRY; nbrRetry++)
+        {
+            uint8_t exponent = (nbrRetry + 1 > ROBUS_BACKOFF_MAX_EXP) ? ROBUS_BACKOFF_MAX_EXP : nbrRetry + 1;
+            uint16_t min     = (1 + (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP)) * ROBUS_BACKOFF_SLOT;
+            uint16_t max     = min + ((1 << exponent) - 1) * ROBUS_BACKOFF_SLOT;
+            for (uint16_t i = 0; i < 1000; i++)
+            {
+                uint16_t backoff = Transmit_ComputeBackoff(&job);
+                TEST_ASSERT_TRUE((backoff >= min) && (backoff <= max));
+                TEST_ASSERT_EQUAL(0, backoff % ROBUS_BACKOFF_SLOT);
+            }
+        }
+    }
+
+    NEW_TEST_CASE("Check that priority messages retry before the others");
+    {
+        msg.header.cmd = DEADTARGET;
+        for (nbrRetry = 0; nbrRetry < NBR_RETRY; nbrRetry++)
+        {
+            for (uint16_t i = 0; i < 1000; i++)
+            {
+                uint16_t backoff = Transmit_ComputeBackoff(&job);
+                TEST_ASSERT_TRUE((backoff >= ROBUS_BACKOFF_SLOT) && (backoff <= (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP) * ROBUS_BACKOFF_SLOT));
+            }
+        }
+    }
+
+    NEW_TEST_CASE("Check that the backoff use all the slots of the window");
+    {
+        msg.header.cmd = LUOS_LAST_STD_CMD;
+        nbrRetry       = ROBUS_BACKOFF_MAX_EXP;
+        uint16_t slot_count[1 << ROBUS_BACKOFF_MAX_EXP];
+        memset(slot_count, 0, sizeof(slot_count));
+        for (uint16_t i = 0; i < 10000; i++)
+        {
+            uint16_t slot = Transmit_ComputeBackoff(&job) / ROBUS_BACKOFF_SLOT - 1 - (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP);
+            slot_count[slot]++;
+        }
+        for (uint16_t slot = 0; slot < (1 << ROBUS_BACKOFF_MAX_EXP); slot++)
+        {
+            TEST_ASSERT_TRUE(slot_count[slot] > 0);
+        }
+        nbrRetry = 0;
+    }
+}
+
+void unittest_Transmit_BurstLimit(void)
+{
+    luos_phy_t *phy_robus = Robus_GetPhy();
+    stub_robus_tx_hold    = true;
+
+    NEW_TEST_CASE("Check that the node release the bus after a burst of messages");
+    {
+        Test_QueueMsgs(phy_robus, TEST_MSG_NB, false);
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        for (uint8_t i = 0; i < ROBUS_TX_BURST_MAX; i++)
+        {
+            TEST_ASSERT_EQUAL(sizeof(header_t) + 2 + CRC_SIZE, stub_robus_tx_size);
+            TEST_ASSERT_EQUAL(i, stub_robus_tx_data[sizeof(header_t)]);
+            stub_robus_timeout = 0;
+            Test_TransmitEnd();
+        }
+        // Nothing is sent until the end of the backoff
+        TEST_ASSERT_EQUAL(0, stub_robus_tx_size);
+        TEST_ASSERT_TRUE(ctx.tx.lock);
+        TEST_ASSERT_EQUAL(TEST_MSG_NB - ROBUS_TX_BURST_MAX, phy_robus->job_nb);
+        TEST_ASSERT_TRUE(stub_robus_timeout >= (1 + (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP)) * ROBUS_BACKOFF_SLOT);
+        TEST_ASSERT_TRUE(stub_robus_timeout <= (2 + (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP)) * ROBUS_BACKOFF_SLOT);
+
+        NEW_STEP("Check that the next messages are sent after the backoff");
+        Test_TransmitEnd();
+        for (uint8_t i = ROBUS_TX_BURST_MAX; i < TEST_MSG_NB; i++)
+        {
+            TEST_ASSERT_EQUAL(i, stub_robus_tx_data[sizeof(header_t)]);
+            Test_TransmitEnd();
+        }
+        TEST_ASSERT_EQUAL(0, phy_robus->job_nb);
+        TEST_ASSERT_FALSE(ctx.tx.lock);
+    }
+
+    NEW_TEST_CASE("Check that the burst backoff is not always the same");
+    {
+        uint8_t slot_count[2] = {0, 0};
+        for (uint16_t i = 0; i < 100; i++)
+        {
+            Test_QueueMsgs(phy_robus, ROBUS_TX_BURST_MAX + 1, false);
+            RobusHAL_StubClearTx();
+            Transmit_Process();
+            for (uint8_t j = 0; j < ROBUS_TX_BURST_MAX; j++)
+            {
+                Test_TransmitEnd();
+            }
+            uint16_t slot = stub_robus_timeout / ROBUS_BACKOFF_SLOT - 1 - (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP);
+            TEST_ASSERT_TRUE(slot < 2);
+            slot_count[slot]++;
+            // End the backoff and send the last message
+            Test_TransmitEnd();
+            Test_TransmitEnd();
+        }
+        TEST_ASSERT_TRUE(slot_count[0] > 0);
+        TEST_ASSERT_TRUE(slot_count[1] > 0);
+    }
+    stub_robus_tx_hold = false;
+}
+
+void unittest_Transmit_RetryCount(void)
+{
+    luos_phy_t *phy_robus = Robus_GetPhy();
+    // Robus is the only phy created in this test
+    phy_stats_t *phy_stats = &Stats_GetIO()->phy[0];
+    stub_robus_tx_hold     = true;
+
+    NEW_TEST_CASE("Check the retry and collision counters");
+    {
+        memset(phy_stats, 0, sizeof(phy_stats_t));
+        Test_QueueMsgs(phy_robus, 1, true);
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+        // No acknowledgement received
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(1, nbrRetry);
+        TEST_ASSERT_EQUAL(1, phy_stats->retry_number);
+        TEST_ASSERT_EQUAL(0, phy_stats->collision_number);
+        // The retry window grows with the number of retries
+        TEST_ASSERT_TRUE(stub_robus_timeout >= (1 + (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP)) * ROBUS_BACKOFF_SLOT);
+        TEST_ASSERT_TRUE(stub_robus_timeout <= (4 + (1 << ROBUS_BACKOFF_PRIORITY_MAX_EXP)) * ROBUS_BACKOFF_SLOT);
+
+        NEW_STEP("Check that a collision is counted as a retry");
+        // End the backoff
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(sizeof(header_t) + 2 + CRC_SIZE, stub_robus_tx_size);
+        ctx.tx.collision = true;
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(2, nbrRetry);
+        TEST_ASSERT_EQUAL(2, phy_stats->retry_number);
+        TEST_ASSERT_EQUAL(1, phy_stats->collision_number);
+        TEST_ASSERT_FALSE(ctx.tx.collision);
+
+        NEW_STEP("Check that the message is dropped after too many retries");
+        for (uint8_t i = 2; i < NBR_RETRY; i++)
+        {
+            Test_TransmitEnd();
+            Test_TransmitEnd();
+        }
+        TEST_ASSERT_EQUAL(NBR_RETRY, phy_stats->retry_number);
+        TEST_ASSERT_EQUAL(1, phy_stats->collision_number);
+        // The end of the last backoff drop the message
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(0, phy_robus->job_nb);
+        TEST_ASSERT_EQUAL(0, nbrRetry);
+        TEST_ASSERT_EQUAL(0, stub_robus_tx_size);
+    }
+    stub_robus_tx_hold = false;
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    MsgAlloc_Init(NULL);
+    Robus_Init();
+
+    UNIT_TEST_RUN(unittest_Transmit_ComputeBackoff);
+    UNIT_TEST_RUN(unittest_Transmit_BurstLimit);
+    UNIT_TEST_RUN(unittest_Transmit_RetryCount);
+
+    UNITY_END();
+}
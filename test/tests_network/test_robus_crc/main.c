@@ -0,0 +1,95 @@
+#define ROBUS_CRC_SLICE_BY_4
+#include "unit_test.h"
+#include "../src/transmission.c"
+
+/******************************************************************************
+ * @brief Reference bit by bit CRC computation
+ ******************************************************************************/
+static uint16_t crc_reference(const uint8_t *data, uint16_t size, uint16_t crc_seed)
+{
+    uint16_t crc_val = crc_seed;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        uint16_t dbyte = data[i];
+        crc_val ^= dbyte << 8;
+        for (uint8_t j = 0; j < 8; ++j)
+        {
+            uint16_t mix = crc_val & 0x8000;
+            crc_val      = (crc_val << 1);
+            if (mix)
+                crc_val = crc_val ^ 0x0007;
+        }
+    }
+    return crc_val;
+}
+
+void unittest_ll_crc_compute(void)
+{
+    NEW_TEST_CASE("Check every byte value with different seeds");
+    {
+        const uint16_t seeds[] = {0x0000, 0xFFFF, 0x1234, 0x8000};
+        for (uint16_t seed = 0; seed < sizeof(seeds) / sizeof(uint16_t); seed++)
+        {
+            for (uint16_t value = 0; value < 256; value++)
+            {
+                uint8_t data = (uint8_t)value;
+                TEST_ASSERT_EQUAL(crc_reference(&data, 1, seeds[seed]), ll_crc_compute(&data, 1, seeds[seed]));
+            }
+        }
+    }
+
+    NEW_TEST_CASE("Check buffers of every size up to a full message");
+    {
+        uint8_t data[sizeof(msg_t) + sizeof(time_luos_t)];
+        uint32_t random = 0x12345678;
+        for (uint16_t i = 0; i < sizeof(data); i++)
+        {
+            random  = random * 1103515245 + 12345;
+            data[i] = (uint8_t)(random >> 16);
+        }
+        for (uint16_t size = 0; size <= sizeof(data); size++)
+        {
+            TEST_ASSERT_EQUAL(crc_reference(data, size, 0xFFFF), ll_crc_compute(data, size, 0xFFFF));
+            // Check with an unaligned buffer
+            if (size > 0)
+            {
+                TEST_ASSERT_EQUAL(crc_reference(&data[1], size - 1, 0xFFFF), ll_crc_compute(&data[1], size - 1, 0xFFFF));
+            }
+        }
+    }
+
+    NEW_TEST_CASE("Check that the CRC can be computed in multiple parts");
+    {
+        uint8_t data[64];
+        for (uint16_t i = 0; i < sizeof(data); i++)
+        {
+            data[i] = (uint8_t)(i * 37);
+        }
+        for (uint16_t split = 0; split <= sizeof(data); split++)
+        {
+            uint16_t crc_val = ll_crc_compute(data, split, 0xFFFF);
+            crc_val          = ll_crc_compute(&data[split], sizeof(data) - split, crc_val);
+            TEST_ASSERT_EQUAL(crc_reference(data, sizeof(data), 0xFFFF), crc_val);
+        }
+    }
+
+    NEW_TEST_CASE("Check that the HAL byte by byte CRC give the same result");
+    {
+        uint8_t data[]   = "Luos robus crc";
+        uint16_t crc_val = 0xFFFF;
+        for (uint16_t i = 0; i < sizeof(data); i++)
+        {
+            RobusHAL_ComputeCRC(&data[i], (uint8_t *)&crc_val);
+        }
+        TEST_ASSERT_EQUAL(crc_reference(data, sizeof(data), 0xFFFF), crc_val);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    UNIT_TEST_RUN(unittest_ll_crc_compute);
+
+    UNITY_END();
+}
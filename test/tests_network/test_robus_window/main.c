@@ -0,0 +1,385 @@
+#include "unit_test.h"
+#include "msg_alloc.h"
+#include "../src/reception.c"
+#include "node.h"
+
+#define WINDOW_SOURCE 5
+#define WINDOW_TARGET 3
+
+static msg_t *window_msg[ROBUS_ACK_WINDOW];
+static robus_encaps_t window_encaps[ROBUS_ACK_WINDOW];
+static uint8_t window_delivered[ROBUS_ACK_WINDOW + 1];
+
+/******************************************************************************
+ * @brief Queue a complete window of messages on the robus phy
+ * @param phy_robus Robus phy
+ * @return None
+ ******************************************************************************/
+static void Test_QueueWindow(luos_phy_t *phy_robus)
+{
+    for (uint8_t i = 0; i < ROBUS_ACK_WINDOW; i++)
+    {
+        // The jobs are freed from the allocator of the robus phy, the only phy of this test
+        window_msg[i] = (msg_t *)MsgAlloc_Alloc(sizeof(header_t) + 2, 0x01);
+        MsgAlloc_Reference((uint8_t *)window_msg[i], 0x01);
+        memset(window_msg[i], 0, sizeof(header_t) + 2);
+        window_msg[i]->header.target      = WINDOW_TARGET;
+        window_msg[i]->header.target_mode = SERVICEIDACK;
+        window_msg[i]->header.source      = WINDOW_SOURCE;
+        window_msg[i]->header.size        = 2;
+        window_msg[i]->data[0]            = i;
+
+        phy_job_t *job = &phy_robus->job[i];
+        memset(job, 0, sizeof(phy_job_t));
+        job->msg_pt               = window_msg[i];
+        job->size                 = sizeof(header_t) + window_msg[i]->header.size;
+        job->ack                  = true;
+        job->phy_data             = &window_encaps[i];
+        window_encaps[i].data_crc = ll_crc_compute(job->data_pt, job->size, 0xFFFF);
+        window_delivered[i + 1]   = 0;
+    }
+    phy_robus->job_nb              = ROBUS_ACK_WINDOW;
+    phy_robus->oldest_job_index    = 0;
+    phy_robus->available_job_index = ROBUS_ACK_WINDOW;
+}
+
+/******************************************************************************
+ * @brief Receive the frame sent by the node as the target would
+ * @param phy_robus Robus phy
+ * @return The acknowledgement sent by the target, 0xFF if none
+ ******************************************************************************/
+static uint8_t Test_ReceiveFrame(luos_phy_t *phy_robus)
+{
+    uint8_t frame[sizeof(header_t) + 2 + CRC_SIZE];
+    uint16_t crc;
+    TEST_ASSERT_EQUAL(sizeof(frame), stub_robus_tx_size);
+    memcpy(frame, stub_robus_tx_data, sizeof(frame));
+    memcpy(&crc, &frame[sizeof(header_t) + 2], CRC_SIZE);
+    uint16_t crc_mask = crc ^ ll_crc_compute(frame, sizeof(header_t) + 2, 0xFFFF);
+
+    // Give the frame to the target
+    memcpy(phy_robus->rx_buffer_base, frame, sizeof(header_t));
+    phy_robus->rx_keep = false;
+    uint8_t received   = window_index[WINDOW_SOURCE] & WINDOW_CRC_INDEX;
+    RobusHAL_StubClearTx();
+    TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, crc_mask));
+    if ((window_index[WINDOW_SOURCE] & WINDOW_CRC_INDEX) != received)
+    {
+        // The target delivered this message
+        window_delivered[crc_mask & 0x0F]++;
+    }
+    if (stub_robus_tx_size == 1)
+    {
+        return stub_robus_tx_data[0];
+    }
+    return 0xFF;
+}
+
+/******************************************************************************
+ * @brief End the current transmission and get the next frame sent
+ * @param None
+ * @return None
+ ******************************************************************************/
+static void Test_TransmitEnd(void)
+{
+    RobusHAL_StubClearTx();
+    Recep_Timeout();
+}
+
+void unittest_Recep_CatchAck(void)
+{
+    luos_phy_t *phy_robus = Robus_GetPhy();
+    uint8_t ack;
+
+    NEW_TEST_CASE("Check a standard acknowledgement");
+    {
+        ctx.tx.window_size = 0;
+        ack                = 0x0F;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_OK, ctx.tx.status);
+        ack = 0x1F;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+        // A window acknowledgement is not valid outside of a window
+        ack = 0x02;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+    }
+
+    NEW_TEST_CASE("Check a window acknowledgement");
+    {
+        ctx.tx.window_size = ROBUS_ACK_WINDOW;
+        ack                = ROBUS_ACK_WINDOW;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_OK, ctx.tx.status);
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ctx.tx.window_ack);
+        // Only the beginning of the window have been received
+        ack = 1;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+        TEST_ASSERT_EQUAL(1, ctx.tx.window_ack);
+        // Nothing received
+        ack = 0;
+        Recep_CatchAck(phy_robus, &ack);
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+        TEST_ASSERT_EQUAL(0, ctx.tx.window_ack);
+        ctx.tx.window_size = 0;
+        ctx.tx.window_ack  = 0;
+        ctx.tx.status      = TX_DISABLE;
+    }
+}
+
+void unittest_Recep_WindowMsg(void)
+{
+    luos_phy_t *phy_robus = Robus_GetPhy();
+    header_t *header      = (header_t *)phy_robus->rx_buffer_base;
+    header->source        = 3;
+    // Don't dispatch the messages
+    phy_robus->rx_keep = false;
+    // Keep the acknowledgements in the stub, their end would reset the reception
+    stub_robus_tx_hold = true;
+
+    NEW_TEST_CASE("Check that window messages are ignored with the base revision");
+    {
+        Node_SetProtocolRevision(0);
+        TEST_ASSERT_EQUAL(FAILED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, false)));
+        TEST_ASSERT_EQUAL(0, window_index[3]);
+    }
+
+    Node_SetProtocolRevision(1);
+    NEW_TEST_CASE("Check that a wrong CRC is not a window message");
+    {
+        TEST_ASSERT_EQUAL(FAILED, Recep_WindowMsg(phy_robus, 0x1234));
+        TEST_ASSERT_EQUAL(FAILED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(0, false, 0, false)));
+        TEST_ASSERT_EQUAL(FAILED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(ROBUS_ACK_WINDOW + 1, true, 0, false)));
+        TEST_ASSERT_EQUAL(0, window_index[3]);
+    }
+
+    NEW_TEST_CASE("Check that messages are only kept in order");
+    {
+        // The first message is missing
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 0, false)));
+        TEST_ASSERT_EQUAL(0, window_index[3]);
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, false)));
+        TEST_ASSERT_EQUAL(1, window_index[3]);
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 0, false)));
+        TEST_ASSERT_EQUAL(2, window_index[3]);
+        // A duplicated message is refused
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 0, false)));
+        TEST_ASSERT_EQUAL(2, window_index[3]);
+        // The third message is missing, the closing one is refused
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(4, true, 0, false)));
+        TEST_ASSERT_EQUAL(2, window_index[3]);
+    }
+
+    NEW_TEST_CASE("Check that windows of different sources are independent");
+    {
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, false)));
+        header->source = 4;
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, false)));
+        header->source = 3;
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, true, 0, false)));
+        TEST_ASSERT_EQUAL(2, window_index[3]);
+        TEST_ASSERT_EQUAL(1, window_index[4]);
+    }
+
+    NEW_TEST_CASE("Check that a retried window is not delivered twice");
+    {
+        volatile status_t ack;
+        // A new window begins with a new sequence number
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 1, false)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 1, window_index[3]);
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 1, false)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 2, window_index[3]);
+        // The sender retries the window, the messages already received are dropped
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 1, true)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 2, window_index[3]);
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 1, true)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 2, window_index[3]);
+        RobusHAL_StubClearTx();
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(3, true, 1, true)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 3, window_index[3]);
+        // The complete window is acknowledged
+        TEST_ASSERT_EQUAL(1, stub_robus_tx_size);
+        ack.unmap = stub_robus_tx_data[0];
+        TEST_ASSERT_EQUAL(3, ack.identifier);
+        // The closing message is received again if the acknowledgement have been lost
+        RobusHAL_StubClearTx();
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(3, true, 1, true)));
+        TEST_ASSERT_EQUAL((1 << WINDOW_CRC_SEQ_SHIFT) | 3, window_index[3]);
+        ack.unmap = stub_robus_tx_data[0];
+        TEST_ASSERT_EQUAL(3, ack.identifier);
+    }
+
+    NEW_TEST_CASE("Check that the retry of a window never received is kept");
+    {
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, true)));
+        TEST_ASSERT_EQUAL(1, window_index[3]);
+    }
+
+    NEW_TEST_CASE("Check that the retry of a window following a lost one is kept");
+    {
+        // The beginning of a window is received then the sender give up
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 1, false)));
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 1, false)));
+        // The next window is lost, the following one collides and is retried
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 3, true)));
+        TEST_ASSERT_EQUAL((3 << WINDOW_CRC_SEQ_SHIFT) | 1, window_index[3]);
+        TEST_ASSERT_EQUAL(SUCCEED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(2, false, 3, true)));
+        TEST_ASSERT_EQUAL((3 << WINDOW_CRC_SEQ_SHIFT) | 2, window_index[3]);
+    }
+
+    NEW_TEST_CASE("Check that the windows of a source out of the routing table are refused");
+    {
+        header->source = MAX_SERVICE_NUMBER + 1;
+        TEST_ASSERT_EQUAL(FAILED, Recep_WindowMsg(phy_robus, WINDOW_CRC_MASK(1, false, 0, false)));
+        header->source = 3;
+        TEST_ASSERT_EQUAL((3 << WINDOW_CRC_SEQ_SHIFT) | 2, window_index[3]);
+    }
+    stub_robus_tx_hold = false;
+    Node_SetProtocolRevision(0);
+}
+
+void unittest_Transmit_WindowRetry(void)
+{
+    luos_phy_t *phy_robus = Robus_GetPhy();
+    volatile status_t ack;
+    Node_SetProtocolRevision(1);
+    stub_robus_tx_hold = true;
+
+    NEW_TEST_CASE("Check that a collision in a window does not deliver any message twice");
+    {
+        Test_QueueWindow(phy_robus);
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ctx.tx.window_size);
+        // The first messages are received
+        TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+        Test_TransmitEnd();
+        // A collision occurs on the third one
+        ctx.tx.collision = true;
+        ctx.tx.status    = TX_NOK;
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, phy_robus->job_nb);
+        NEW_STEP("Check that the complete window is sent again as a retry");
+        // End the backoff
+        Test_TransmitEnd();
+        TEST_ASSERT_TRUE(ctx.tx.window_retry);
+        for (uint8_t i = 1; i < ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+            Test_TransmitEnd();
+        }
+        ack.unmap = Test_ReceiveFrame(phy_robus);
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ack.identifier);
+        Recep_CatchAck(phy_robus, &ack.unmap);
+        Test_TransmitEnd();
+        NEW_STEP("Check that each message have been delivered once");
+        for (uint8_t i = 1; i <= ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(1, window_delivered[i]);
+        }
+        TEST_ASSERT_EQUAL(0, phy_robus->job_nb);
+        TEST_ASSERT_FALSE(ctx.tx.window_retry);
+    }
+
+    NEW_TEST_CASE("Check that a lost acknowledgement does not deliver any message twice");
+    {
+        Test_QueueWindow(phy_robus);
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        for (uint8_t i = 1; i < ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+            Test_TransmitEnd();
+        }
+        // The window is received but the acknowledgement is lost
+        ack.unmap = Test_ReceiveFrame(phy_robus);
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ack.identifier);
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, phy_robus->job_nb);
+        // End the backoff, the window is retried
+        Test_TransmitEnd();
+        for (uint8_t i = 1; i < ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+            Test_TransmitEnd();
+        }
+        ack.unmap = Test_ReceiveFrame(phy_robus);
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ack.identifier);
+        Recep_CatchAck(phy_robus, &ack.unmap);
+        Test_TransmitEnd();
+        for (uint8_t i = 1; i <= ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(1, window_delivered[i]);
+        }
+        TEST_ASSERT_EQUAL(0, phy_robus->job_nb);
+    }
+
+    NEW_TEST_CASE("Check that the next window of a source is delivered");
+    {
+        uint8_t seq = ctx.tx.window_seq;
+        Test_QueueWindow(phy_robus);
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        // Each new window use the next sequence number
+        TEST_ASSERT_EQUAL((seq + 1) & 0x03, ctx.tx.window_seq);
+        for (uint8_t i = 1; i < ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(0xFF, Test_ReceiveFrame(phy_robus));
+            Test_TransmitEnd();
+        }
+        ack.unmap = Test_ReceiveFrame(phy_robus);
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW, ack.identifier);
+        Recep_CatchAck(phy_robus, &ack.unmap);
+        Test_TransmitEnd();
+        for (uint8_t i = 1; i <= ROBUS_ACK_WINDOW; i++)
+        {
+            TEST_ASSERT_EQUAL(1, window_delivered[i]);
+        }
+        TEST_ASSERT_EQUAL(0, phy_robus->job_nb);
+    }
+
+    NEW_TEST_CASE("Check that a source out of the routing table does not send windows");
+    {
+        Test_QueueWindow(phy_robus);
+        for (uint8_t i = 0; i < ROBUS_ACK_WINDOW; i++)
+        {
+            window_msg[i]->header.source = MAX_SERVICE_NUMBER + 1;
+        }
+        RobusHAL_StubClearTx();
+        Transmit_Process();
+        TEST_ASSERT_EQUAL(1, ctx.tx.window_size);
+        // The message is acknowledged alone
+        TEST_ASSERT_EQUAL(TX_NOK, ctx.tx.status);
+        ctx.tx.status = TX_OK;
+        Test_TransmitEnd();
+        TEST_ASSERT_EQUAL(ROBUS_ACK_WINDOW - 1, phy_robus->job_nb);
+        while (phy_robus->job_nb > 0)
+        {
+            Phy_RmJob(phy_robus, Phy_GetJob(phy_robus));
+        }
+        ctx.tx.lock        = false;
+        ctx.tx.status      = TX_DISABLE;
+        ctx.tx.window_size = 0;
+        ctx.tx.window_sent = 0;
+        RobusHAL_StubClearTx();
+    }
+    stub_robus_tx_hold = false;
+    Node_SetProtocolRevision(0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    MsgAlloc_Init(NULL);
+    Robus_Init();
+
+    UNIT_TEST_RUN(unittest_Recep_CatchAck);
+    UNIT_TEST_RUN(unittest_Recep_WindowMsg);
+    UNIT_TEST_RUN(unittest_Transmit_WindowRetry);
+
+    UNITY_END();
+}
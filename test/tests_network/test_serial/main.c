@@ -0,0 +1,332 @@
+#define SERIAL_TX_BATCH_SIZE 200
+#include "unit_test.h"
+#include "serial_network.h"
+#include "../src/serial_network.c"
+#include "_luos_phy.h"
+
+#define REMOTE_SERVICE_ID 10 // Service sending the messages received by the serial phy
+
+typedef enum
+{
+    TEST_CMD = LUOS_LAST_STD_CMD
+} test_cmd_t;
+
+service_t *app[2];
+msg_t last_rx_msg[2];
+
+static void App_MsgHandler(service_t *service, const msg_t *msg)
+{
+    memcpy(&last_rx_msg[(service == app[0]) ? 0 : 1], msg, sizeof(msg_t));
+}
+
+// Check if the detection master sent its periodic clock synchronization
+static bool clock_sync_sent(void)
+{
+    uint16_t index = 0;
+    while (index + sizeof(SerialHeader_t) + sizeof(header_t) < stub_tx_size)
+    {
+        SerialHeader_t *frame = (SerialHeader_t *)&stub_tx_data[index];
+        header_t *header      = (header_t *)&stub_tx_data[index + sizeof(SerialHeader_t)];
+        if ((frame->header == SERIAL_HEADER) && (header->cmd == CLOCK_SYNC))
+        {
+            return true;
+        }
+        index += sizeof(SerialHeader_t) + frame->size + 1;
+    }
+    return false;
+}
+
+// The serial phy is the only phy of this node
+static void Init_Serial_Context(void)
+{
+    RESET_ASSERT();
+    Luos_ServicesClear();
+    RoutingTB_Erase();
+    Luos_Init();
+    Serial_Init();
+    revision_t revision = {.major = 1, .minor = 0, .build = 0};
+    app[0]              = Luos_CreateService(App_MsgHandler, VOID_TYPE, "app_1", revision);
+    app[1]              = Luos_CreateService(App_MsgHandler, VOID_TYPE, "app_2", revision);
+    Luos_Detect(app[0]);
+    uint32_t started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 10000);
+    } while (!Luos_IsDetected());
+    // Keep the next clock synchronization out of the tests
+    started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 2 * CLOCK_SYNC_PERIOD_MS);
+    } while (!clock_sync_sent());
+    // Make the remote service known on the serial port
+    Phy_IndexSet(phy_serial->services, REMOTE_SERVICE_ID);
+    memset(last_rx_msg, 0, sizeof(last_rx_msg));
+    memset(&serial_stats, 0, sizeof(serial_stats_t));
+    SerialHAL_StubClearTx();
+}
+
+// Create a message from an unknown service to a local one
+static void set_msg(msg_t *msg, uint16_t target, uint16_t size, uint8_t value)
+{
+    memset(msg, 0, sizeof(msg_t));
+    msg->header.config      = BASE_PROTOCOL;
+    msg->header.target_mode = SERVICEID;
+    msg->header.target      = target;
+    msg->header.source      = REMOTE_SERVICE_ID;
+    msg->header.cmd         = TEST_CMD;
+    msg->header.size        = size;
+    memset(msg->data, value, size);
+}
+
+// Put a message in a frame
+static uint16_t set_frame(uint8_t *frame, const msg_t *msg)
+{
+    SerialHeader_t header;
+    header.header = SERIAL_HEADER;
+    header.size   = sizeof(header_t) + msg->header.size;
+    memcpy(frame, &header, sizeof(SerialHeader_t));
+    memcpy(&frame[sizeof(SerialHeader_t)], msg->stream, header.size);
+    frame[sizeof(SerialHeader_t) + header.size] = SERIAL_FOOTER;
+    return sizeof(SerialHeader_t) + header.size + 1;
+}
+
+// Put messages in a batched frame
+static uint16_t set_batch_frame(uint8_t *frame, const msg_t *msgs, uint16_t msg_nb)
+{
+    SerialHeader_t header;
+    header.header = SERIAL_BATCH_HEADER;
+    header.size   = 0;
+    for (uint16_t i = 0; i < msg_nb; i++)
+    {
+        uint16_t msg_size                                  = sizeof(header_t) + msgs[i].header.size;
+        frame[sizeof(SerialHeader_t) + header.size]        = (uint8_t)msg_size;
+        frame[sizeof(SerialHeader_t) + header.size + 1]    = (uint8_t)(msg_size >> 8);
+        memcpy(&frame[sizeof(SerialHeader_t) + header.size + 2], msgs[i].stream, msg_size);
+        header.size += msg_size + 2;
+    }
+    memcpy(frame, &header, sizeof(SerialHeader_t));
+    frame[sizeof(SerialHeader_t) + header.size] = SERIAL_FOOTER;
+    return sizeof(SerialHeader_t) + header.size + 1;
+}
+
+// Give received bytes to the serial phy then dispatch the messages
+static void receive(const uint8_t *data, uint16_t size)
+{
+    Serial_ReceptionWrite((uint8_t *)data, size);
+    Serial_Loop();
+    Luos_Loop();
+}
+
+void unittest_Serial_Send(void)
+{
+    NEW_TEST_CASE("Check the frame of a single message");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            msg_t msg;
+            set_msg(&msg, 0, 4, 0x55);
+            msg.header.target_mode = BROADCAST;
+            msg.header.target      = BROADCAST_VAL;
+            Luos_SendMsg(app[0], &msg);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(sizeof(SerialHeader_t) + sizeof(header_t) + 4 + 1, stub_tx_size);
+            TEST_ASSERT_EQUAL(SERIAL_HEADER, stub_tx_data[0]);
+            TEST_ASSERT_EQUAL(sizeof(header_t) + 4, stub_tx_data[1] | (stub_tx_data[2] << 8));
+            header_t *header = (header_t *)&stub_tx_data[sizeof(SerialHeader_t)];
+            TEST_ASSERT_EQUAL(TEST_CMD, header->cmd);
+            TEST_ASSERT_EQUAL(4, header->size);
+            TEST_ASSERT_EQUAL(0x55, stub_tx_data[sizeof(SerialHeader_t) + sizeof(header_t) + 3]);
+            TEST_ASSERT_EQUAL(SERIAL_FOOTER, stub_tx_data[stub_tx_size - 1]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that waiting messages are batched in a single frame");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            msg_t msg;
+            set_msg(&msg, 0, 4, 0x55);
+            msg.header.target_mode = BROADCAST;
+            msg.header.target      = BROADCAST_VAL;
+            // The first message is sent alone, the other ones wait for the end of its transmission
+            stub_tx_hold = true;
+            for (uint8_t i = 0; i < 3; i++)
+            {
+                msg.data[0] = i;
+                Luos_SendMsg(app[0], &msg);
+                Luos_Loop();
+            }
+            TEST_ASSERT_EQUAL(1, tx_job_nb);
+            SerialHAL_StubClearTx();
+            Serial_TransmissionEnd();
+            TEST_ASSERT_EQUAL(2, tx_job_nb);
+            uint16_t msg_size = sizeof(header_t) + 4;
+            TEST_ASSERT_EQUAL(sizeof(SerialHeader_t) + 2 * (SERIAL_SUBHEADER_SIZE + msg_size) + 1, stub_tx_size);
+            TEST_ASSERT_EQUAL(SERIAL_BATCH_HEADER, stub_tx_data[0]);
+            TEST_ASSERT_EQUAL(2 * (SERIAL_SUBHEADER_SIZE + msg_size), stub_tx_data[1] | (stub_tx_data[2] << 8));
+            for (uint8_t i = 0; i < 2; i++)
+            {
+                uint8_t *sub_header = &stub_tx_data[sizeof(SerialHeader_t) + i * (SERIAL_SUBHEADER_SIZE + msg_size)];
+                TEST_ASSERT_EQUAL(msg_size, sub_header[0] | (sub_header[1] << 8));
+                TEST_ASSERT_EQUAL(i + 1, sub_header[SERIAL_SUBHEADER_SIZE + sizeof(header_t)]);
+            }
+            TEST_ASSERT_EQUAL(SERIAL_FOOTER, stub_tx_data[stub_tx_size - 1]);
+
+            NEW_STEP("Check that the sent jobs are removed");
+            SerialHAL_StubClearTx();
+            stub_tx_hold = false;
+            Serial_TransmissionEnd();
+            TEST_ASSERT_EQUAL(0, Phy_GetJobNumber(phy_serial));
+            TEST_ASSERT_EQUAL(0, stub_tx_size);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_ReceiveBatch(void)
+{
+    NEW_TEST_CASE("Check the reception of a batched frame");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msgs[2];
+            set_msg(&msgs[0], app[0]->id, 4, 0x22);
+            set_msg(&msgs[1], app[1]->id, 8, 0x33);
+            uint16_t size = set_batch_frame(frame, msgs, 2);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(4, last_rx_msg[0].header.size);
+            TEST_ASSERT_EQUAL(0x22, last_rx_msg[0].data[3]);
+            TEST_ASSERT_EQUAL(8, last_rx_msg[1].header.size);
+            TEST_ASSERT_EQUAL(0x33, last_rx_msg[1].data[7]);
+            TEST_ASSERT_EQUAL(0, rx_size);
+            TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a batched frame with a wrong sub-header is dropped");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msgs[2];
+            set_msg(&msgs[0], app[0]->id, 4, 0x22);
+            set_msg(&msgs[1], app[1]->id, 8, 0x33);
+            uint16_t size = set_batch_frame(frame, msgs, 2);
+            // The second message is announced bigger than the frame
+            frame[sizeof(SerialHeader_t) + SERIAL_SUBHEADER_SIZE + sizeof(header_t) + 4]++;
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(0, last_rx_msg[0].header.size);
+            TEST_ASSERT_EQUAL(0, last_rx_msg[1].header.size);
+            TEST_ASSERT_EQUAL(1, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+
+            NEW_STEP("Check that the next frame is received");
+            size = set_frame(frame, &msgs[1]);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(0x33, last_rx_msg[1].data[7]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_ReceiveWrap(void)
+{
+    NEW_TEST_CASE("Check the reception of a frame cut by the end of the buffer at every position");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, app[0]->id, 8, 0x44);
+            uint16_t size = set_frame(frame, &msg);
+            // Cut the serial header, the message header, the data and the footer
+            for (uint16_t cut = 1; cut < size; cut++)
+            {
+                phy_serial->rx_buffer_base = &RX_data[sizeof(RX_data) - cut];
+                phy_serial->rx_data        = phy_serial->rx_buffer_base;
+                memset(&last_rx_msg[0], 0, sizeof(msg_t));
+                msg.data[0] = (uint8_t)cut;
+                set_frame(frame, &msg);
+                receive(frame, size);
+                TEST_ASSERT_EQUAL(8, last_rx_msg[0].header.size);
+                TEST_ASSERT_EQUAL(cut, last_rx_msg[0].data[0]);
+                TEST_ASSERT_EQUAL(0x44, last_rx_msg[0].data[7]);
+                TEST_ASSERT_EQUAL(0, rx_size);
+                TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+            }
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check the reception of a batched frame cut by the end of the buffer at every position");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msgs[2];
+            set_msg(&msgs[0], app[0]->id, 4, 0x22);
+            set_msg(&msgs[1], app[1]->id, 8, 0x33);
+            uint16_t size = set_batch_frame(frame, msgs, 2);
+            for (uint16_t cut = 1; cut < size; cut++)
+            {
+                phy_serial->rx_buffer_base = &RX_data[sizeof(RX_data) - cut];
+                phy_serial->rx_data        = phy_serial->rx_buffer_base;
+                memset(last_rx_msg, 0, sizeof(last_rx_msg));
+                receive(frame, size);
+                TEST_ASSERT_EQUAL(0x22, last_rx_msg[0].data[3]);
+                TEST_ASSERT_EQUAL(8, last_rx_msg[1].header.size);
+                TEST_ASSERT_EQUAL(0x33, last_rx_msg[1].data[7]);
+                TEST_ASSERT_EQUAL(0, rx_size);
+                TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+            }
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    UNIT_TEST_RUN(unittest_Serial_Send);
+    UNIT_TEST_RUN(unittest_Serial_ReceiveBatch);
+    UNIT_TEST_RUN(unittest_Serial_ReceiveWrap);
+
+    UNITY_END();
+}
@@ -0,0 +1,442 @@
+#define SERIAL_TX_BATCH_SIZE 300
+#define SERIAL_CRC           1
+#define SERIAL_COBS          1
+#include "unit_test.h"
+#include "serial_network.h"
+#include "../src/serial_network.c"
+#include "_luos_phy.h"
+
+#define REMOTE_SERVICE_ID 10 // Service sending the messages received by the serial phy
+
+typedef enum
+{
+    TEST_CMD = LUOS_LAST_STD_CMD
+} test_cmd_t;
+
+service_t *app;
+msg_t last_rx_msg;
+
+static void App_MsgHandler(service_t *service, const msg_t *msg)
+{
+    memcpy(&last_rx_msg, msg, sizeof(msg_t));
+}
+
+/******************************************************************************
+ * @brief Reference COBS encoding, the frame is surrounded by delimiters
+ ******************************************************************************/
+static uint16_t cobs_encode(const uint8_t *data, uint16_t size, uint8_t *encoded)
+{
+    uint16_t code_index = 1;
+    uint16_t index      = 2;
+    encoded[0]          = 0x00;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        if (data[i] != 0x00)
+        {
+            encoded[index++] = data[i];
+        }
+        if ((data[i] == 0x00) || (index - code_index == 0xFF))
+        {
+            encoded[code_index] = index - code_index;
+            code_index          = index++;
+        }
+    }
+    encoded[code_index] = index - code_index;
+    encoded[index++]    = 0x00;
+    return index;
+}
+
+/******************************************************************************
+ * @brief Reference COBS decoding of a frame surrounded by delimiters
+ ******************************************************************************/
+static uint16_t cobs_decode(const uint8_t *encoded, uint16_t size, uint8_t *data)
+{
+    uint16_t index   = 1;
+    uint16_t decoded = 0;
+    while (index < size - 1)
+    {
+        uint8_t code = encoded[index++];
+        for (uint8_t i = 1; i < code; i++)
+        {
+            data[decoded++] = encoded[index++];
+        }
+        if ((code < 0xFF) && (index < size - 1))
+        {
+            data[decoded++] = 0x00;
+        }
+    }
+    return decoded;
+}
+
+// Check if the detection master sent its periodic clock synchronization
+static bool clock_sync_sent(void)
+{
+    uint8_t frame[SERIAL_TX_FRAME_SIZE];
+    uint16_t start = 0;
+    for (uint16_t i = 1; i < stub_tx_size; i++)
+    {
+        if (stub_tx_data[i] != SERIAL_DELIMITER)
+        {
+            continue;
+        }
+        if (i - start > 1)
+        {
+            cobs_decode(&stub_tx_data[start], i - start + 1, frame);
+            header_t *header = (header_t *)&frame[sizeof(SerialHeader_t)];
+            if ((frame[0] == SERIAL_HEADER) && (header->cmd == CLOCK_SYNC))
+            {
+                return true;
+            }
+        }
+        start = ++i;
+    }
+    return false;
+}
+
+// The serial phy is the only phy of this node
+static void Init_Serial_Context(void)
+{
+    RESET_ASSERT();
+    Luos_ServicesClear();
+    RoutingTB_Erase();
+    Luos_Init();
+    Serial_Init();
+    revision_t revision = {.major = 1, .minor = 0, .build = 0};
+    app                 = Luos_CreateService(App_MsgHandler, VOID_TYPE, "app", revision);
+    Luos_Detect(app);
+    uint32_t started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 10000);
+    } while (!Luos_IsDetected());
+    // Keep the next clock synchronization out of the tests
+    started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 2 * CLOCK_SYNC_PERIOD_MS);
+    } while (!clock_sync_sent());
+    // Make the remote service known on the serial port
+    Phy_IndexSet(phy_serial->services, REMOTE_SERVICE_ID);
+    memset(&last_rx_msg, 0, sizeof(msg_t));
+    memset(&serial_stats, 0, sizeof(serial_stats_t));
+    SerialHAL_StubClearTx();
+}
+
+// Create a message from an unknown service to the local one, the data contains some delimiters
+static void set_msg(msg_t *msg, uint16_t size)
+{
+    memset(msg, 0, sizeof(msg_t));
+    msg->header.config      = BASE_PROTOCOL;
+    msg->header.target_mode = SERVICEID;
+    msg->header.target      = app->id;
+    msg->header.source      = REMOTE_SERVICE_ID;
+    msg->header.cmd         = TEST_CMD;
+    msg->header.size        = size;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        msg->data[i] = (i % 3 == 0) ? 0x00 : (uint8_t)i;
+    }
+}
+
+// Put a message in an encoded frame
+static uint16_t set_frame(uint8_t *frame, const msg_t *msg)
+{
+    uint8_t raw[SERIAL_TX_FRAME_SIZE];
+    SerialHeader_t header;
+    header.header = SERIAL_HEADER;
+    header.size   = sizeof(header_t) + msg->header.size;
+    memcpy(raw, &header, sizeof(SerialHeader_t));
+    memcpy(&raw[sizeof(SerialHeader_t)], msg->stream, header.size);
+    uint16_t size = sizeof(SerialHeader_t) + header.size;
+    uint16_t crc  = Luos_ComputeCRC(raw, size, 0xFFFF);
+    raw[size++]   = (uint8_t)crc;
+    raw[size++]   = (uint8_t)(crc >> 8);
+    return cobs_encode(raw, size, frame);
+}
+
+// Give received bytes to the serial phy then dispatch the messages
+static void receive(const uint8_t *data, uint16_t size)
+{
+    Serial_ReceptionWrite((uint8_t *)data, size);
+    Serial_Loop();
+    Luos_Loop();
+}
+
+void unittest_Luos_ComputeCRC(void)
+{
+    NEW_TEST_CASE("Check the CRC of a known vector");
+    {
+        const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+        TEST_ASSERT_EQUAL(0x329C, Luos_ComputeCRC(data, sizeof(data), 0xFFFF));
+    }
+
+    NEW_TEST_CASE("Check that the CRC can be computed in multiple parts");
+    {
+        const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+        uint16_t crc         = Luos_ComputeCRC(data, 4, 0xFFFF);
+        TEST_ASSERT_EQUAL(0x329C, Luos_ComputeCRC(&data[4], sizeof(data) - 4, crc));
+    }
+}
+
+void unittest_Serial_CobsDecode(void)
+{
+    NEW_TEST_CASE("Check the decoding of a known vector");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            const uint8_t encoded[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+            const uint8_t decoded[] = {0x11, 0x22, 0x00, 0x33};
+            memcpy(RX_data, encoded, sizeof(encoded));
+            phy_serial->rx_buffer_base = RX_data;
+            rx_size                    = sizeof(encoded);
+            TEST_ASSERT_EQUAL(sizeof(decoded), Serial_CobsDecode(sizeof(encoded)));
+            TEST_ASSERT_EQUAL_MEMORY(decoded, RX_data, sizeof(decoded));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check the decoding of a vector cut by the end of the buffer");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            const uint8_t encoded[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+            const uint8_t decoded[] = {0x11, 0x22, 0x00, 0x33};
+            memcpy(&RX_data[sizeof(RX_data) - 2], encoded, 2);
+            memcpy(RX_data, &encoded[2], sizeof(encoded) - 2);
+            phy_serial->rx_buffer_base = &RX_data[sizeof(RX_data) - 2];
+            rx_size                    = sizeof(encoded);
+            TEST_ASSERT_EQUAL(sizeof(decoded), Serial_CobsDecode(sizeof(encoded)));
+            TEST_ASSERT_EQUAL(decoded[0], RX_data[sizeof(RX_data) - 2]);
+            TEST_ASSERT_EQUAL(decoded[1], RX_data[sizeof(RX_data) - 1]);
+            TEST_ASSERT_EQUAL_MEMORY(&decoded[2], RX_data, sizeof(decoded) - 2);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a block going after the end of the frame is refused");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            const uint8_t encoded[] = {0x05, 0x11, 0x22};
+            memcpy(RX_data, encoded, sizeof(encoded));
+            phy_serial->rx_buffer_base = RX_data;
+            rx_size                    = sizeof(encoded);
+            TEST_ASSERT_EQUAL(0, Serial_CobsDecode(sizeof(encoded)));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_CobsSend(void)
+{
+    NEW_TEST_CASE("Check the encoded frame of a message containing delimiters");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            msg_t msg;
+            set_msg(&msg, 20);
+            msg.header.target_mode = BROADCAST;
+            msg.header.target      = BROADCAST_VAL;
+            Luos_SendMsg(app, &msg);
+            Luos_Loop();
+            TEST_ASSERT_EQUAL(SERIAL_DELIMITER, stub_tx_data[0]);
+            TEST_ASSERT_EQUAL(SERIAL_DELIMITER, stub_tx_data[stub_tx_size - 1]);
+            for (uint16_t i = 1; i < stub_tx_size - 1; i++)
+            {
+                TEST_ASSERT_NOT_EQUAL(SERIAL_DELIMITER, stub_tx_data[i]);
+            }
+            uint8_t frame[SERIAL_TX_FRAME_SIZE];
+            uint16_t size = cobs_decode(stub_tx_data, stub_tx_size, frame);
+            TEST_ASSERT_EQUAL(sizeof(SerialHeader_t) + sizeof(header_t) + 20 + SERIAL_CRC_SIZE, size);
+            TEST_ASSERT_EQUAL(SERIAL_HEADER, frame[0]);
+            TEST_ASSERT_EQUAL(sizeof(header_t) + 20, frame[1] | (frame[2] << 8));
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, &frame[sizeof(SerialHeader_t) + sizeof(header_t)], 20);
+            uint16_t crc = Luos_ComputeCRC(frame, size - SERIAL_CRC_SIZE, 0xFFFF);
+            TEST_ASSERT_EQUAL(crc, frame[size - 2] | (frame[size - 1] << 8));
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check the loopback of a frame bigger than a COBS block");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            // A frame without any delimiter needs more than one block
+            SerialHeader_t header;
+            header.header = SERIAL_BATCH_HEADER;
+            header.size   = 280;
+            memcpy(TX_data, &header, sizeof(SerialHeader_t));
+            memset(&TX_data[sizeof(SerialHeader_t)], 0x55, header.size);
+            Serial_SendFrame();
+            TEST_ASSERT_EQUAL(SERIAL_DELIMITER, stub_tx_data[0]);
+            TEST_ASSERT_EQUAL(0xFF, stub_tx_data[1]);
+            Serial_ReceptionWrite(stub_tx_data, stub_tx_size);
+            SerialHeader_t rx_header;
+            TEST_ASSERT_EQUAL(stub_tx_size - 1, Serial_FindFrame(&rx_header));
+            TEST_ASSERT_EQUAL(SERIAL_BATCH_HEADER, rx_header.header);
+            TEST_ASSERT_EQUAL(280, rx_header.size);
+            for (uint16_t i = 0; i < header.size; i++)
+            {
+                TEST_ASSERT_EQUAL(0x55, Serial_GetRxByte(sizeof(SerialHeader_t) + i));
+            }
+            TEST_ASSERT_EQUAL(0, serial_stats.crc_error_number);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_CobsReceive(void)
+{
+    NEW_TEST_CASE("Check the reception of an encoded frame");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20);
+            uint16_t size = set_frame(frame, &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(0, rx_size);
+            TEST_ASSERT_EQUAL(0, serial_stats.crc_error_number);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a frame with a wrong CRC is dropped");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20);
+            uint16_t size = set_frame(frame, &msg);
+            // Corrupt a data byte without creating a delimiter
+            frame[size - 6] ^= 0x01;
+            if (frame[size - 6] == SERIAL_DELIMITER)
+            {
+                frame[size - 6] ^= 0x03;
+            }
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(0, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL(1, serial_stats.crc_error_number);
+            TEST_ASSERT_EQUAL(1, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+
+            NEW_STEP("Check that the next frame is received");
+            size = set_frame(frame, &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check the resynchronisation on the delimiter after garbage");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20);
+            // Garbage followed by a complete frame, the garbage ends on the first delimiter of the frame
+            const uint8_t garbage[] = {0x12, 0x34, 0x56};
+            memcpy(frame, garbage, sizeof(garbage));
+            uint16_t size = sizeof(garbage) + set_frame(&frame[sizeof(garbage)], &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(1, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_CobsReceiveWrap(void)
+{
+    NEW_TEST_CASE("Check the reception of an encoded frame cut by the end of the buffer at every position");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20);
+            uint16_t size = set_frame(frame, &msg);
+            for (uint16_t cut = 1; cut < size; cut++)
+            {
+                phy_serial->rx_buffer_base = &RX_data[sizeof(RX_data) - cut];
+                phy_serial->rx_data        = phy_serial->rx_buffer_base;
+                memset(&last_rx_msg, 0, sizeof(msg_t));
+                receive(frame, size);
+                TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+                TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+                TEST_ASSERT_EQUAL(0, rx_size);
+                TEST_ASSERT_EQUAL(0, serial_stats.crc_error_number);
+                TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+            }
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    UNIT_TEST_RUN(unittest_Luos_ComputeCRC);
+    UNIT_TEST_RUN(unittest_Serial_CobsDecode);
+    UNIT_TEST_RUN(unittest_Serial_CobsSend);
+    UNIT_TEST_RUN(unittest_Serial_CobsReceive);
+    UNIT_TEST_RUN(unittest_Serial_CobsReceiveWrap);
+
+    UNITY_END();
+}
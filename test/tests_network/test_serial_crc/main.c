@@ -0,0 +1,297 @@
+#define SERIAL_TX_BATCH_SIZE 200
+#define SERIAL_CRC           1
+#include "unit_test.h"
+#include "serial_network.h"
+#include "../src/serial_network.c"
+#include "_luos_phy.h"
+
+#define REMOTE_SERVICE_ID 10 // Service sending the messages received by the serial phy
+
+typedef enum
+{
+    TEST_CMD = LUOS_LAST_STD_CMD
+} test_cmd_t;
+
+service_t *app;
+msg_t last_rx_msg;
+
+static void App_MsgHandler(service_t *service, const msg_t *msg)
+{
+    memcpy(&last_rx_msg, msg, sizeof(msg_t));
+}
+
+// Check if the detection master sent its periodic clock synchronization
+static bool clock_sync_sent(void)
+{
+    uint16_t index = 0;
+    while (index + sizeof(SerialHeader_t) + sizeof(header_t) < stub_tx_size)
+    {
+        SerialHeader_t *frame = (SerialHeader_t *)&stub_tx_data[index];
+        header_t *header      = (header_t *)&stub_tx_data[index + sizeof(SerialHeader_t)];
+        if ((frame->header == SERIAL_HEADER) && (header->cmd == CLOCK_SYNC))
+        {
+            return true;
+        }
+        index += sizeof(SerialHeader_t) + frame->size + SERIAL_CRC_SIZE + 1;
+    }
+    return false;
+}
+
+// The serial phy is the only phy of this node
+static void Init_Serial_Context(void)
+{
+    RESET_ASSERT();
+    Luos_ServicesClear();
+    RoutingTB_Erase();
+    Luos_Init();
+    Serial_Init();
+    revision_t revision = {.major = 1, .minor = 0, .build = 0};
+    app                 = Luos_CreateService(App_MsgHandler, VOID_TYPE, "app", revision);
+    Luos_Detect(app);
+    uint32_t started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 10000);
+    } while (!Luos_IsDetected());
+    // Keep the next clock synchronization out of the tests
+    started_time = Luos_GetSystick();
+    do
+    {
+        Luos_Loop();
+        TEST_ASSERT_TRUE(Luos_GetSystick() - started_time < 2 * CLOCK_SYNC_PERIOD_MS);
+    } while (!clock_sync_sent());
+    // Make the remote service known on the serial port
+    Phy_IndexSet(phy_serial->services, REMOTE_SERVICE_ID);
+    memset(&last_rx_msg, 0, sizeof(msg_t));
+    memset(&serial_stats, 0, sizeof(serial_stats_t));
+    SerialHAL_StubClearTx();
+}
+
+// Create a message from an unknown service to the local one
+static void set_msg(msg_t *msg, uint16_t size, uint8_t value)
+{
+    memset(msg, 0, sizeof(msg_t));
+    msg->header.config      = BASE_PROTOCOL;
+    msg->header.target_mode = SERVICEID;
+    msg->header.target      = app->id;
+    msg->header.source      = REMOTE_SERVICE_ID;
+    msg->header.cmd         = TEST_CMD;
+    msg->header.size        = size;
+    memset(msg->data, value, size);
+}
+
+// Put a message in a frame protected by a CRC
+static uint16_t set_frame(uint8_t *frame, const msg_t *msg)
+{
+    SerialHeader_t header;
+    header.header = SERIAL_HEADER;
+    header.size   = sizeof(header_t) + msg->header.size;
+    memcpy(frame, &header, sizeof(SerialHeader_t));
+    memcpy(&frame[sizeof(SerialHeader_t)], msg->stream, header.size);
+    uint16_t size = sizeof(SerialHeader_t) + header.size;
+    uint16_t crc  = Luos_ComputeCRC(frame, size, 0xFFFF);
+    frame[size++] = (uint8_t)crc;
+    frame[size++] = (uint8_t)(crc >> 8);
+    frame[size++] = SERIAL_FOOTER;
+    return size;
+}
+
+// Give received bytes to the serial phy then dispatch the messages
+static void receive(const uint8_t *data, uint16_t size)
+{
+    Serial_ReceptionWrite((uint8_t *)data, size);
+    Serial_Loop();
+    Luos_Loop();
+}
+
+void unittest_Serial_CrcSend(void)
+{
+    NEW_TEST_CASE("Check that the CRC is sent before the footer");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            msg_t msg;
+            set_msg(&msg, 4, 0x55);
+            msg.header.target_mode = BROADCAST;
+            msg.header.target      = BROADCAST_VAL;
+            Luos_SendMsg(app, &msg);
+            Luos_Loop();
+            uint16_t size = sizeof(SerialHeader_t) + sizeof(header_t) + 4;
+            TEST_ASSERT_EQUAL(size + SERIAL_CRC_SIZE + 1, stub_tx_size);
+            TEST_ASSERT_EQUAL(SERIAL_HEADER, stub_tx_data[0]);
+            TEST_ASSERT_EQUAL(sizeof(header_t) + 4, stub_tx_data[1] | (stub_tx_data[2] << 8));
+            uint16_t crc = Luos_ComputeCRC(stub_tx_data, size, 0xFFFF);
+            TEST_ASSERT_EQUAL(crc, stub_tx_data[size] | (stub_tx_data[size + 1] << 8));
+            TEST_ASSERT_EQUAL(SERIAL_FOOTER, stub_tx_data[stub_tx_size - 1]);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_CrcReceive(void)
+{
+    NEW_TEST_CASE("Check the reception of a frame with a correct CRC");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20, 0x55);
+            uint16_t size = set_frame(frame, &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(0, rx_size);
+            TEST_ASSERT_EQUAL(0, serial_stats.crc_error_number);
+            TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that a frame with a wrong CRC is dropped");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20, 0x55);
+            uint16_t size = set_frame(frame, &msg);
+            // This frame only have a header byte at its beginning
+            TEST_ASSERT_TRUE(memchr(&frame[1], SERIAL_HEADER, size - 1) == NULL);
+            TEST_ASSERT_TRUE(memchr(&frame[1], SERIAL_BATCH_HEADER, size - 1) == NULL);
+            frame[size - 6] ^= 0x01;
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(0, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL(1, serial_stats.crc_error_number);
+            TEST_ASSERT_EQUAL(1, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(size, serial_stats.dropped_byte_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+
+            NEW_STEP("Check that the next frame is received");
+            size = set_frame(frame, &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(1, serial_stats.crc_error_number);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check that the garbage before a frame is dropped at once");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20, 0x55);
+            const uint8_t garbage[] = {0x12, 0x34, 0x56, 0x78};
+            memcpy(frame, garbage, sizeof(garbage));
+            uint16_t size = sizeof(garbage) + set_frame(&frame[sizeof(garbage)], &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(sizeof(garbage), serial_stats.dropped_byte_number);
+            TEST_ASSERT_EQUAL(0, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+
+    NEW_TEST_CASE("Check the resynchronisation after a false header in the garbage");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20, 0x55);
+            // The false headers give a size too big to be received
+            const uint8_t garbage[] = {0x12, SERIAL_HEADER, 0xFF, 0xFF, 0x34, SERIAL_BATCH_HEADER, 0xFF, 0xFF, 0x56};
+            memcpy(frame, garbage, sizeof(garbage));
+            uint16_t size = sizeof(garbage) + set_frame(&frame[sizeof(garbage)], &msg);
+            receive(frame, size);
+            TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+            TEST_ASSERT_EQUAL_MEMORY(msg.data, last_rx_msg.data, 20);
+            TEST_ASSERT_EQUAL(sizeof(garbage), serial_stats.dropped_byte_number);
+            TEST_ASSERT_EQUAL(2, serial_stats.resync_number);
+            TEST_ASSERT_EQUAL(0, rx_size);
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+void unittest_Serial_CrcReceiveWrap(void)
+{
+    NEW_TEST_CASE("Check the reception of a frame cut by the end of the buffer at every position");
+    {
+        TRY
+        {
+            Init_Serial_Context();
+            uint8_t frame[SERIAL_RX_BUFFER_SIZE];
+            msg_t msg;
+            set_msg(&msg, 20, 0x44);
+            // Garbage before the frame is dropped across the end of the buffer too
+            frame[0]      = 0x12;
+            frame[1]      = 0x34;
+            uint16_t size = 2 + set_frame(&frame[2], &msg);
+            // Cut the garbage, the serial header, the message header, the data, the CRC and the footer
+            for (uint16_t cut = 1; cut < size; cut++)
+            {
+                msg.data[0] = (uint8_t)cut;
+                set_frame(&frame[2], &msg);
+                phy_serial->rx_buffer_base = &RX_data[sizeof(RX_data) - cut];
+                phy_serial->rx_data        = phy_serial->rx_buffer_base;
+                memset(&last_rx_msg, 0, sizeof(msg_t));
+                memset(&serial_stats, 0, sizeof(serial_stats_t));
+                receive(frame, size);
+                TEST_ASSERT_EQUAL(20, last_rx_msg.header.size);
+                TEST_ASSERT_EQUAL(cut, last_rx_msg.data[0]);
+                TEST_ASSERT_EQUAL(0x44, last_rx_msg.data[19]);
+                TEST_ASSERT_EQUAL(2, serial_stats.dropped_byte_number);
+                TEST_ASSERT_EQUAL(0, serial_stats.crc_error_number);
+                TEST_ASSERT_EQUAL(0, rx_size);
+            }
+        }
+        CATCH
+        {
+            TEST_ASSERT_TRUE(false);
+        }
+        END_TRY;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    UNIT_TEST_RUN(unittest_Serial_CrcSend);
+    UNIT_TEST_RUN(unittest_Serial_CrcReceive);
+    UNIT_TEST_RUN(unittest_Serial_CrcReceiveWrap);
+
+    UNITY_END();
+}
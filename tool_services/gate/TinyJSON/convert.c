@@ -550,6 +550,15 @@ void Convert_JsonToMsg(service_t *service, uint16_t id, luos_type_t type, char *
         Luos_SendMsg(service, msg);
         return;
     }
+    // Luos IO STAT
+    if (property && !strcmp(property, "luos_io_statistics"))
+    {
+        msg->header.cmd  = LUOS_STATISTICS;
+        msg->header.size = 1;
+        msg->data[0]     = IO_STATS;
+        Luos_SendMsg(service, msg);
+        return;
+    }
     // Parameters
     if (property && !strcmp(property, "parameters"))
     {
@@ -672,7 +681,7 @@ uint16_t Convert_StartServiceData(char *data, char *alias)
     return (uint16_t)strlen(data);
 }
 // This function create the Json content from a message and return the string size.
-uint16_t Convert_MsgToData(msg_t *msg, char *data)
+uint16_t Convert_MsgToData(const msg_t *msg, char *data)
 {
     float fdata;
     switch (msg->header.cmd)
@@ -744,7 +753,7 @@ uint16_t Convert_MsgToData(msg_t *msg, char *data)
         case LUOS_STATISTICS:
             if (msg->header.size == sizeof(general_stats_t))
             {
-                general_stats_t *stat = (general_stats_t *)msg->data;
+                const general_stats_t *stat = (const general_stats_t *)msg->data;
                 // create the Json content
                 sprintf(data, "\"luos_statistics\":{\"rx_msg_stack\":%d,\"luos_stack\":%d,\"tx_msg_stack\":%d,\"buffer_occupation\":%d,\"msg_drop\":%d,\"loop_ms\":%d,\"max_retry\":%d},",
                         stat->node_stat.memory.rx_msg_stack_ratio,
@@ -755,6 +764,29 @@ uint16_t Convert_MsgToData(msg_t *msg, char *data)
                         stat->node_stat.max_loop_time_ms,
                         stat->service_stat.max_retry);
             }
+            else if (msg->header.size == sizeof(io_stats_t))
+            {
+                io_stats_t stat;
+                char *json = data;
+                memcpy(stat.unmap, msg->data, sizeof(io_stats_t));
+                // create the Json content
+                json += sprintf(json, "\"luos_io_statistics\":{\"alloc_latency_ns\":%lu,\"alloc_fail\":%d,\"msg_size\":[%d,%d,%d,%d,%d],\"phy\":[",
+                                (unsigned long)stat.max_alloc_latency_ns,
+                                stat.alloc_failure_number,
+                                stat.msg_size[0], stat.msg_size[1], stat.msg_size[2], stat.msg_size[3], stat.msg_size[4]);
+                for (uint8_t i = 0; i < STATS_PHY_NB; i++)
+                {
+                    const phy_stats_t *phy_stat = &stat.phy[i];
+                    json += sprintf(json, "{\"rx_queue\":[%d,%d,%d,%d,%d],\"tx_queue\":[%d,%d,%d,%d,%d],\"drop\":%d,\"retry\":%d,\"collision\":%d}%s",
+                                    phy_stat->rx_queue_depth[0], phy_stat->rx_queue_depth[1], phy_stat->rx_queue_depth[2], phy_stat->rx_queue_depth[3], phy_stat->rx_queue_depth[4],
+                                    phy_stat->tx_queue_depth[0], phy_stat->tx_queue_depth[1], phy_stat->tx_queue_depth[2], phy_stat->tx_queue_depth[3], phy_stat->tx_queue_depth[4],
+                                    phy_stat->drop_number,
+                                    phy_stat->retry_number,
+                                    phy_stat->collision_number,
+                                    (i < STATS_PHY_NB - 1) ? "," : "");
+                }
+                sprintf(json, "]},");
+            }
             break;
         case IO_STATE:
             // check size
@@ -117,7 +117,6 @@ void DataManager_Format(service_t *service)
 {
     char data[GATE_BUFF_SIZE];
     char boot_data[GATE_BUFF_SIZE];
-    msg_t data_msg;
     search_result_t result;
     static uint32_t FirstNoReceptionDate = 0;
     static uint32_t LastVoidMsg          = 0;
@@ -137,64 +136,75 @@ void DataManager_Format(service_t *service)
         int i = 0;
         while (i < result.result_nbr)
         {
-            if (Luos_ReadFromService(service, result.result_table[i]->id, &data_msg) == SUCCEED)
+            // Messages are read directly from the message buffer without copying them
+            const msg_t *data_msg;
+            if (Luos_BorrowFromService(service, result.result_table[i]->id, &data_msg) == SUCCEED)
             {
                 // check if this is an assert
-                if (data_msg.header.cmd == ASSERT)
+                if (data_msg->header.cmd == ASSERT)
                 {
                     luos_assert_t assertion;
-                    memcpy(assertion.unmap, data_msg.data, data_msg.header.size);
-                    assertion.unmap[data_msg.header.size] = '\0';
-                    Convert_AssertToData(service, data_msg.header.source, assertion);
+                    uint16_t source = data_msg->header.source;
+                    memcpy(assertion.unmap, data_msg->data, data_msg->header.size);
+                    assertion.unmap[data_msg->header.size] = '\0';
+                    Luos_ReleaseMsg(service, data_msg);
+                    Convert_AssertToData(service, source, assertion);
                     i++;
                     continue;
                 }
-                if (data_msg.header.cmd == DEADTARGET)
+                if (data_msg->header.cmd == DEADTARGET)
                 {
-                    dead_target_t *dead_target = (dead_target_t *)data_msg.data;
-                    if (dead_target->node_id != 0)
+                    dead_target_t dead_target;
+                    memcpy(&dead_target, data_msg->data, sizeof(dead_target_t));
+                    Luos_ReleaseMsg(service, data_msg);
+                    if (dead_target.node_id != 0)
                     {
-                        Convert_DeadNodeToData(service, dead_target->node_id);
+                        Convert_DeadNodeToData(service, dead_target.node_id);
                     }
-                    if (dead_target->service_id != 0)
+                    if (dead_target.service_id != 0)
                     {
-                        Convert_DeadServiceToData(service, dead_target->service_id);
+                        Convert_DeadServiceToData(service, dead_target.service_id);
                     }
                     continue;
                 }
                 // check if a node send a bootloader message
-                if (data_msg.header.cmd >= BOOTLOADER_START && data_msg.header.cmd <= BOOTLOADER_ERROR_SIZE)
+                if (data_msg->header.cmd >= BOOTLOADER_START && data_msg->header.cmd <= BOOTLOADER_ERROR_SIZE)
                 {
+                    uint16_t source = data_msg->header.source;
                     do
                     {
-                        boot_data_ptr += Bootloader_LuosToJson(&data_msg, boot_data_ptr);
-                    } while (Luos_ReadFromService(service, data_msg.header.source, &data_msg) == SUCCEED);
+                        boot_data_ptr += Bootloader_LuosToJson(data_msg, boot_data_ptr);
+                        Luos_ReleaseMsg(service, data_msg);
+                    } while (Luos_BorrowFromService(service, source, &data_msg) == SUCCEED);
                     boot_data_ok = true;
                     i++;
                     continue;
                 }
                 // check if a node send a end detection
-                if (data_msg.header.cmd == END_DETECTION)
+                if (data_msg->header.cmd == END_DETECTION)
                 {
+                    Luos_ReleaseMsg(service, data_msg);
                     // find a pipe
                     PipeLink_Find(service);
                     i++;
                     continue;
                 }
                 // Check if this is a message from pipe
-                if (data_msg.header.source == PipeLink_GetId())
+                if (data_msg->header.source == PipeLink_GetId())
                 {
                     do
                     {
                         // This message is a command from pipe
                         static char data_cmd[GATE_BUFF_SIZE];
                         // Convert the received data into Luos commands
-                        int size = Luos_ReceiveData(service, &data_msg, data_cmd);
+                        int size    = Luos_ReceiveData(service, data_msg, data_cmd);
+                        uint8_t cmd = data_msg->header.cmd;
+                        Luos_ReleaseMsg(service, data_msg);
                         if (size > 0)
                         {
                             // We finish to receive this data, execute the received command
                             char *data_ptr = data_cmd;
-                            if (data_msg.header.cmd == SET_CMD)
+                            if (cmd == SET_CMD)
                             {
                                 while (size > 0 && *data_ptr == '{')
                                 {
@@ -205,11 +215,12 @@ void DataManager_Format(service_t *service)
                                 }
                             }
                         }
-                    } while (Luos_ReadFromService(service, PipeLink_GetId(), &data_msg) == SUCCEED);
+                    } while (Luos_BorrowFromService(service, PipeLink_GetId(), &data_msg) == SUCCEED);
                     i++;
                     continue;
                 }
                 // get the source of this message
+                uint16_t source = data_msg->header.source;
                 // Create service description
                 char *alias;
                 alias = result.result_table[i]->alias;
@@ -219,8 +230,9 @@ void DataManager_Format(service_t *service)
                 // Convert all msgs from this service into data
                 do
                 {
-                    data_ptr += Convert_MsgToData(&data_msg, data_ptr);
-                } while (Luos_ReadFromService(service, data_msg.header.source, &data_msg) == SUCCEED);
+                    data_ptr += Convert_MsgToData(data_msg, data_ptr);
+                    Luos_ReleaseMsg(service, data_msg);
+                } while (Luos_BorrowFromService(service, source, &data_msg) == SUCCEED);
 
                 data_ptr += Convert_EndServiceData(data_ptr);
                 LUOS_ASSERT((data_ptr - data) < GATE_BUFF_SIZE);